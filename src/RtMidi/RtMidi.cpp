@@ -39,16 +39,583 @@
 #include "RtMidi.h"
 #include <sstream>
 
+// All APIs with an input thread of their own use POSIX threads.
+#if defined(__LINUX_ALSASEQ__) || defined(__LINUX_ALSARAW__) || defined(__UNIX_JACK__) || defined(__IRIX_MD__) || defined(__RTMIDI_LOOPBACK__)
+#define __RTMIDI_PTHREADS__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+// The clock used for absolute time stamps.
+#if defined(__MACOSX_CORE__)
+#include <CoreAudio/HostTime.h>
+#elif defined(__WINDOWS_MM__)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// Counters that the input threads change and the application reads are
+// updated atomically.  Read them by adding zero.
+#if defined(_MSC_VER)
+#include <windows.h>
+static unsigned long rtmidiAtomicAdd( volatile unsigned long *counter, unsigned long value )
+{
+  return (unsigned long) InterlockedExchangeAdd( (volatile LONG *) counter, (LONG) value ) + value;
+}
+#else
+static unsigned long rtmidiAtomicAdd( volatile unsigned long *counter, unsigned long value )
+{
+  return __sync_add_and_fetch( counter, value );
+}
+#endif
+
+// Optional trace spans of the send and receive paths (CONFIG+=trace_events).
+#if defined(__DTEDIT_TRACE_EVENTS__)
+#include "../traceevents.h"
+#else
+#define TRACE_SPAN( category, name )
+#endif
+
+// **************************************************************** //
+//
+// MidiInApi and MidiOutApi subclass prototypes.
+//
+// **************************************************************** //
+
+#if defined(__MACOSX_CORE__)
+
+class MidiInCore: public MidiInApi
+{
+ public:
+  MidiInCore( const std::string clientName );
+  ~MidiInCore( void );
+  RtMidi::Api getCurrentApi( void ) { return RtMidi::MACOSX_CORE; };
+  void openPort( unsigned int portNumber, const std::string portName );
+  void openVirtualPort( const std::string portName );
+  void closePort( void );
+  unsigned int getPortCount( void );
+  std::string getPortName( unsigned int portNumber );
+
+ protected:
+  void initialize( const std::string& clientName );
+};
+
+class MidiOutCore: public MidiOutApi
+{
+ public:
+  MidiOutCore( const std::string clientName );
+  ~MidiOutCore( void );
+  RtMidi::Api getCurrentApi( void ) { return RtMidi::MACOSX_CORE; };
+  void openPort( unsigned int portNumber, const std::string portName );
+  void openVirtualPort( const std::string portName );
+  void closePort( void );
+  unsigned int getPortCount( void );
+  std::string getPortName( unsigned int portNumber );
+  void sendMessage( std::vector<unsigned char> *message );
+
+ protected:
+  void initialize( const std::string& clientName );
+};
+
+#endif
+
+#if defined(__LINUX_ALSASEQ__)
+
+class MidiInAlsa: public MidiInApi
+{
+ public:
+  MidiInAlsa( const std::string clientName );
+  ~MidiInAlsa( void );
+  RtMidi::Api getCurrentApi( void ) { return RtMidi::LINUX_ALSA; };
+  void openPort( unsigned int portNumber, const std::string portName );
+  void openVirtualPort( const std::string portName );
+  void closePort( void );
+  unsigned int getPortCount( void );
+  std::string getPortName( unsigned int portNumber );
+
+ protected:
+  void initialize( const std::string& clientName );
+};
+
+class MidiOutAlsa: public MidiOutApi
+{
+ public:
+  MidiOutAlsa( const std::string clientName );
+  ~MidiOutAlsa( void );
+  RtMidi::Api getCurrentApi( void ) { return RtMidi::LINUX_ALSA; };
+  void openPort( unsigned int portNumber, const std::string portName );
+  void openVirtualPort( const std::string portName );
+  void closePort( void );
+  unsigned int getPortCount( void );
+  std::string getPortName( unsigned int portNumber );
+  void sendMessage( std::vector<unsigned char> *message );
+
+ protected:
+  void initialize( const std::string& clientName );
+};
+
+#endif
+
+#if defined(__LINUX_ALSARAW__)
+
+class MidiInAlsaRaw: public MidiInApi
+{
+ public:
+  MidiInAlsaRaw( const std::string clientName );
+  ~MidiInAlsaRaw( void );
+  RtMidi::Api getCurrentApi( void ) { return RtMidi::LINUX_ALSA_RAW; };
+  void openPort( unsigned int portNumber, const std::string portName );
+  void openVirtualPort( const std::string portName );
+  void closePort( void );
+  unsigned int getPortCount( void );
+  std::string getPortName( unsigned int portNumber );
+
+ protected:
+  void initialize( const std::string& clientName );
+};
+
+class MidiOutAlsaRaw: public MidiOutApi
+{
+ public:
+  MidiOutAlsaRaw( const std::string clientName );
+  ~MidiOutAlsaRaw( void );
+  RtMidi::Api getCurrentApi( void ) { return RtMidi::LINUX_ALSA_RAW; };
+  void openPort( unsigned int portNumber, const std::string portName );
+  void openVirtualPort( const std::string portName );
+  void closePort( void );
+  unsigned int getPortCount( void );
+  std::string getPortName( unsigned int portNumber );
+  void sendMessage( std::vector<unsigned char> *message );
+
+ protected:
+  void initialize( const std::string& clientName );
+};
+
+#endif
+
+#if defined(__UNIX_JACK__)
+
+class MidiInJack: public MidiInApi
+{
+ public:
+  MidiInJack( const std::string clientName );
+  ~MidiInJack( void );
+  RtMidi::Api getCurrentApi( void ) { return RtMidi::UNIX_JACK; };
+  void openPort( unsigned int portNumber, const std::string portName );
+  void openVirtualPort( const std::string portName );
+  void closePort( void );
+  unsigned int getPortCount( void );
+  std::string getPortName( unsigned int portNumber );
+
+ protected:
+  void initialize( const std::string& clientName );
+};
+
+class MidiOutJack: public MidiOutApi
+{
+ public:
+  MidiOutJack( const std::string clientName );
+  ~MidiOutJack( void );
+  RtMidi::Api getCurrentApi( void ) { return RtMidi::UNIX_JACK; };
+  void openPort( unsigned int portNumber, const std::string portName );
+  void openVirtualPort( const std::string portName );
+  void closePort( void );
+  unsigned int getPortCount( void );
+  std::string getPortName( unsigned int portNumber );
+  void sendMessage( std::vector<unsigned char> *message );
+
+ protected:
+  void initialize( const std::string& clientName );
+};
+
+#endif
+
+#if defined(__IRIX_MD__)
+
+class MidiInIrix: public MidiInApi
+{
+ public:
+  MidiInIrix( const std::string clientName );
+  ~MidiInIrix( void );
+  RtMidi::Api getCurrentApi( void ) { return RtMidi::IRIX_MD; };
+  void openPort( unsigned int portNumber, const std::string portName );
+  void openVirtualPort( const std::string portName );
+  void closePort( void );
+  unsigned int getPortCount( void );
+  std::string getPortName( unsigned int portNumber );
+
+ protected:
+  void initialize( const std::string& clientName );
+};
+
+class MidiOutIrix: public MidiOutApi
+{
+ public:
+  MidiOutIrix( const std::string clientName );
+  ~MidiOutIrix( void );
+  RtMidi::Api getCurrentApi( void ) { return RtMidi::IRIX_MD; };
+  void openPort( unsigned int portNumber, const std::string portName );
+  void openVirtualPort( const std::string portName );
+  void closePort( void );
+  unsigned int getPortCount( void );
+  std::string getPortName( unsigned int portNumber );
+  void sendMessage( std::vector<unsigned char> *message );
+
+ protected:
+  void initialize( const std::string& clientName );
+};
+
+#endif
+
+#if defined(__WINDOWS_MM__)
+
+class MidiInWinMM: public MidiInApi
+{
+ public:
+  MidiInWinMM( const std::string clientName );
+  ~MidiInWinMM( void );
+  RtMidi::Api getCurrentApi( void ) { return RtMidi::WINDOWS_MM; };
+  void openPort( unsigned int portNumber, const std::string portName );
+  void openVirtualPort( const std::string portName );
+  void closePort( void );
+  unsigned int getPortCount( void );
+  std::string getPortName( unsigned int portNumber );
+
+ protected:
+  void initialize( const std::string& clientName );
+};
+
+class MidiOutWinMM: public MidiOutApi
+{
+ public:
+  MidiOutWinMM( const std::string clientName );
+  ~MidiOutWinMM( void );
+  RtMidi::Api getCurrentApi( void ) { return RtMidi::WINDOWS_MM; };
+  void openPort( unsigned int portNumber, const std::string portName );
+  void openVirtualPort( const std::string portName );
+  void closePort( void );
+  unsigned int getPortCount( void );
+  std::string getPortName( unsigned int portNumber );
+  void sendMessage( std::vector<unsigned char> *message );
+
+ protected:
+  void initialize( const std::string& clientName );
+};
+
+#endif
+
+#if defined(__RTMIDI_LOOPBACK__)
+
+class MidiInLoopback: public MidiInApi
+{
+ public:
+  MidiInLoopback( const std::string clientName );
+  ~MidiInLoopback( void );
+  RtMidi::Api getCurrentApi( void ) { return RtMidi::LOOPBACK; };
+  void openPort( unsigned int portNumber, const std::string portName );
+  void openVirtualPort( const std::string portName );
+  void closePort( void );
+  unsigned int getPortCount( void );
+  std::string getPortName( unsigned int portNumber );
+
+ protected:
+  void initialize( const std::string& clientName );
+  void connect( void *bus, bool ownsBus );
+};
+
+class MidiOutLoopback: public MidiOutApi
+{
+ public:
+  MidiOutLoopback( const std::string clientName );
+  ~MidiOutLoopback( void );
+  RtMidi::Api getCurrentApi( void ) { return RtMidi::LOOPBACK; };
+  void openPort( unsigned int portNumber, const std::string portName );
+  void openVirtualPort( const std::string portName );
+  void closePort( void );
+  unsigned int getPortCount( void );
+  std::string getPortName( unsigned int portNumber );
+  void sendMessage( std::vector<unsigned char> *message );
+
+ protected:
+  void initialize( const std::string& clientName );
+};
+
+#endif
+
 //*********************************************************************//
 //  Common RtMidi Definitions
 //*********************************************************************//
 
-RtMidi :: RtMidi()
+void RtMidi :: getCompiledApi( std::vector<RtMidi::Api> &apis )
+{
+  apis.clear();
+
+  // The order here will control the order of RtMidi's API search in
+  // the constructor.  The sequencer comes first on Linux as it is
+  // what we have always used.  The loopback must come last, as the
+  // search never picks it when a system API is compiled in.
+#if defined(__MACOSX_CORE__)
+  apis.push_back( MACOSX_CORE );
+#endif
+#if defined(__LINUX_ALSASEQ__)
+  apis.push_back( LINUX_ALSA );
+#endif
+#if defined(__LINUX_ALSARAW__)
+  apis.push_back( LINUX_ALSA_RAW );
+#endif
+#if defined(__UNIX_JACK__)
+  apis.push_back( UNIX_JACK );
+#endif
+#if defined(__IRIX_MD__)
+  apis.push_back( IRIX_MD );
+#endif
+#if defined(__WINDOWS_MM__)
+  apis.push_back( WINDOWS_MM );
+#endif
+#if defined(__RTMIDI_LOOPBACK__)
+  apis.push_back( LOOPBACK );
+#endif
+}
+
+std::string RtMidi :: getApiName( RtMidi::Api api )
+{
+  switch ( api ) {
+  case MACOSX_CORE:    return "core";
+  case LINUX_ALSA:     return "alsa";
+  case LINUX_ALSA_RAW: return "alsaraw";
+  case UNIX_JACK:      return "jack";
+  case IRIX_MD:        return "irix";
+  case WINDOWS_MM:     return "winmm";
+  case LOOPBACK:       return "loopback";
+  default:             return "";
+  }
+}
+
+std::string RtMidi :: getApiDisplayName( RtMidi::Api api )
+{
+  switch ( api ) {
+  case MACOSX_CORE:    return "CoreMIDI";
+  case LINUX_ALSA:     return "ALSA sequencer";
+  case LINUX_ALSA_RAW: return "ALSA raw MIDI";
+  case UNIX_JACK:      return "JACK";
+  case IRIX_MD:        return "IRIX MD";
+  case WINDOWS_MM:     return "Windows MultiMedia";
+  case LOOPBACK:       return "Loopback";
+  default:             return "Automatic";
+  }
+}
+
+RtMidi::Api RtMidi :: getCompiledApiByName( const std::string &name )
+{
+  std::vector<RtMidi::Api> apis;
+  getCompiledApi( apis );
+  for ( unsigned int i=0; i<apis.size(); i++ )
+    if ( getApiName( apis[i] ) == name ) return apis[i];
+  return UNSPECIFIED;
+}
+
+unsigned long long RtMidi :: getMonotonicTime( void )
+{
+#if defined(__MACOSX_CORE__)
+  return AudioConvertHostTimeToNanos( AudioGetCurrentHostTime() );
+#elif defined(__WINDOWS_MM__)
+  static LARGE_INTEGER frequency = { { 0, 0 } };
+  if ( frequency.QuadPart == 0 ) QueryPerformanceFrequency( &frequency );
+  LARGE_INTEGER counter;
+  QueryPerformanceCounter( &counter );
+  // Split the conversion so the multiplication cannot overflow.
+  unsigned long long seconds = counter.QuadPart / frequency.QuadPart;
+  unsigned long long rest = counter.QuadPart % frequency.QuadPart;
+  return seconds * 1000000000ULL + rest * 1000000000ULL / frequency.QuadPart;
+#else
+  struct timespec now;
+  clock_gettime( CLOCK_MONOTONIC, &now );
+  return (unsigned long long) now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+//*********************************************************************//
+//  Common RtMidiIn Definitions
+//*********************************************************************//
+
+void RtMidiIn :: openMidiApi( RtMidi::Api api, const std::string clientName )
+{
+  if ( rtapi_ )
+    delete rtapi_;
+  rtapi_ = 0;
+
+#if defined(__MACOSX_CORE__)
+  if ( api == MACOSX_CORE )
+    rtapi_ = new MidiInCore( clientName );
+#endif
+#if defined(__LINUX_ALSASEQ__)
+  if ( api == LINUX_ALSA )
+    rtapi_ = new MidiInAlsa( clientName );
+#endif
+#if defined(__LINUX_ALSARAW__)
+  if ( api == LINUX_ALSA_RAW )
+    rtapi_ = new MidiInAlsaRaw( clientName );
+#endif
+#if defined(__UNIX_JACK__)
+  if ( api == UNIX_JACK )
+    rtapi_ = new MidiInJack( clientName );
+#endif
+#if defined(__IRIX_MD__)
+  if ( api == IRIX_MD )
+    rtapi_ = new MidiInIrix( clientName );
+#endif
+#if defined(__WINDOWS_MM__)
+  if ( api == WINDOWS_MM )
+    rtapi_ = new MidiInWinMM( clientName );
+#endif
+#if defined(__RTMIDI_LOOPBACK__)
+  if ( api == LOOPBACK )
+    rtapi_ = new MidiInLoopback( clientName );
+#endif
+}
+
+RtMidiIn :: RtMidiIn( RtMidi::Api api, const std::string clientName )
+  : rtapi_( 0 )
+{
+  if ( api != UNSPECIFIED ) {
+    // Attempt to open the specified API.
+    openMidiApi( api, clientName );
+    if ( rtapi_ ) return;
+
+    // No compiled support for specified API value.  Issue a warning
+    // and continue as if no API was specified.
+    std::cerr << "\nRtMidiIn: no compiled support for specified API argument!\n\n";
+  }
+
+  // Iterate through the compiled APIs and return as soon as we find
+  // one with at least one port or we reach the end of the list.
+  std::vector< RtMidi::Api > apis;
+  getCompiledApi( apis );
+  for ( unsigned int i=0; i<apis.size(); i++ ) {
+    // The loopback always has a port, so it is only used if it is the
+    // only compiled API.
+    if ( apis[i] == LOOPBACK && rtapi_ ) break;
+    openMidiApi( apis[i], clientName );
+    if ( rtapi_->getPortCount() ) break;
+  }
+
+  if ( rtapi_ ) return;
+
+  // It should not be possible to get here because at least one API
+  // has to be defined for the build.  But just in case something
+  // weird happens, we'll throw an error.
+  std::string errorText = "RtMidiIn: no compiled API support found ... critical error!!";
+  throw( RtError( errorText, RtError::UNSPECIFIED ) );
+}
+
+RtMidiIn :: ~RtMidiIn()
+{
+  delete rtapi_;
+}
+
+//*********************************************************************//
+//  Common RtMidiOut Definitions
+//*********************************************************************//
+
+void RtMidiOut :: openMidiApi( RtMidi::Api api, const std::string clientName )
+{
+  if ( rtapi_ )
+    delete rtapi_;
+  rtapi_ = 0;
+
+#if defined(__MACOSX_CORE__)
+  if ( api == MACOSX_CORE )
+    rtapi_ = new MidiOutCore( clientName );
+#endif
+#if defined(__LINUX_ALSASEQ__)
+  if ( api == LINUX_ALSA )
+    rtapi_ = new MidiOutAlsa( clientName );
+#endif
+#if defined(__LINUX_ALSARAW__)
+  if ( api == LINUX_ALSA_RAW )
+    rtapi_ = new MidiOutAlsaRaw( clientName );
+#endif
+#if defined(__UNIX_JACK__)
+  if ( api == UNIX_JACK )
+    rtapi_ = new MidiOutJack( clientName );
+#endif
+#if defined(__IRIX_MD__)
+  if ( api == IRIX_MD )
+    rtapi_ = new MidiOutIrix( clientName );
+#endif
+#if defined(__WINDOWS_MM__)
+  if ( api == WINDOWS_MM )
+    rtapi_ = new MidiOutWinMM( clientName );
+#endif
+#if defined(__RTMIDI_LOOPBACK__)
+  if ( api == LOOPBACK )
+    rtapi_ = new MidiOutLoopback( clientName );
+#endif
+}
+
+RtMidiOut :: RtMidiOut( RtMidi::Api api, const std::string clientName )
+  : rtapi_( 0 )
+{
+  if ( api != UNSPECIFIED ) {
+    // Attempt to open the specified API.
+    openMidiApi( api, clientName );
+    if ( rtapi_ ) return;
+
+    // No compiled support for specified API value.  Issue a warning
+    // and continue as if no API was specified.
+    std::cerr << "\nRtMidiOut: no compiled support for specified API argument!\n\n";
+  }
+
+  // Iterate through the compiled APIs and return as soon as we find
+  // one with at least one port or we reach the end of the list.
+  std::vector< RtMidi::Api > apis;
+  getCompiledApi( apis );
+  for ( unsigned int i=0; i<apis.size(); i++ ) {
+    // The loopback always has a port, so it is only used if it is the
+    // only compiled API.
+    if ( apis[i] == LOOPBACK && rtapi_ ) break;
+    openMidiApi( apis[i], clientName );
+    if ( rtapi_->getPortCount() ) break;
+  }
+
+  if ( rtapi_ ) return;
+
+  // It should not be possible to get here because at least one API
+  // has to be defined for the build.  But just in case something
+  // weird happens, we'll throw an error.
+  std::string errorText = "RtMidiOut: no compiled API support found ... critical error!!";
+  throw( RtError( errorText, RtError::UNSPECIFIED ) );
+}
+
+RtMidiOut :: ~RtMidiOut()
+{
+  delete rtapi_;
+}
+
+#if defined(__DTEDIT_TRACE_EVENTS__)
+void RtMidiOut :: sendMessage( std::vector<unsigned char> *message )
+{
+  TRACE_SPAN( "RtMidi", "RtMidiOut::sendMessage" );
+  rtapi_->sendMessage( message );
+}
+#endif
+
+//*********************************************************************//
+//  Common MidiApi Definitions
+//*********************************************************************//
+
+MidiApi :: MidiApi()
   : apiData_( 0 ), connected_( false )
 {
 }
 
-void RtMidi :: error( RtError::Type type )
+MidiApi :: ~MidiApi()
+{
+}
+
+void MidiApi :: error( RtError::Type type )
 {
   if (type == RtError::WARNING) {
     std::cerr << '\n' << errorString_ << "\n\n";
@@ -65,15 +632,20 @@ void RtMidi :: error( RtError::Type type )
 }
 
 //*********************************************************************//
-//  Common RtMidiIn Definitions
+//  Common MidiInApi Definitions
 //*********************************************************************//
 
-RtMidiIn :: RtMidiIn( const std::string clientName ) : RtMidi()
+MidiInApi :: MidiInApi()
+  : MidiApi(), inputThread_( 0 ), scheduling_( RtMidi::NORMAL_SCHEDULING ), priority_( 0 ),
+    achievedScheduling_( RtMidi::NORMAL_SCHEDULING ), achievedPriority_( 0 )
 {
-  this->initialize( clientName );
 }
 
-void RtMidiIn :: setCallback( RtMidiCallback callback, void *userData )
+MidiInApi :: ~MidiInApi()
+{
+}
+
+void MidiInApi :: setCallback( RtMidiIn::RtMidiCallback callback, void *userData )
 {
   if ( inputData_.usingCallback ) {
     errorString_ = "RtMidiIn::setCallback: a callback function is already set!";
@@ -89,10 +661,31 @@ void RtMidiIn :: setCallback( RtMidiCallback callback, void *userData )
 
   inputData_.userCallback = (void *) callback;
   inputData_.userData = userData;
+  inputData_.timedCallback = false;
+  inputData_.usingCallback = true;
+}
+
+void MidiInApi :: setTimedCallback( RtMidiIn::RtMidiTimedCallback callback, void *userData )
+{
+  if ( inputData_.usingCallback ) {
+    errorString_ = "RtMidiIn::setTimedCallback: a callback function is already set!";
+    error( RtError::WARNING );
+    return;
+  }
+
+  if ( !callback ) {
+    errorString_ = "RtMidiIn::setTimedCallback: callback function value is invalid!";
+    error( RtError::WARNING );
+    return;
+  }
+
+  inputData_.userCallback = (void *) callback;
+  inputData_.userData = userData;
+  inputData_.timedCallback = true;
   inputData_.usingCallback = true;
 }
 
-void RtMidiIn :: cancelCallback()
+void MidiInApi :: cancelCallback()
 {
   if ( !inputData_.usingCallback ) {
     errorString_ = "RtMidiIn::cancelCallback: no callback function was set!";
@@ -102,15 +695,21 @@ void RtMidiIn :: cancelCallback()
 
   inputData_.userCallback = 0;
   inputData_.userData = 0;
+  inputData_.timedCallback = false;
   inputData_.usingCallback = false;
 }
 
-void RtMidiIn :: setQueueSizeLimit( unsigned int queueSize )
+void MidiInApi :: setQueueSizeLimit( unsigned int queueSize )
 {
   inputData_.queueLimit = queueSize;
 }
 
-void RtMidiIn :: ignoreTypes( bool midiSysex, bool midiTime, bool midiSense )
+unsigned long MidiInApi :: getDroppedMessageCount( void )
+{
+  return rtmidiAtomicAdd( &inputData_.droppedMessages, 0 );
+}
+
+void MidiInApi :: ignoreTypes( bool midiSysex, bool midiTime, bool midiSense )
 {
   inputData_.ignoreFlags = 0;
   if ( midiSysex ) inputData_.ignoreFlags = 0x01;
@@ -118,9 +717,10 @@ void RtMidiIn :: ignoreTypes( bool midiSysex, bool midiTime, bool midiSense )
   if ( midiSense ) inputData_.ignoreFlags |= 0x04;
 }
 
-double RtMidiIn :: getMessage( std::vector<unsigned char> *message )
+double MidiInApi :: getMessage( std::vector<unsigned char> *message, unsigned long long *monotonicTime )
 {
   message->clear();
+  if ( monotonicTime ) *monotonicTime = 0;
 
   if ( inputData_.usingCallback ) {
     errorString_ = "RtMidiIn::getNextMessage: a user callback is currently set for this port.";
@@ -134,40 +734,192 @@ double RtMidiIn :: getMessage( std::vector<unsigned char> *message )
   std::vector<unsigned char> *bytes = &(inputData_.queue.front().bytes);
   message->assign( bytes->begin(), bytes->end() );
   double deltaTime = inputData_.queue.front().timeStamp;
+  if ( monotonicTime ) *monotonicTime = inputData_.queue.front().monotonicTime;
   inputData_.queue.pop();
 
   return deltaTime;
 }
 
-//*********************************************************************//
-//  Common RtMidiOut Definitions
-//*********************************************************************//
-
-RtMidiOut :: RtMidiOut( const std::string clientName ) : RtMidi()
+void MidiInApi :: deliverMessage( RtMidiInData *data, MidiMessage &message )
 {
-  this->initialize( clientName );
+  TRACE_SPAN( "RtMidi", "MidiInApi::deliverMessage" );
+  if ( data->usingCallback ) {
+    std::vector<unsigned char> *bytes = &message.bytes;
+    if ( data->timedCallback ) {
+      RtMidiIn::RtMidiTimedCallback callback = (RtMidiIn::RtMidiTimedCallback) data->userCallback;
+      callback( message.monotonicTime, message.timeStamp, bytes, data->userData );
+    }
+    else {
+      RtMidiIn::RtMidiCallback callback = (RtMidiIn::RtMidiCallback) data->userCallback;
+      callback( message.timeStamp, bytes, data->userData );
+    }
+  }
+  else {
+    // As long as we haven't reached our queue size limit, push the message.
+    if ( data->queueLimit > data->queue.size() )
+      data->queue.push( message );
+    else {
+      rtmidiAtomicAdd( &data->droppedMessages, 1 );
+      std::cerr << "\nRtMidiIn: message queue limit reached!!\n\n";
+    }
+  }
 }
 
+void MidiInApi :: setScheduling( RtMidi::Scheduling scheduling, int priority )
+{
+  scheduling_ = scheduling;
+  priority_ = priority;
+  if ( inputThread_ ) applyScheduling();
+}
 
-//*********************************************************************//
-//  API: Macintosh OS-X
-//*********************************************************************//
+RtMidi::Scheduling MidiInApi :: getScheduling( int *priority )
+{
+  if ( priority ) *priority = achievedPriority_;
+  return achievedScheduling_;
+}
 
-// API information found at:
-//   - http://developer.apple.com/audio/pdf/coreaudio.pdf
+void MidiInApi :: setInputThread( void *thread )
+{
+  inputThread_ = thread;
+  achievedScheduling_ = RtMidi::NORMAL_SCHEDULING;
+  achievedPriority_ = 0;
+  if ( inputThread_ ) applyScheduling();
+}
 
-#if defined(__MACOSX_CORE__)
+void MidiInApi :: applyScheduling( void )
+{
+#if defined(__RTMIDI_PTHREADS__)
+  pthread_t thread = *static_cast<pthread_t *> (inputThread_);
+  struct sched_param param;
+  int policy = SCHED_OTHER;
+  param.sched_priority = 0;
+  if ( scheduling_ != RtMidi::NORMAL_SCHEDULING ) {
+    policy = ( scheduling_ == RtMidi::FIFO_SCHEDULING ) ? SCHED_FIFO : SCHED_RR;
+    param.sched_priority = priority_;
+    if ( param.sched_priority < sched_get_priority_min( policy ) ) param.sched_priority = sched_get_priority_min( policy );
+    if ( param.sched_priority > sched_get_priority_max( policy ) ) param.sched_priority = sched_get_priority_max( policy );
+  }
 
-// The CoreMIDI API is based on the use of a callback function for
-// MIDI input.  We convert the system specific time stamps to delta
-// time values.
+  if ( pthread_setschedparam( thread, policy, &param ) != 0 ) {
+    errorString_ = "RtMidiIn::setScheduling: real-time scheduling not permitted (check the rtprio limit), using normal scheduling.";
+    error( RtError::WARNING );
+    policy = SCHED_OTHER;
+    param.sched_priority = 0;
+    pthread_setschedparam( thread, policy, &param );
+  }
 
-// OS-X CoreMIDI header files.
-#include <CoreMIDI/CoreMIDI.h>
-#include <CoreAudio/HostTime.h>
-#include <CoreServices/CoreServices.h>
+  // Ask the system what we really got.
+  achievedScheduling_ = RtMidi::NORMAL_SCHEDULING;
+  achievedPriority_ = 0;
+  if ( pthread_getschedparam( thread, &policy, &param ) == 0 ) {
+    if ( policy == SCHED_FIFO ) achievedScheduling_ = RtMidi::FIFO_SCHEDULING;
+    if ( policy == SCHED_RR ) achievedScheduling_ = RtMidi::ROUND_ROBIN_SCHEDULING;
+    achievedPriority_ = param.sched_priority;
+  }
 
-// A structure to hold variables related to the CoreMIDI API
+  // A real-time thread should not wait for pages to come back from
+  // swap, so lock the memory of the process once.  MCL_FUTURE is not
+  // used as it makes any allocation beyond the memlock limit fail.
+  static bool memoryLocked = false;
+  if ( achievedScheduling_ != RtMidi::NORMAL_SCHEDULING && !memoryLocked ) {
+    if ( mlockall( MCL_CURRENT ) == 0 )
+      memoryLocked = true;
+    else {
+      errorString_ = "RtMidiIn::setScheduling: could not lock memory (check the memlock limit).";
+      error( RtError::WARNING );
+    }
+  }
+#endif
+}
+
+//*********************************************************************//
+//  Common MidiOutApi Definitions
+//*********************************************************************//
+
+MidiOutApi :: MidiOutApi()
+  : MidiApi(), wireBytes_( 0 )
+{
+}
+
+MidiOutApi :: ~MidiOutApi()
+{
+}
+
+void MidiOutApi :: setRunningStatus( bool enable, unsigned int refreshInterval )
+{
+  runningStatus_.setEnabled( enable, refreshInterval );
+}
+
+//*********************************************************************//
+//  Common RtMidiRunningStatus Definitions
+//*********************************************************************//
+
+RtMidiRunningStatus :: RtMidiRunningStatus()
+  : enabled_( false ), status_( 0 ), refreshInterval_( 16 ), omitted_( 0 )
+{
+}
+
+void RtMidiRunningStatus :: setEnabled( bool enable, unsigned int refreshInterval )
+{
+  enabled_ = enable;
+  refreshInterval_ = refreshInterval;
+  reset();
+}
+
+void RtMidiRunningStatus :: reset()
+{
+  status_ = 0;
+  omitted_ = 0;
+}
+
+unsigned int RtMidiRunningStatus :: encode( const unsigned char *message, unsigned int nBytes )
+{
+  if ( nBytes == 0 ) return 0;
+  unsigned char status = message[0];
+
+  // Real-time messages may be interleaved anywhere without touching
+  // the running status.  Anything not starting with a status byte is
+  // passed through unchanged.
+  if ( status >= 0xF8 || !( status & 0x80 ) ) return 0;
+
+  // System exclusive and system common messages cancel it.
+  if ( status >= 0xF0 ) {
+    status_ = 0;
+    omitted_ = 0;
+    return 0;
+  }
+
+  // Same channel status as before and no refresh due: omit it.
+  if ( enabled_ && status == status_ && omitted_ < refreshInterval_ ) {
+    ++omitted_;
+    return 1;
+  }
+
+  status_ = status;
+  omitted_ = 0;
+  return 0;
+}
+
+
+//*********************************************************************//
+//  API: Macintosh OS-X
+//*********************************************************************//
+
+// API information found at:
+//   - http://developer.apple.com/audio/pdf/coreaudio.pdf
+
+#if defined(__MACOSX_CORE__)
+
+// The CoreMIDI API is based on the use of a callback function for
+// MIDI input.  We convert the system specific time stamps to delta
+// time values.
+
+// OS-X CoreMIDI header files.
+#include <CoreMIDI/CoreMIDI.h>
+#include <CoreAudio/HostTime.h>
+#include <CoreServices/CoreServices.h>
+
+// A structure to hold variables related to the CoreMIDI API
 // implementation.
 struct CoreMidiData {
   MIDIClientRef client;
@@ -184,7 +936,7 @@ struct CoreMidiData {
 
 void midiInputCallback( const MIDIPacketList *list, void *procRef, void *srcRef )
 {
-  RtMidiIn::RtMidiInData *data = static_cast<RtMidiIn::RtMidiInData *> (procRef);
+  MidiInApi::RtMidiInData *data = static_cast<MidiInApi::RtMidiInData *> (procRef);
   CoreMidiData *apiData = static_cast<CoreMidiData *> (data->apiData);
 
   unsigned char status;
@@ -192,7 +944,7 @@ void midiInputCallback( const MIDIPacketList *list, void *procRef, void *srcRef
   unsigned long long time;
 
   bool& continueSysex = data->continueSysex;
-  RtMidiIn::MidiMessage& message = data->message;
+  MidiInApi::MidiMessage& message = data->message;
 
   const MIDIPacket *packet = &list->packet[0];
   for ( unsigned int i=0; i<list->numPackets; ++i ) {
@@ -221,6 +973,13 @@ void midiInputCallback( const MIDIPacketList *list, void *procRef, void *srcRef
     }
     apiData->lastTime = packet->timeStamp;
 
+    // The packet time is host time, which is our monotonic clock.
+    // Some drivers leave it zero, meaning "now".
+    if ( packet->timeStamp )
+      message.monotonicTime = AudioConvertHostTimeToNanos( packet->timeStamp );
+    else
+      message.monotonicTime = RtMidi::getMonotonicTime();
+
     iByte = 0;
     if ( continueSysex ) {
       // We have a continuing, segmented sysex message.
@@ -233,17 +992,8 @@ void midiInputCallback( const MIDIPacketList *list, void *procRef, void *srcRef
 
       if ( !continueSysex ) {
         // If not a continuing sysex message, invoke the user callback function or queue the message.
-        if ( data->usingCallback && message.bytes.size() > 0 ) {
-          RtMidiIn::RtMidiCallback callback = (RtMidiIn::RtMidiCallback) data->userCallback;
-          callback( message.timeStamp, &message.bytes, data->userData );
-        }
-        else {
-          // As long as we haven't reached our queue size limit, push the message.
-          if ( data->queueLimit > data->queue.size() )
-            data->queue.push( message );
-          else
-            std::cerr << "\nRtMidiIn: message queue limit reached!!\n\n";
-        }
+        if ( message.bytes.size() > 0 )
+          MidiInApi::deliverMessage( data, message );
         message.bytes.clear();
       }
     }
@@ -295,17 +1045,7 @@ void midiInputCallback( const MIDIPacketList *list, void *procRef, void *srcRef
           message.bytes.assign( &packet->data[iByte], &packet->data[iByte+size] );
           if ( !continueSysex ) {
             // If not a continuing sysex message, invoke the user callback function or queue the message.
-            if ( data->usingCallback ) {
-              RtMidiIn::RtMidiCallback callback = (RtMidiIn::RtMidiCallback) data->userCallback;
-              callback( message.timeStamp, &message.bytes, data->userData );
-            }
-            else {
-              // As long as we haven't reached our queue size limit, push the message.
-              if ( data->queueLimit > data->queue.size() )
-                data->queue.push( message );
-              else
-                std::cerr << "\nRtMidiIn: message queue limit reached!!\n\n";
-            }
+            MidiInApi::deliverMessage( data, message );
             message.bytes.clear();
           }
           iByte += size;
@@ -316,7 +1056,12 @@ void midiInputCallback( const MIDIPacketList *list, void *procRef, void *srcRef
   }
 }
 
-void RtMidiIn :: initialize( const std::string& clientName )
+MidiInCore :: MidiInCore( const std::string clientName ) : MidiInApi()
+{
+  initialize( clientName );
+}
+
+void MidiInCore :: initialize( const std::string& clientName )
 {
   // Set up our client.
   MIDIClientRef client;
@@ -334,7 +1079,7 @@ void RtMidiIn :: initialize( const std::string& clientName )
   inputData_.apiData = (void *) data;
 }
 
-void RtMidiIn :: openPort( unsigned int portNumber, const std::string portName )
+void MidiInCore :: openPort( unsigned int portNumber, const std::string portName )
 {
   if ( connected_ ) {
     errorString_ = "RtMidiIn::openPort: a valid connection already exists!";
@@ -390,7 +1135,7 @@ void RtMidiIn :: openPort( unsigned int portNumber, const std::string portName )
   connected_ = true;
 }
 
-void RtMidiIn :: openVirtualPort( const std::string portName )
+void MidiInCore :: openVirtualPort( const std::string portName )
 {
   CoreMidiData *data = static_cast<CoreMidiData *> (apiData_);
 
@@ -408,7 +1153,7 @@ void RtMidiIn :: openVirtualPort( const std::string portName )
   data->endpoint = endpoint;
 }
 
-void RtMidiIn :: closePort( void )
+void MidiInCore :: closePort( void )
 {
   if ( connected_ ) {
     CoreMidiData *data = static_cast<CoreMidiData *> (apiData_);
@@ -417,7 +1162,7 @@ void RtMidiIn :: closePort( void )
   }
 }
 
-RtMidiIn :: ~RtMidiIn()
+MidiInCore :: ~MidiInCore()
 {
   // Close a connection if it exists.
   closePort();
@@ -429,7 +1174,7 @@ RtMidiIn :: ~RtMidiIn()
   delete data;
 }
 
-unsigned int RtMidiIn :: getPortCount()
+unsigned int MidiInCore :: getPortCount()
 {
   return MIDIGetNumberOfSources();
 }
@@ -558,7 +1303,7 @@ static CFStringRef ConnectedEndpointName( MIDIEndpointRef endpoint )
   return EndpointName( endpoint, false );
 }
 
-std::string RtMidiIn :: getPortName( unsigned int portNumber )
+std::string MidiInCore :: getPortName( unsigned int portNumber )
 {
   CFStringRef nameRef;
   MIDIEndpointRef portRef;
@@ -587,12 +1332,12 @@ std::string RtMidiIn :: getPortName( unsigned int portNumber )
 //  Class Definitions: RtMidiOut
 //*********************************************************************//
 
-unsigned int RtMidiOut :: getPortCount()
+unsigned int MidiOutCore :: getPortCount()
 {
   return MIDIGetNumberOfDestinations();
 }
 
-std::string RtMidiOut :: getPortName( unsigned int portNumber )
+std::string MidiOutCore :: getPortName( unsigned int portNumber )
 {
   CFStringRef nameRef;
   MIDIEndpointRef portRef;
@@ -614,7 +1359,12 @@ std::string RtMidiOut :: getPortName( unsigned int portNumber )
   return stringName;
 }
 
-void RtMidiOut :: initialize( const std::string& clientName )
+MidiOutCore :: MidiOutCore( const std::string clientName ) : MidiOutApi()
+{
+  initialize( clientName );
+}
+
+void MidiOutCore :: initialize( const std::string& clientName )
 {
   // Set up our client.
   MIDIClientRef client;
@@ -631,7 +1381,7 @@ void RtMidiOut :: initialize( const std::string& clientName )
   apiData_ = (void *) data;
 }
 
-void RtMidiOut :: openPort( unsigned int portNumber, const std::string portName )
+void MidiOutCore :: openPort( unsigned int portNumber, const std::string portName )
 {
   if ( connected_ ) {
     errorString_ = "RtMidiOut::openPort: a valid connection already exists!";
@@ -678,7 +1428,7 @@ void RtMidiOut :: openPort( unsigned int portNumber, const std::string portName
   connected_ = true;
 }
 
-void RtMidiOut :: closePort( void )
+void MidiOutCore :: closePort( void )
 {
   if ( connected_ ) {
     CoreMidiData *data = static_cast<CoreMidiData *> (apiData_);
@@ -687,7 +1437,7 @@ void RtMidiOut :: closePort( void )
   }
 }
 
-void RtMidiOut :: openVirtualPort( std::string portName )
+void MidiOutCore :: openVirtualPort( std::string portName )
 {
   CoreMidiData *data = static_cast<CoreMidiData *> (apiData_);
 
@@ -711,7 +1461,7 @@ void RtMidiOut :: openVirtualPort( std::string portName )
   data->endpoint = endpoint;
 }
 
-RtMidiOut :: ~RtMidiOut()
+MidiOutCore :: ~MidiOutCore()
 {
   // Close a connection if it exists.
   closePort();
@@ -723,7 +1473,7 @@ RtMidiOut :: ~RtMidiOut()
   delete data;
 }
 
-void RtMidiOut :: sendMessage( std::vector<unsigned char> *message )
+void MidiOutCore :: sendMessage( std::vector<unsigned char> *message )
 {
   // The CoreMidi documentation indicates a maximum PackList size of
   // 64K, so we may need to break long sysex messages into pieces and
@@ -802,7 +1552,9 @@ void RtMidiOut :: sendMessage( std::vector<unsigned char> *message )
 
 // If you don't need timestamping for incoming MIDI events, define the
 // preprocessor definition AVOID_TIMESTAMPING to save resources
-// associated with the ALSA sequencer queues.
+// associated with the ALSA sequencer queues.  Incoming messages are
+// then stamped with the monotonic clock when the input thread reads
+// them instead of when the sequencer received them.
 
 #include <pthread.h>
 #include <sys/time.h>
@@ -822,6 +1574,7 @@ struct AlsaMidiData {
   pthread_t thread;
   unsigned long long lastTime;
   int queue_id; // an input queue is needed to get timestamped events
+  unsigned long long queueOffset; // monotonic time at queue time zero
 };
 
 #define PORT_TYPE( pinfo, bits ) ((snd_seq_port_info_get_capability(pinfo) & (bits)) == (bits))
@@ -833,13 +1586,12 @@ struct AlsaMidiData {
 
 extern "C" void *alsaMidiHandler( void *ptr )
 {
-  RtMidiIn::RtMidiInData *data = static_cast<RtMidiIn::RtMidiInData *> (ptr);
+  MidiInApi::RtMidiInData *data = static_cast<MidiInApi::RtMidiInData *> (ptr);
   AlsaMidiData *apiData = static_cast<AlsaMidiData *> (data->apiData);
 
   long nBytes;
-  unsigned long long time, lastTime;
   bool continueSysex = false;
-  RtMidiIn::MidiMessage message;
+  MidiInApi::MidiMessage message;
 
   snd_seq_event_t *ev;
   int result;
@@ -947,39 +1699,28 @@ extern "C" void *alsaMidiHandler( void *ptr )
       if ( continueSysex )
         break;
 
-      // Calculate the time stamp:
+      // Calculate the time stamps.  The ALSA sequencer event time is
+      // the real time of our input queue (thanks to Pedro
+      // Lopez-Cabanillas!), the queue offset moves it to the
+      // monotonic clock.
+#ifndef AVOID_TIMESTAMPING
+      message.monotonicTime = apiData->queueOffset
+        + (unsigned long long) ev->time.time.tv_sec * 1000000000ULL + ev->time.time.tv_nsec;
+#else
+      message.monotonicTime = RtMidi::getMonotonicTime();
+#endif
       message.timeStamp = 0.0;
-
-      // Method 1: Use the system time.
-      //(void)gettimeofday(&tv, (struct timezone *)NULL);
-      //time = (tv.tv_sec * 1000000) + tv.tv_usec;
-
-      // Method 2: Use the ALSA sequencer event time data.
-      // (thanks to Pedro Lopez-Cabanillas!).
-      time = ( ev->time.time.tv_sec * 1000000 ) + ( ev->time.time.tv_nsec/1000 );
-      lastTime = time;
-      time -= apiData->lastTime;
-      apiData->lastTime = lastTime;
       if ( data->firstMessage == true )
         data->firstMessage = false;
       else
-        message.timeStamp = time * 0.000001;
+        message.timeStamp = ( message.monotonicTime - apiData->lastTime ) * 0.000000001;
+      apiData->lastTime = message.monotonicTime;
     }
 
     snd_seq_free_event(ev);
-    if ( message.bytes.size() == 0 ) continue;
+    if ( message.bytes.size() == 0 || continueSysex ) continue;
 
-    if ( data->usingCallback && !continueSysex ) {
-      RtMidiIn::RtMidiCallback callback = (RtMidiIn::RtMidiCallback) data->userCallback;
-      callback( message.timeStamp, &message.bytes, data->userData );
-    }
-    else {
-      // As long as we haven't reached our queue size limit, push the message.
-      if ( data->queueLimit > data->queue.size() )
-        data->queue.push( message );
-      else
-        std::cerr << "\nRtMidiIn: message queue limit reached!!\n\n";
-    }
+    MidiInApi::deliverMessage( data, message );
   }
 
   if ( buffer ) free( buffer );
@@ -988,7 +1729,12 @@ extern "C" void *alsaMidiHandler( void *ptr )
   return 0;
 }
 
-void RtMidiIn :: initialize( const std::string& clientName )
+MidiInAlsa :: MidiInAlsa( const std::string clientName ) : MidiInApi()
+{
+  initialize( clientName );
+}
+
+void MidiInAlsa :: initialize( const std::string& clientName )
 {
   // Set up the ALSA sequencer client.
   snd_seq_t *seq;
@@ -1005,6 +1751,8 @@ void RtMidiIn :: initialize( const std::string& clientName )
   AlsaMidiData *data = (AlsaMidiData *) new AlsaMidiData;
   data->seq = seq;
   data->vport = -1;
+  data->lastTime = 0;
+  data->queueOffset = 0;
   apiData_ = (void *) data;
   inputData_.apiData = (void *) data;
 
@@ -1021,6 +1769,28 @@ void RtMidiIn :: initialize( const std::string& clientName )
 #endif
 }
 
+#ifndef AVOID_TIMESTAMPING
+// Relate the real time of the input queue to the monotonic clock.  This
+// is called whenever the queue is (re)started, as that resets its time.
+static void alsaSyncQueueClock( AlsaMidiData *data )
+{
+  snd_seq_queue_status_t *status;
+  snd_seq_queue_status_alloca( &status );
+
+  unsigned long long before = RtMidi::getMonotonicTime();
+  if ( snd_seq_get_queue_status( data->seq, data->queue_id, status ) < 0 ) {
+    data->queueOffset = before;
+    return;
+  }
+  unsigned long long after = RtMidi::getMonotonicTime();
+
+  // Take the middle of the query as the time the status was read.
+  const snd_seq_real_time_t *real = snd_seq_queue_status_get_real_time( status );
+  unsigned long long queueTime = (unsigned long long) real->tv_sec * 1000000000ULL + real->tv_nsec;
+  data->queueOffset = before + ( after - before ) / 2 - queueTime;
+}
+#endif
+
 // This function is used to count or get the pinfo structure for a given port number.
 unsigned int portInfo( snd_seq_t *seq, snd_seq_port_info_t *pinfo, unsigned int type, int portNumber )
 {
@@ -1051,7 +1821,7 @@ unsigned int portInfo( snd_seq_t *seq, snd_seq_port_info_t *pinfo, unsigned int
   return 0;
 }
 
-void RtMidiIn :: openPort( unsigned int portNumber, const std::string portName )
+void MidiInAlsa :: openPort( unsigned int portNumber, const std::string portName )
 {
   if ( connected_ ) {
     errorString_ = "RtMidiIn::openPort: a valid connection already exists!";
@@ -1120,6 +1890,7 @@ void RtMidiIn :: openPort( unsigned int portNumber, const std::string portName )
 #ifndef AVOID_TIMESTAMPING
     snd_seq_start_queue( data->seq, data->queue_id, NULL );
     snd_seq_drain_output( data->seq );
+    alsaSyncQueueClock( data );
 #endif
     // Start our MIDI input thread.
     pthread_attr_t attr;
@@ -1137,12 +1908,13 @@ void RtMidiIn :: openPort( unsigned int portNumber, const std::string portName )
       errorString_ = "RtMidiIn::openPort: error starting MIDI input thread!";
       error( RtError::THREAD_ERROR );
     }
+    setInputThread( &data->thread );
   }
 
   connected_ = true;
 }
 
-void RtMidiIn :: openVirtualPort( std::string portName )
+void MidiInAlsa :: openVirtualPort( std::string portName )
 {
   AlsaMidiData *data = static_cast<AlsaMidiData *> (apiData_);
   if ( data->vport < 0 ) {
@@ -1174,6 +1946,7 @@ void RtMidiIn :: openVirtualPort( std::string portName )
 #ifndef AVOID_TIMESTAMPING
     snd_seq_start_queue( data->seq, data->queue_id, NULL );
     snd_seq_drain_output( data->seq );
+    alsaSyncQueueClock( data );
 #endif
     // Start our MIDI input thread.
     pthread_attr_t attr;
@@ -1191,10 +1964,11 @@ void RtMidiIn :: openVirtualPort( std::string portName )
       errorString_ = "RtMidiIn::openPort: error starting MIDI input thread!";
       error( RtError::THREAD_ERROR );
     }
+    setInputThread( &data->thread );
   }
 }
 
-void RtMidiIn :: closePort( void )
+void MidiInAlsa :: closePort( void )
 {
   if ( connected_ ) {
     AlsaMidiData *data = static_cast<AlsaMidiData *> (apiData_);
@@ -1209,7 +1983,7 @@ void RtMidiIn :: closePort( void )
   }
 }
 
-RtMidiIn :: ~RtMidiIn()
+MidiInAlsa :: ~MidiInAlsa()
 {
   // Close a connection if it exists.
   closePort();
@@ -1230,7 +2004,7 @@ RtMidiIn :: ~RtMidiIn()
   delete data;
 }
 
-unsigned int RtMidiIn :: getPortCount()
+unsigned int MidiInAlsa :: getPortCount()
 {
   snd_seq_port_info_t *pinfo;
   snd_seq_port_info_alloca( &pinfo );
@@ -1239,7 +2013,7 @@ unsigned int RtMidiIn :: getPortCount()
   return portInfo( data->seq, pinfo, SND_SEQ_PORT_CAP_READ|SND_SEQ_PORT_CAP_SUBS_READ, -1 );
 }
 
-std::string RtMidiIn :: getPortName( unsigned int portNumber )
+std::string MidiInAlsa :: getPortName( unsigned int portNumber )
 {
   snd_seq_client_info_t *cinfo;
   snd_seq_port_info_t *pinfo;
@@ -1269,7 +2043,7 @@ std::string RtMidiIn :: getPortName( unsigned int portNumber )
 //  Class Definitions: RtMidiOut
 //*********************************************************************//
 
-unsigned int RtMidiOut :: getPortCount()
+unsigned int MidiOutAlsa :: getPortCount()
 {
   snd_seq_port_info_t *pinfo;
   snd_seq_port_info_alloca( &pinfo );
@@ -1278,7 +2052,7 @@ unsigned int RtMidiOut :: getPortCount()
   return portInfo( data->seq, pinfo, SND_SEQ_PORT_CAP_WRITE|SND_SEQ_PORT_CAP_SUBS_WRITE, -1 );
 }
 
-std::string RtMidiOut :: getPortName( unsigned int portNumber )
+std::string MidiOutAlsa :: getPortName( unsigned int portNumber )
 {
   snd_seq_client_info_t *cinfo;
   snd_seq_port_info_t *pinfo;
@@ -1303,7 +2077,12 @@ std::string RtMidiOut :: getPortName( unsigned int portNumber )
   return 0;
 }
 
-void RtMidiOut :: initialize( const std::string& clientName )
+MidiOutAlsa :: MidiOutAlsa( const std::string clientName ) : MidiOutApi()
+{
+  initialize( clientName );
+}
+
+void MidiOutAlsa :: initialize( const std::string& clientName )
 {
   // Set up the ALSA sequencer client.
   snd_seq_t *seq;
@@ -1339,7 +2118,7 @@ void RtMidiOut :: initialize( const std::string& clientName )
   apiData_ = (void *) data;
 }
 
-void RtMidiOut :: openPort( unsigned int portNumber, const std::string portName )
+void MidiOutAlsa :: openPort( unsigned int portNumber, const std::string portName )
 {
   if ( connected_ ) {
     errorString_ = "RtMidiOut::openPort: a valid connection already exists!";
@@ -1394,7 +2173,7 @@ void RtMidiOut :: openPort( unsigned int portNumber, const std::string portName
   connected_ = true;
 }
 
-void RtMidiOut :: closePort( void )
+void MidiOutAlsa :: closePort( void )
 {
   if ( connected_ ) {
     AlsaMidiData *data = static_cast<AlsaMidiData *> (apiData_);
@@ -1404,7 +2183,7 @@ void RtMidiOut :: closePort( void )
   }
 }
 
-void RtMidiOut :: openVirtualPort( std::string portName )
+void MidiOutAlsa :: openVirtualPort( std::string portName )
 {
   AlsaMidiData *data = static_cast<AlsaMidiData *> (apiData_);
   if ( data->vport < 0 ) {
@@ -1419,7 +2198,7 @@ void RtMidiOut :: openVirtualPort( std::string portName )
   }
 }
 
-RtMidiOut :: ~RtMidiOut()
+MidiOutAlsa :: ~MidiOutAlsa()
 {
   // Close a connection if it exists.
   closePort();
@@ -1433,7 +2212,7 @@ RtMidiOut :: ~RtMidiOut()
   delete data;
 }
 
-void RtMidiOut :: sendMessage( std::vector<unsigned char> *message )
+void MidiOutAlsa :: sendMessage( std::vector<unsigned char> *message )
 {
   int result;
   AlsaMidiData *data = static_cast<AlsaMidiData *> (apiData_);
@@ -1466,16 +2245,1057 @@ void RtMidiOut :: sendMessage( std::vector<unsigned char> *message )
     return;
   }
 
-  // Send the event.
-  result = snd_seq_event_output(data->seq, &ev);
-  if ( result < 0 ) {
-    errorString_ = "RtMidiOut::sendMessage: error sending MIDI message to port.";
+  // Send the event.
+  result = snd_seq_event_output(data->seq, &ev);
+  if ( result < 0 ) {
+    errorString_ = "RtMidiOut::sendMessage: error sending MIDI message to port.";
+    error( RtError::WARNING );
+  }
+  else wireBytes_ += nBytes;
+  snd_seq_drain_output(data->seq);
+}
+
+#endif // __LINUX_ALSA__
+
+
+//*********************************************************************//
+//  API: LINUX ALSA RAW MIDI
+//*********************************************************************//
+
+// API information found at:
+//   - http://www.alsa-project.org/alsa-doc/alsa-lib/rawmidi.html
+
+#if defined(__LINUX_ALSARAW__)
+
+// The raw MIDI API talks to the MIDI device of a sound card directly
+// and bypasses the sequencer client, its event encoder and its
+// queue.  Incoming bytes are read by a thread that sleeps in poll()
+// until the device has data and are parsed into messages here.
+// Outgoing messages are handed to the driver as one contiguous byte
+// buffer, optionally with running status applied.  There are no
+// virtual ports with this API.
+
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+
+// ALSA header file.
+#include <alsa/asoundlib.h>
+
+// A raw MIDI port, i.e. one subdevice of a sound card MIDI device.
+struct AlsaRawPort {
+  std::string device; // "hw:card,device,subdevice"
+  std::string name;
+};
+
+// A structure to hold variables related to the ALSA raw MIDI API
+// implementation.
+struct AlsaRawMidiData {
+  snd_rawmidi_t *in;
+  snd_rawmidi_t *out;
+  pthread_t thread;
+  int wakeFds[2]; // a pipe to interrupt the poll() of the input thread
+  unsigned long long lastTime;
+  std::vector<AlsaRawPort> ports; // the port list of the last getPortCount()
+};
+
+// This function collects the raw MIDI ports of all cards for the given direction.
+static void alsaRawPorts( snd_rawmidi_stream_t stream, std::vector<AlsaRawPort> &ports )
+{
+  ports.clear();
+
+  snd_rawmidi_info_t *info;
+  snd_rawmidi_info_alloca( &info );
+
+  int card = -1;
+  while ( snd_card_next( &card ) >= 0 && card >= 0 ) {
+    std::ostringstream ctlName;
+    ctlName << "hw:" << card;
+    snd_ctl_t *ctl;
+    if ( snd_ctl_open( &ctl, ctlName.str().c_str(), 0 ) < 0 ) continue;
+
+    int device = -1;
+    while ( snd_ctl_rawmidi_next_device( ctl, &device ) >= 0 && device >= 0 ) {
+      snd_rawmidi_info_set_device( info, device );
+      snd_rawmidi_info_set_subdevice( info, 0 );
+      snd_rawmidi_info_set_stream( info, stream );
+      if ( snd_ctl_rawmidi_info( ctl, info ) < 0 ) continue;
+
+      unsigned int subdevices = snd_rawmidi_info_get_subdevices_count( info );
+      for ( unsigned int sub=0; sub<subdevices; ++sub ) {
+        snd_rawmidi_info_set_subdevice( info, sub );
+        if ( snd_ctl_rawmidi_info( ctl, info ) < 0 ) continue;
+
+        std::ostringstream os;
+        os << "hw:" << card << "," << device << "," << sub;
+        AlsaRawPort port;
+        port.device = os.str();
+        const char *subName = snd_rawmidi_info_get_subdevice_name( info );
+        if ( subdevices > 1 && subName && subName[0] )
+          port.name = subName;
+        else
+          port.name = snd_rawmidi_info_get_name( info );
+        port.name += " (" + port.device + ")";
+        ports.push_back( port );
+      }
+    }
+    snd_ctl_close( ctl );
+  }
+}
+
+// Return the number of data bytes following the given status byte.
+static unsigned int alsaRawDataBytes( unsigned char status )
+{
+  switch ( status & 0xF0 ) {
+  case 0xC0:
+  case 0xD0:
+    return 1;
+  case 0xF0:
+    if ( status == 0xF1 || status == 0xF3 ) return 1;
+    if ( status == 0xF2 ) return 2;
+    return 0;
+  default:
+    return 2;
+  }
+}
+
+// Time stamp a complete message and pass it to the callback or queue.
+static void alsaRawDeliver( MidiInApi::RtMidiInData *data, AlsaRawMidiData *apiData,
+                            MidiInApi::MidiMessage &message, unsigned long long time )
+{
+  if ( data->firstMessage == true ) {
+    data->firstMessage = false;
+    message.timeStamp = 0.0;
+  }
+  else
+    message.timeStamp = ( time - apiData->lastTime ) * 0.000000001;
+  apiData->lastTime = time;
+  message.monotonicTime = time;
+
+  MidiInApi::deliverMessage( data, message );
+}
+
+//*********************************************************************//
+//  API: LINUX ALSA RAW MIDI
+//  Class Definitions: RtMidiIn
+//*********************************************************************//
+
+extern "C" void *alsaRawMidiHandler( void *ptr )
+{
+  MidiInApi::RtMidiInData *data = static_cast<MidiInApi::RtMidiInData *> (ptr);
+  AlsaRawMidiData *apiData = static_cast<AlsaRawMidiData *> (data->apiData);
+
+  // Wait on the device descriptors and the read end of the wake pipe.
+  int nDeviceFds = snd_rawmidi_poll_descriptors_count( apiData->in );
+  std::vector<struct pollfd> fds( nDeviceFds + 1 );
+  snd_rawmidi_poll_descriptors( apiData->in, &fds[0], nDeviceFds );
+  fds[nDeviceFds].fd = apiData->wakeFds[0];
+  fds[nDeviceFds].events = POLLIN;
+
+  unsigned char buffer[256];
+  MidiInApi::MidiMessage message, realTime;
+  message.bytes.clear();
+  unsigned char runningStatus = 0;
+  unsigned int missing = 0;
+  bool inSysex = false;
+
+  while ( data->doInput ) {
+
+    if ( poll( &fds[0], nDeviceFds + 1, -1 ) < 0 ) {
+      if ( errno == EINTR ) continue;
+      std::cerr << "\nRtMidiIn::alsaRawMidiHandler: poll error!\n\n";
+      break;
+    }
+
+    // closePort() writes to the pipe when we should stop.
+    if ( fds[nDeviceFds].revents ) break;
+
+    unsigned short revents = 0;
+    snd_rawmidi_poll_descriptors_revents( apiData->in, &fds[0], nDeviceFds, &revents );
+    if ( revents & ( POLLERR | POLLHUP ) ) {
+      std::cerr << "\nRtMidiIn::alsaRawMidiHandler: MIDI device error or device removed!\n\n";
+      break;
+    }
+    if ( !( revents & POLLIN ) ) continue;
+
+    ssize_t nRead = snd_rawmidi_read( apiData->in, buffer, sizeof( buffer ) );
+    if ( nRead == -EAGAIN ) continue;
+    if ( nRead < 0 ) {
+      std::cerr << "\nRtMidiIn::alsaRawMidiHandler: MIDI input read error!\n\n";
+      break;
+    }
+
+    // The bytes of one read arrived together, so they share a time stamp.
+    unsigned long long time = RtMidi::getMonotonicTime();
+
+    for ( ssize_t i=0; i<nRead; ++i ) {
+      unsigned char byte = buffer[i];
+
+      // Real-time messages may appear anywhere, even inside other
+      // messages, and do not affect the parser state.
+      if ( byte >= 0xF8 ) {
+        if ( byte == 0xF8 && ( data->ignoreFlags & 0x02 ) ) continue;
+        if ( byte == 0xFE && ( data->ignoreFlags & 0x04 ) ) continue;
+        realTime.bytes.assign( 1, byte );
+        alsaRawDeliver( data, apiData, realTime, time );
+        continue;
+      }
+
+      if ( inSysex && ( byte == 0xF7 || !( byte & 0x80 ) ) ) {
+        message.bytes.push_back( byte );
+        if ( byte != 0xF7 ) continue;
+        inSysex = false;
+        if ( !( data->ignoreFlags & 0x01 ) )
+          alsaRawDeliver( data, apiData, message, time );
+        message.bytes.clear();
+        continue;
+      }
+
+      if ( byte & 0x80 ) {
+        // Any other status byte drops an unfinished message.
+        message.bytes.clear();
+        inSysex = false;
+        if ( byte >= 0xF0 ) {
+          // System exclusive and system common messages cancel running status.
+          runningStatus = 0;
+          if ( byte == 0xF7 ) continue;
+          if ( byte == 0xF0 ) {
+            inSysex = true;
+            message.bytes.push_back( byte );
+            continue;
+          }
+        }
+        else
+          runningStatus = byte;
+        message.bytes.push_back( byte );
+        missing = alsaRawDataBytes( byte );
+      }
+      else {
+        // A data byte without a pending message starts a new one
+        // with the running status (if there is one).
+        if ( message.bytes.empty() ) {
+          if ( runningStatus == 0 ) continue;
+          message.bytes.push_back( runningStatus );
+          missing = alsaRawDataBytes( runningStatus );
+        }
+        message.bytes.push_back( byte );
+        --missing;
+      }
+
+      if ( missing > 0 ) continue;
+      if ( !( message.bytes[0] == 0xF1 && ( data->ignoreFlags & 0x02 ) ) )
+        alsaRawDeliver( data, apiData, message, time );
+      message.bytes.clear();
+    }
+  }
+
+  return 0;
+}
+
+MidiInAlsaRaw :: MidiInAlsaRaw( const std::string clientName ) : MidiInApi()
+{
+  initialize( clientName );
+}
+
+void MidiInAlsaRaw :: initialize( const std::string& /*clientName*/ )
+{
+  // Save our api-specific connection information.
+  AlsaRawMidiData *data = (AlsaRawMidiData *) new AlsaRawMidiData;
+  data->in = 0;
+  data->out = 0;
+  data->wakeFds[0] = -1;
+  data->wakeFds[1] = -1;
+  data->lastTime = 0;
+  apiData_ = (void *) data;
+  inputData_.apiData = (void *) data;
+}
+
+void MidiInAlsaRaw :: openPort( unsigned int portNumber, const std::string /*portName*/ )
+{
+  if ( connected_ ) {
+    errorString_ = "RtMidiIn::openPort: a valid connection already exists!";
+    error( RtError::WARNING );
+    return;
+  }
+
+  // Use the list the port number was taken from, if there is one:
+  AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+  if ( data->ports.empty() )
+    alsaRawPorts( SND_RAWMIDI_STREAM_INPUT, data->ports );
+  const std::vector<AlsaRawPort> &ports = data->ports;
+  if ( ports.size() < 1 ) {
+    errorString_ = "RtMidiIn::openPort: no raw MIDI input devices found!";
+    error( RtError::NO_DEVICES_FOUND );
+  }
+
+  std::ostringstream ost;
+  if ( portNumber >= ports.size() ) {
+    ost << "RtMidiIn::openPort: the 'portNumber' argument (" << portNumber << ") is invalid.";
+    errorString_ = ost.str();
+    error( RtError::INVALID_PARAMETER );
+  }
+
+  if ( snd_rawmidi_open( &data->in, NULL, ports[portNumber].device.c_str(), SND_RAWMIDI_NONBLOCK ) < 0 ) {
+    data->in = 0;
+    ost << "RtMidiIn::openPort: ALSA error opening raw MIDI device " << ports[portNumber].device << ".";
+    errorString_ = ost.str();
+    error( RtError::DRIVER_ERROR );
+  }
+
+  if ( pipe( data->wakeFds ) < 0 ) {
+    snd_rawmidi_close( data->in );
+    data->in = 0;
+    errorString_ = "RtMidiIn::openPort: error creating the input thread wake pipe!";
+    error( RtError::SYSTEM_ERROR );
+  }
+
+  // Start our MIDI input thread.
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+  pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+
+  inputData_.doInput = true;
+  inputData_.firstMessage = true;
+  int err = pthread_create(&data->thread, &attr, alsaRawMidiHandler, &inputData_);
+  pthread_attr_destroy(&attr);
+  if (err) {
+    close( data->wakeFds[0] );
+    close( data->wakeFds[1] );
+    snd_rawmidi_close( data->in );
+    data->in = 0;
+    inputData_.doInput = false;
+    errorString_ = "RtMidiIn::openPort: error starting MIDI input thread!";
+    error( RtError::THREAD_ERROR );
+  }
+  setInputThread( &data->thread );
+
+  connected_ = true;
+}
+
+void MidiInAlsaRaw :: openVirtualPort( const std::string /*portName*/ )
+{
+  // This function cannot be implemented for the ALSA raw MIDI API.
+  errorString_ = "RtMidiIn::openVirtualPort: cannot be implemented in ALSA raw MIDI API!";
+  error( RtError::WARNING );
+}
+
+void MidiInAlsaRaw :: closePort( void )
+{
+  if ( connected_ ) {
+    AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+
+    // Wake up the input thread and wait until it is gone.
+    inputData_.doInput = false;
+    char wake = 0;
+    if ( write( data->wakeFds[1], &wake, 1 ) < 0 )
+      std::cerr << "\nRtMidiIn::closePort: error waking the MIDI input thread!\n\n";
+    pthread_join( data->thread, NULL );
+    setInputThread( 0 );
+
+    close( data->wakeFds[0] );
+    close( data->wakeFds[1] );
+    snd_rawmidi_close( data->in );
+    data->in = 0;
+    connected_ = false;
+  }
+}
+
+MidiInAlsaRaw :: ~MidiInAlsaRaw()
+{
+  // Close a connection if it exists.
+  closePort();
+
+  // Cleanup.
+  AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+  delete data;
+}
+
+unsigned int MidiInAlsaRaw :: getPortCount()
+{
+  // Listing the cards opens each control device, so the list is kept for
+  // the getPortName() and openPort() calls that usually follow.
+  AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+  alsaRawPorts( SND_RAWMIDI_STREAM_INPUT, data->ports );
+  return data->ports.size();
+}
+
+std::string MidiInAlsaRaw :: getPortName( unsigned int portNumber )
+{
+  AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+  if ( data->ports.empty() )
+    alsaRawPorts( SND_RAWMIDI_STREAM_INPUT, data->ports );
+  if ( portNumber < data->ports.size() )
+    return data->ports[portNumber].name;
+
+  // If we get here, we didn't find a match.
+  errorString_ = "RtMidiIn::getPortName: error looking for port name!";
+  error( RtError::INVALID_PARAMETER );
+  return std::string();
+}
+
+//*********************************************************************//
+//  API: LINUX ALSA RAW MIDI
+//  Class Definitions: RtMidiOut
+//*********************************************************************//
+
+MidiOutAlsaRaw :: MidiOutAlsaRaw( const std::string clientName ) : MidiOutApi()
+{
+  initialize( clientName );
+}
+
+void MidiOutAlsaRaw :: initialize( const std::string& /*clientName*/ )
+{
+  // Save our api-specific connection information.
+  AlsaRawMidiData *data = (AlsaRawMidiData *) new AlsaRawMidiData;
+  data->in = 0;
+  data->out = 0;
+  data->wakeFds[0] = -1;
+  data->wakeFds[1] = -1;
+  data->lastTime = 0;
+  apiData_ = (void *) data;
+}
+
+unsigned int MidiOutAlsaRaw :: getPortCount()
+{
+  // Listing the cards opens each control device, so the list is kept for
+  // the getPortName() and openPort() calls that usually follow.
+  AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+  alsaRawPorts( SND_RAWMIDI_STREAM_OUTPUT, data->ports );
+  return data->ports.size();
+}
+
+std::string MidiOutAlsaRaw :: getPortName( unsigned int portNumber )
+{
+  AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+  if ( data->ports.empty() )
+    alsaRawPorts( SND_RAWMIDI_STREAM_OUTPUT, data->ports );
+  if ( portNumber < data->ports.size() )
+    return data->ports[portNumber].name;
+
+  // If we get here, we didn't find a match.
+  errorString_ = "RtMidiOut::getPortName: error looking for port name!";
+  error( RtError::INVALID_PARAMETER );
+  return std::string();
+}
+
+void MidiOutAlsaRaw :: openPort( unsigned int portNumber, const std::string /*portName*/ )
+{
+  if ( connected_ ) {
+    errorString_ = "RtMidiOut::openPort: a valid connection already exists!";
+    error( RtError::WARNING );
+    return;
+  }
+
+  // Use the list the port number was taken from, if there is one:
+  AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+  if ( data->ports.empty() )
+    alsaRawPorts( SND_RAWMIDI_STREAM_OUTPUT, data->ports );
+  const std::vector<AlsaRawPort> &ports = data->ports;
+  if ( ports.size() < 1 ) {
+    errorString_ = "RtMidiOut::openPort: no raw MIDI output devices found!";
+    error( RtError::NO_DEVICES_FOUND );
+  }
+
+  std::ostringstream ost;
+  if ( portNumber >= ports.size() ) {
+    ost << "RtMidiOut::openPort: the 'portNumber' argument (" << portNumber << ") is invalid.";
+    errorString_ = ost.str();
+    error( RtError::INVALID_PARAMETER );
+  }
+
+  // Blocking mode: a write only waits if the driver buffer is full.
+  if ( snd_rawmidi_open( NULL, &data->out, ports[portNumber].device.c_str(), 0 ) < 0 ) {
+    data->out = 0;
+    ost << "RtMidiOut::openPort: ALSA error opening raw MIDI device " << ports[portNumber].device << ".";
+    errorString_ = ost.str();
+    error( RtError::DRIVER_ERROR );
+  }
+
+  // The device does not know our running status yet.
+  runningStatus_.reset();
+  connected_ = true;
+}
+
+void MidiOutAlsaRaw :: closePort( void )
+{
+  if ( connected_ ) {
+    AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+    snd_rawmidi_close( data->out );
+    data->out = 0;
+    connected_ = false;
+  }
+}
+
+void MidiOutAlsaRaw :: openVirtualPort( const std::string /*portName*/ )
+{
+  // This function cannot be implemented for the ALSA raw MIDI API.
+  errorString_ = "RtMidiOut::openVirtualPort: cannot be implemented in ALSA raw MIDI API!";
+  error( RtError::WARNING );
+}
+
+MidiOutAlsaRaw :: ~MidiOutAlsaRaw()
+{
+  // Close a connection if it exists.
+  closePort();
+
+  // Cleanup.
+  AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+  delete data;
+}
+
+void MidiOutAlsaRaw :: sendMessage( std::vector<unsigned char> *message )
+{
+  unsigned int nBytes = message->size();
+  if ( nBytes == 0 ) {
+    errorString_ = "RtMidiOut::sendMessage: no data in message argument!";
+    error( RtError::WARNING );
+    return;
+  }
+
+  if ( !connected_ ) {
+    errorString_ = "RtMidiOut::sendMessage: no output port is open!";
+    error( RtError::WARNING );
+    return;
+  }
+
+  // Skip a status byte the device already knows and hand the rest of
+  // the message to the driver in one piece.
+  AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+  unsigned int skip = runningStatus_.encode( &(*message)[0], nBytes );
+  ssize_t result = snd_rawmidi_write( data->out, &(*message)[skip], nBytes - skip );
+  if ( result < (ssize_t) ( nBytes - skip ) ) {
+    // We don't know what made it out, so start over with a status byte.
+    runningStatus_.reset();
+    errorString_ = "RtMidiOut::sendMessage: error writing MIDI message to device.";
+    error( RtError::WARNING );
+    return;
+  }
+  wireBytes_ += nBytes - skip;
+}
+
+#endif // __LINUX_ALSARAW__
+
+
+//*********************************************************************//
+//  API: UNIX JACK
+//*********************************************************************//
+
+// API information found at:
+//   - http://jackaudio.org/files/docs/html/group__MIDIAPI.html
+
+#if defined(__UNIX_JACK__)
+
+// JACK MIDI events are handled in the JACK process callback, which
+// runs in the real-time audio thread.  That callback must not block,
+// allocate or call back into the application, so all MIDI data is
+// passed through lock-free ring buffers:
+//   - input events are copied into a ring buffer together with their
+//     absolute frame time, a handler thread is woken with a semaphore
+//     and delivers them to the user callback or queue;
+//   - output messages are stamped with the current frame time and
+//     written to a ring buffer which the process callback plays one
+//     period later at the same position within the period.  This
+//     keeps the output latency constant instead of rounding every
+//     message to the start of the next period.
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <errno.h>
+
+// JACK header files.
+#include <jack/jack.h>
+#include <jack/midiport.h>
+#include <jack/ringbuffer.h>
+
+#define JACK_RINGBUFFER_SIZE 16384 // Default size for ringbuffer
+
+// The header in front of each message in the ring buffers.
+struct JackMidiEventHeader {
+  jack_nframes_t frame; // absolute frame time of the message
+  size_t size;          // number of message bytes following
+};
+
+// A structure to hold variables related to the JACK API
+// implementation.
+struct JackMidiData {
+  jack_client_t *client;
+  jack_port_t *port;
+  jack_ringbuffer_t *buffer;
+  jack_nframes_t sampleRate;
+  pthread_t thread;
+  sem_t wake;
+  jack_nframes_t lastTime;
+  volatile unsigned long *droppedMessages; // the counter of an input, 0 for an output
+};
+
+// Open the JACK client of an input or output object and register its
+// process callback.  Returns false if no JACK server is running.
+static bool jackOpenClient( JackMidiData *data, const std::string &clientName, JackProcessCallback process )
+{
+  data->client = jack_client_open( clientName.c_str(), JackNoStartServer, NULL );
+  if ( data->client == 0 ) return false;
+
+  data->sampleRate = jack_get_sample_rate( data->client );
+  jack_set_process_callback( data->client, process, data );
+  jack_activate( data->client );
+  return true;
+}
+
+// This function collects the MIDI ports of the other JACK clients.
+// Our inputs connect to their outputs and vice versa.
+static unsigned int jackPorts( JackMidiData *data, unsigned long flags, std::vector<std::string> &ports )
+{
+  ports.clear();
+  if ( data->client == 0 ) return 0;
+
+  const char **names = jack_get_ports( data->client, NULL, JACK_DEFAULT_MIDI_TYPE, flags );
+  if ( names == NULL ) return 0;
+  for ( unsigned int i=0; names[i] != NULL; i++ )
+    ports.push_back( names[i] );
+  jack_free( names );
+  return ports.size();
+}
+
+// Unregister our port.  The client is deactivated meanwhile so the
+// process callback never sees a stale port.
+static void jackUnregisterPort( JackMidiData *data )
+{
+  if ( data->port == 0 ) return;
+  jack_deactivate( data->client );
+  jack_port_unregister( data->client, data->port );
+  data->port = 0;
+  jack_activate( data->client );
+}
+
+//*********************************************************************//
+//  API: JACK
+//  Class Definitions: RtMidiIn
+//*********************************************************************//
+
+extern "C" int jackProcessIn( jack_nframes_t nFrames, void *arg )
+{
+  JackMidiData *data = static_cast<JackMidiData *> (arg);
+  if ( data->port == 0 ) return 0;
+
+  void *portBuffer = jack_port_get_buffer( data->port, nFrames );
+  jack_nframes_t cycleStart = jack_last_frame_time( data->client );
+  jack_nframes_t nEvents = jack_midi_get_event_count( portBuffer );
+
+  for ( jack_nframes_t i=0; i<nEvents; i++ ) {
+    jack_midi_event_t event;
+    if ( jack_midi_event_get( &event, portBuffer, i ) != 0 ) continue;
+
+    // Drop the event if the handler thread can't keep up.
+    JackMidiEventHeader header;
+    header.frame = cycleStart + event.time;
+    header.size = event.size;
+    if ( jack_ringbuffer_write_space( data->buffer ) < sizeof( header ) + event.size ) {
+      rtmidiAtomicAdd( data->droppedMessages, 1 );
+      continue;
+    }
+    jack_ringbuffer_write( data->buffer, (const char *) &header, sizeof( header ) );
+    jack_ringbuffer_write( data->buffer, (const char *) event.buffer, event.size );
+  }
+
+  if ( nEvents > 0 ) sem_post( &data->wake );
+  return 0;
+}
+
+extern "C" void *jackMidiHandler( void *ptr )
+{
+  MidiInApi::RtMidiInData *data = static_cast<MidiInApi::RtMidiInData *> (ptr);
+  JackMidiData *apiData = static_cast<JackMidiData *> (data->apiData);
+
+  MidiInApi::MidiMessage message;
+  JackMidiEventHeader header;
+
+  while ( data->doInput ) {
+
+    if ( sem_wait( &apiData->wake ) != 0 ) {
+      if ( errno == EINTR ) continue;
+      std::cerr << "\nRtMidiIn::jackMidiHandler: error waiting for MIDI input!\n\n";
+      break;
+    }
+
+    // The process callback writes the header and the body separately,
+    // so leave a message alone until all of it has arrived.
+    while ( jack_ringbuffer_read_space( apiData->buffer ) >= sizeof( header ) ) {
+      jack_ringbuffer_peek( apiData->buffer, (char *) &header, sizeof( header ) );
+      if ( jack_ringbuffer_read_space( apiData->buffer ) < sizeof( header ) + header.size ) break;
+      jack_ringbuffer_read_advance( apiData->buffer, sizeof( header ) );
+      message.bytes.resize( header.size );
+      if ( header.size > 0 )
+        jack_ringbuffer_read( apiData->buffer, (char *) &message.bytes[0], header.size );
+      if ( header.size == 0 ) continue;
+
+      // Filter the message types we should ignore.
+      unsigned char status = message.bytes[0];
+      if ( status == 0xF0 && ( data->ignoreFlags & 0x01 ) ) continue;
+      if ( ( status == 0xF1 || status == 0xF8 ) && ( data->ignoreFlags & 0x02 ) ) continue;
+      if ( status == 0xFE && ( data->ignoreFlags & 0x04 ) ) continue;
+
+      // Compute the delta time from the frame times, which are exact
+      // to the sample.
+      if ( data->firstMessage == true ) {
+        data->firstMessage = false;
+        message.timeStamp = 0.0;
+      }
+      else
+        message.timeStamp = (jack_nframes_t) ( header.frame - apiData->lastTime ) / (double) apiData->sampleRate;
+      apiData->lastTime = header.frame;
+
+      // The JACK clock may have a different origin than ours, so move
+      // the frame time over by its age on the JACK clock.
+      jack_time_t frameTime = jack_frames_to_time( apiData->client, header.frame );
+      jack_time_t jackNow = jack_get_time();
+      unsigned long long now = RtMidi::getMonotonicTime();
+      if ( jackNow >= frameTime )
+        message.monotonicTime = now - ( jackNow - frameTime ) * 1000ULL;
+      else
+        message.monotonicTime = now + ( frameTime - jackNow ) * 1000ULL;
+
+      MidiInApi::deliverMessage( data, message );
+    }
+  }
+
+  return 0;
+}
+
+MidiInJack :: MidiInJack( const std::string clientName ) : MidiInApi()
+{
+  initialize( clientName );
+}
+
+void MidiInJack :: initialize( const std::string& clientName )
+{
+  // Save our api-specific connection information.
+  JackMidiData *data = new JackMidiData;
+  data->client = 0;
+  data->port = 0;
+  data->lastTime = 0;
+  data->droppedMessages = &inputData_.droppedMessages;
+  data->buffer = jack_ringbuffer_create( JACK_RINGBUFFER_SIZE );
+  sem_init( &data->wake, 0, 0 );
+  apiData_ = (void *) data;
+  inputData_.apiData = (void *) data;
+
+  // Start the handler thread that delivers the messages.
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+  pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+
+  inputData_.doInput = true;
+  int err = pthread_create(&data->thread, &attr, jackMidiHandler, &inputData_);
+  pthread_attr_destroy(&attr);
+  if (err) {
+    // The destructor won't run for a failed constructor, so clean up here.
+    jack_ringbuffer_free( data->buffer );
+    sem_destroy( &data->wake );
+    delete data;
+    apiData_ = 0;
+    inputData_.apiData = 0;
+    inputData_.doInput = false;
+    errorString_ = "RtMidiIn::initialize: error starting MIDI input thread!";
+    error( RtError::THREAD_ERROR );
+  }
+  setInputThread( &data->thread );
+
+  // Without a running server we have no ports, which is not an error.
+  if ( !jackOpenClient( data, clientName, jackProcessIn ) ) {
+    errorString_ = "RtMidiIn::initialize: JACK server not running?";
+    error( RtError::DEBUG_WARNING );
+  }
+}
+
+void MidiInJack :: openPort( unsigned int portNumber, const std::string portName )
+{
+  if ( connected_ ) {
+    errorString_ = "RtMidiIn::openPort: a valid connection already exists!";
+    error( RtError::WARNING );
+    return;
+  }
+
+  JackMidiData *data = static_cast<JackMidiData *> (apiData_);
+  std::vector<std::string> ports;
+  if ( jackPorts( data, JackPortIsOutput, ports ) < 1 ) {
+    errorString_ = "RtMidiIn::openPort: no JACK MIDI input sources found!";
+    error( RtError::NO_DEVICES_FOUND );
+  }
+
+  std::ostringstream ost;
+  if ( portNumber >= ports.size() ) {
+    ost << "RtMidiIn::openPort: the 'portNumber' argument (" << portNumber << ") is invalid.";
+    errorString_ = ost.str();
+    error( RtError::INVALID_PARAMETER );
+  }
+
+  // Create our port and connect it to the source.
+  if ( data->port == 0 )
+    data->port = jack_port_register( data->client, portName.c_str(), JACK_DEFAULT_MIDI_TYPE, JackPortIsInput, 0 );
+  if ( data->port == 0 ) {
+    errorString_ = "RtMidiIn::openPort: JACK error creating port.";
+    error( RtError::DRIVER_ERROR );
+  }
+  if ( jack_connect( data->client, ports[portNumber].c_str(), jack_port_name( data->port ) ) != 0 ) {
+    jackUnregisterPort( data );
+    errorString_ = "RtMidiIn::openPort: JACK error making port connection.";
+    error( RtError::DRIVER_ERROR );
+  }
+
+  inputData_.firstMessage = true;
+  connected_ = true;
+}
+
+void MidiInJack :: openVirtualPort( const std::string portName )
+{
+  JackMidiData *data = static_cast<JackMidiData *> (apiData_);
+  if ( data->client == 0 ) {
+    errorString_ = "RtMidiIn::openVirtualPort: JACK server not running?";
+    error( RtError::DRIVER_ERROR );
+  }
+
+  if ( data->port == 0 )
+    data->port = jack_port_register( data->client, portName.c_str(), JACK_DEFAULT_MIDI_TYPE, JackPortIsInput, 0 );
+  if ( data->port == 0 ) {
+    errorString_ = "RtMidiIn::openVirtualPort: JACK error creating virtual port.";
+    error( RtError::DRIVER_ERROR );
+  }
+}
+
+void MidiInJack :: closePort( void )
+{
+  JackMidiData *data = static_cast<JackMidiData *> (apiData_);
+  jackUnregisterPort( data );
+  connected_ = false;
+}
+
+MidiInJack :: ~MidiInJack()
+{
+  // Close a connection if it exists.
+  closePort();
+
+  // Shutdown the handler thread.
+  JackMidiData *data = static_cast<JackMidiData *> (apiData_);
+  if ( inputData_.doInput ) {
+    inputData_.doInput = false;
+    sem_post( &data->wake );
+    pthread_join( data->thread, NULL );
+  }
+
+  // Cleanup.
+  if ( data->client ) jack_client_close( data->client );
+  jack_ringbuffer_free( data->buffer );
+  sem_destroy( &data->wake );
+  delete data;
+}
+
+unsigned int MidiInJack :: getPortCount()
+{
+  std::vector<std::string> ports;
+  return jackPorts( static_cast<JackMidiData *> (apiData_), JackPortIsOutput, ports );
+}
+
+std::string MidiInJack :: getPortName( unsigned int portNumber )
+{
+  std::vector<std::string> ports;
+  if ( portNumber < jackPorts( static_cast<JackMidiData *> (apiData_), JackPortIsOutput, ports ) )
+    return ports[portNumber];
+
+  // If we get here, we didn't find a match.
+  errorString_ = "RtMidiIn::getPortName: error looking for port name!";
+  error( RtError::INVALID_PARAMETER );
+  return std::string();
+}
+
+//*********************************************************************//
+//  API: JACK
+//  Class Definitions: RtMidiOut
+//*********************************************************************//
+
+extern "C" int jackProcessOut( jack_nframes_t nFrames, void *arg )
+{
+  JackMidiData *data = static_cast<JackMidiData *> (arg);
+  if ( data->port == 0 ) return 0;
+
+  void *portBuffer = jack_port_get_buffer( data->port, nFrames );
+  jack_midi_clear_buffer( portBuffer );
+
+  jack_nframes_t cycleStart = jack_last_frame_time( data->client );
+  jack_nframes_t lastOffset = 0;
+  JackMidiEventHeader header;
+
+  while ( jack_ringbuffer_read_space( data->buffer ) >= sizeof( header ) ) {
+    jack_ringbuffer_peek( data->buffer, (char *) &header, sizeof( header ) );
+    if ( jack_ringbuffer_read_space( data->buffer ) < sizeof( header ) + header.size ) break;
+
+    // A message sent at frame time t is due at t plus one period.
+    // Messages due in a later cycle stay in the buffer, late ones go
+    // out at once.  Offsets must not decrease within a cycle.
+    int due = (int) ( header.frame + nFrames - cycleStart );
+    if ( due >= (int) nFrames ) break;
+    jack_nframes_t offset = due < 0 ? 0 : (jack_nframes_t) due;
+    if ( offset < lastOffset ) offset = lastOffset;
+
+    jack_midi_data_t *dest = jack_midi_event_reserve( portBuffer, offset, header.size );
+    if ( dest == 0 ) break; // port buffer full, try again next cycle
+    jack_ringbuffer_read_advance( data->buffer, sizeof( header ) );
+    jack_ringbuffer_read( data->buffer, (char *) dest, header.size );
+    lastOffset = offset;
+  }
+
+  return 0;
+}
+
+MidiOutJack :: MidiOutJack( const std::string clientName ) : MidiOutApi()
+{
+  initialize( clientName );
+}
+
+void MidiOutJack :: initialize( const std::string& clientName )
+{
+  // Save our api-specific connection information.
+  JackMidiData *data = new JackMidiData;
+  data->client = 0;
+  data->port = 0;
+  data->lastTime = 0;
+  data->droppedMessages = 0;
+  data->buffer = jack_ringbuffer_create( JACK_RINGBUFFER_SIZE );
+  apiData_ = (void *) data;
+
+  // Without a running server we have no ports, which is not an error.
+  if ( !jackOpenClient( data, clientName, jackProcessOut ) ) {
+    errorString_ = "RtMidiOut::initialize: JACK server not running?";
+    error( RtError::DEBUG_WARNING );
+  }
+}
+
+void MidiOutJack :: openPort( unsigned int portNumber, const std::string portName )
+{
+  if ( connected_ ) {
+    errorString_ = "RtMidiOut::openPort: a valid connection already exists!";
+    error( RtError::WARNING );
+    return;
+  }
+
+  JackMidiData *data = static_cast<JackMidiData *> (apiData_);
+  std::vector<std::string> ports;
+  if ( jackPorts( data, JackPortIsInput, ports ) < 1 ) {
+    errorString_ = "RtMidiOut::openPort: no JACK MIDI output destinations found!";
+    error( RtError::NO_DEVICES_FOUND );
+  }
+
+  std::ostringstream ost;
+  if ( portNumber >= ports.size() ) {
+    ost << "RtMidiOut::openPort: the 'portNumber' argument (" << portNumber << ") is invalid.";
+    errorString_ = ost.str();
+    error( RtError::INVALID_PARAMETER );
+  }
+
+  // Create our port and connect it to the destination.
+  if ( data->port == 0 )
+    data->port = jack_port_register( data->client, portName.c_str(), JACK_DEFAULT_MIDI_TYPE, JackPortIsOutput, 0 );
+  if ( data->port == 0 ) {
+    errorString_ = "RtMidiOut::openPort: JACK error creating port.";
+    error( RtError::DRIVER_ERROR );
+  }
+  if ( jack_connect( data->client, jack_port_name( data->port ), ports[portNumber].c_str() ) != 0 ) {
+    jackUnregisterPort( data );
+    errorString_ = "RtMidiOut::openPort: JACK error making port connection.";
+    error( RtError::DRIVER_ERROR );
+  }
+
+  connected_ = true;
+}
+
+void MidiOutJack :: closePort( void )
+{
+  JackMidiData *data = static_cast<JackMidiData *> (apiData_);
+  jackUnregisterPort( data );
+  connected_ = false;
+}
+
+void MidiOutJack :: openVirtualPort( const std::string portName )
+{
+  JackMidiData *data = static_cast<JackMidiData *> (apiData_);
+  if ( data->client == 0 ) {
+    errorString_ = "RtMidiOut::openVirtualPort: JACK server not running?";
+    error( RtError::DRIVER_ERROR );
+  }
+
+  if ( data->port == 0 )
+    data->port = jack_port_register( data->client, portName.c_str(), JACK_DEFAULT_MIDI_TYPE, JackPortIsOutput, 0 );
+  if ( data->port == 0 ) {
+    errorString_ = "RtMidiOut::openVirtualPort: JACK error creating virtual port.";
+    error( RtError::DRIVER_ERROR );
+  }
+}
+
+MidiOutJack :: ~MidiOutJack()
+{
+  // Close a connection if it exists.
+  closePort();
+
+  // Cleanup.
+  JackMidiData *data = static_cast<JackMidiData *> (apiData_);
+  if ( data->client ) jack_client_close( data->client );
+  jack_ringbuffer_free( data->buffer );
+  delete data;
+}
+
+unsigned int MidiOutJack :: getPortCount()
+{
+  std::vector<std::string> ports;
+  return jackPorts( static_cast<JackMidiData *> (apiData_), JackPortIsInput, ports );
+}
+
+std::string MidiOutJack :: getPortName( unsigned int portNumber )
+{
+  std::vector<std::string> ports;
+  if ( portNumber < jackPorts( static_cast<JackMidiData *> (apiData_), JackPortIsInput, ports ) )
+    return ports[portNumber];
+
+  // If we get here, we didn't find a match.
+  errorString_ = "RtMidiOut::getPortName: error looking for port name!";
+  error( RtError::INVALID_PARAMETER );
+  return std::string();
+}
+
+void MidiOutJack :: sendMessage( std::vector<unsigned char> *message )
+{
+  unsigned int nBytes = message->size();
+  if ( nBytes == 0 ) {
+    errorString_ = "RtMidiOut::sendMessage: no data in message argument!";
+    error( RtError::WARNING );
+    return;
+  }
+
+  JackMidiData *data = static_cast<JackMidiData *> (apiData_);
+  if ( data->port == 0 ) {
+    errorString_ = "RtMidiOut::sendMessage: no output port is open!";
     error( RtError::WARNING );
+    return;
   }
-  snd_seq_drain_output(data->seq);
+
+  // Stamp the message with the current frame time so the process
+  // callback can place it exactly one period later.
+  JackMidiEventHeader header;
+  header.frame = jack_frame_time( data->client );
+  header.size = nBytes;
+  if ( jack_ringbuffer_write_space( data->buffer ) < sizeof( header ) + nBytes ) {
+    errorString_ = "RtMidiOut::sendMessage: JACK output buffer full, message dropped.";
+    error( RtError::WARNING );
+    return;
+  }
+  jack_ringbuffer_write( data->buffer, (const char *) &header, sizeof( header ) );
+  jack_ringbuffer_write( data->buffer, (const char *) &(*message)[0], nBytes );
+  wireBytes_ += nBytes;
 }
 
-#endif // __LINUX_ALSA__
+#endif // __UNIX_JACK__
 
 
 //*********************************************************************//
@@ -1514,7 +3334,7 @@ struct IrixMidiData {
 
 extern "C" void *irixMidiHandler( void *ptr )
 {
-  RtMidiIn::RtMidiInData *data = static_cast<RtMidiIn::RtMidiInData *> (ptr);
+  MidiInApi::RtMidiInData *data = static_cast<MidiInApi::RtMidiInData *> (ptr);
   IrixMidiData *apiData = static_cast<IrixMidiData *> (data->apiData);
 
   bool continueSysex = false;
@@ -1532,7 +3352,7 @@ extern "C" void *irixMidiHandler( void *ptr )
   FD_ZERO( &mask );
   FD_SET( fd, &mask );
   struct timeval timeout = {0, 0};
-  RtMidiIn::MidiMessage message;
+  MidiInApi::MidiMessage message;
   int result;
 
   while ( data->doInput ) {
@@ -1554,6 +3374,7 @@ extern "C" void *irixMidiHandler( void *ptr )
     }
 
     message.timeStamp = event.stamp * 0.000000001;
+    message.monotonicTime = RtMidi::getMonotonicTime();
 
     size = 0;
     status = event.msg[0];
@@ -1569,17 +3390,8 @@ extern "C" void *irixMidiHandler( void *ptr )
           if ( event.sysexmsg[event.msglen-1] == 0xF7 ) continueSysex = false;
           if ( !continueSysex ) {
             // If not a continuing sysex message, invoke the user callback function or queue the message.
-            if ( data->usingCallback && message.bytes.size() > 0 ) {
-              RtMidiIn::RtMidiCallback callback = (RtMidiIn::RtMidiCallback) data->userCallback;
-              callback( message.timeStamp, &message.bytes, data->userData );
-            }
-            else {
-              // As long as we haven't reached our queue size limit, push the message.
-              if ( data->queueLimit > data->queue.size() )
-                data->queue.push( message );
-              else
-                std::cerr << "\nRtMidiIn: message queue limit reached!!\n\n";
-            }
+            if ( message.bytes.size() > 0 )
+              MidiInApi::deliverMessage( data, message );
             message.bytes.clear();
           }
         }
@@ -1613,17 +3425,7 @@ extern "C" void *irixMidiHandler( void *ptr )
     if ( size ) {
       message.bytes.assign( &event.msg[0], &event.msg[size] );
       // Invoke the user callback function or queue the message.
-      if ( data->usingCallback ) {
-        RtMidiIn::RtMidiCallback callback = (RtMidiIn::RtMidiCallback) data->userCallback;
-        callback( message.timeStamp, &message.bytes, data->userData );
-      }
-      else {
-        // As long as we haven't reached our queue size limit, push the message.
-        if ( data->queueLimit > data->queue.size() )
-          data->queue.push( message );
-        else
-          std::cerr << "\nRtMidiIn: message queue limit reached!!\n\n";
-      }
+      MidiInApi::deliverMessage( data, message );
       message.bytes.clear();
     }
   }
@@ -1631,7 +3433,12 @@ extern "C" void *irixMidiHandler( void *ptr )
   return 0;
 }
 
-void RtMidiIn :: initialize( const std::string& /*clientName*/ )
+MidiInIrix :: MidiInIrix( const std::string clientName ) : MidiInApi()
+{
+  initialize( clientName );
+}
+
+void MidiInIrix :: initialize( const std::string& /*clientName*/ )
 {
   // Initialize the Irix MIDI system.  At the moment, we will not
   // worry about a return value of zero (ports) because there is a
@@ -1644,7 +3451,7 @@ void RtMidiIn :: initialize( const std::string& /*clientName*/ )
   inputData_.apiData = (void *) data;
 }
 
-void RtMidiIn :: openPort( unsigned int portNumber, const std::string /*portName*/ )
+void MidiInIrix :: openPort( unsigned int portNumber, const std::string /*portName*/ )
 {
   if ( connected_ ) {
     errorString_ = "RtMidiIn::openPort: a valid connection already exists!";
@@ -1689,18 +3496,19 @@ void RtMidiIn :: openPort( unsigned int portNumber, const std::string /*portName
     errorString_ = "RtMidiIn::openPort: error starting MIDI input thread!";
     error( RtError::THREAD_ERROR );
   }
+  setInputThread( &data->thread );
 
   connected_ = true;
 }
 
-void RtMidiIn :: openVirtualPort( std::string portName )
+void MidiInIrix :: openVirtualPort( std::string portName )
 {
   // This function cannot be implemented for the Irix MIDI API.
   errorString_ = "RtMidiIn::openVirtualPort: cannot be implemented in Irix MIDI API!";
   error( RtError::WARNING );
 }
 
-void RtMidiIn :: closePort( void )
+void MidiInIrix :: closePort( void )
 {
   if ( connected_ ) {
     IrixMidiData *data = static_cast<IrixMidiData *> (apiData_);
@@ -1710,10 +3518,11 @@ void RtMidiIn :: closePort( void )
     // Shutdown the input thread.
     inputData_.doInput = false;
     pthread_join( data->thread, NULL );
+    setInputThread( 0 );
   }
 }
 
-RtMidiIn :: ~RtMidiIn()
+MidiInIrix :: ~MidiInIrix()
 {
   // Close a connection if it exists.
   closePort();
@@ -1723,14 +3532,14 @@ RtMidiIn :: ~RtMidiIn()
   delete data;
 }
 
-unsigned int RtMidiIn :: getPortCount()
+unsigned int MidiInIrix :: getPortCount()
 {
   int nPorts = mdInit();
   if ( nPorts >= 0 ) return nPorts;
   else return 0;
 }
 
-std::string RtMidiIn :: getPortName( unsigned int portNumber )
+std::string MidiInIrix :: getPortName( unsigned int portNumber )
 {
   int nPorts = mdInit();
 
@@ -1750,14 +3559,14 @@ std::string RtMidiIn :: getPortName( unsigned int portNumber )
 //  Class Definitions: RtMidiOut
 //*********************************************************************//
 
-unsigned int RtMidiOut :: getPortCount()
+unsigned int MidiOutIrix :: getPortCount()
 {
   int nPorts = mdInit();
   if ( nPorts >= 0 ) return nPorts;
   else return 0;
 }
 
-std::string RtMidiOut :: getPortName( unsigned int portNumber )
+std::string MidiOutIrix :: getPortName( unsigned int portNumber )
 {
   int nPorts = mdInit();
 
@@ -1772,7 +3581,12 @@ std::string RtMidiOut :: getPortName( unsigned int portNumber )
   return stringName;
 }
 
-void RtMidiOut :: initialize( const std::string& /*clientName*/ )
+MidiOutIrix :: MidiOutIrix( const std::string clientName ) : MidiOutApi()
+{
+  initialize( clientName );
+}
+
+void MidiOutIrix :: initialize( const std::string& /*clientName*/ )
 {
   // Initialize the Irix MIDI system.  At the moment, we will not
   // worry about a return value of zero (ports) because there is a
@@ -1784,7 +3598,7 @@ void RtMidiOut :: initialize( const std::string& /*clientName*/ )
   apiData_ = (void *) data;
 }
 
-void RtMidiOut :: openPort( unsigned int portNumber, const std::string /*portName*/ )
+void MidiOutIrix :: openPort( unsigned int portNumber, const std::string /*portName*/ )
 {
   if ( connected_ ) {
     errorString_ = "RtMidiOut::openPort: a valid connection already exists!";
@@ -1817,7 +3631,7 @@ void RtMidiOut :: openPort( unsigned int portNumber, const std::string /*portNam
   connected_ = true;
 }
 
-void RtMidiOut :: closePort( void )
+void MidiOutIrix :: closePort( void )
 {
   if ( connected_ ) {
     IrixMidiData *data = static_cast<IrixMidiData *> (apiData_);
@@ -1826,14 +3640,14 @@ void RtMidiOut :: closePort( void )
   }
 }
 
-void RtMidiOut :: openVirtualPort( std::string portName )
+void MidiOutIrix :: openVirtualPort( std::string portName )
 {
   // This function cannot be implemented for the Irix MIDI API.
   errorString_ = "RtMidiOut::openVirtualPort: cannot be implemented in Irix MIDI API!";
   error( RtError::WARNING );
 }
 
-RtMidiOut :: ~RtMidiOut()
+MidiOutIrix :: ~MidiOutIrix()
 {
   // Close a connection if it exists.
   closePort();
@@ -1843,7 +3657,7 @@ RtMidiOut :: ~RtMidiOut()
   delete data;
 }
 
-void RtMidiOut :: sendMessage( std::vector<unsigned char> *message )
+void MidiOutIrix :: sendMessage( std::vector<unsigned char> *message )
 {
   int result;
   MDevent event;
@@ -1874,6 +3688,7 @@ void RtMidiOut :: sendMessage( std::vector<unsigned char> *message )
     error( RtError::WARNING );
     return;
   }
+  wireBytes_ += nBytes;
 }
 
 #endif // __IRIX_MD__
@@ -1906,7 +3721,7 @@ struct WinMidiData {
   HMIDIIN inHandle;    // Handle to Midi Input Device
   HMIDIOUT outHandle;  // Handle to Midi Output Device
   DWORD lastTime;
-  RtMidiIn::MidiMessage message;
+  MidiInApi::MidiMessage message;
   LPMIDIHDR sysexBuffer[RT_SYSEX_BUFFER_COUNT];
 };
 
@@ -1923,8 +3738,8 @@ static void CALLBACK midiInputCallback( HMIDIOUT hmin,
 {
   if ( inputStatus != MIM_DATA && inputStatus != MIM_LONGDATA && inputStatus != MIM_LONGERROR ) return;
 
-  //RtMidiIn::RtMidiInData *data = static_cast<RtMidiIn::RtMidiInData *> (instancePtr);
-  RtMidiIn::RtMidiInData *data = (RtMidiIn::RtMidiInData *)instancePtr;
+  //MidiInApi::RtMidiInData *data = static_cast<MidiInApi::RtMidiInData *> (instancePtr);
+  MidiInApi::RtMidiInData *data = (MidiInApi::RtMidiInData *)instancePtr;
   WinMidiData *apiData = static_cast<WinMidiData *> (data->apiData);
 
   // Calculate time stamp.
@@ -1933,6 +3748,10 @@ static void CALLBACK midiInputCallback( HMIDIOUT hmin,
   else apiData->message.timeStamp = (double) ( timestamp - apiData->lastTime ) * 0.001;
   apiData->lastTime = timestamp;
 
+  // The driver time stamp only has millisecond resolution, so take the
+  // arrival time from the performance counter instead.
+  apiData->message.monotonicTime = RtMidi::getMonotonicTime();
+
   if ( inputStatus == MIM_DATA ) { // Channel or system message
 
     // Make sure the first byte is a status byte.
@@ -1990,23 +3809,18 @@ static void CALLBACK midiInputCallback( HMIDIOUT hmin,
     else return;
   }
 
-  if ( data->usingCallback ) {
-    RtMidiIn::RtMidiCallback callback = (RtMidiIn::RtMidiCallback) data->userCallback;
-    callback( apiData->message.timeStamp, &apiData->message.bytes, data->userData );
-  }
-  else {
-    // As long as we haven't reached our queue size limit, push the message.
-    if ( data->queueLimit > data->queue.size() )
-      data->queue.push( apiData->message );
-    else
-      std::cerr << "\nRtMidiIn: message queue limit reached!!\n\n";
-  }
+  MidiInApi::deliverMessage( data, apiData->message );
 
   // Clear the vector for the next input message.
   apiData->message.bytes.clear();
 }
 
-void RtMidiIn :: initialize( const std::string& /*clientName*/ )
+MidiInWinMM :: MidiInWinMM( const std::string clientName ) : MidiInApi()
+{
+  initialize( clientName );
+}
+
+void MidiInWinMM :: initialize( const std::string& /*clientName*/ )
 {
   // We'll issue a warning here if no devices are available but not
   // throw an error since the user can plugin something later.
@@ -2023,7 +3837,7 @@ void RtMidiIn :: initialize( const std::string& /*clientName*/ )
   data->message.bytes.clear();  // needs to be empty for first input message
 }
 
-void RtMidiIn :: openPort( unsigned int portNumber, const std::string /*portName*/ )
+void MidiInWinMM :: openPort( unsigned int portNumber, const std::string /*portName*/ )
 {
   if ( connected_ ) {
     errorString_ = "RtMidiIn::openPort: a valid connection already exists!";
@@ -2089,14 +3903,14 @@ void RtMidiIn :: openPort( unsigned int portNumber, const std::string /*portName
   connected_ = true;
 }
 
-void RtMidiIn :: openVirtualPort( std::string portName )
+void MidiInWinMM :: openVirtualPort( std::string portName )
 {
   // This function cannot be implemented for the Windows MM MIDI API.
   errorString_ = "RtMidiIn::openVirtualPort: cannot be implemented in Windows MM MIDI API!";
   error( RtError::WARNING );
 }
 
-void RtMidiIn :: closePort( void )
+void MidiInWinMM :: closePort( void )
 {
   if ( connected_ ) {
     WinMidiData *data = static_cast<WinMidiData *> (apiData_);
@@ -2119,7 +3933,7 @@ void RtMidiIn :: closePort( void )
   }
 }
 
-RtMidiIn :: ~RtMidiIn()
+MidiInWinMM :: ~MidiInWinMM()
 {
   // Close a connection if it exists.
   closePort();
@@ -2129,12 +3943,12 @@ RtMidiIn :: ~RtMidiIn()
   delete data;
 }
 
-unsigned int RtMidiIn :: getPortCount()
+unsigned int MidiInWinMM :: getPortCount()
 {
   return midiInGetNumDevs();
 }
 
-std::string RtMidiIn :: getPortName( unsigned int portNumber )
+std::string MidiInWinMM :: getPortName( unsigned int portNumber )
 {
   unsigned int nDevices = midiInGetNumDevs();
   if ( portNumber >= nDevices ) {
@@ -2163,12 +3977,12 @@ std::string RtMidiIn :: getPortName( unsigned int portNumber )
 //  Class Definitions: RtMidiOut
 //*********************************************************************//
 
-unsigned int RtMidiOut :: getPortCount()
+unsigned int MidiOutWinMM :: getPortCount()
 {
   return midiOutGetNumDevs();
 }
 
-std::string RtMidiOut :: getPortName( unsigned int portNumber )
+std::string MidiOutWinMM :: getPortName( unsigned int portNumber )
 {
   unsigned int nDevices = midiOutGetNumDevs();
   if ( portNumber >= nDevices ) {
@@ -2192,7 +4006,12 @@ std::string RtMidiOut :: getPortName( unsigned int portNumber )
   return stringName;
 }
 
-void RtMidiOut :: initialize( const std::string& /*clientName*/ )
+MidiOutWinMM :: MidiOutWinMM( const std::string clientName ) : MidiOutApi()
+{
+  initialize( clientName );
+}
+
+void MidiOutWinMM :: initialize( const std::string& /*clientName*/ )
 {
   // We'll issue a warning here if no devices are available but not
   // throw an error since the user can plug something in later.
@@ -2207,7 +4026,7 @@ void RtMidiOut :: initialize( const std::string& /*clientName*/ )
   apiData_ = (void *) data;
 }
 
-void RtMidiOut :: openPort( unsigned int portNumber, const std::string /*portName*/ )
+void MidiOutWinMM :: openPort( unsigned int portNumber, const std::string /*portName*/ )
 {
   if ( connected_ ) {
     errorString_ = "RtMidiOut::openPort: a valid connection already exists!";
@@ -2242,7 +4061,7 @@ void RtMidiOut :: openPort( unsigned int portNumber, const std::string /*portNam
   connected_ = true;
 }
 
-void RtMidiOut :: closePort( void )
+void MidiOutWinMM :: closePort( void )
 {
   if ( connected_ ) {
     WinMidiData *data = static_cast<WinMidiData *> (apiData_);
@@ -2252,14 +4071,14 @@ void RtMidiOut :: closePort( void )
   }
 }
 
-void RtMidiOut :: openVirtualPort( std::string portName )
+void MidiOutWinMM :: openVirtualPort( std::string portName )
 {
   // This function cannot be implemented for the Windows MM MIDI API.
   errorString_ = "RtMidiOut::openVirtualPort: cannot be implemented in Windows MM MIDI API!";
   error( RtError::WARNING );
 }
 
-RtMidiOut :: ~RtMidiOut()
+MidiOutWinMM :: ~MidiOutWinMM()
 {
   // Close a connection if it exists.
   closePort();
@@ -2269,7 +4088,7 @@ RtMidiOut :: ~RtMidiOut()
   delete data;
 }
 
-void RtMidiOut :: sendMessage( std::vector<unsigned char> *message )
+void MidiOutWinMM :: sendMessage( std::vector<unsigned char> *message )
 {
   unsigned int nBytes = message->size();
   if ( nBytes == 0 ) {
@@ -2341,6 +4160,518 @@ void RtMidiOut :: sendMessage( std::vector<unsigned char> *message )
       error( RtError::DRIVER_ERROR );
     }
   }
+
+  wireBytes_ += nBytes;
 }
 
 #endif  // __WINDOWS_MM__
+
+
+//*********************************************************************//
+//  API: LOOPBACK
+//*********************************************************************//
+
+#if defined(__RTMIDI_LOOPBACK__)
+
+// The loopback API connects RtMidiOut and RtMidiIn objects of the same
+// process through in-memory buses, without any system MIDI service.
+// Bus 0 ("RtMidi Loopback") always exists and can be opened from both
+// sides.  A virtual port creates another bus that only the other
+// direction lists.  Every message sent to a bus is delivered to all
+// inputs connected to it.  Each input has a thread of its own that
+// delivers the messages, so callbacks run just like with the system
+// APIs.  A sender blocks while an input has LOOPBACK_QUEUE_LIMIT
+// messages waiting, much like a write to a busy device, so a callback
+// must not send bursts of that size to its own bus.  The sender only
+// holds the lock of the waiting input then, never the bus registry, so
+// the callbacks may still open, close and list ports meanwhile.
+
+#include <deque>
+
+#define LOOPBACK_QUEUE_LIMIT 65536
+
+// Bus owners.  A bus is listed by the direction that did not create it.
+#define LOOPBACK_SHARED 0
+#define LOOPBACK_INPUT  1
+#define LOOPBACK_OUTPUT 2
+#define LOOPBACK_CLOSED 3
+
+struct LoopbackInData;
+
+// A structure to hold a loopback bus.  Buses are never deleted, closed
+// virtual buses are kept hidden and reused by name.
+struct LoopbackBus {
+  std::string name;
+  int owner;
+  std::vector<LoopbackInData *> inputs;
+};
+
+// A structure to hold variables related to the loopback input.
+struct LoopbackInData {
+  LoopbackBus *bus;
+  bool ownsBus;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t wake;  // signals new messages to the input thread
+  pthread_cond_t space; // signals free queue space to senders
+  pthread_cond_t idle;  // signals the last sender leaving
+  std::deque<MidiInApi::MidiMessage> pending;
+  unsigned int senders; // senders that hold on to this input
+  bool running;
+  unsigned long long lastTime;
+};
+
+// A structure to hold variables related to the loopback output.
+struct LoopbackOutData {
+  LoopbackBus *bus;
+  bool ownsBus;
+  std::vector<LoopbackInData *> targets; // inputs of the current message
+};
+
+// The bus registry, shared by all loopback objects of the process.
+static pthread_mutex_t loopbackMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Return the bus registry.  Call with loopbackMutex held.
+static std::vector<LoopbackBus *> &loopbackBuses( void )
+{
+  static std::vector<LoopbackBus *> buses;
+  if ( buses.empty() ) {
+    LoopbackBus *bus = new LoopbackBus;
+    bus->name = "RtMidi Loopback";
+    bus->owner = LOOPBACK_SHARED;
+    buses.push_back( bus );
+  }
+  return buses;
+}
+
+// Count the buses an input (or output) can open, or return the one
+// with the given port number.  Call with loopbackMutex held.
+static unsigned int loopbackFindBus( bool forInput, int portNumber, LoopbackBus **bus )
+{
+  std::vector<LoopbackBus *> &buses = loopbackBuses();
+  int hiddenOwner = forInput ? LOOPBACK_INPUT : LOOPBACK_OUTPUT;
+  int count = 0;
+  for ( unsigned int i=0; i<buses.size(); i++ ) {
+    if ( buses[i]->owner == LOOPBACK_CLOSED || buses[i]->owner == hiddenOwner ) continue;
+    if ( count == portNumber ) {
+      if ( bus ) *bus = buses[i];
+      return 1;
+    }
+    ++count;
+  }
+
+  // If a negative portNumber was used, return the bus count.
+  if ( portNumber < 0 ) return count;
+  return 0;
+}
+
+// Create a virtual bus or reuse a closed one of the same name.  Call
+// with loopbackMutex held.
+static LoopbackBus *loopbackCreateBus( const std::string &name, int owner )
+{
+  std::vector<LoopbackBus *> &buses = loopbackBuses();
+  for ( unsigned int i=0; i<buses.size(); i++ ) {
+    if ( buses[i]->owner == LOOPBACK_CLOSED && buses[i]->name == name ) {
+      buses[i]->owner = owner;
+      return buses[i];
+    }
+  }
+
+  LoopbackBus *bus = new LoopbackBus;
+  bus->name = name;
+  bus->owner = owner;
+  buses.push_back( bus );
+  return bus;
+}
+
+extern "C" void *loopbackMidiHandler( void *ptr )
+{
+  MidiInApi::RtMidiInData *data = static_cast<MidiInApi::RtMidiInData *> (ptr);
+  LoopbackInData *apiData = static_cast<LoopbackInData *> (data->apiData);
+
+  std::deque<MidiInApi::MidiMessage> batch;
+
+  pthread_mutex_lock( &apiData->mutex );
+  while ( apiData->running ) {
+
+    if ( apiData->pending.empty() ) {
+      pthread_cond_wait( &apiData->wake, &apiData->mutex );
+      continue;
+    }
+
+    // Take all waiting messages at once to keep the lock short.
+    batch.swap( apiData->pending );
+    pthread_cond_broadcast( &apiData->space );
+    pthread_mutex_unlock( &apiData->mutex );
+
+    for ( unsigned int i=0; i<batch.size(); i++ ) {
+      MidiInApi::MidiMessage &message = batch[i];
+
+      // Filter the message types we should ignore.
+      unsigned char status = message.bytes[0];
+      if ( status == 0xF0 && ( data->ignoreFlags & 0x01 ) ) continue;
+      if ( ( status == 0xF1 || status == 0xF8 ) && ( data->ignoreFlags & 0x02 ) ) continue;
+      if ( status == 0xFE && ( data->ignoreFlags & 0x04 ) ) continue;
+
+      // The messages carry the time they were sent.
+      if ( data->firstMessage == true ) {
+        data->firstMessage = false;
+        message.timeStamp = 0.0;
+      }
+      else
+        message.timeStamp = ( message.monotonicTime - apiData->lastTime ) * 0.000000001;
+      apiData->lastTime = message.monotonicTime;
+
+      MidiInApi::deliverMessage( data, message );
+    }
+    batch.clear();
+
+    pthread_mutex_lock( &apiData->mutex );
+  }
+  pthread_mutex_unlock( &apiData->mutex );
+
+  return 0;
+}
+
+//*********************************************************************//
+//  API: LOOPBACK
+//  Class Definitions: MidiInLoopback
+//*********************************************************************//
+
+MidiInLoopback :: MidiInLoopback( const std::string clientName ) : MidiInApi()
+{
+  initialize( clientName );
+}
+
+void MidiInLoopback :: initialize( const std::string& /*clientName*/ )
+{
+  // Save our api-specific connection information.
+  LoopbackInData *data = (LoopbackInData *) new LoopbackInData;
+  data->bus = 0;
+  data->ownsBus = false;
+  pthread_mutex_init( &data->mutex, NULL );
+  pthread_cond_init( &data->wake, NULL );
+  pthread_cond_init( &data->space, NULL );
+  pthread_cond_init( &data->idle, NULL );
+  data->senders = 0;
+  data->running = false;
+  data->lastTime = 0;
+  apiData_ = (void *) data;
+  inputData_.apiData = (void *) data;
+}
+
+// Connect the input to a bus and start its thread.
+void MidiInLoopback :: connect( void *bus, bool ownsBus )
+{
+  LoopbackInData *data = static_cast<LoopbackInData *> (apiData_);
+
+  // Start the input thread first so no message can get stuck.
+  data->running = true;
+  inputData_.doInput = true;
+  inputData_.firstMessage = true;
+  int err = pthread_create( &data->thread, NULL, loopbackMidiHandler, &inputData_ );
+  if ( err ) {
+    data->running = false;
+    inputData_.doInput = false;
+    errorString_ = "RtMidiIn::openPort: error starting MIDI input thread!";
+    error( RtError::THREAD_ERROR );
+  }
+  setInputThread( &data->thread );
+
+  data->bus = static_cast<LoopbackBus *> (bus);
+  data->ownsBus = ownsBus;
+  data->bus->inputs.push_back( data );
+  connected_ = true;
+}
+
+void MidiInLoopback :: openPort( unsigned int portNumber, const std::string /*portName*/ )
+{
+  if ( connected_ ) {
+    errorString_ = "RtMidiIn::openPort: a valid connection already exists!";
+    error( RtError::WARNING );
+    return;
+  }
+
+  pthread_mutex_lock( &loopbackMutex );
+  LoopbackBus *bus = 0;
+  if ( loopbackFindBus( true, (int) portNumber, &bus ) == 0 ) {
+    pthread_mutex_unlock( &loopbackMutex );
+    std::ostringstream ost;
+    ost << "RtMidiIn::openPort: the 'portNumber' argument (" << portNumber << ") is invalid.";
+    errorString_ = ost.str();
+    error( RtError::INVALID_PARAMETER );
+  }
+
+  try {
+    connect( bus, false );
+  }
+  catch ( RtError & ) {
+    pthread_mutex_unlock( &loopbackMutex );
+    throw;
+  }
+  pthread_mutex_unlock( &loopbackMutex );
+}
+
+void MidiInLoopback :: openVirtualPort( const std::string portName )
+{
+  if ( connected_ ) {
+    errorString_ = "RtMidiIn::openVirtualPort: a valid connection already exists!";
+    error( RtError::WARNING );
+    return;
+  }
+
+  pthread_mutex_lock( &loopbackMutex );
+  LoopbackBus *bus = loopbackCreateBus( portName, LOOPBACK_INPUT );
+  try {
+    connect( bus, true );
+  }
+  catch ( RtError & ) {
+    bus->owner = LOOPBACK_CLOSED;
+    pthread_mutex_unlock( &loopbackMutex );
+    throw;
+  }
+  pthread_mutex_unlock( &loopbackMutex );
+}
+
+void MidiInLoopback :: closePort( void )
+{
+  if ( !connected_ ) return;
+  LoopbackInData *data = static_cast<LoopbackInData *> (apiData_);
+
+  // Leave the bus first, this also ends any sender waiting for us.
+  pthread_mutex_lock( &loopbackMutex );
+  std::vector<LoopbackInData *> &inputs = data->bus->inputs;
+  for ( unsigned int i=0; i<inputs.size(); i++ ) {
+    if ( inputs[i] == data ) {
+      inputs.erase( inputs.begin() + i );
+      break;
+    }
+  }
+  if ( data->ownsBus ) data->bus->owner = LOOPBACK_CLOSED;
+  data->bus = 0;
+  pthread_mutex_unlock( &loopbackMutex );
+
+  // Shutdown the input thread.  Messages still waiting are discarded.
+  pthread_mutex_lock( &data->mutex );
+  data->running = false;
+  data->pending.clear();
+  pthread_cond_signal( &data->wake );
+  pthread_cond_broadcast( &data->space );
+
+  // Senders that took us before we left the bus may still hold on.
+  while ( data->senders > 0 )
+    pthread_cond_wait( &data->idle, &data->mutex );
+  pthread_mutex_unlock( &data->mutex );
+  pthread_join( data->thread, NULL );
+  setInputThread( 0 );
+
+  inputData_.doInput = false;
+  connected_ = false;
+}
+
+MidiInLoopback :: ~MidiInLoopback()
+{
+  // Close a connection if it exists.
+  closePort();
+
+  // Cleanup.
+  LoopbackInData *data = static_cast<LoopbackInData *> (apiData_);
+  pthread_cond_destroy( &data->idle );
+  pthread_cond_destroy( &data->space );
+  pthread_cond_destroy( &data->wake );
+  pthread_mutex_destroy( &data->mutex );
+  delete data;
+}
+
+unsigned int MidiInLoopback :: getPortCount()
+{
+  pthread_mutex_lock( &loopbackMutex );
+  unsigned int count = loopbackFindBus( true, -1, 0 );
+  pthread_mutex_unlock( &loopbackMutex );
+  return count;
+}
+
+std::string MidiInLoopback :: getPortName( unsigned int portNumber )
+{
+  std::string stringName;
+  LoopbackBus *bus = 0;
+  pthread_mutex_lock( &loopbackMutex );
+  if ( loopbackFindBus( true, (int) portNumber, &bus ) ) stringName = bus->name;
+  pthread_mutex_unlock( &loopbackMutex );
+
+  if ( bus == 0 ) {
+    std::ostringstream ost;
+    ost << "RtMidiIn::getPortName: the 'portNumber' argument (" << portNumber << ") is invalid.";
+    errorString_ = ost.str();
+    error( RtError::INVALID_PARAMETER );
+  }
+  return stringName;
+}
+
+//*********************************************************************//
+//  API: LOOPBACK
+//  Class Definitions: MidiOutLoopback
+//*********************************************************************//
+
+MidiOutLoopback :: MidiOutLoopback( const std::string clientName ) : MidiOutApi()
+{
+  initialize( clientName );
+}
+
+void MidiOutLoopback :: initialize( const std::string& /*clientName*/ )
+{
+  // Save our api-specific connection information.
+  LoopbackOutData *data = (LoopbackOutData *) new LoopbackOutData;
+  data->bus = 0;
+  data->ownsBus = false;
+  apiData_ = (void *) data;
+}
+
+void MidiOutLoopback :: openPort( unsigned int portNumber, const std::string /*portName*/ )
+{
+  if ( connected_ ) {
+    errorString_ = "RtMidiOut::openPort: a valid connection already exists!";
+    error( RtError::WARNING );
+    return;
+  }
+
+  LoopbackOutData *data = static_cast<LoopbackOutData *> (apiData_);
+  pthread_mutex_lock( &loopbackMutex );
+  LoopbackBus *bus = 0;
+  loopbackFindBus( false, (int) portNumber, &bus );
+  pthread_mutex_unlock( &loopbackMutex );
+  if ( bus == 0 ) {
+    std::ostringstream ost;
+    ost << "RtMidiOut::openPort: the 'portNumber' argument (" << portNumber << ") is invalid.";
+    errorString_ = ost.str();
+    error( RtError::INVALID_PARAMETER );
+  }
+
+  data->bus = bus;
+  data->ownsBus = false;
+  connected_ = true;
+}
+
+void MidiOutLoopback :: openVirtualPort( const std::string portName )
+{
+  if ( connected_ ) {
+    errorString_ = "RtMidiOut::openVirtualPort: a valid connection already exists!";
+    error( RtError::WARNING );
+    return;
+  }
+
+  LoopbackOutData *data = static_cast<LoopbackOutData *> (apiData_);
+  pthread_mutex_lock( &loopbackMutex );
+  data->bus = loopbackCreateBus( portName, LOOPBACK_OUTPUT );
+  pthread_mutex_unlock( &loopbackMutex );
+  data->ownsBus = true;
+  connected_ = true;
+}
+
+void MidiOutLoopback :: closePort( void )
+{
+  if ( !connected_ ) return;
+  LoopbackOutData *data = static_cast<LoopbackOutData *> (apiData_);
+
+  // Inputs connected to our virtual bus stay connected to the hidden
+  // bus and receive nothing more.
+  pthread_mutex_lock( &loopbackMutex );
+  if ( data->ownsBus ) data->bus->owner = LOOPBACK_CLOSED;
+  pthread_mutex_unlock( &loopbackMutex );
+  data->bus = 0;
+  connected_ = false;
+}
+
+MidiOutLoopback :: ~MidiOutLoopback()
+{
+  // Close a connection if it exists.
+  closePort();
+
+  // Cleanup.
+  LoopbackOutData *data = static_cast<LoopbackOutData *> (apiData_);
+  delete data;
+}
+
+unsigned int MidiOutLoopback :: getPortCount()
+{
+  pthread_mutex_lock( &loopbackMutex );
+  unsigned int count = loopbackFindBus( false, -1, 0 );
+  pthread_mutex_unlock( &loopbackMutex );
+  return count;
+}
+
+std::string MidiOutLoopback :: getPortName( unsigned int portNumber )
+{
+  std::string stringName;
+  LoopbackBus *bus = 0;
+  pthread_mutex_lock( &loopbackMutex );
+  if ( loopbackFindBus( false, (int) portNumber, &bus ) ) stringName = bus->name;
+  pthread_mutex_unlock( &loopbackMutex );
+
+  if ( bus == 0 ) {
+    std::ostringstream ost;
+    ost << "RtMidiOut::getPortName: the 'portNumber' argument (" << portNumber << ") is invalid.";
+    errorString_ = ost.str();
+    error( RtError::INVALID_PARAMETER );
+  }
+  return stringName;
+}
+
+void MidiOutLoopback :: sendMessage( std::vector<unsigned char> *message )
+{
+  LoopbackOutData *data = static_cast<LoopbackOutData *> (apiData_);
+  if ( !connected_ ) {
+    errorString_ = "RtMidiOut::sendMessage: no open MIDI output port.";
+    error( RtError::WARNING );
+    return;
+  }
+
+  unsigned int nBytes = message->size();
+  if ( nBytes == 0 ) {
+    errorString_ = "RtMidiOut::sendMessage: no data in message argument!";
+    error( RtError::WARNING );
+    return;
+  }
+  else if ( ( message->at( 0 ) & 0x80 ) == 0 ) {
+    errorString_ = "RtMidiOut::sendMessage: message does not start with a status byte.";
+    error( RtError::WARNING );
+    return;
+  }
+
+  // Take the inputs of the bus.  Each one is held by a sender count, so
+  // it can't go away once the registry lock is released again.
+  std::vector<LoopbackInData *> &targets = data->targets;
+  pthread_mutex_lock( &loopbackMutex );
+  targets = data->bus->inputs;
+  for ( unsigned int i=0; i<targets.size(); i++ ) {
+    pthread_mutex_lock( &targets[i]->mutex );
+    ++targets[i]->senders;
+    pthread_mutex_unlock( &targets[i]->mutex );
+  }
+  pthread_mutex_unlock( &loopbackMutex );
+
+  // Only copy the message if somebody listens, a bus without inputs acts
+  // as a null device:
+  MidiInApi::MidiMessage event;
+  if ( !targets.empty() ) {
+    event.bytes = *message;
+    event.monotonicTime = RtMidi::getMonotonicTime();
+  }
+  for ( unsigned int i=0; i<targets.size(); i++ ) {
+    LoopbackInData *input = targets[i];
+    pthread_mutex_lock( &input->mutex );
+    while ( input->running && input->pending.size() >= LOOPBACK_QUEUE_LIMIT )
+      pthread_cond_wait( &input->space, &input->mutex );
+    if ( input->running ) {
+      input->pending.push_back( event );
+      if ( input->pending.size() == 1 ) pthread_cond_signal( &input->wake );
+    }
+    if ( --input->senders == 0 ) pthread_cond_signal( &input->idle );
+    pthread_mutex_unlock( &input->mutex );
+  }
+  targets.clear();
+
+  wireBytes_ += nBytes;
+}
+
+#endif  // __RTMIDI_LOOPBACK__
@@ -35,18 +35,69 @@
 */
 /**********************************************************************/
 
-// RtMidi: Version 1.0.11
+// RtMidi: Version 1.0.11 (with the runtime API selection of later releases)
 
 #ifndef RTMIDI_H
 #define RTMIDI_H
 
 #include "RtError.h"
 #include <string>
+#include <vector>
+#include <queue>
+
+class MidiInApi;
+class MidiOutApi;
 
 class RtMidi
 {
  public:
 
+  //! MIDI API specifier arguments.
+  enum Api {
+    UNSPECIFIED,    /*!< Search for a working compiled API. */
+    MACOSX_CORE,    /*!< Macintosh OS-X Core Midi API. */
+    LINUX_ALSA,     /*!< The Advanced Linux Sound Architecture sequencer API. */
+    LINUX_ALSA_RAW, /*!< The ALSA raw MIDI API (direct device access). */
+    UNIX_JACK,      /*!< The JACK Low-Latency MIDI Server API. */
+    IRIX_MD,        /*!< The IRIX MD API. */
+    WINDOWS_MM,     /*!< The Microsoft Multimedia MIDI API. */
+    LOOPBACK        /*!< In-process buses between RtMidiOut and RtMidiIn objects. */
+  };
+
+  //! Scheduling classes for the threads that handle MIDI input.
+  enum Scheduling {
+    NORMAL_SCHEDULING,     /*!< The default time sharing scheduling. */
+    FIFO_SCHEDULING,       /*!< Real-time first in, first out (POSIX SCHED_FIFO). */
+    ROUND_ROBIN_SCHEDULING /*!< Real-time round robin (POSIX SCHED_RR). */
+  };
+
+  //! A static function to determine the available compiled MIDI APIs.
+  /*!
+      The values returned in the std::vector can be compared against
+      the enumerated list values.  Note that there can be more than one
+      API compiled for certain operating systems.  The first entry is
+      the one chosen for an UNSPECIFIED API when it has ports.
+  */
+  static void getCompiledApi( std::vector<RtMidi::Api> &apis );
+
+  //! Return a short lower case identifier for the given API, suitable for config files.
+  static std::string getApiName( RtMidi::Api api );
+
+  //! Return a human readable name for the given API.
+  static std::string getApiDisplayName( RtMidi::Api api );
+
+  //! Return the compiled API with the given short identifier or UNSPECIFIED if there is none.
+  static RtMidi::Api getCompiledApiByName( const std::string &name );
+
+  //! Return the current time of the monotonic clock in nanoseconds.
+  /*!
+      All absolute MIDI time stamps are taken from this clock.  It is
+      CLOCK_MONOTONIC on POSIX systems, the host time on OS-X and the
+      performance counter on Windows.  Its origin is unspecified, so
+      only differences between two values are meaningful.
+  */
+  static unsigned long long getMonotonicTime( void );
+
   //! Pure virtual openPort() function.
   virtual void openPort( unsigned int portNumber = 0, const std::string portName = std::string( "RtMidi" ) ) = 0;
 
@@ -64,17 +115,8 @@ class RtMidi
 
  protected:
 
-  RtMidi();
+  RtMidi() {};
   virtual ~RtMidi() {};
-
-  // A basic error reporting function for internal use in the RtMidi
-  // subclasses.  The behavior of this function can be modified to
-  // suit specific needs.
-  void error( RtError::Type type );
-
-  void *apiData_;
-  bool connected_;
-  std::string errorString_;
 };
 
 /**********************************************************************/
@@ -91,13 +133,13 @@ class RtMidi
     to open a virtual input port to which other MIDI software clients
     can connect.
 
+    The actual work is done by an API specific MidiInApi object that
+    is chosen at construction time.
+
     by Gary P. Scavone, 2003-2008.
 */
 /**********************************************************************/
 
-#include <vector>
-#include <queue>
-
 class RtMidiIn : public RtMidi
 {
  public:
@@ -105,21 +147,35 @@ class RtMidiIn : public RtMidi
   //! User callback function type definition.
   typedef void (*RtMidiCallback)( double timeStamp, std::vector<unsigned char> *message, void *userData);
 
-  //! Default constructor that allows an optional client name.
+  //! User callback function type that also receives the absolute time stamp in nanoseconds.
   /*!
-      An exception will be thrown if a MIDI system initialization error occurs.
+      \e monotonicTime is the arrival time of the message on the clock
+      of RtMidi::getMonotonicTime(), \e deltaTime the time in seconds
+      since the previous message.
   */
-  RtMidiIn( const std::string clientName = std::string( "RtMidi Input Client") );
+  typedef void (*RtMidiTimedCallback)( unsigned long long monotonicTime, double deltaTime, std::vector<unsigned char> *message, void *userData );
+
+  //! Default constructor that allows an optional API and client name.
+  /*!
+      If no API is given or the given one is not compiled in, the
+      compiled APIs are searched in the order of getCompiledApi() for
+      one with at least one input port.  An exception will be thrown if
+      a MIDI system initialization error occurs.
+  */
+  RtMidiIn( RtMidi::Api api = UNSPECIFIED, const std::string clientName = std::string( "RtMidi Input Client") );
 
   //! If a MIDI connection is still open, it will be closed by the destructor.
   ~RtMidiIn();
 
+  //! Returns the MIDI API specifier for the current instance of RtMidiIn.
+  RtMidi::Api getCurrentApi( void );
+
   //! Open a MIDI input connection.
   /*!
       An optional port number greater than 0 can be specified.
       Otherwise, the default or first port found is opened.
   */
-  void openPort( unsigned int portNumber = 0, const std::string Portname = std::string( "RtMidi Input" ) );
+  void openPort( unsigned int portNumber = 0, const std::string portName = std::string( "RtMidi Input" ) );
 
   //! Create a virtual input port, with optional name, to allow software connections (OS X and ALSA only).
   /*!
@@ -139,6 +195,13 @@ class RtMidiIn : public RtMidi
   */
   void setCallback( RtMidiCallback callback, void *userData = 0 );
 
+  //! Set a callback function that receives absolute time stamps.
+  /*!
+      This is the same as setCallback() except for the callback type.
+      Only one callback of either type can be set at a time.
+  */
+  void setTimedCallback( RtMidiTimedCallback callback, void *userData = 0 );
+
   //! Cancel use of the current callback function (if one exists).
   /*!
       Subsequent incoming MIDI messages will be written to the queue
@@ -165,6 +228,9 @@ class RtMidiIn : public RtMidi
   */
   void setQueueSizeLimit( unsigned int queueSize );
 
+  //! Return the number of incoming messages ignored because the queue was full.
+  unsigned long getDroppedMessageCount( void );
+
   //! Specify whether certain MIDI message types should be queued or ignored during input.
   /*!
       By default, MIDI timing and active sensing messages are ignored
@@ -181,48 +247,91 @@ class RtMidiIn : public RtMidi
       available or not.  A valid message is indicated by a non-zero
       vector size.  An exception is thrown if an error occurs during
       message retrieval or an input connection was not previously
-      established.
+      established.  If \e monotonicTime is given, it receives the
+      absolute arrival time of the message in nanoseconds.
   */
-  double getMessage( std::vector<unsigned char> *message );
+  double getMessage( std::vector<unsigned char> *message, unsigned long long *monotonicTime = 0 );
 
-  // A MIDI structure used internally by the class to store incoming
-  // messages.  Each message represents one and only one MIDI message.
-  struct MidiMessage { 
-    std::vector<unsigned char> bytes; 
-    double timeStamp;
+  //! Request a scheduling class and priority for the input thread.
+  /*!
+      Real-time scheduling keeps MIDI input responsive while the system
+      is under load.  The request applies to a running input thread
+      immediately and to threads started later by openPort().  The
+      priority is clipped to the range of the scheduling class.  When
+      real-time scheduling is granted, the memory of the process is
+      also locked to avoid page faults.  If the system refuses the
+      request (usually because of the user's rtprio limit) a warning
+      is issued and the thread keeps normal scheduling.  APIs without
+      an input thread of their own (CoreMIDI, Windows MM) ignore the
+      request.
+  */
+  void setScheduling( RtMidi::Scheduling scheduling, int priority = 0 );
 
-    // Default constructor.
-    MidiMessage()
-      :bytes(3), timeStamp(0.0) {}
-  };
+  //! Return the scheduling class the input thread actually runs with.
+  /*!
+      If \e priority is given, it receives the achieved priority.
+      Without a running input thread NORMAL_SCHEDULING is returned.
+  */
+  RtMidi::Scheduling getScheduling( int *priority = 0 );
 
-  // The RtMidiInData structure is used to pass private class data to
-  // the MIDI input handling function or thread.
-  struct RtMidiInData {
-    std::queue<MidiMessage> queue;
-    MidiMessage message;
-    unsigned int queueLimit;
-    unsigned char ignoreFlags;
-    bool doInput;
-    bool firstMessage;
-    void *apiData;
-    bool usingCallback;
-    void *userCallback;
-    void *userData;
-    bool continueSysex;
+ private:
 
-    // Default constructor.
-    RtMidiInData()
-      : queueLimit(1024), ignoreFlags(7), doInput(false), firstMessage(true),
-        apiData(0), usingCallback(false), userCallback(0), userData(0),
-        continueSysex(false) {}
-  };
+  void openMidiApi( RtMidi::Api api, const std::string clientName );
+  MidiInApi *rtapi_;
 
- private:
+};
 
-  void initialize( const std::string& clientName );
-  RtMidiInData inputData_;
+/**********************************************************************/
+/*! \class RtMidiRunningStatus
+    \brief A running status encoder for outgoing MIDI byte streams.
+
+    This class decides, message by message, whether the status byte
+    of a channel message may be omitted on the wire.  It is meant for
+    RtMidiOut backends that write raw bytes to a device.  System
+    exclusive and system common messages cancel the running status
+    while real-time messages leave it untouched.  To recover from lost
+    bytes, the status byte is sent again after \e refreshInterval
+    consecutive messages that relied on running status.
+*/
+/**********************************************************************/
+
+class RtMidiRunningStatus
+{
+ public:
+
+  //! Default constructor.  Running status is disabled initially.
+  RtMidiRunningStatus();
+
+  //! Enable or disable running status and set the status refresh interval.
+  /*!
+      A \e refreshInterval of zero never omits a status byte.
+  */
+  void setEnabled( bool enable, unsigned int refreshInterval = 16 );
+
+  //! Returns true if running status is enabled.
+  bool isEnabled() const { return enabled_; }
+
+  //! Forget the current running status.
+  /*!
+      The next channel message will be sent with its status byte.
+      Call this whenever the receiver might have lost track of the
+      stream, i.e. after (re)opening a port.
+  */
+  void reset();
+
+  //! Return the number of leading bytes of \e message that can be omitted on the wire.
+  /*!
+      The message must be complete, i.e. start with a status byte.
+      The return value is either 0 or 1.
+  */
+  unsigned int encode( const unsigned char *message, unsigned int nBytes );
+
+ private:
 
+  bool enabled_;
+  unsigned char status_;
+  unsigned int refreshInterval_;
+  unsigned int omitted_;
 };
 
 /**********************************************************************/
@@ -235,6 +344,9 @@ class RtMidiIn : public RtMidi
     the connection.  Create multiple instances of this class to
     connect to more than one MIDI device at the same time.
 
+    The actual work is done by an API specific MidiOutApi object that
+    is chosen at construction time.
+
     by Gary P. Scavone, 2003-2008.
 */
 /**********************************************************************/
@@ -243,15 +355,21 @@ class RtMidiOut : public RtMidi
 {
  public:
 
-  //! Default constructor that allows an optional client name.
+  //! Default constructor that allows an optional API and client name.
   /*!
-      An exception will be thrown if a MIDI system initialization error occurs.
+      If no API is given or the given one is not compiled in, the
+      compiled APIs are searched in the order of getCompiledApi() for
+      one with at least one output port.  An exception will be thrown
+      if a MIDI system initialization error occurs.
   */
-  RtMidiOut( const std::string clientName = std::string( "RtMidi Output Client" ) );
+  RtMidiOut( RtMidi::Api api = UNSPECIFIED, const std::string clientName = std::string( "RtMidi Output Client" ) );
 
   //! The destructor closes any open MIDI connections.
   ~RtMidiOut();
 
+  //! Returns the MIDI API specifier for the current instance of RtMidiOut.
+  RtMidi::Api getCurrentApi( void );
+
   //! Open a MIDI output connection.
   /*!
       An optional port number greater than 0 can be specified.
@@ -291,9 +409,194 @@ class RtMidiOut : public RtMidi
   */
   void sendMessage( std::vector<unsigned char> *message );
 
+  //! Enable or disable running status compression of the outgoing byte stream.
+  /*!
+      With running status enabled, the status byte of a channel
+      message is omitted if it equals the status byte of the previous
+      channel message.  It is repeated at least every \e refreshInterval
+      messages so a receiver that missed a byte resynchronizes
+      quickly.  This only affects backends that write raw bytes to a
+      device (LINUX_ALSA_RAW).  Event based backends (ALSA sequencer,
+      JACK, Windows MM, IRIX) always transport complete messages and
+      ignore this setting.
+  */
+  void setRunningStatus( bool enable, unsigned int refreshInterval = 16 );
+
+  //! Return the number of MIDI bytes written to the wire by this object so far.
+  /*!
+      With running status enabled on a raw byte backend this is the
+      compressed size, otherwise it is the sum of all message sizes.
+  */
+  unsigned long getWireByteCount() const;
+
  private:
 
-  void initialize( const std::string& clientName );
+  void openMidiApi( RtMidi::Api api, const std::string clientName );
+  MidiOutApi *rtapi_;
+};
+
+// **************************************************************** //
+//
+// MidiInApi / MidiOutApi class declarations.
+//
+// Subclasses of MidiInApi and MidiOutApi contain all API- and
+// OS-specific code necessary to fully implement the RtMidi API.
+//
+// Note that MidiInApi and MidiOutApi are abstract base classes and
+// cannot be explicitly instantiated.  RtMidiIn and RtMidiOut will
+// create instances of a MidiInApi or MidiOutApi subclass.
+//
+// **************************************************************** //
+
+class MidiApi
+{
+ public:
+
+  MidiApi();
+  virtual ~MidiApi();
+  virtual RtMidi::Api getCurrentApi( void ) = 0;
+  virtual void openPort( unsigned int portNumber, const std::string portName ) = 0;
+  virtual void openVirtualPort( const std::string portName ) = 0;
+  virtual void closePort( void ) = 0;
+  virtual unsigned int getPortCount( void ) = 0;
+  virtual std::string getPortName( unsigned int portNumber ) = 0;
+
+  // A basic error reporting function for internal use in the MidiApi
+  // subclasses.  The behavior of this function can be modified to
+  // suit specific needs.
+  void error( RtError::Type type );
+
+ protected:
+
+  virtual void initialize( const std::string& clientName ) = 0;
+
+  void *apiData_;
+  bool connected_;
+  std::string errorString_;
 };
 
+class MidiInApi : public MidiApi
+{
+ public:
+
+  MidiInApi();
+  virtual ~MidiInApi();
+  void setCallback( RtMidiIn::RtMidiCallback callback, void *userData );
+  void setTimedCallback( RtMidiIn::RtMidiTimedCallback callback, void *userData );
+  void cancelCallback( void );
+  void setQueueSizeLimit( unsigned int queueSize );
+  unsigned long getDroppedMessageCount( void );
+  virtual void ignoreTypes( bool midiSysex, bool midiTime, bool midiSense );
+  double getMessage( std::vector<unsigned char> *message, unsigned long long *monotonicTime );
+  void setScheduling( RtMidi::Scheduling scheduling, int priority );
+  RtMidi::Scheduling getScheduling( int *priority );
+
+  // A MIDI structure used internally by the class to store incoming
+  // messages.  Each message represents one and only one MIDI message.
+  // The timeStamp is the delta time in seconds, monotonicTime the
+  // absolute arrival time in nanoseconds (see getMonotonicTime()).
+  struct MidiMessage { 
+    std::vector<unsigned char> bytes; 
+    double timeStamp;
+    unsigned long long monotonicTime;
+
+    // Default constructor.
+    MidiMessage()
+      :bytes(3), timeStamp(0.0), monotonicTime(0) {}
+  };
+
+  // The RtMidiInData structure is used to pass private class data to
+  // the MIDI input handling function or thread.
+  struct RtMidiInData {
+    std::queue<MidiMessage> queue;
+    MidiMessage message;
+    unsigned int queueLimit;
+    volatile unsigned long droppedMessages; // changed atomically, see deliverMessage()
+    unsigned char ignoreFlags;
+    bool doInput;
+    bool firstMessage;
+    void *apiData;
+    bool usingCallback;
+    bool timedCallback;
+    void *userCallback;
+    void *userData;
+    bool continueSysex;
+
+    // Default constructor.
+    RtMidiInData()
+      : queueLimit(1024), droppedMessages(0), ignoreFlags(7), doInput(false), firstMessage(true),
+        apiData(0), usingCallback(false), timedCallback(false), userCallback(0), userData(0),
+        continueSysex(false) {}
+  };
+
+  // Hand a complete message to the user callback or, without one,
+  // to the queue.  Called by the input handlers of all backends.
+  static void deliverMessage( RtMidiInData *data, MidiMessage &message );
+
+ protected:
+
+  // Backends with an input thread pass a pointer to its pthread_t
+  // after starting it, and 0 after joining it, so the requested
+  // scheduling can be applied.
+  void setInputThread( void *thread );
+  void applyScheduling( void );
+
+  RtMidiInData inputData_;
+  void *inputThread_;
+  RtMidi::Scheduling scheduling_;
+  int priority_;
+  RtMidi::Scheduling achievedScheduling_;
+  int achievedPriority_;
+};
+
+class MidiOutApi : public MidiApi
+{
+ public:
+
+  MidiOutApi();
+  virtual ~MidiOutApi();
+  virtual void sendMessage( std::vector<unsigned char> *message ) = 0;
+  void setRunningStatus( bool enable, unsigned int refreshInterval );
+  unsigned long getWireByteCount() const { return wireBytes_; }
+
+ protected:
+
+  RtMidiRunningStatus runningStatus_;
+  unsigned long wireBytes_;
+};
+
+// **************************************************************** //
+//
+// Inline RtMidiIn and RtMidiOut definitions.
+//
+// **************************************************************** //
+
+inline RtMidi::Api RtMidiIn :: getCurrentApi( void ) { return rtapi_->getCurrentApi(); }
+inline void RtMidiIn :: openPort( unsigned int portNumber, const std::string portName ) { rtapi_->openPort( portNumber, portName ); }
+inline void RtMidiIn :: openVirtualPort( const std::string portName ) { rtapi_->openVirtualPort( portName ); }
+inline void RtMidiIn :: closePort( void ) { rtapi_->closePort(); }
+inline void RtMidiIn :: setCallback( RtMidiCallback callback, void *userData ) { rtapi_->setCallback( callback, userData ); }
+inline void RtMidiIn :: setTimedCallback( RtMidiTimedCallback callback, void *userData ) { rtapi_->setTimedCallback( callback, userData ); }
+inline void RtMidiIn :: cancelCallback( void ) { rtapi_->cancelCallback(); }
+inline unsigned int RtMidiIn :: getPortCount( void ) { return rtapi_->getPortCount(); }
+inline std::string RtMidiIn :: getPortName( unsigned int portNumber ) { return rtapi_->getPortName( portNumber ); }
+inline void RtMidiIn :: setQueueSizeLimit( unsigned int queueSize ) { rtapi_->setQueueSizeLimit( queueSize ); }
+inline unsigned long RtMidiIn :: getDroppedMessageCount( void ) { return rtapi_->getDroppedMessageCount(); }
+inline void RtMidiIn :: ignoreTypes( bool midiSysex, bool midiTime, bool midiSense ) { rtapi_->ignoreTypes( midiSysex, midiTime, midiSense ); }
+inline double RtMidiIn :: getMessage( std::vector<unsigned char> *message, unsigned long long *monotonicTime ) { return rtapi_->getMessage( message, monotonicTime ); }
+inline void RtMidiIn :: setScheduling( RtMidi::Scheduling scheduling, int priority ) { rtapi_->setScheduling( scheduling, priority ); }
+inline RtMidi::Scheduling RtMidiIn :: getScheduling( int *priority ) { return rtapi_->getScheduling( priority ); }
+
+inline RtMidi::Api RtMidiOut :: getCurrentApi( void ) { return rtapi_->getCurrentApi(); }
+inline void RtMidiOut :: openPort( unsigned int portNumber, const std::string portName ) { rtapi_->openPort( portNumber, portName ); }
+inline void RtMidiOut :: openVirtualPort( const std::string portName ) { rtapi_->openVirtualPort( portName ); }
+inline void RtMidiOut :: closePort( void ) { rtapi_->closePort(); }
+inline unsigned int RtMidiOut :: getPortCount( void ) { return rtapi_->getPortCount(); }
+inline std::string RtMidiOut :: getPortName( unsigned int portNumber ) { return rtapi_->getPortName( portNumber ); }
+#if !defined(__DTEDIT_TRACE_EVENTS__)
+inline void RtMidiOut :: sendMessage( std::vector<unsigned char> *message ) { rtapi_->sendMessage( message ); }
+#endif
+inline void RtMidiOut :: setRunningStatus( bool enable, unsigned int refreshInterval ) { rtapi_->setRunningStatus( enable, refreshInterval ); }
+inline unsigned long RtMidiOut :: getWireByteCount() const { return rtapi_->getWireByteCount(); }
+
 #endif
@@ -0,0 +1,30 @@
+#-------------------------------------------------
+#
+# RtMidi platform settings shared by all targets.
+#
+#-------------------------------------------------
+
+win* {
+    DEFINES += __WINDOWS_MM__
+    LIBS += -lwinmm
+}
+
+linux* {
+    DEFINES += __LINUX_ALSASEQ__
+    DEFINES += __LINUX_ALSARAW__
+    CONFIG += link_pkgconfig
+    PKGCONFIG += alsa
+}
+
+# JACK MIDI support, enable with "qmake CONFIG+=jack":
+jack {
+    DEFINES += __UNIX_JACK__
+    CONFIG += link_pkgconfig
+    PKGCONFIG += jack
+}
+
+# In-process loopback API for tests and benchmarks, enable with
+# "qmake CONFIG+=loopback":
+loopback:DEFINES += __RTMIDI_LOOPBACK__
+
+debug:DEFINES += __RTMIDI_DEBUG__
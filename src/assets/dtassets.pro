@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# Converts the editor images to raw premultiplied
+# ARGB32 images, see imageassets.h.
+#
+#-------------------------------------------------
+
+QT += core gui
+
+TARGET = dtassets
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+INCLUDEPATH += ..
+
+SOURCES += main.cpp
+
+HEADERS += ../imageassets.h
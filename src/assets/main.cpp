@@ -0,0 +1,145 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    main.cpp
+///\ingroup dtedit
+///\brief   Converter from PNG images to raw images.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include <cstdio>
+#include <QtCore>
+#include "imageassets.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// convert()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Convert a PNG image to a raw image.
+///\param   [in] source: Path of the PNG image.
+///\param   [in] target: Path of the raw image.
+///\return  Returns true if successful or false on failure.
+////////////////////////////////////////////////////////////////////////////////
+static bool convert(const QString& source, const QString& target)
+{
+  // Decode the image:
+  QImage image(source);
+  if (image.isNull())
+  {
+    fprintf(stderr, "dtassets: Could not decode %s\n", qPrintable(source));
+    return false;
+  }
+  image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+  // Write header and pixels:
+  QFile file(target);
+  if (!file.open(QIODevice::WriteOnly))
+  {
+    fprintf(stderr, "dtassets: Could not create %s\n", qPrintable(target));
+    return false;
+  }
+  quint32 header[4];
+  memcpy(header, "DTRI", 4);
+  header[1] = RAWIMAGE_BYTE_ORDER;
+  header[2] = image.width();
+  header[3] = image.height();
+  bool ok = file.write(reinterpret_cast<const char*>(header), sizeof(header)) == sizeof(header);
+  for (int y = 0; ok && y < image.height(); y++)
+  {
+    qint64 rowSize = image.width() * 4;
+    ok = file.write(reinterpret_cast<const char*>(image.constScanLine(y)), rowSize) == rowSize;
+  }
+  if (!ok)
+  {
+    fprintf(stderr, "dtassets: Could not write %s\n", qPrintable(target));
+    file.close();
+    file.remove();
+    return false;
+  }
+
+  // Return to sender:
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// main()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Converter entry point.
+///\param   [in] argc: Number of command line arguments passed to this program.
+///\param   [in] argv: Array of command line arguments.
+///\return  Returns zero if successfull or an error code on failure.
+///\remarks Usage: dtassets <output dir> <png files...>
+///         Converts each PNG image that is newer than its raw image and
+///         writes rawassets.qrc that lists all raw images uncompressed, so
+///         the images can be used right from the resource memory.
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+  QCoreApplication a(argc, argv);
+  QStringList args = a.arguments();
+  if (args.size() < 3)
+  {
+    fprintf(stderr, "Usage: dtassets <output dir> <png files...>\n");
+    return 1;
+  }
+
+  // Create the output directory:
+  QDir outDir(args[1]);
+  if (!outDir.exists() && !QDir().mkpath(outDir.path()))
+  {
+    fprintf(stderr, "dtassets: Could not create %s\n", qPrintable(outDir.path()));
+    return 1;
+  }
+
+  // Convert the images:
+  QStringList names;
+  for (int i = 2; i < args.size(); i++)
+  {
+    QFileInfo source(args[i]);
+    QString   name = source.completeBaseName() + ".argb";
+    QFileInfo target(outDir.filePath(name));
+    if (!target.exists() || target.lastModified() < source.lastModified())
+    {
+      if (!convert(source.filePath(), target.filePath()))
+        return 1;
+    }
+    names.append(name);
+  }
+
+  // Write the resource file, but only if it changed so rcc does not run
+  // on every build:
+  QString qrc = "<RCC>\n    <qresource prefix=\"/raw\">\n";
+  for (int i = 0; i < names.size(); i++)
+    qrc += "        <file compress=\"0\">" + names[i] + "</file>\n";
+  qrc += "    </qresource>\n</RCC>\n";
+  QFile qrcFile(outDir.filePath("rawassets.qrc"));
+  if (qrcFile.open(QIODevice::ReadOnly) && qrcFile.readAll() == qrc.toUtf8())
+    return 0;
+  qrcFile.close();
+  if (!qrcFile.open(QIODevice::WriteOnly) || qrcFile.write(qrc.toUtf8()) < 0)
+  {
+    fprintf(stderr, "dtassets: Could not write %s\n", qPrintable(qrcFile.fileName()));
+    return 1;
+  }
+
+  // Return to sender:
+  return 0;
+}
+
+///////////////////////////////// End of File //////////////////////////////////
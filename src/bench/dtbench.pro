@@ -0,0 +1,18 @@
+#-------------------------------------------------
+#
+# Micro benchmarks of the editor's MIDI paths.
+#
+#-------------------------------------------------
+
+QT += core gui xml
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = dtbench
+TEMPLATE = app
+CONFIG += console loopback
+CONFIG -= app_bundle
+
+SOURCES += main.cpp
+
+include(../dtedit.pri)
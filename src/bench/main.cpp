@@ -0,0 +1,1057 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    main.cpp
+///\ingroup dtedit
+///\brief   Micro benchmarks of the MIDI paths of the editor.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+#include <QApplication>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include "dtedit.h"
+#include "mainmidiwindow.h"
+#include "mainwindow.h"
+#include "imageassets.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Allocation counting
+////////////////////////////////////////////////////////////////////////////////
+// Number of heap allocations done by the measuring thread. The MIDI input
+// threads, the flood sender and the image prefetch allocate through the same
+// hooks, so only the thread that set countAllocations is counted and the
+// counter has a single writer.
+#if defined(_MSC_VER)
+#define BENCH_THREAD_LOCAL __declspec(thread)
+#else
+#define BENCH_THREAD_LOCAL __thread
+#endif
+static BENCH_THREAD_LOCAL bool countAllocations = false;
+static unsigned long long allocationCount = 0;
+
+static inline void countAllocation()
+{
+  if (countAllocations)
+    allocationCount++;
+}
+
+#if defined(__GLIBC__)
+
+// With glibc the allocator itself is replaced so the allocations done by Qt
+// (QString and friends use malloc) are counted as well:
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+extern "C" void* malloc(size_t size) __THROW
+{
+  countAllocation();
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) __THROW
+{
+  countAllocation();
+  return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) __THROW
+{
+  countAllocation();
+  return __libc_realloc(ptr, size);
+}
+
+#else
+
+// Elsewhere only the C++ allocations are seen:
+#if __cplusplus < 201103L
+#define BENCH_THROW_BAD_ALLOC throw (std::bad_alloc)
+#else
+#define BENCH_THROW_BAD_ALLOC
+#endif
+
+void* operator new(size_t size) BENCH_THROW_BAD_ALLOC
+{
+  countAllocation();
+  void* ptr = malloc(size ? size : 1);
+  if (ptr == 0)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void* operator new[](size_t size) BENCH_THROW_BAD_ALLOC
+{
+  countAllocation();
+  void* ptr = malloc(size ? size : 1);
+  if (ptr == 0)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void* ptr) throw ()
+{
+  free(ptr);
+}
+
+void operator delete[](void* ptr) throw ()
+{
+  free(ptr);
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+///\class DecodeWindow
+///\brief MIDI window that only counts the decoded messages.
+/// This isolates the status decoding of MainMIDIWindow::onMIDIMessage() from
+/// the work done by the editor for each message.
+////////////////////////////////////////////////////////////////////////////////
+class DecodeWindow :
+  public MainMIDIWindow
+{
+public:
+  DecodeWindow() : decoded(0) { }
+
+  void decode(const std::vector<unsigned char>& message) { onMIDIMessage(0, message); }
+
+  unsigned long decoded; ///> Number of messages that reached a handler.
+
+protected:
+  void noteOnReceived(unsigned char, unsigned char, unsigned char)          { decoded++; }
+  void noteOffReceived(unsigned char, unsigned char, unsigned char)         { decoded++; }
+  void controlChangeReceived(unsigned char, unsigned char, unsigned char)   { decoded++; }
+  void programChangeReceived(unsigned char, unsigned char)                  { decoded++; }
+  void channelAftertouchReceived(unsigned char, unsigned char)              { decoded++; }
+  void pitchBendReceived(unsigned char, unsigned short)                     { decoded++; }
+  void polyAftertouchReceived(unsigned char, unsigned char, unsigned char)  { decoded++; }
+  void sysExReceived(const std::vector<unsigned char>&)                     { decoded++; }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///\class EditorWindow
+///\brief The editor window with its MIDI handlers made accessible.
+////////////////////////////////////////////////////////////////////////////////
+class EditorWindow :
+  public MainWindow
+{
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  // EditorWindow::openNullOutput()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Route all outgoing messages to the loopback API.
+  ///\remarks Nothing listens on the default loopback bus, so this measures
+  ///         the editor side of the output path without a driver.
+  //////////////////////////////////////////////////////////////////////////////
+  void openNullOutput()
+  {
+    delete midiOut;
+    midiOut = new RtMidiOut(RtMidi::LOOPBACK);
+    midiOut->openPort(0);
+    midiOK = true;
+  }
+
+  void receiveControlChange(unsigned char controlNumber, unsigned char value) { controlChangeReceived(DT_MIDI_CHANNEL, controlNumber, value); }
+  void receiveSysEx(const std::vector<unsigned char>& buff)                  { sysExReceived(buff); }
+  void send(unsigned char controlNumber, unsigned char value)                { sendControlChange(DT_MIDI_CHANNEL, controlNumber, value); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///\struct ControllerInfo
+///\brief  A controller of the CC mix and the number of values it takes.
+////////////////////////////////////////////////////////////////////////////////
+struct ControllerInfo
+{
+  unsigned char controlNumber; ///> The controller.
+  unsigned char range;         ///> Values are 0 to range - 1.
+};
+
+// The controllers the amp sends while a knob is turned or a preset changes.
+// The voice selectors and the block/receive markers (126, 127) are left out
+// on purpose as they start a new parameter query that waits for the amp.
+static const ControllerInfo controllerMix[] =
+{
+  { CC_GAIN_A,         128 }, { CC_BASS_A,         128 }, { CC_MIDDLE_A,       128 },
+  { CC_TREBLE_A,       128 }, { CC_PRESENCE_A,     128 }, { CC_VOLUME_A,       128 },
+  { CC_REV_DECAY_A,    128 }, { CC_REV_PREDELAY_A, 128 }, { CC_REV_TONE_A,     128 },
+  { CC_REV_MIX_A,      128 }, { CC_GAIN_B,         128 }, { CC_BASS_B,         128 },
+  { CC_MIDDLE_B,       128 }, { CC_TREBLE_B,       128 }, { CC_PRESENCE_B,     128 },
+  { CC_VOLUME_B,       128 }, { CC_REV_DECAY_B,    128 }, { CC_REV_PREDELAY_B, 128 },
+  { CC_REV_TONE_B,     128 }, { CC_REV_MIX_B,      128 }, { CC_MASTER_VOL,     128 },
+  { CC_AMP_A,            4 }, { CC_CAB_A,            4 }, { CC_REV_TYPE_A,       4 },
+  { CC_AMP_B,            4 }, { CC_CAB_B,            4 }, { CC_REV_TYPE_B,       4 },
+  { CC_XLR_MIC,          4 }, { CC_TOPOL_A,          4 }, { CC_TOPOL_B,          4 },
+  { CC_REV_BYPASS_A,   128 }, { CC_REV_BYPASS_B,   128 }, { CC_CLASS_A,        128 },
+  { CC_CLASS_B,        128 }, { CC_XTODE_A,        128 }, { CC_XTODE_B,        128 },
+  { CC_BOOST_A,        128 }, { CC_BOOST_B,        128 }, { CC_PI_VOLTAGE_A,   128 },
+  { CC_PI_VOLTAGE_B,   128 }, { CC_CAP_TYPE_A,     128 }, { CC_CAP_TYPE_B,     128 },
+  { CC_LOWVOLUME,      128 }, { CC_CHANNEL,        128 }
+};
+
+// Length of the prepared message sequences:
+static const int sequenceLength = 1024;
+
+////////////////////////////////////////////////////////////////////////////////
+// nextRandom()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Simple deterministic random numbers for the message mixes.
+///\param   [in,out] state: State of the generator.
+///\return  The next random number.
+////////////////////////////////////////////////////////////////////////////////
+static unsigned int nextRandom(unsigned int& state)
+{
+  state = state * 1103515245 + 12345;
+  return (state >> 16) & 0x7FFF;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// makeControlChanges()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Build the CC mix used by the editor benchmarks.
+///\return  Pairs of controller number and value.
+////////////////////////////////////////////////////////////////////////////////
+static std::vector<std::pair<unsigned char, unsigned char> > makeControlChanges()
+{
+  std::vector<std::pair<unsigned char, unsigned char> > ccs;
+  unsigned int state = 1;
+  const int controllers = sizeof(controllerMix) / sizeof(controllerMix[0]);
+  for (int i = 0; i < sequenceLength; i++)
+  {
+    // Knobs are turned far more often than anything else is changed, so
+    // three out of four messages come from the first 21 (continuous) entries:
+    int index = nextRandom(state) % 4 ? nextRandom(state) % 21 : nextRandom(state) % controllers;
+    const ControllerInfo& info = controllerMix[index];
+    ccs.push_back(std::make_pair(info.controlNumber, (unsigned char)(nextRandom(state) % info.range)));
+  }
+  return ccs;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// makeIdentityReply()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Build the identity reply of a DT amp.
+///\param   [in] model: Model number (0 = DT50 1x12 Combo ... 4 = DT25 Head).
+///\return  The 17 byte SysEx message.
+////////////////////////////////////////////////////////////////////////////////
+static std::vector<unsigned char> makeIdentityReply(unsigned char model)
+{
+  static const unsigned char reply[17] =
+  {
+    0xF0, 0x7E, 0x7F, 0x06, 0x02, 0x00, 0x01, 0x0C, 0x15, 0x00,
+    0x00, 0x00, ' ', '1', '0', '4', 0xF7
+  };
+  std::vector<unsigned char> buff(reply, reply + 17);
+  buff[10] = model;
+  return buff;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// makeInputStream()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Build a stream of raw messages as the MIDI input sees them.
+///\return  Mostly control changes with some notes, program changes, pitch
+///         bends and identity replies mixed in.
+////////////////////////////////////////////////////////////////////////////////
+static std::vector<std::vector<unsigned char> > makeInputStream()
+{
+  std::vector<std::pair<unsigned char, unsigned char> > ccs = makeControlChanges();
+  std::vector<std::vector<unsigned char> > messages;
+  unsigned int state = 2;
+  for (int i = 0; i < sequenceLength; i++)
+  {
+    std::vector<unsigned char> message;
+    unsigned int kind = nextRandom(state) % 64;
+    if (kind == 0)
+      message = makeIdentityReply(i % 5);
+    else if (kind < 4)
+    {
+      message.push_back(0xE0);
+      message.push_back(nextRandom(state) & 0x7F);
+      message.push_back(nextRandom(state) & 0x7F);
+    }
+    else if (kind < 6)
+    {
+      message.push_back(0xC0);
+      message.push_back(nextRandom(state) & 0x7F);
+    }
+    else if (kind < 10)
+    {
+      message.push_back(kind & 1 ? 0x90 : 0x80);
+      message.push_back(nextRandom(state) & 0x7F);
+      message.push_back(nextRandom(state) & 0x7F);
+    }
+    else
+    {
+      message.push_back(0xB0 | DT_MIDI_CHANNEL);
+      message.push_back(ccs[i].first);
+      message.push_back(ccs[i].second);
+    }
+    messages.push_back(message);
+  }
+  return messages;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///\struct Result
+///\brief  Outcome of a single benchmark run.
+////////////////////////////////////////////////////////////////////////////////
+struct Result
+{
+  unsigned long      messages;    ///> Number of processed messages.
+  unsigned long long nanoSeconds; ///> Elapsed time.
+  unsigned long long allocations; ///> Heap allocations done during the run.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Benchmark bodies
+////////////////////////////////////////////////////////////////////////////////
+// Each one processes at least the given number of messages and returns how
+// many it actually processed.
+
+static std::vector<std::vector<unsigned char> >             inputStream;
+static std::vector<std::pair<unsigned char, unsigned char> > controlChanges;
+static std::vector<std::vector<unsigned char> >             identityReplies;
+
+static unsigned long runDecode(DecodeWindow& decoder, EditorWindow&, unsigned long count)
+{
+  unsigned long n = 0;
+  while (n < count)
+    for (int i = 0; i < sequenceLength; i++, n++)
+      decoder.decode(inputStream[i]);
+  return n;
+}
+
+static unsigned long runControlChange(DecodeWindow&, EditorWindow& editor, unsigned long count)
+{
+  unsigned long n = 0;
+  while (n < count)
+  {
+    for (int i = 0; i < sequenceLength; i++, n++)
+      editor.receiveControlChange(controlChanges[i].first, controlChanges[i].second);
+    editor.flushUpdates();
+  }
+  return n;
+}
+
+static unsigned long runSysEx(DecodeWindow&, EditorWindow& editor, unsigned long count)
+{
+  unsigned long n = 0;
+  while (n < count)
+  {
+    for (size_t i = 0; i < identityReplies.size(); i++, n++)
+      editor.receiveSysEx(identityReplies[i]);
+
+    // The title is set by a queued call, deliver it like the event loop:
+    QCoreApplication::sendPostedEvents(&editor, QEvent::MetaCall);
+  }
+  return n;
+}
+
+static unsigned long runSend(DecodeWindow&, EditorWindow& editor, unsigned long count)
+{
+  unsigned long n = 0;
+  while (n < count)
+    for (int i = 0; i < sequenceLength; i++, n++)
+      editor.send(controlChanges[i].first, controlChanges[i].second);
+  return n;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///\struct Benchmark
+///\brief  Name and body of a benchmark.
+////////////////////////////////////////////////////////////////////////////////
+struct Benchmark
+{
+  const char* name;                                                    ///> Name used on the command line.
+  const char* description;                                             ///> What is measured.
+  unsigned long (*run)(DecodeWindow&, EditorWindow&, unsigned long);  ///> The body.
+};
+
+static const Benchmark benchmarks[] =
+{
+  { "decode",  "MainMIDIWindow::onMIDIMessage() status decoding", runDecode        },
+  { "cc",      "MainWindow::controlChangeReceived(), CC batches", runControlChange },
+  { "sysex",   "MainWindow::sysExReceived(), identity replies",   runSysEx         },
+  { "send",    "sendControlChange() to a null output",            runSend          }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// measure()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Run a benchmark once for warm up and once for the measurement.
+///\param   [in] benchmark: The benchmark to run.
+///\param   [in] decoder:   Window for the decoding benchmark.
+///\param   [in] editor:    Window for the editor benchmarks.
+///\param   [in] count:     Minimum number of messages to process.
+///\return  The measured values.
+////////////////////////////////////////////////////////////////////////////////
+static Result measure(const Benchmark& benchmark, DecodeWindow& decoder, EditorWindow& editor, unsigned long count)
+{
+  // Warm up caches and let lazy initializations happen:
+  benchmark.run(decoder, editor, count / 10);
+
+  // Measure:
+  Result result;
+  unsigned long long allocations = allocationCount;
+  unsigned long long start       = RtMidi::getMonotonicTime();
+  countAllocations   = true;
+  result.messages    = benchmark.run(decoder, editor, count);
+  countAllocations   = false;
+  result.nanoSeconds = RtMidi::getMonotonicTime() - start;
+  result.allocations = allocationCount - allocations;
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Image assets
+////////////////////////////////////////////////////////////////////////////////
+// The images loaded by the editor window at startup.
+static const char* assetNames[] =
+{
+  "back",
+  "I_II_III_IV", "I_II_III_IV_disabled", "knob_movie", "knob_disabled",
+  "led_yellow",  "led_yellow_disabled",  "onoff",      "onoff_disabled",
+  "class",       "class_disabled",       "xtode",      "xtode_disabled",
+  "boost",       "boost_disabled",       "piv",        "piv_disabled",
+  "cap",         "cap_disabled",         "channel",    "channel_disabled",
+  "led_red",     "led_red_disabled",     "midi",       "midi_disabled",
+  "about",       "about_disabled"
+};
+static const int assetCount = sizeof(assetNames) / sizeof(assetNames[0]);
+
+////////////////////////////////////////////////////////////////////////////////
+// residentMemory()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the resident memory of this process.
+///\param   [out] privateSize: Receives the resident memory that is not backed
+///                            by a file (heap and anonymous maps).
+///\return  Resident memory in KiB or -1 if not available on this system.
+////////////////////////////////////////////////////////////////////////////////
+static long residentMemory(long& privateSize)
+{
+  privateSize = -1;
+  long size = -1;
+  long shared;
+  #ifdef __linux__
+  FILE* file = fopen("/proc/self/statm", "r");
+  if (file != 0)
+  {
+    long total;
+    if (fscanf(file, "%ld %ld %ld", &total, &size, &shared) == 3)
+    {
+      long pageKiB = sysconf(_SC_PAGESIZE) / 1024;
+      privateSize  = (size - shared) * pageKiB;
+      size        *= pageKiB;
+    }
+    else
+      size = -1;
+    fclose(file);
+  }
+  #else
+  (void)shared;
+  #endif
+  return size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// loadAssets()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Load the image set of the editor window.
+///\param   [in]  raw:    Use the raw images instead of decoding the PNGs?
+///\param   [out] images: Receives the images.
+///\return  Checksum over the pixels, so every page is touched as by painting.
+////////////////////////////////////////////////////////////////////////////////
+static unsigned int loadAssets(bool raw, QList<QImage>& images)
+{
+  unsigned int sum = 0;
+  for (int i = 0; i < assetCount; i++)
+  {
+    QImage image = raw ? ImageAssets::rawImage(assetNames[i]) : ImageAssets::pngImage(assetNames[i]);
+    const uchar* bits = image.constBits();
+    for (int offset = 0; offset < image.byteCount(); offset += 4096)
+      sum += bits[offset];
+    images.append(image);
+  }
+  return sum;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// measureAssets()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Compare loading the images from PNG and from raw images.
+///\param   [in] rounds: Number of times the whole set is loaded as pixmaps.
+///\remarks The memory is measured first, while the heap is still fresh, and
+///         the raw images before the PNG images so freed decoder buffers do
+///         not hide the memory used by the decoded images.
+////////////////////////////////////////////////////////////////////////////////
+static void measureAssets(int rounds)
+{
+  bool haveRaw = !ImageAssets::rawImage(assetNames[0]).isNull();
+  printf("%-8s %12s %12s %12s %12s\n", "assets", "rounds", "ms/set", "rss KiB", "private KiB");
+  for (int path = haveRaw ? 0 : 1; path < 2; path++)
+  {
+    bool raw = path == 0;
+
+    // Resident memory of one set, held like the widgets hold it:
+    QList<QImage> images;
+    long privateBefore;
+    long privateAfter;
+    long before = residentMemory(privateBefore);
+    loadAssets(raw, images);
+    long after = residentMemory(privateAfter);
+    images.clear();
+
+    // Time to create the pixmaps of the whole set, like createEditArea():
+    unsigned long long start = RtMidi::getMonotonicTime();
+    for (int round = 0; round < rounds; round++)
+    {
+      for (int i = 0; i < assetCount; i++)
+      {
+        QImage image = raw ? ImageAssets::rawImage(assetNames[i]) : ImageAssets::pngImage(assetNames[i]);
+        #if QT_VERSION >= 0x050300
+        QPixmap pixmap = QPixmap::fromImageInPlace(image);
+        #else
+        QPixmap pixmap = QPixmap::fromImage(image);
+        #endif
+      }
+    }
+    unsigned long long elapsed = RtMidi::getMonotonicTime() - start;
+
+    if (before < 0)
+      printf("%-8s %12d %12.2f %12s %12s\n", raw ? "raw" : "png", rounds, elapsed / 1e6 / rounds, "n/a", "n/a");
+    else
+      printf("%-8s %12d %12.2f %12ld %12ld\n", raw ? "raw" : "png", rounds, elapsed / 1e6 / rounds,
+             after - before, privateAfter - privateBefore);
+    fflush(stdout);
+  }
+  if (!haveRaw)
+    printf("(raw images not compiled in, rebuild with \"qmake CONFIG+=raw_assets\")\n");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Wire round trip
+////////////////////////////////////////////////////////////////////////////////
+// Controller of the round trip messages, undefined in the MIDI spec and not
+// used by the DT:
+static const unsigned char wireController = 102;
+
+// Give up on a round trip after this many milliseconds:
+static const unsigned long wireTimeout = 1000;
+
+////////////////////////////////////////////////////////////////////////////////
+///\class WireProbe
+///\brief Waits for the looped back controller changes.
+////////////////////////////////////////////////////////////////////////////////
+class WireProbe
+{
+public:
+  WireProbe() : expected(-1), arrival(0) { }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // WireProbe::expect()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Start waiting for a value.
+  ///\param   [in] value: The value that was sent.
+  //////////////////////////////////////////////////////////////////////////////
+  void expect(int value)
+  {
+    QMutexLocker locker(&mutex);
+    expected = value;
+    arrival  = 0;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // WireProbe::wait()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Wait for the expected value.
+  ///\return  Arrival time in nanoseconds or 0 on timeout.
+  //////////////////////////////////////////////////////////////////////////////
+  unsigned long long wait()
+  {
+    QMutexLocker locker(&mutex);
+    if (arrival == 0)
+      arrived.wait(&mutex, wireTimeout);
+    return arrival;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // WireProbe::onMIDIMessageProxy()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Callback of the input port.
+  ///\remarks The arrival is stamped here, so both drivers are measured up to
+  ///         the point where the editor gets the message.
+  //////////////////////////////////////////////////////////////////////////////
+  static void onMIDIMessageProxy(unsigned long long /* timeStamp */, double /* deltaTime */, std::vector<unsigned char>* message, void* userData)
+  {
+    unsigned long long now = RtMidi::getMonotonicTime();
+    WireProbe* probe = static_cast<WireProbe*>(userData);
+    if (message->size() != 3 || (message->at(0) & 0xF0) != 0xB0 || message->at(1) != wireController)
+      return;
+    QMutexLocker locker(&probe->mutex);
+    if (message->at(2) == probe->expected && probe->arrival == 0)
+    {
+      probe->arrival = now;
+      probe->arrived.wakeAll();
+    }
+  }
+
+private:
+  QMutex             mutex;    ///> Guards the members below.
+  QWaitCondition     arrived;  ///> Signalled when the value arrived.
+  int                expected; ///> The value in flight.
+  unsigned long long arrival;  ///> Its arrival time or 0.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// findPort()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Find the first port whose name contains a text.
+///\param   [in] midi: Input or output to search.
+///\param   [in] name: Part of the port name, case insensitive.
+///\return  The port number or -1 if no port matches.
+////////////////////////////////////////////////////////////////////////////////
+template <class T> static int findPort(T& midi, const QString& name)
+{
+  for (unsigned int i = 0; i < midi.getPortCount(); i++)
+  {
+    if (QString(midi.getPortName(i).c_str()).contains(name, Qt::CaseInsensitive))
+      return static_cast<int>(i);
+  }
+  return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// measureWire()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Compare the round trip time of the MIDI drivers.
+///\param   [in] port:    Part of the port names to use.
+///\param   [in] samples: Round trips per driver.
+///\remarks Needs a cable from the MIDI output to the input of the same
+///         interface. Each driver that has a matching port sends a
+///         controller change and waits until it is back, the raw driver
+///         runs once more with running status. The DT itself does not echo
+///         the benchmark controller, so it can't close the loop.
+////////////////////////////////////////////////////////////////////////////////
+static void measureWire(const QString& port, int samples)
+{
+  printf("%-14s %8s %10s %10s %10s %10s %6s\n", "wire [us]", "samples", "min", "p50", "p99", "max", "lost");
+  std::vector<RtMidi::Api> apis;
+  RtMidi::getCompiledApi(apis);
+  for (size_t i = 0; i < apis.size(); i++)
+  {
+    if (apis[i] == RtMidi::LOOPBACK)
+      continue;
+    for (int runningStatus = 0; runningStatus < (apis[i] == RtMidi::LINUX_ALSA_RAW ? 2 : 1); runningStatus++)
+    {
+      std::string name = RtMidi::getApiName(apis[i]) + (runningStatus ? "+rs" : "");
+      std::vector<unsigned long long> trips;
+      int lost = 0;
+      try
+      {
+        // Open the ports:
+        WireProbe probe;
+        RtMidiIn  in(apis[i]);
+        RtMidiOut out(apis[i]);
+        int inPort  = findPort(in,  port);
+        int outPort = findPort(out, port);
+        if (inPort < 0 || outPort < 0)
+        {
+          printf("%-14s no port matches \"%s\"\n", name.c_str(), qPrintable(port));
+          continue;
+        }
+        in.setTimedCallback(&WireProbe::onMIDIMessageProxy, &probe);
+        in.openPort(inPort);
+        out.setRunningStatus(runningStatus != 0);
+        out.openPort(outPort);
+
+        // Send one controller change at a time:
+        std::vector<unsigned char> message(3);
+        message[0] = 0xB0 | DT_MIDI_CHANNEL;
+        message[1] = wireController;
+        for (int n = 0; n < samples; n++)
+        {
+          message[2] = n & 0x7F;
+          probe.expect(message[2]);
+          unsigned long long start = RtMidi::getMonotonicTime();
+          out.sendMessage(&message);
+          unsigned long long arrival = probe.wait();
+          if (arrival != 0)
+            trips.push_back(arrival - start);
+          else
+            lost++;
+        }
+      }
+      catch (RtError& err)
+      {
+        printf("%-14s %s\n", name.c_str(), err.getMessage().c_str());
+        continue;
+      }
+
+      // Print the distribution (nearest rank percentiles):
+      if (trips.empty())
+      {
+        printf("%-14s no samples (%d lost)\n", name.c_str(), lost);
+        continue;
+      }
+      std::sort(trips.begin(), trips.end());
+      size_t p50 = (trips.size() * 50 + 99) / 100;
+      size_t p99 = (trips.size() * 99 + 99) / 100;
+      printf("%-14s %8lu %10.1f %10.1f %10.1f %10.1f %6d\n", name.c_str(), (unsigned long)trips.size(),
+             trips.front() / 1000.0, trips[p50 - 1] / 1000.0, trips[p99 - 1] / 1000.0, trips.back() / 1000.0, lost);
+      fflush(stdout);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Loopback flood
+////////////////////////////////////////////////////////////////////////////////
+// Messages of the flood, four times the queue of a loopback input so the
+// sender has to wait for space a few times:
+static const unsigned long floodMessages = 4 * 65536;
+
+// Give up if the sender makes no progress for this many milliseconds:
+static const unsigned long floodTimeout = 10000;
+
+////////////////////////////////////////////////////////////////////////////////
+///\class FloodProbe
+///\brief Counts the flood at the input and lists the ports meanwhile.
+////////////////////////////////////////////////////////////////////////////////
+class FloodProbe
+{
+public:
+  FloodProbe(RtMidiIn& input) : input(input), received(0) { }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // FloodProbe::wait()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Wait until a number of messages arrived.
+  ///\param   [in] count: Number of messages sent.
+  ///\return  Number of messages received.
+  //////////////////////////////////////////////////////////////////////////////
+  unsigned long wait(unsigned long count)
+  {
+    QMutexLocker locker(&mutex);
+    while (received < count)
+    {
+      if (!arrived.wait(&mutex, floodTimeout))
+        break;
+    }
+    return received;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // FloodProbe::onMIDIMessageProxy()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Callback of the input port.
+  ///\remarks Every so often the callback takes a short nap so the queue
+  ///         fills up, then lists the ports, which needs the bus registry of
+  ///         the loopback driver. A sender that keeps the registry locked
+  ///         while it waits for space hangs here.
+  //////////////////////////////////////////////////////////////////////////////
+  static void onMIDIMessageProxy(unsigned long long /* timeStamp */, double /* deltaTime */, std::vector<unsigned char>* /* message */, void* userData)
+  {
+    FloodProbe* probe = static_cast<FloodProbe*>(userData);
+    unsigned long count;
+    {
+      QMutexLocker locker(&probe->mutex);
+      count = ++probe->received;
+      probe->arrived.wakeAll();
+    }
+    if ((count & 0x3FFF) == 0)
+    {
+      usleep(20000);
+      probe->input.getPortCount();
+    }
+  }
+
+private:
+  RtMidiIn&      input;    ///> The input that calls us.
+  QMutex         mutex;    ///> Guards the members below.
+  QWaitCondition arrived;  ///> Signalled for each message.
+  unsigned long  received; ///> Messages received so far.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///\class FloodSender
+///\brief Sends the flood from a thread of its own.
+////////////////////////////////////////////////////////////////////////////////
+class FloodSender :
+  public QThread
+{
+public:
+  FloodSender(RtMidiOut& output, unsigned long count) : output(output), count(count), elapsed(0) { }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // FloodSender::run()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Send the controller changes as fast as possible.
+  //////////////////////////////////////////////////////////////////////////////
+  void run()
+  {
+    std::vector<unsigned char> message(3);
+    message[0] = 0xB0 | DT_MIDI_CHANNEL;
+    message[1] = wireController;
+    unsigned long long start = RtMidi::getMonotonicTime();
+    for (unsigned long n = 0; n < count; n++)
+    {
+      message[2] = n & 0x7F;
+      output.sendMessage(&message);
+    }
+    elapsed = RtMidi::getMonotonicTime() - start;
+  }
+
+  RtMidiOut&         output;  ///> Port to flood.
+  unsigned long      count;   ///> Number of messages to send.
+  unsigned long long elapsed; ///> Send time in nanoseconds.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// measureFlood()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Flood a loopback input faster than it delivers.
+///\param   [in] messages: Minimum number of messages to send.
+///\return  True if all messages arrived.
+///\remarks The sender blocks whenever the input queue is full while the
+///         callback keeps using the driver. Any lost message or a stalled
+///         sender is a driver bug.
+////////////////////////////////////////////////////////////////////////////////
+static bool measureFlood(unsigned long messages)
+{
+  printf("%-8s %12s %12s %12s\n", "name", "messages", "ns/msg", "lost");
+  unsigned long count = std::max(messages, floodMessages);
+  try
+  {
+    // Connect an output to a virtual input:
+    RtMidiIn  in(RtMidi::LOOPBACK);
+    RtMidiOut out(RtMidi::LOOPBACK);
+    FloodProbe probe(in);
+    in.setTimedCallback(&FloodProbe::onMIDIMessageProxy, &probe);
+    in.openVirtualPort("DTBench Flood");
+    int outPort = findPort(out, "DTBench Flood");
+    if (outPort < 0)
+    {
+      printf("%-8s virtual port not found\n", "flood");
+      return false;
+    }
+    out.openPort(outPort);
+
+    // Send and wait for the input to catch up:
+    FloodSender sender(out, count);
+    sender.start();
+    unsigned long received = 0;
+    while (received < count)
+    {
+      unsigned long before = received;
+      received = probe.wait(count);
+      if (received == before)
+        break;
+    }
+    if (!sender.wait(floodTimeout))
+    {
+      // The objects can't be torn down under a hanging sender:
+      printf("%-8s %12lu sender stalled\n", "flood", count);
+      fflush(stdout);
+      _exit(1);
+    }
+    in.closePort();
+    printf("%-8s %12lu %12.1f %12lu\n", "flood", count, (double)sender.elapsed / count, count - received);
+    fflush(stdout);
+    return received == count;
+  }
+  catch (RtError& err)
+  {
+    printf("%-8s %s\n", "flood", err.getMessage().c_str());
+    return false;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// usage()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Print the command line help.
+////////////////////////////////////////////////////////////////////////////////
+static void usage()
+{
+  printf("Usage: dtbench [options] [benchmark...]\n"
+         "Measures the MIDI paths of the editor.\n\n"
+         "  --messages <n>  Messages per benchmark (default 200000).\n"
+         "  --rounds <n>    Image set loads of the assets benchmark (default 20).\n"
+         "  --port <name>   Part of the port names for the wire benchmark.\n"
+         "  --samples <n>   Round trips per driver of the wire benchmark\n"
+         "                  (default 1000).\n\n"
+         "Benchmarks:\n");
+  for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++)
+    printf("  %-8s %s\n", benchmarks[i].name, benchmarks[i].description);
+  printf("  %-8s %s\n", "assets", "Startup images, PNG decoding vs. raw images");
+  printf("  %-8s %s\n", "flood", "Loopback input flooded faster than it delivers");
+  printf("  %-8s %s\n", "wire", "Round trip per driver over a looped MIDI cable (needs --port,");
+  printf("  %-8s %s\n", "", "only runs when named)");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// main()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Benchmark entry point.
+///\param   [in] argc: Number of command line arguments passed to this program.
+///\param   [in] argv: Array of command line arguments.
+///\return  Returns zero if successfull or an error code on failure.
+///\remarks Runs without a display, Qt 5 uses the offscreen platform unless
+///         QT_QPA_PLATFORM says otherwise.
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+  #if QT_VERSION >= 0x050000
+  if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  #endif
+
+  // Init the global application object:
+  QApplication a(argc, argv);
+
+  // Use own settings so the configuration of the editor is left alone:
+  a.setApplicationName   (QString("DTBench"));
+  a.setOrganizationName  (QString("Rolf Meyerhoff"));
+  a.setOrganizationDomain(QString("dtedit.googlecode.com"));
+
+  // Parse the command line:
+  unsigned long messages = 200000;
+  int           rounds   = 20;
+  int           samples  = 1000;
+  QString       port;
+  QStringList   selected;
+  QStringList   args = a.arguments();
+  for (int i = 1; i < args.size(); i++)
+  {
+    if (args[i] == "--messages" && i + 1 < args.size())
+    {
+      bool ok;
+      messages = args[++i].toULong(&ok);
+      if (!ok || messages == 0)
+      {
+        fprintf(stderr, "Invalid value for --messages\n");
+        return 1;
+      }
+    }
+    else if (args[i] == "--rounds" && i + 1 < args.size())
+    {
+      rounds = args[++i].toInt();
+      if (rounds <= 0)
+      {
+        fprintf(stderr, "Invalid value for --rounds\n");
+        return 1;
+      }
+    }
+    else if (args[i] == "--samples" && i + 1 < args.size())
+    {
+      samples = args[++i].toInt();
+      if (samples <= 0)
+      {
+        fprintf(stderr, "Invalid value for --samples\n");
+        return 1;
+      }
+    }
+    else if (args[i] == "--port" && i + 1 < args.size())
+      port = args[++i];
+    else if (args[i].startsWith("-"))
+    {
+      usage();
+      return args[i] == "--help" ? 0 : 1;
+    }
+    else
+      selected.append(args[i]);
+  }
+
+  // The driver comparison needs hardware, so it only runs when named:
+  if (selected.contains("wire"))
+  {
+    if (port.isEmpty())
+    {
+      fprintf(stderr, "The wire benchmark needs --port\n");
+      return 1;
+    }
+    measureWire(port, samples);
+    selected.removeAll("wire");
+    if (selected.isEmpty())
+      return 0;
+    printf("\n");
+  }
+
+  // The flood checks the loopback driver and needs no windows:
+  if (selected.isEmpty() || selected.contains("flood"))
+  {
+    if (!measureFlood(messages))
+      return 1;
+    selected.removeAll("flood");
+    if (selected.isEmpty() && args.contains("flood"))
+      return 0;
+    printf("\n");
+  }
+
+  // Measure the images first, before the windows load them:
+  if (selected.isEmpty() || selected.contains("assets"))
+  {
+    measureAssets(rounds);
+    selected.removeAll("assets");
+    if (selected.isEmpty() && args.contains("assets"))
+      return 0;
+    printf("\n");
+  }
+
+  // Prepare the input data:
+  inputStream    = makeInputStream();
+  controlChanges = makeControlChanges();
+  for (unsigned char model = 0; model < 5; model++)
+    identityReplies.push_back(makeIdentityReply(model));
+
+  // Create the windows. They are not shown, like the editor while it
+  // receives a preset dump they only update their widget state. Without a
+  // first frame the editor needs its remaining sections built by hand:
+  DecodeWindow decoder;
+  EditorWindow editor;
+  editor.createDeferredSections();
+  editor.openNullOutput();
+
+  // Run the benchmarks:
+  printf("%-8s %12s %12s %12s\n", "name", "messages", "ns/msg", "allocs/msg");
+  for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++)
+  {
+    if (!selected.isEmpty() && !selected.contains(benchmarks[i].name))
+      continue;
+    Result result = measure(benchmarks[i], decoder, editor, messages);
+    printf("%-8s %12lu %12.1f %12.2f\n", benchmarks[i].name, result.messages,
+           (double)result.nanoSeconds / result.messages,
+           (double)result.allocations / result.messages);
+    fflush(stdout);
+  }
+
+  // Return to sender:
+  return 0;
+}
+
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,134 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    diagnosticsdialog.cpp
+///\ingroup dtedit
+///\brief   Diagnostics dialog class implementation.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include "diagnosticsdialog.h"
+#include "mainmidiwindow.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// DiagnosticsDialog::DiagnosticsDialog()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Initialization constructor of this window.
+///\param   [in] window: The window whose statistics are shown.
+///\param   [in] parent: Parent window for this window.
+////////////////////////////////////////////////////////////////////////////////
+DiagnosticsDialog::DiagnosticsDialog(MainMIDIWindow* window, QWidget *parent) :
+  QDialog(parent),
+  window(window)
+{
+  setWindowTitle(tr("MIDI Diagnostics"));
+
+  // Report view:
+  text = new QPlainTextEdit(this);
+  text->setReadOnly(true);
+  text->setLineWrapMode(QPlainTextEdit::NoWrap);
+  QFont font("Monospace");
+  font.setStyleHint(QFont::TypeWriter);
+  text->setFont(font);
+
+  // Buttons:
+  QPushButton* resetButton = new QPushButton(tr("Reset"), this);
+  QPushButton* copyButton  = new QPushButton(tr("Copy JSON"), this);
+  QPushButton* closeButton = new QPushButton(tr("Close"), this);
+  connect(resetButton, SIGNAL(clicked()), this, SLOT(reset()));
+  connect(copyButton,  SIGNAL(clicked()), this, SLOT(copyJSON()));
+  connect(closeButton, SIGNAL(clicked()), this, SLOT(close()));
+
+  // Layout:
+  QHBoxLayout* buttons = new QHBoxLayout();
+  buttons->addWidget(resetButton);
+  buttons->addWidget(copyButton);
+  buttons->addStretch();
+  buttons->addWidget(closeButton);
+  QVBoxLayout* layout = new QVBoxLayout(this);
+  layout->addWidget(text);
+  layout->addLayout(buttons);
+  resize(520, 560);
+
+  // Refresh timer:
+  connect(&timer, SIGNAL(timeout()), this, SLOT(refresh()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DiagnosticsDialog::showEvent()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Start refreshing when the dialog is shown.
+///\param   [in] e: Description of the event.
+////////////////////////////////////////////////////////////////////////////////
+void DiagnosticsDialog::showEvent(QShowEvent* e)
+{
+  refresh();
+  timer.start(500);
+  QDialog::showEvent(e);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DiagnosticsDialog::hideEvent()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Stop refreshing when the dialog is hidden.
+///\param   [in] e: Description of the event.
+////////////////////////////////////////////////////////////////////////////////
+void DiagnosticsDialog::hideEvent(QHideEvent* e)
+{
+  timer.stop();
+  QDialog::hideEvent(e);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DiagnosticsDialog::refresh()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Show the current numbers.
+////////////////////////////////////////////////////////////////////////////////
+void DiagnosticsDialog::refresh()
+{
+  // Keep the scroll position:
+  int position = text->verticalScrollBar()->value();
+  text->setPlainText(window->getStatistics());
+  text->verticalScrollBar()->setValue(position);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DiagnosticsDialog::reset()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the reset button.
+////////////////////////////////////////////////////////////////////////////////
+void DiagnosticsDialog::reset()
+{
+  window->resetStatistics();
+  refresh();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DiagnosticsDialog::copyJSON()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the copy button, puts the JSON report on the
+///         clipboard.
+////////////////////////////////////////////////////////////////////////////////
+void DiagnosticsDialog::copyJSON()
+{
+  QApplication::clipboard()->setText(window->getStatistics(true));
+}
+
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    diagnosticsdialog.h
+///\ingroup dtedit
+///\brief   Diagnostics dialog class definition.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef __DIAGNOSTICSDIALOG_H_INCLUDED__
+#define __DIAGNOSTICSDIALOG_H_INCLUDED__
+
+#include <QDialog>
+#include <QTimer>
+
+////////////////////////////////////////////////////////////////////////////////
+// Forwards:
+class MainMIDIWindow;
+class QPlainTextEdit;
+
+////////////////////////////////////////////////////////////////////////////////
+///\class DiagnosticsDialog diagnosticsdialog.h
+///\brief Diagnostics dialog class.
+/// Shows the live statistics of the MIDI engine of a window. The numbers are
+/// refreshed twice a second while the dialog is visible.
+////////////////////////////////////////////////////////////////////////////////
+class DiagnosticsDialog : public QDialog
+{
+  Q_OBJECT // Qt magic...
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  // DiagnosticsDialog::DiagnosticsDialog()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Initialization constructor of this window.
+  ///\param   [in] window: The window whose statistics are shown.
+  ///\param   [in] parent: Parent window for this window.
+  //////////////////////////////////////////////////////////////////////////////
+  DiagnosticsDialog(MainMIDIWindow* window, QWidget *parent = 0);
+
+protected:
+  //////////////////////////////////////////////////////////////////////////////
+  // DiagnosticsDialog::showEvent()
+  // DiagnosticsDialog::hideEvent()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Start and stop the refreshing with the visibility.
+  ///\param   [in] e: Description of the event.
+  //////////////////////////////////////////////////////////////////////////////
+  void showEvent(QShowEvent* e);
+  void hideEvent(QHideEvent* e);
+
+private slots:
+  //////////////////////////////////////////////////////////////////////////////
+  // DiagnosticsDialog::refresh()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Show the current numbers.
+  //////////////////////////////////////////////////////////////////////////////
+  void refresh();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // DiagnosticsDialog::reset()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the reset button.
+  //////////////////////////////////////////////////////////////////////////////
+  void reset();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // DiagnosticsDialog::copyJSON()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the copy button, puts the JSON report on the
+  ///         clipboard.
+  //////////////////////////////////////////////////////////////////////////////
+  void copyJSON();
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  MainMIDIWindow* window; ///> The window whose statistics are shown.
+  QPlainTextEdit* text;   ///> The report.
+  QTimer          timer;  ///> Refresh timer.
+};
+
+#endif // __DIAGNOSTICSDIALOG_H_INCLUDED__
+///////////////////////////////// End of File //////////////////////////////////
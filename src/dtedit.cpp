@@ -26,6 +26,96 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include "dtedit.h"
 
+////////////////////////////////////////////////////////////////////////////////
+// Display names, indexed by the AMP_*, CAB_*, MIC_* and REV_* defines:
+////////////////////////////////////////////////////////////////////////////////
+const char* const ampNames[AMP_COUNT] =
+{
+  "None",
+  "Blackface Double Normal",
+  "Blackface Double Vib",
+  "Hiway 100",
+  "Super O",
+  "Gibtone 185",
+  "Tweed B-Man Normal",
+  "Tweed B-Man Bright",
+  "Blackface 'Lux Normal",
+  "Blackface 'Lux Vib",
+  "Divide 9/15",
+  "Phd Motorway",
+  "Class A-15",
+  "Class A-30",
+  "Brit J-45 Normal",
+  "Brit J-45 Bright",
+  "Brit Plexi 100 Normal",
+  "Brit Plexi 100 Bright",
+  "Brit P-75 Normal",
+  "Brit P-75 Bright",
+  "Brit J-800",
+  "Bomber Uber",
+  "Treadplate",
+  "Angel F-Ball",
+  "Line 6 Elektrik",
+  "Flip Top (Bass)",
+  "Solo 100 Clean",
+  "Solo 100 Crunch",
+  "Solo 100 Overdrive",
+  "Line 6 Doom",
+  "Line 6 Epic"
+};
+
+const char* const cabNames[CAB_COUNT] =
+{
+  "None",
+  "2x12 Blackface Double",
+  "4x12 Hiway",
+  "1x(6x9) Super O",
+  "1x12 Gibtone F-Coil",
+  "4x10 Tweed B-Man",
+  "1x12 Blackface 'Lux",
+  "1x12 Brit 12-H",
+  "2x12 PhD Ported",
+  "1x12 Blue Bell",
+  "2x12 Silver Bell",
+  "4x12 Greenback 25",
+  "4x12 Blackback 30",
+  "4x12 Brit T-75",
+  "4x12 Uber",
+  "4x12 Tread V-30",
+  "4x12 XXL V-30",
+  "1x15 Flip Top (Bass)"
+};
+
+const char* const micNames[MIC_COUNT] =
+{
+  "None",
+  "57 Dynamic",
+  "57 Dynamic, Off Axis",
+  "409 Dynamic",
+  "421 Dynamic",
+  "4038 Ribbon",
+  "121 Ribbon",
+  "67 Condenser",
+  "87 Condenser"
+};
+
+const char* const reverbNames[REV_COUNT] =
+{
+  "None",
+  "Spring",
+  "'63 Spring",
+  "Plate",
+  "Room",
+  "Chamber",
+  "Hall",
+  "Cave",
+  "Ducking",
+  "Octo",
+  "Tile",
+  "Echo",
+  "Particle Verb"
+};
+
 // MIDI tools implementation:
 #include "RtMidi/RtMidi.cpp"
 
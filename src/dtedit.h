@@ -132,6 +132,7 @@
 #define AMP_SOLO_100_OVERDRIVE      28
 #define AMP_LINE6_DOOM              29
 #define AMP_LINE6_EPIC              30
+#define AMP_COUNT                   31
 
 // Cab models:
 #define CAB_NONE                  0
@@ -152,6 +153,7 @@
 #define CAB_4X12_TREAD_V_30       15
 #define CAB_4X12_XXL_V_30         16
 #define CAB_1X15_FLIP_TOP         17
+#define CAB_COUNT                 18
 
 // XLR microphone mode:
 #define MIC_NONE          0
@@ -163,6 +165,7 @@
 #define MIC_RIBBON_121    6
 #define MIC_CONDENSER_67  7
 #define MIC_CONDENSER_87  8
+#define MIC_COUNT         9
 
 // Direct voicing select:
 #define VOICING_A_I   0
@@ -194,6 +197,14 @@
 #define REV_TILE          10
 #define REV_ECHO          11
 #define REV_PARTICLE_VERB 12
+#define REV_COUNT         13
+
+// Display names of the amp models, cab models, mics and reverb types, indexed
+// by the defines above (see dtedit.cpp):
+extern const char* const ampNames[AMP_COUNT];
+extern const char* const cabNames[CAB_COUNT];
+extern const char* const micNames[MIC_COUNT];
+extern const char* const reverbNames[REV_COUNT];
 
 #endif // #ifndef __DTEDIT_H_INCLUDED__
 ///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,89 @@
+#-------------------------------------------------
+#
+# Editor sources shared by the application and the
+# tools that are built from them.
+#
+#-------------------------------------------------
+
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/mainwindow.cpp \
+    $$PWD/setupdialog.cpp \
+    $$PWD/aboutdialog.cpp \
+    $$PWD/dtedit.cpp \
+    $$PWD/mainmidiwindow.cpp \
+    $$PWD/midilog.cpp \
+    $$PWD/midistatistics.cpp \
+    $$PWD/diagnosticsdialog.cpp \
+    $$PWD/miditrace.cpp \
+    $$PWD/midimonitor.cpp \
+    $$PWD/startupprofile.cpp \
+    $$PWD/imageassets.cpp \
+    $$PWD/panelcanvas.cpp \
+    $$PWD/spriteatlas.cpp \
+    $$PWD/namelistmodel.cpp \
+    $$PWD/updatescheduler.cpp \
+    $$PWD/preset.cpp \
+    $$PWD/stageview.cpp \
+    $$PWD/edithistory.cpp
+
+HEADERS += $$PWD/mainwindow.h \
+    $$PWD/setupdialog.h \
+    $$PWD/aboutdialog.h \
+    $$PWD/dtedit.h \
+    $$PWD/mainmidiwindow.h \
+    $$PWD/midilog.h \
+    $$PWD/midistatistics.h \
+    $$PWD/diagnosticsdialog.h \
+    $$PWD/miditrace.h \
+    $$PWD/midimonitor.h \
+    $$PWD/traceevents.h \
+    $$PWD/startupprofile.h \
+    $$PWD/imageassets.h \
+    $$PWD/panelcanvas.h \
+    $$PWD/spriteatlas.h \
+    $$PWD/namelistmodel.h \
+    $$PWD/updatescheduler.h \
+    $$PWD/preset.h \
+    $$PWD/stageview.h \
+    $$PWD/edithistory.h \
+    $$PWD/qimagedial.h \
+    $$PWD/qimagetoggle.h \
+    $$PWD/qimageled.h \
+    $$PWD/qimagetoggle4.h \
+    $$PWD/qimagebutton.h \
+    $$PWD/qimagewidget.h
+
+include(RtMidi/rtmidi.pri)
+
+# Chrome trace-event spans, enable with "qmake CONFIG+=trace_events":
+trace_events {
+    DEFINES += __DTEDIT_TRACE_EVENTS__
+    SOURCES += $$PWD/traceevents.cpp
+}
+
+# Raw premultiplied images instead of PNG decoding at startup, build
+# assets/dtassets.pro first and enable with "qmake CONFIG+=raw_assets":
+raw_assets {
+    isEmpty(DTASSETS) {
+        DTASSETS = $$PWD/assets/dtassets
+        win*: DTASSETS = $$PWD/assets/release/dtassets.exe
+    }
+    !exists($$DTASSETS): error("raw_assets: $$DTASSETS not found, build assets/dtassets.pro first")
+    RAW_ASSETS_DIR = $$OUT_PWD/rawassets
+    !system($$DTASSETS $$RAW_ASSETS_DIR $$files($$PWD/images/*.png)) {
+        error("raw_assets: Converting the images failed")
+    }
+    RESOURCES += $$RAW_ASSETS_DIR/rawassets.qrc
+}
+
+linux* {
+    DEFINES += __LINUX_ALSA__
+}
+
+RESOURCES += \
+    $$PWD/dtedit.qrc
+
+FORMS += \
+    $$PWD/setupdialog.ui \
+    $$PWD/aboutdialog.ui
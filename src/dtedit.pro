@@ -4,52 +4,24 @@
 #
 #-------------------------------------------------
 
-QT += core gui xml
+QT += core gui xml network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 TARGET = dtedit
 TEMPLATE = app
 
-SOURCES += main.cpp\
-        mainwindow.cpp \
-    setupdialog.cpp \
-    aboutdialog.cpp \
-    dtedit.cpp \
-    mainmidiwindow.cpp
-
-HEADERS  += mainwindow.h \
-    setupdialog.h \
-    aboutdialog.h \
-    dtedit.h \
-    mainmidiwindow.h \
-    qimagedial.h \
-    qimagetoggle.h \
-    qimageled.h \
-    qimagetoggle4.h \
-    qimagebutton.h \
-    qimagewidget.h
+SOURCES += main.cpp \
+    singleinstance.cpp
+
+HEADERS += singleinstance.h
+
+include(dtedit.pri)
 
 win* {
-    DEFINES += __WINDOWS_MM__
-    LIBS += -lwinmm
     RC_FILE = dtedit.rc
 }
 
 linux* {
-    DEFINES += __LINUX_ALSA__
-    DEFINES += __LINUX_ALSASEQ__
-    DEFINES += AVOID_TIMESTAMPING
-    CONFIG += link_pkgconfig \
-        x11
-    PKGCONFIG += alsa
+    CONFIG += x11
 }
-
-debug:DEFINES += __RTMIDI_DEBUG__
-
-RESOURCES += \
-    dtedit.qrc
-
-FORMS += \
-    setupdialog.ui \
-    aboutdialog.ui
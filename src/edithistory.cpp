@@ -0,0 +1,224 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    edithistory.cpp
+///\ingroup dtedit
+///\brief   Edit history class implementation.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include "edithistory.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// EditHistory::EditHistory()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Default constructor of this class.
+///\remarks The history starts empty.
+////////////////////////////////////////////////////////////////////////////////
+EditHistory::EditHistory() :
+  grouping(false),
+  groupStarted(false)
+{
+  clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// EditHistory::clear()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Forget all changes.
+////////////////////////////////////////////////////////////////////////////////
+void EditHistory::clear()
+{
+  first    = 0;
+  count    = 0;
+  position = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// EditHistory::record()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Add a change.
+///\param   [in] controlNumber: Controller number of the parameter.
+///\param   [in] oldValue:      Value before the change.
+///\param   [in] newValue:      Value after the change.
+///\param   [in] open:          Merge the following changes of this
+///                             parameter into this entry until close()?
+///\param   [in] defaults:      Did the change load the defaults of the new
+///                             value, like an amp selected with them?
+///\remarks Drops the changes that could be redone.
+////////////////////////////////////////////////////////////////////////////////
+void EditHistory::record(int controlNumber, int oldValue, int newValue, bool open, bool defaults)
+{
+  // Still dragging the same dial?
+  if (position > 0 && position == count)
+  {
+    Entry& last = entry(position - 1);
+    if ((last.flags & OPEN) && last.controlNumber == controlNumber)
+    {
+      last.newValue = static_cast<quint8>(newValue);
+      return;
+    }
+  }
+  close();
+
+  // Drop the redo steps and make room:
+  count = position;
+  if (count == EDITHISTORY_SIZE)
+  {
+    first = (first + 1) % EDITHISTORY_SIZE;
+    count--;
+    position--;
+    entry(0).flags &= ~JOINED;
+  }
+
+  // Add the entry:
+  Entry& e = entry(count);
+  e.controlNumber = static_cast<quint8>(controlNumber);
+  e.oldValue      = static_cast<quint8>(oldValue);
+  e.newValue      = static_cast<quint8>(newValue);
+  e.flags         = open ? OPEN : 0;
+  if (defaults)
+    e.flags |= DEFAULTS;
+  if (grouping && groupStarted)
+    e.flags |= JOINED;
+  groupStarted = grouping;
+  count++;
+  position++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// EditHistory::close()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   End the merging of an open entry.
+///\remarks Called when a dial is released.
+////////////////////////////////////////////////////////////////////////////////
+void EditHistory::close()
+{
+  if (position > 0)
+    entry(position - 1).flags &= ~OPEN;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// EditHistory::beginGroup()
+// EditHistory::endGroup()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Record the following changes as a single step.
+////////////////////////////////////////////////////////////////////////////////
+void EditHistory::beginGroup()
+{
+  close();
+  grouping     = true;
+  groupStarted = false;
+}
+
+void EditHistory::endGroup()
+{
+  grouping     = false;
+  groupStarted = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// EditHistory::canUndo()
+// EditHistory::canRedo()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Is there a step to undo or redo?
+////////////////////////////////////////////////////////////////////////////////
+bool EditHistory::canUndo() const
+{
+  return position > 0;
+}
+
+bool EditHistory::canRedo() const
+{
+  return position < count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// EditHistory::undo()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Step back.
+///\param   [out] values:   Receives the values to send.
+///\param   [out] defaults: Receives the values that load their defaults.
+///\return  Returns false if there is nothing to undo.
+///\remarks Only the parameters of the step are set in values.
+////////////////////////////////////////////////////////////////////////////////
+bool EditHistory::undo(Preset& values, Preset& defaults)
+{
+  if (!canUndo())
+    return false;
+  close();
+
+  // Newest first, so the oldest value of a parameter wins:
+  bool joined;
+  do
+  {
+    position--;
+    const Entry& e = entry(position);
+    values.setValue(e.controlNumber, e.oldValue);
+    if (e.flags & DEFAULTS)
+      defaults.setValue(e.controlNumber, e.oldValue);
+    joined = (e.flags & JOINED) != 0;
+  } while (joined && position > 0);
+
+  // Return to sender:
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// EditHistory::redo()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Step forward again.
+///\param   [out] values:   Receives the values to send.
+///\param   [out] defaults: Receives the values that load their defaults.
+///\return  Returns false if there is nothing to redo.
+///\remarks Only the parameters of the step are set in values.
+////////////////////////////////////////////////////////////////////////////////
+bool EditHistory::redo(Preset& values, Preset& defaults)
+{
+  if (!canRedo())
+    return false;
+
+  // Oldest first, so the newest value of a parameter wins:
+  do
+  {
+    const Entry& e = entry(position);
+    values.setValue(e.controlNumber, e.newValue);
+    if (e.flags & DEFAULTS)
+      defaults.setValue(e.controlNumber, e.newValue);
+    position++;
+  } while (position < count && (entry(position).flags & JOINED));
+
+  // Return to sender:
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// EditHistory::entry()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Access an entry.
+///\param   [in] index: Index counted from the oldest entry.
+///\return  The entry.
+////////////////////////////////////////////////////////////////////////////////
+EditHistory::Entry& EditHistory::entry(int index)
+{
+  return entries[(first + index) % EDITHISTORY_SIZE];
+}
+
+///////////////////////////////// End of File //////////////////////////////////
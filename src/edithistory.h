@@ -0,0 +1,168 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    edithistory.h
+///\ingroup dtedit
+///\brief   Edit history class definition.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef __EDITHISTORY_H_INCLUDED__
+#define __EDITHISTORY_H_INCLUDED__
+
+#include <QtCore>
+#include "preset.h"
+
+// Number of changes the history keeps, the oldest ones are dropped:
+#define EDITHISTORY_SIZE 1024
+
+////////////////////////////////////////////////////////////////////////////////
+///\class EditHistory edithistory.h
+///\brief Undo and redo journal of the parameter changes.
+/// Each change is kept as controller number, old and new value in a fixed
+/// ring of 4 byte entries, so recording a change never allocates. Changes of
+/// one dial drag are merged into a single entry and a group, like a loaded
+/// preset, is undone as one step.
+////////////////////////////////////////////////////////////////////////////////
+class EditHistory
+{
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  // EditHistory::EditHistory()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Default constructor of this class.
+  ///\remarks The history starts empty.
+  //////////////////////////////////////////////////////////////////////////////
+  EditHistory();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // EditHistory::clear()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Forget all changes.
+  //////////////////////////////////////////////////////////////////////////////
+  void clear();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // EditHistory::record()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Add a change.
+  ///\param   [in] controlNumber: Controller number of the parameter.
+  ///\param   [in] oldValue:      Value before the change.
+  ///\param   [in] newValue:      Value after the change.
+  ///\param   [in] open:          Merge the following changes of this
+  ///                             parameter into this entry until close()?
+  ///\param   [in] defaults:      Did the change load the defaults of the
+  ///                             new value, like an amp selected with them?
+  ///\remarks Drops the changes that could be redone.
+  //////////////////////////////////////////////////////////////////////////////
+  void record(int controlNumber, int oldValue, int newValue, bool open = false, bool defaults = false);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // EditHistory::close()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   End the merging of an open entry.
+  ///\remarks Called when a dial is released.
+  //////////////////////////////////////////////////////////////////////////////
+  void close();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // EditHistory::beginGroup()
+  // EditHistory::endGroup()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Record the following changes as a single step.
+  //////////////////////////////////////////////////////////////////////////////
+  void beginGroup();
+  void endGroup();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // EditHistory::canUndo()
+  // EditHistory::canRedo()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Is there a step to undo or redo?
+  //////////////////////////////////////////////////////////////////////////////
+  bool canUndo() const;
+  bool canRedo() const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // EditHistory::undo()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Step back.
+  ///\param   [out] values:   Receives the values to send.
+  ///\param   [out] defaults: Receives the values that load their defaults.
+  ///\return  Returns false if there is nothing to undo.
+  ///\remarks Only the parameters of the step are set in values.
+  //////////////////////////////////////////////////////////////////////////////
+  bool undo(Preset& values, Preset& defaults);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // EditHistory::redo()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Step forward again.
+  ///\param   [out] values:   Receives the values to send.
+  ///\param   [out] defaults: Receives the values that load their defaults.
+  ///\return  Returns false if there is nothing to redo.
+  ///\remarks Only the parameters of the step are set in values.
+  //////////////////////////////////////////////////////////////////////////////
+  bool redo(Preset& values, Preset& defaults);
+
+private:
+
+  //////////////////////////////////////////////////////////////////////////////
+  ///\struct Entry
+  ///\brief  A recorded change.
+  //////////////////////////////////////////////////////////////////////////////
+  struct Entry
+  {
+    quint8 controlNumber; ///> Controller number of the parameter.
+    quint8 oldValue;      ///> Value before the change.
+    quint8 newValue;      ///> Value after the change.
+    quint8 flags;         ///> Combination of the flags below.
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Entry flags:
+  enum
+  {
+    OPEN     = 0x01, ///> Following changes of the parameter are merged.
+    JOINED   = 0x02, ///> Undone together with the entry before it.
+    DEFAULTS = 0x04  ///> The values loaded their defaults.
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // EditHistory::entry()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Access an entry.
+  ///\param   [in] index: Index counted from the oldest entry.
+  ///\return  The entry.
+  //////////////////////////////////////////////////////////////////////////////
+  Entry& entry(int index);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  Entry entries[EDITHISTORY_SIZE]; ///> The ring.
+  int   first;                     ///> Ring index of the oldest entry.
+  int   count;                     ///> Number of entries.
+  int   position;                  ///> Number of entries that are done.
+  bool  grouping;                  ///> Is a group being recorded?
+  bool  groupStarted;              ///> Has the group an entry yet?
+};
+
+#endif // #ifndef __EDITHISTORY_H_INCLUDED__
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# DT amp emulator for testing without hardware.
+#
+#-------------------------------------------------
+
+QT += core
+QT -= gui
+
+TARGET = dt-emulator
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+INCLUDEPATH += ..
+
+SOURCES += main.cpp \
+    dtemulator.cpp \
+    ../RtMidi/RtMidi.cpp
+
+HEADERS += dtemulator.h
+
+include(../RtMidi/rtmidi.pri)
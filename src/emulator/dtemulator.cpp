@@ -0,0 +1,439 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    dtemulator.cpp
+///\ingroup dtedit
+///\brief   DT amp emulator class implementation.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include "dtemulator.h"
+#include "dtedit.h"
+#include <cstdio>
+#include <cstring>
+
+// The CC that requests a parameter group:
+#define CC_QUERY 83
+
+// Parameter groups sent in reply to CC 83/x, see the comments in dtedit.h:
+static const unsigned char group0[]  = { CC_TREBLE_A, CC_PRESENCE_A, CC_CLASS_A, CC_XTODE_A, CC_BASS_B, CC_TREBLE_B, CC_PRESENCE_B, CC_VOLUME_B, CC_CLASS_B, CC_XTODE_B, CC_VOICE_A, CC_VOICE_B };
+static const unsigned char group17[] = { CC_TREBLE_A, CC_PRESENCE_A, CC_CLASS_A, CC_XTODE_A, CC_VOICE_A };
+static const unsigned char group18[] = { CC_BASS_B, CC_TREBLE_B, CC_PRESENCE_B, CC_VOLUME_B, CC_CLASS_B, CC_XTODE_B, CC_VOICE_B };
+static const unsigned char group19[] = { CC_TREBLE_A, CC_PRESENCE_A, CC_CLASS_A, CC_XTODE_A, CC_BASS_B, CC_TREBLE_B, CC_PRESENCE_B, CC_VOLUME_B, CC_CLASS_B, CC_XTODE_B, CC_VOICE_A, CC_VOICE_B };
+static const unsigned char group29[] = { CC_GAIN_A, CC_BASS_A, CC_MIDDLE_A, CC_TREBLE_A, CC_VOLUME_A, CC_REV_MIX_A, CC_PRESENCE_A, CC_REV_TYPE_A, CC_CLASS_A, CC_BOOST_A, CC_XTODE_A, CC_TOPOL_A, CC_CAP_TYPE_A };
+static const unsigned char group30[] = { CC_AMP_A, CC_CAB_A, CC_PI_VOLTAGE_A, CC_XLR_MIC, CC_GAIN_B, CC_BASS_B, CC_MIDDLE_B, CC_TREBLE_B, CC_PRESENCE_B, CC_VOLUME_B, CC_REV_MIX_B, CC_REV_TYPE_B, CC_UNKNOWN_2, CC_TOPOL_B };
+static const unsigned char group31[] = { CC_PI_VOLTAGE_B, CC_CAP_TYPE_B, CC_CLASS_B, CC_XTODE_B, CC_BOOST_B };
+static const unsigned char group32[] = { CC_XLR_MIC, CC_AMP_B, CC_VOLUME_B, CC_UNKNOWN_3, CC_CAB_B };
+static const unsigned char group33[] = { CC_GAIN_B, CC_BASS_B, CC_MIDDLE_B, CC_TREBLE_B, CC_PRESENCE_B, CC_REV_MIX_B, CC_REV_TYPE_B, CC_TOPOL_B };
+static const unsigned char group34[] = { CC_PI_VOLTAGE_B, CC_CAP_TYPE_B, CC_UNKNOWN_3, CC_CLASS_B, CC_XTODE_B, CC_BOOST_B };
+static const unsigned char group35[] = { CC_AMP_A, CC_GAIN_A, CC_BASS_A, CC_MIDDLE_A, CC_TREBLE_A, CC_VOLUME_A, CC_REV_MIX_A, CC_PRESENCE_A, CC_REV_TYPE_A, CC_CAB_A, CC_BOOST_A, CC_TOPOL_A, CC_PI_VOLTAGE_A, CC_CAP_TYPE_A, CC_XLR_MIC, CC_AMP_B, CC_UNKNOWN_2, CC_CAB_B };
+
+static const struct
+{
+  unsigned char        query;    // Value of the CC 83 query.
+  const unsigned char* controls; // Controls sent in reply.
+  unsigned int         count;    // Number of controls.
+} parameterGroups[] =
+{
+  {  0, group0,  sizeof(group0)  },
+  { 17, group17, sizeof(group17) },
+  { 18, group18, sizeof(group18) },
+  { 19, group19, sizeof(group19) },
+  { 29, group29, sizeof(group29) },
+  { 30, group30, sizeof(group30) },
+  { 31, group31, sizeof(group31) },
+  { 32, group32, sizeof(group32) },
+  { 33, group33, sizeof(group33) },
+  { 34, group34, sizeof(group34) },
+  { 35, group35, sizeof(group35) }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// DTEmulator::DTEmulator()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Initialization constructor of this class.
+///\param   [in] model:    Model number reported in the identity reply
+///                        (0 = DT50 1x12 Combo ... 4 = DT25 Head).
+///\param   [in] firmware: Firmware version reported in the identity
+///                        reply, three digits like "104" for v1.04.
+////////////////////////////////////////////////////////////////////////////////
+DTEmulator::DTEmulator(int model, const QString& firmware) :
+  QThread(),
+  model(model),
+  firmware(firmware),
+  latency(0),
+  dropLimit(0),
+  randomState(1),
+  verbose(false),
+  midiIn(0),
+  midiOut(0),
+  stopRequested(false),
+  received(0),
+  sent(0),
+  dropped(0)
+{
+  // All controls start at zero:
+  memset(values, 0, sizeof(values));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DTEmulator::~DTEmulator()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Destructor of this class.
+///\remarks Closes the ports if they are still open.
+////////////////////////////////////////////////////////////////////////////////
+DTEmulator::~DTEmulator()
+{
+  close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DTEmulator::setLatency()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Set the response latency.
+///\param   [in] milliSeconds: Delay between receiving a message and
+///                            sending the reply.
+////////////////////////////////////////////////////////////////////////////////
+void DTEmulator::setLatency(double milliSeconds)
+{
+  latency = milliSeconds > 0.0 ? (unsigned long long)(milliSeconds * 1000000.0) : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DTEmulator::setDropRate()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Set the rate of replies that get lost.
+///\param   [in] percent: Probability for each reply to be dropped (0-100).
+///\param   [in] seed:    Seed of the random numbers, the same seed drops
+///                       the same replies for the same input.
+////////////////////////////////////////////////////////////////////////////////
+void DTEmulator::setDropRate(double percent, unsigned int seed)
+{
+  // Map the rate to the 32 bit range of the random generator:
+  if (percent <= 0.0)
+    dropLimit = 0;
+  else if (percent >= 100.0)
+    dropLimit = 0xFFFFFFFF;
+  else
+    dropLimit = (unsigned int)(percent / 100.0 * 4294967295.0);
+
+  // Zero is a fixed point of the generator:
+  randomState = seed != 0 ? seed : 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DTEmulator::setVerbose()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Print all MIDI traffic to stdout?
+///\param   [in] verbose: Print the traffic?
+////////////////////////////////////////////////////////////////////////////////
+void DTEmulator::setVerbose(bool verbose)
+{
+  this->verbose = verbose;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DTEmulator::open()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Create the virtual MIDI ports and start answering.
+///\param   [in] api:      The MIDI API to use. It must support virtual
+///                        ports (ALSA sequencer, JACK or CoreMIDI).
+///\param   [in] portName: Name of the virtual ports.
+///\return  Returns true if successfull or false otherwise.
+////////////////////////////////////////////////////////////////////////////////
+bool DTEmulator::open(RtMidi::Api api, const QString& portName)
+{
+  // Close old ports:
+  close();
+
+  try
+  {
+    // Create the ports. The output comes first so no reply can get lost:
+    std::string name = portName.toLocal8Bit().constData();
+    midiOut = new RtMidiOut(api, name);
+    midiOut->openVirtualPort(name);
+    midiIn = new RtMidiIn(api, name);
+    midiIn->ignoreTypes(false, true, true);
+    midiIn->setTimedCallback(onMIDIMessageProxy, this);
+
+    // Start the sender thread before the first message can arrive:
+    stopRequested = false;
+    start();
+    midiIn->openVirtualPort(name);
+  }
+  catch (const RtError& err)
+  {
+    fprintf(stderr, "%s\n", err.getMessage().c_str());
+    close();
+    return false;
+  }
+
+  // Return success:
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DTEmulator::close()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Stop answering and close the virtual ports.
+///\remarks Replies that are still pending are discarded.
+////////////////////////////////////////////////////////////////////////////////
+void DTEmulator::close()
+{
+  // Stop receiving first so nothing new is queued:
+  delete midiIn;
+  midiIn = 0;
+
+  // Stop the sender thread:
+  mutex.lock();
+  stopRequested = true;
+  pending.clear();
+  wakeUp.wakeAll();
+  mutex.unlock();
+  wait();
+
+  // Close the output:
+  delete midiOut;
+  midiOut = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DTEmulator::getStatistics()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get a short summary of the traffic so far.
+///\return  Numbers of received, sent and dropped messages.
+////////////////////////////////////////////////////////////////////////////////
+QString DTEmulator::getStatistics()
+{
+  QMutexLocker locker(&mutex);
+  return QString("%1 received, %2 sent, %3 dropped").arg(received).arg(sent).arg(dropped);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DTEmulator::run()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Thread function that sends the pending replies when due.
+////////////////////////////////////////////////////////////////////////////////
+void DTEmulator::run()
+{
+  QMutexLocker locker(&mutex);
+  while (!stopRequested)
+  {
+    // Wait for work:
+    if (pending.isEmpty())
+    {
+      wakeUp.wait(&mutex);
+      continue;
+    }
+
+    // Sleep until the next reply is due. All replies have the same latency so
+    // later ones can't overtake it:
+    unsigned long long now = RtMidi::getMonotonicTime();
+    if (pending.head().dueTime > now)
+    {
+      unsigned long delay = (unsigned long)((pending.head().dueTime - now) / 1000);
+      locker.unlock();
+      usleep(delay > 0 ? delay : 1);
+      locker.relock();
+      continue;
+    }
+
+    // Send it:
+    PendingMessage message = pending.dequeue();
+    locker.unlock();
+    print("->", message.bytes);
+    midiOut->sendMessage(&message.bytes);
+    locker.relock();
+    sent++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DTEmulator::onMIDIMessage()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handle an incoming MIDI message.
+///\param   [in] timeStamp: Absolute arrival time in nanoseconds.
+///\param   [in] message:   The raw MIDI message as byte buffer.
+///\remarks This is called from the MIDI input thread.
+////////////////////////////////////////////////////////////////////////////////
+void DTEmulator::onMIDIMessage(unsigned long long timeStamp, const std::vector<unsigned char>& message)
+{
+  // Count and log:
+  mutex.lock();
+  received++;
+  mutex.unlock();
+  print("<-", message);
+
+  // Dispatch:
+  if (message.size() == 3 && (message[0] & 0xF0) == 0xB0)
+    controlChangeReceived(timeStamp, message[0] & 0x0F, message[1], message[2]);
+  else if (message.size() > 0 && message[0] == 0xF0)
+    sysExReceived(timeStamp, message);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DTEmulator::controlChangeReceived()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Reflect a control change and answer parameter queries.
+///\param   [in] timeStamp:     Absolute arrival time in nanoseconds.
+///\param   [in] channel:       MIDI channel of this message.
+///\param   [in] controlNumber: Controller number.
+///\param   [in] value:         Control value.
+////////////////////////////////////////////////////////////////////////////////
+void DTEmulator::controlChangeReceived(unsigned long long timeStamp, unsigned char channel, unsigned char controlNumber, unsigned char value)
+{
+  // Like the amp, reflect everything we get:
+  std::vector<unsigned char> buff(3);
+  buff[0] = 0xB0 | channel;
+  buff[1] = controlNumber;
+  buff[2] = value;
+  reply(timeStamp, buff);
+
+  // Are we ment?
+  if (channel != DT_MIDI_CHANNEL)
+    return;
+
+  // Parameter query?
+  if (controlNumber == CC_QUERY)
+  {
+    for (unsigned int i = 0; i < sizeof(parameterGroups) / sizeof(parameterGroups[0]); i++)
+    {
+      if (parameterGroups[i].query != value)
+        continue;
+      for (unsigned int j = 0; j < parameterGroups[i].count; j++)
+      {
+        buff[1] = parameterGroups[i].controls[j];
+        buff[2] = values[buff[1]];
+        reply(timeStamp, buff);
+      }
+    }
+    return;
+  }
+
+  // The editor's guard CCs are no parameters:
+  if (controlNumber == 126 || controlNumber == 127)
+    return;
+
+  // Store the new value:
+  values[controlNumber] = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DTEmulator::sysExReceived()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Answer the universal identity request.
+///\param   [in] timeStamp: Absolute arrival time in nanoseconds.
+///\param   [in] buff:      The message buffer.
+////////////////////////////////////////////////////////////////////////////////
+void DTEmulator::sysExReceived(unsigned long long timeStamp, const std::vector<unsigned char>& buff)
+{
+  // Identity request?
+  if (buff.size() != 6 || buff[1] != 0x7E || buff[3] != 0x06 || buff[4] != 0x01 || buff[5] != 0xF7)
+    return;
+
+  // Build the identity reply (Line 6, DT family, model and firmware version):
+  std::vector<unsigned char> reply(17);
+  reply[0]  = 0xF0;
+  reply[1]  = 0x7E;
+  reply[2]  = 0x7F;
+  reply[3]  = 0x06;
+  reply[4]  = 0x02;
+  reply[5]  = 0x00;
+  reply[6]  = 0x01;
+  reply[7]  = 0x0C;
+  reply[8]  = 0x15;
+  reply[9]  = 0x00;
+  reply[10] = model & 0x7F;
+  reply[11] = 0x00;
+  reply[12] = ' ';
+  reply[13] = firmware.length() > 0 ? firmware.at(0).toLatin1() : '1';
+  reply[14] = firmware.length() > 1 ? firmware.at(1).toLatin1() : '0';
+  reply[15] = firmware.length() > 2 ? firmware.at(2).toLatin1() : '0';
+  reply[16] = 0xF7;
+  this->reply(timeStamp, reply);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DTEmulator::reply()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Queue a reply for sending after the configured latency.
+///\param   [in] timeStamp: Arrival time of the message this answers.
+///\param   [in] message:   The reply.
+///\remarks The reply may be dropped according to the drop rate.
+////////////////////////////////////////////////////////////////////////////////
+void DTEmulator::reply(unsigned long long timeStamp, const std::vector<unsigned char>& message)
+{
+  // Roll the dice (xorshift, so runs are reproducible on every platform):
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  bool drop = dropLimit > 0 && randomState <= dropLimit;
+
+  QMutexLocker locker(&mutex);
+  if (drop)
+  {
+    dropped++;
+    return;
+  }
+
+  // Queue it:
+  PendingMessage pendingMessage;
+  pendingMessage.dueTime = timeStamp + latency;
+  pendingMessage.bytes   = message;
+  pending.enqueue(pendingMessage);
+  wakeUp.wakeAll();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DTEmulator::print()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Print a message to stdout if verbose output is enabled.
+///\param   [in] prefix:  Direction marker.
+///\param   [in] message: The raw MIDI message as byte buffer.
+////////////////////////////////////////////////////////////////////////////////
+void DTEmulator::print(const char* prefix, const std::vector<unsigned char>& message)
+{
+  if (!verbose)
+    return;
+
+  // Build the whole line first so the two threads don't mix their output:
+  QString line = QString("%1 %2 ").arg(RtMidi::getMonotonicTime() / 1000).arg(prefix);
+  for (unsigned int i = 0; i < message.size(); i++)
+    line += QString(" %1").arg(message[i], 2, 16, QChar('0')).toUpper();
+  printf("%s\n", line.toLatin1().constData());
+  fflush(stdout);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DTEmulator::onMIDIMessageProxy()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Callback for incoming MIDI messages.
+///\param   [in] timeStamp: Absolute arrival time in nanoseconds.
+///\param   [in] deltaTime: Seconds since the previous message.
+///\param   [in] message:   The raw MIDI message as byte buffer.
+///\param   [in] userData:  Pointer to the emulator.
+////////////////////////////////////////////////////////////////////////////////
+void DTEmulator::onMIDIMessageProxy(unsigned long long timeStamp, double /* deltaTime */, std::vector<unsigned char>* message, void* userData)
+{
+  // Delegate to the class function:
+  static_cast<DTEmulator*>(userData)->onMIDIMessage(timeStamp, *message);
+}
+
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,221 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    dtemulator.h
+///\ingroup dtedit
+///\brief   DT amp emulator class definition.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef __DTEMULATOR_H_INCLUDED__
+#define __DTEMULATOR_H_INCLUDED__
+
+#include <QtCore>
+#include "RtMidi/RtMidi.h"
+
+////////////////////////////////////////////////////////////////////////////////
+///\class DTEmulator dtemulator.h
+///\brief Software imitation of a DT amp on virtual MIDI ports.
+/// The emulator behaves like the amp as far as the editor can tell: It
+/// reflects every control change it receives, answers the universal identity
+/// request and answers the CC 83 parameter queries with the parameter groups
+/// documented in dtedit.h. All replies can be delayed by a fixed latency and
+/// dropped at a given rate to reproduce bad connections.
+/// The replies are sent by the thread of this class so the MIDI input thread
+/// is never blocked by the simulated latency.
+////////////////////////////////////////////////////////////////////////////////
+class DTEmulator :
+  public QThread
+{
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  // DTEmulator::DTEmulator()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Initialization constructor of this class.
+  ///\param   [in] model:    Model number reported in the identity reply
+  ///                        (0 = DT50 1x12 Combo ... 4 = DT25 Head).
+  ///\param   [in] firmware: Firmware version reported in the identity
+  ///                        reply, three digits like "104" for v1.04.
+  //////////////////////////////////////////////////////////////////////////////
+  DTEmulator(int model = 0, const QString& firmware = "104");
+
+  //////////////////////////////////////////////////////////////////////////////
+  // DTEmulator::~DTEmulator()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Destructor of this class.
+  ///\remarks Closes the ports if they are still open.
+  //////////////////////////////////////////////////////////////////////////////
+  ~DTEmulator();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // DTEmulator::setLatency()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Set the response latency.
+  ///\param   [in] milliSeconds: Delay between receiving a message and
+  ///                            sending the reply.
+  //////////////////////////////////////////////////////////////////////////////
+  void setLatency(double milliSeconds);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // DTEmulator::setDropRate()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Set the rate of replies that get lost.
+  ///\param   [in] percent: Probability for each reply to be dropped (0-100).
+  ///\param   [in] seed:    Seed of the random numbers, the same seed drops
+  ///                       the same replies for the same input.
+  //////////////////////////////////////////////////////////////////////////////
+  void setDropRate(double percent, unsigned int seed = 1);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // DTEmulator::setVerbose()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Print all MIDI traffic to stdout?
+  ///\param   [in] verbose: Print the traffic?
+  //////////////////////////////////////////////////////////////////////////////
+  void setVerbose(bool verbose);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // DTEmulator::open()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Create the virtual MIDI ports and start answering.
+  ///\param   [in] api:      The MIDI API to use. It must support virtual
+  ///                        ports (ALSA sequencer, JACK or CoreMIDI).
+  ///\param   [in] portName: Name of the virtual ports.
+  ///\return  Returns true if successfull or false otherwise.
+  //////////////////////////////////////////////////////////////////////////////
+  bool open(RtMidi::Api api, const QString& portName);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // DTEmulator::close()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Stop answering and close the virtual ports.
+  ///\remarks Replies that are still pending are discarded.
+  //////////////////////////////////////////////////////////////////////////////
+  void close();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // DTEmulator::getStatistics()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get a short summary of the traffic so far.
+  ///\return  Numbers of received, sent and dropped messages.
+  //////////////////////////////////////////////////////////////////////////////
+  QString getStatistics();
+
+protected:
+  //////////////////////////////////////////////////////////////////////////////
+  // DTEmulator::run()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Thread function that sends the pending replies when due.
+  //////////////////////////////////////////////////////////////////////////////
+  virtual void run();
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  ///\struct PendingMessage
+  ///\brief  A reply waiting for its send time.
+  //////////////////////////////////////////////////////////////////////////////
+  struct PendingMessage
+  {
+    unsigned long long         dueTime; ///> Monotonic send time in nanoseconds.
+    std::vector<unsigned char> bytes;   ///> The MIDI message.
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // DTEmulator::onMIDIMessage()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handle an incoming MIDI message.
+  ///\param   [in] timeStamp: Absolute arrival time in nanoseconds.
+  ///\param   [in] message:   The raw MIDI message as byte buffer.
+  ///\remarks This is called from the MIDI input thread.
+  //////////////////////////////////////////////////////////////////////////////
+  void onMIDIMessage(unsigned long long timeStamp, const std::vector<unsigned char>& message);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // DTEmulator::controlChangeReceived()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Reflect a control change and answer parameter queries.
+  ///\param   [in] timeStamp:     Absolute arrival time in nanoseconds.
+  ///\param   [in] channel:       MIDI channel of this message.
+  ///\param   [in] controlNumber: Controller number.
+  ///\param   [in] value:         Control value.
+  //////////////////////////////////////////////////////////////////////////////
+  void controlChangeReceived(unsigned long long timeStamp, unsigned char channel, unsigned char controlNumber, unsigned char value);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // DTEmulator::sysExReceived()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Answer the universal identity request.
+  ///\param   [in] timeStamp: Absolute arrival time in nanoseconds.
+  ///\param   [in] buff:      The message buffer.
+  //////////////////////////////////////////////////////////////////////////////
+  void sysExReceived(unsigned long long timeStamp, const std::vector<unsigned char>& buff);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // DTEmulator::reply()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Queue a reply for sending after the configured latency.
+  ///\param   [in] timeStamp: Arrival time of the message this answers.
+  ///\param   [in] message:   The reply.
+  ///\remarks The reply may be dropped according to the drop rate.
+  //////////////////////////////////////////////////////////////////////////////
+  void reply(unsigned long long timeStamp, const std::vector<unsigned char>& message);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // DTEmulator::print()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Print a message to stdout if verbose output is enabled.
+  ///\param   [in] prefix:  Direction marker.
+  ///\param   [in] message: The raw MIDI message as byte buffer.
+  //////////////////////////////////////////////////////////////////////////////
+  void print(const char* prefix, const std::vector<unsigned char>& message);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // DTEmulator::onMIDIMessageProxy()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Callback for incoming MIDI messages.
+  ///\param   [in] timeStamp: Absolute arrival time in nanoseconds.
+  ///\param   [in] deltaTime: Seconds since the previous message.
+  ///\param   [in] message:   The raw MIDI message as byte buffer.
+  ///\param   [in] userData:  Pointer to the emulator.
+  //////////////////////////////////////////////////////////////////////////////
+  static void onMIDIMessageProxy(unsigned long long timeStamp, double deltaTime, std::vector<unsigned char>* message, void* userData);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  int                     model;         ///> Reported model number.
+  QString                 firmware;      ///> Reported firmware version digits.
+  unsigned long long      latency;       ///> Response latency in nanoseconds.
+  unsigned int            dropLimit;     ///> Random numbers below this drop a reply.
+  unsigned int            randomState;   ///> State of the drop random generator.
+  bool                    verbose;       ///> Print the traffic?
+  unsigned char           values[128];   ///> Current value of each controller.
+  RtMidiIn*               midiIn;        ///> The virtual input (0 if closed).
+  RtMidiOut*              midiOut;       ///> The virtual output (0 if closed).
+  QMutex                  mutex;         ///> Guards the members below.
+  QWaitCondition          wakeUp;        ///> Signals new pending replies.
+  QQueue<PendingMessage>  pending;       ///> Replies waiting to be sent.
+  bool                    stopRequested; ///> Ask the thread to stop?
+  unsigned long           received;      ///> Number of received messages.
+  unsigned long           sent;          ///> Number of sent replies.
+  unsigned long           dropped;       ///> Number of dropped replies.
+};
+
+#endif // #ifndef __DTEMULATOR_H_INCLUDED__
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,166 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    main.cpp
+///\ingroup dtedit
+///\brief   DT amp emulator entry point.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include <QtCore>
+#include <csignal>
+#include <cstdio>
+#include "dtemulator.h"
+
+// Set by the signal handler to end the program:
+static volatile sig_atomic_t quitRequested = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+// onSignal()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for SIGINT and SIGTERM.
+///\param   [in] signal: The signal number.
+////////////////////////////////////////////////////////////////////////////////
+static void onSignal(int /* signal */)
+{
+  quitRequested = 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// usage()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Print the command line help.
+////////////////////////////////////////////////////////////////////////////////
+static void usage()
+{
+  printf("Usage: dt-emulator [options]\n"
+         "Imitates a DT amp on virtual MIDI ports.\n\n"
+         "  --name <name>        Name of the virtual ports (default \"DT Emulator\").\n"
+         "  --api <api>          MIDI API to use (alsa, jack, core).\n"
+         "  --latency <ms>       Response latency in milliseconds (default 0).\n"
+         "  --drop <percent>     Percentage of replies to drop (default 0).\n"
+         "  --seed <n>           Seed for the drop decisions (default 1).\n"
+         "  --model <n>          Reported model, 0 = DT50 1x12 Combo ... 4 = DT25 Head.\n"
+         "  --firmware <digits>  Reported firmware version (default 104 = v1.04).\n"
+         "  --duration <s>       Quit after this many seconds (default: run until\n"
+         "                       interrupted).\n"
+         "  --verbose            Print all MIDI traffic.\n");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// main()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Emulator entry point.
+///\param   [in] argc: Number of command line arguments passed to this program.
+///\param   [in] argv: Array of command line arguments.
+///\return  Returns zero if successfull or an error code on failure.
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+  QCoreApplication a(argc, argv);
+
+  // Defaults:
+  QString     name("DT Emulator");
+  RtMidi::Api api = RtMidi::UNSPECIFIED;
+  double      latency  = 0.0;
+  double      drop     = 0.0;
+  uint        seed     = 1;
+  int         model    = 0;
+  QString     firmware("104");
+  double      duration = 0.0;
+  bool        verbose  = false;
+
+  // Parse the command line:
+  QStringList args = a.arguments();
+  for (int i = 1; i < args.size(); i++)
+  {
+    QString arg   = args[i];
+    QString value = i + 1 < args.size() ? args[i + 1] : QString();
+    bool    ok    = true;
+    if (arg == "--verbose")
+    {
+      verbose = true;
+      continue;
+    }
+    else if (arg == "--name")
+      name = value;
+    else if (arg == "--api")
+    {
+      api = RtMidi::getCompiledApiByName(value.toStdString());
+      ok  = api != RtMidi::UNSPECIFIED;
+    }
+    else if (arg == "--latency")
+      latency = value.toDouble(&ok);
+    else if (arg == "--drop")
+      drop = value.toDouble(&ok);
+    else if (arg == "--seed")
+      seed = value.toUInt(&ok);
+    else if (arg == "--model")
+      model = value.toInt(&ok);
+    else if (arg == "--firmware")
+      firmware = value;
+    else if (arg == "--duration")
+      duration = value.toDouble(&ok);
+    else
+    {
+      usage();
+      return arg == "--help" ? 0 : 1;
+    }
+
+    // Check the value:
+    if (!ok || value.isEmpty())
+    {
+      fprintf(stderr, "Invalid value for %s\n", arg.toLocal8Bit().constData());
+      return 1;
+    }
+    i++;
+  }
+
+  // Set up the emulator:
+  DTEmulator emulator(model, firmware);
+  emulator.setLatency(latency);
+  emulator.setDropRate(drop, seed);
+  emulator.setVerbose(verbose);
+  if (!emulator.open(api, name))
+    return 1;
+  printf("%s ready, latency %g ms, drop rate %g%%\n", name.toLocal8Bit().constData(), latency, drop);
+  fflush(stdout);
+
+  // Run until interrupted or the time is up:
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  QTime timer;
+  timer.start();
+  while (!quitRequested && (duration <= 0.0 || timer.elapsed() < duration * 1000.0))
+  {
+    // Sleep a while. This only returns true if the sender thread ended:
+    if (emulator.wait(100))
+      break;
+  }
+
+  // Clean up:
+  emulator.close();
+  printf("%s\n", emulator.getStatistics().toLocal8Bit().constData());
+
+  // Return to sender:
+  return 0;
+}
+
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,233 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    imageassets.cpp
+///\ingroup dtedit
+///\brief   Image asset loader implementation.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include <cstring>
+#include "imageassets.h"
+
+////////////////////////////////////////////////////////////////////////////////
+///\class ImagePrefetch
+///\brief Thread that decodes a list of images.
+////////////////////////////////////////////////////////////////////////////////
+class ImagePrefetch :
+  public QThread
+{
+public:
+  ImagePrefetch(const QStringList& imageNames) :
+    QThread(QCoreApplication::instance()),
+    names(imageNames)
+  {
+  }
+
+  ~ImagePrefetch()
+  {
+    // Don't destroy a running thread on exit:
+    wait();
+  }
+
+  QStringList            names;  ///> Images to decode.
+  QHash<QString, QImage> images; ///> The decoded images.
+
+protected:
+  void run()
+  {
+    for (int i = 0; i < names.size(); i++)
+      images.insert(names[i], ImageAssets::image(names[i]));
+  }
+};
+
+// Running prefetch and the images it decoded that are not used yet:
+static ImagePrefetch*         prefetcher = 0;
+static QHash<QString, QImage> prefetched;
+
+////////////////////////////////////////////////////////////////////////////////
+// takePrefetched()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get an image from the prefetch.
+///\param   [in]  name:  Base name of the image.
+///\param   [out] image: Receives the image.
+///\return  Returns true if the image was prefetched.
+///\remarks Waits for the prefetch thread if it decodes the image.
+////////////////////////////////////////////////////////////////////////////////
+static bool takePrefetched(const QString& name, QImage& image)
+{
+  // Collect the images once the thread is done:
+  if (prefetcher != 0 && (prefetcher->isFinished() || prefetcher->names.contains(name)))
+  {
+    prefetcher->wait();
+    QHash<QString, QImage>::const_iterator it = prefetcher->images.constBegin();
+    for (; it != prefetcher->images.constEnd(); ++it)
+      prefetched.insert(it.key(), it.value());
+    delete prefetcher;
+    prefetcher = 0;
+  }
+
+  // Each image is handed out only once, the pixmap cache keeps it:
+  if (!prefetched.contains(name))
+    return false;
+  image = prefetched.take(name);
+
+  // Return to sender:
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ImageAssets::image()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get an image.
+///\param   [in] name: Base name of the image, like "knob_movie".
+///\return  The image in premultiplied ARGB32 format.
+////////////////////////////////////////////////////////////////////////////////
+QImage ImageAssets::image(const QString& name)
+{
+  // Prefer the raw image:
+  QImage result = rawImage(name);
+  if (result.isNull())
+    result = pngImage(name);
+
+  // Return to sender:
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ImageAssets::pixmap()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get an image as pixmap.
+///\param   [in] name: Base name of the image, like "knob_movie".
+///\return  The pixmap.
+///\remarks With Qt 5.3 and later on raster platforms a raw image becomes a
+///         pixmap without copying the pixels.
+////////////////////////////////////////////////////////////////////////////////
+QPixmap ImageAssets::pixmap(const QString& name)
+{
+  // Converted before?
+  QString key = "asset:" + name;
+  QPixmap result;
+  if (QPixmapCache::find(key, &result))
+    return result;
+
+  // Decode it, unless the prefetch did:
+  QImage source;
+  if (!takePrefetched(name, source))
+    source = image(name);
+  #if QT_VERSION >= 0x050300
+  result = QPixmap::fromImageInPlace(source);
+  #else
+  result = QPixmap::fromImage(source);
+  #endif
+  QPixmapCache::insert(key, result);
+
+  // Return to sender:
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ImageAssets::prefetch()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Decode images on a background thread ahead of time.
+///\param   [in] names: Base names of the images.
+///\remarks pixmap() picks up the decoded images and only waits for the
+///         thread if it asks for one of them before the thread is done.
+////////////////////////////////////////////////////////////////////////////////
+void ImageAssets::prefetch(const QStringList& names)
+{
+  // Collect a previous prefetch first:
+  QImage dummy;
+  if (prefetcher != 0)
+  {
+    prefetcher->wait();
+    takePrefetched(QString(), dummy);
+  }
+
+  prefetcher = new ImagePrefetch(names);
+  prefetcher->start(QThread::LowPriority);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ImageAssets::rawImage()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the raw version of an image.
+///\param   [in] name: Base name of the image.
+///\return  The image or a null image if it is not compiled in or was
+///         converted on a machine with another byte order.
+///\remarks The image refers to the resource memory, nothing is copied.
+////////////////////////////////////////////////////////////////////////////////
+QImage ImageAssets::rawImage(const QString& name)
+{
+  // Compiled in?
+  QResource resource(":/raw/" + name + ".argb");
+  if (!resource.isValid() || resource.size() < RAWIMAGE_HEADER_SIZE)
+    return QImage();
+
+  // The raw resource file is built without compression, but be safe:
+  QByteArray uncompressed;
+  const uchar* data = resource.data();
+  qint64       size = resource.size();
+  if (resource.isCompressed())
+  {
+    uncompressed = qUncompress(data, static_cast<int>(size));
+    data = reinterpret_cast<const uchar*>(uncompressed.constData());
+    size = uncompressed.size();
+  }
+
+  // Check header:
+  quint32 header[4];
+  if (size < RAWIMAGE_HEADER_SIZE)
+    return QImage();
+  memcpy(header, data, sizeof(header));
+  if (memcmp(data, "DTRI", 4) != 0 || header[1] != RAWIMAGE_BYTE_ORDER)
+    return QImage();
+  int width  = static_cast<int>(header[2]);
+  int height = static_cast<int>(header[3]);
+  if (width <= 0 || height <= 0 || size < RAWIMAGE_HEADER_SIZE + static_cast<qint64>(width) * height * 4)
+    return QImage();
+
+  // Wrap the pixels. A copy is only needed if they are not aligned or
+  // had to be uncompressed:
+  const uchar* pixels = data + RAWIMAGE_HEADER_SIZE;
+  QImage result(pixels, width, height, width * 4, QImage::Format_ARGB32_Premultiplied);
+  if (!uncompressed.isEmpty() || (reinterpret_cast<quintptr>(pixels) & 3) != 0)
+    result = result.copy();
+
+  // Return to sender:
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ImageAssets::pngImage()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Decode the PNG version of an image.
+///\param   [in] name: Base name of the image.
+///\return  The image in premultiplied ARGB32 format.
+////////////////////////////////////////////////////////////////////////////////
+QImage ImageAssets::pngImage(const QString& name)
+{
+  QImage result(":/images/" + name + ".png");
+  if (result.format() != QImage::Format_ARGB32_Premultiplied && !result.isNull())
+    result = result.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+  return result;
+}
+
+///////////////////////////////// End of File //////////////////////////////////
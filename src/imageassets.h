@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    imageassets.h
+///\ingroup dtedit
+///\brief   Image asset loader definitions.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef __IMAGEASSETS_H_INCLUDED__
+#define __IMAGEASSETS_H_INCLUDED__
+
+#include <QtGui>
+
+////////////////////////////////////////////////////////////////////////////////
+// Raw image layout
+////////////////////////////////////////////////////////////////////////////////
+// "qmake CONFIG+=raw_assets" converts the PNG images to raw images with the
+// assets/dtassets tool and compiles them uncompressed into the program as
+// ":/raw/<name>.argb". All numbers are in the byte order of the machine that
+// ran the converter:
+//
+//   char    magic[4];   "DTRI"
+//   quint32 byteOrder;  RAWIMAGE_BYTE_ORDER
+//   quint32 width;      Width in pixels
+//   quint32 height;     Height in pixels
+//   quint32 pixels[];   width * height premultiplied ARGB32 pixels, row by row
+//
+// The size of a raw image is a multiple of four, so all images in the raw
+// resource file stay aligned for QImage.
+#define RAWIMAGE_BYTE_ORDER  0x01020304
+#define RAWIMAGE_HEADER_SIZE 16
+
+////////////////////////////////////////////////////////////////////////////////
+///\class ImageAssets imageassets.h
+///\brief Loads the images of the user interface.
+/// Uses the raw images if they are compiled in and falls back to decoding
+/// the PNG images otherwise. Pixmaps are kept in the QPixmapCache, so each
+/// image is only converted once.
+////////////////////////////////////////////////////////////////////////////////
+class ImageAssets
+{
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  // ImageAssets::image()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get an image.
+  ///\param   [in] name: Base name of the image, like "knob_movie".
+  ///\return  The image in premultiplied ARGB32 format.
+  //////////////////////////////////////////////////////////////////////////////
+  static QImage image(const QString& name);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // ImageAssets::pixmap()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get an image as pixmap.
+  ///\param   [in] name: Base name of the image, like "knob_movie".
+  ///\return  The pixmap.
+  ///\remarks With Qt 5.3 and later on raster platforms a raw image becomes a
+  ///         pixmap without copying the pixels.
+  //////////////////////////////////////////////////////////////////////////////
+  static QPixmap pixmap(const QString& name);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // ImageAssets::prefetch()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Decode images on a background thread ahead of time.
+  ///\param   [in] names: Base names of the images.
+  ///\remarks pixmap() picks up the decoded images and only waits for the
+  ///         thread if it asks for one of them before the thread is done.
+  //////////////////////////////////////////////////////////////////////////////
+  static void prefetch(const QStringList& names);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // ImageAssets::rawImage()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get the raw version of an image.
+  ///\param   [in] name: Base name of the image.
+  ///\return  The image or a null image if it is not compiled in or was
+  ///         converted on a machine with another byte order.
+  ///\remarks The image refers to the resource memory, nothing is copied.
+  //////////////////////////////////////////////////////////////////////////////
+  static QImage rawImage(const QString& name);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // ImageAssets::pngImage()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Decode the PNG version of an image.
+  ///\param   [in] name: Base name of the image.
+  ///\return  The image in premultiplied ARGB32 format.
+  //////////////////////////////////////////////////////////////////////////////
+  static QImage pngImage(const QString& name);
+};
+
+#endif // #ifndef __IMAGEASSETS_H_INCLUDED__
+///////////////////////////////// End of File //////////////////////////////////
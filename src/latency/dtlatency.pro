@@ -0,0 +1,18 @@
+#-------------------------------------------------
+#
+# Edit-to-wire and wire-to-pixel latency harness.
+#
+#-------------------------------------------------
+
+QT += core gui xml testlib
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = dtlatency
+TEMPLATE = app
+CONFIG += console loopback
+CONFIG -= app_bundle
+
+SOURCES += main.cpp
+
+include(../dtedit.pri)
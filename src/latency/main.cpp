@@ -0,0 +1,377 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    main.cpp
+///\ingroup dtedit
+///\brief   End-to-end latency harness of the editor.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cstdio>
+#include <QApplication>
+#include <QtTest/QtTest>
+#include "dtedit.h"
+#include "mainmidiwindow.h"
+#include "mainwindow.h"
+#include "qimagedial.h"
+
+// Names of the virtual ports the harness creates:
+static const char* harnessInName  = "DT Latency Harness In";
+static const char* harnessOutName = "DT Latency Harness Out";
+
+// Give up on a sample after this many nanoseconds:
+static const unsigned long long sampleTimeout = 1000000000ULL;
+
+////////////////////////////////////////////////////////////////////////////////
+///\class EditorWindow
+///\brief The editor window connected to the harness ports.
+////////////////////////////////////////////////////////////////////////////////
+class EditorWindow :
+  public MainWindow
+{
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  // EditorWindow::connectToHarness()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Open the virtual ports of the harness like a real amp.
+  ///\return  Returns true if successfull or false otherwise.
+  ///\remarks This runs the regular openMIDIPorts() so the input goes
+  ///         through the same callback and thread as with a real driver.
+  //////////////////////////////////////////////////////////////////////////////
+  bool connectToHarness()
+  {
+    midiApi     = RtMidi::LOOPBACK;
+    midiInName  = harnessOutName;
+    midiOutName = harnessInName;
+    return openMIDIPorts();
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///\class LatencyProbe
+///\brief Observes both ends of the editor.
+/// The probe receives the editor output on a loopback port and watches the
+/// paint events of one dial. Both observations are time stamped with
+/// RtMidi::getMonotonicTime().
+////////////////////////////////////////////////////////////////////////////////
+class LatencyProbe :
+  public QObject
+{
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  // LatencyProbe::LatencyProbe()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Initialization constructor of this class.
+  ///\param   [in] control: The controller of the observed dial.
+  //////////////////////////////////////////////////////////////////////////////
+  LatencyProbe(unsigned char control) :
+    controlNumber(control),
+    wireTime(0),
+    paintTime(0)
+  {
+    // Nothing to do here.
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // LatencyProbe::reset()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Forget the previous observations before the next sample.
+  //////////////////////////////////////////////////////////////////////////////
+  void reset()
+  {
+    QMutexLocker locker(&mutex);
+    wireTime  = 0;
+    paintTime = 0;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // LatencyProbe::getWireTime()
+  // LatencyProbe::getPaintTime()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get the time of the last observation.
+  ///\return  Time in nanoseconds or 0 if nothing was seen since reset().
+  //////////////////////////////////////////////////////////////////////////////
+  unsigned long long getWireTime()
+  {
+    QMutexLocker locker(&mutex);
+    return wireTime;
+  }
+  unsigned long long getPaintTime()
+  {
+    QMutexLocker locker(&mutex);
+    return paintTime;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // LatencyProbe::onMIDIMessageProxy()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Callback for the messages the editor sends.
+  ///\param   [in] timeStamp: Time the message was handed to RtMidiOut.
+  ///\param   [in] deltaTime: Seconds since the previous message.
+  ///\param   [in] message:   The raw MIDI message as byte buffer.
+  ///\param   [in] userData:  Pointer to the probe.
+  //////////////////////////////////////////////////////////////////////////////
+  static void onMIDIMessageProxy(unsigned long long timeStamp, double /* deltaTime */, std::vector<unsigned char>* message, void* userData)
+  {
+    LatencyProbe* probe = static_cast<LatencyProbe*>(userData);
+    if (message->size() == 3 && (message->at(0) & 0xF0) == 0xB0 && message->at(1) == probe->controlNumber)
+    {
+      QMutexLocker locker(&probe->mutex);
+      if (probe->wireTime == 0)
+        probe->wireTime = timeStamp;
+    }
+  }
+
+protected:
+  //////////////////////////////////////////////////////////////////////////////
+  // LatencyProbe::eventFilter()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Time stamp the end of each paint event of the dial.
+  ///\param   [in] watched: The dial.
+  ///\param   [in] event:   The event to filter.
+  ///\return  Returns true if the event was handled here.
+  ///\remarks The paint event is delivered right here so the time stamp is
+  ///         taken after the dial has drawn itself.
+  //////////////////////////////////////////////////////////////////////////////
+  bool eventFilter(QObject* watched, QEvent* event)
+  {
+    if (event->type() != QEvent::Paint)
+      return false;
+    watched->event(event);
+    unsigned long long now = RtMidi::getMonotonicTime();
+    QMutexLocker locker(&mutex);
+    if (paintTime == 0)
+      paintTime = now;
+    return true;
+  }
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  unsigned char      controlNumber; ///> Controller of the observed dial.
+  QMutex             mutex;         ///> Guards the time stamps.
+  unsigned long long wireTime;      ///> First matching CC on the wire.
+  unsigned long long paintTime;     ///> End of the first dial repaint.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// waitFor()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Process events until an observation was made.
+///\param   [in] probe:  The probe to ask.
+///\param   [in] getter: Which observation to wait for.
+///\return  Time of the observation or 0 on timeout.
+////////////////////////////////////////////////////////////////////////////////
+static unsigned long long waitFor(LatencyProbe& probe, unsigned long long (LatencyProbe::*getter)())
+{
+  unsigned long long deadline = RtMidi::getMonotonicTime() + sampleTimeout;
+  while (RtMidi::getMonotonicTime() < deadline)
+  {
+    QCoreApplication::processEvents();
+    unsigned long long t = (probe.*getter)();
+    if (t != 0)
+      return t;
+  }
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// report()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Print the distribution of a latency series.
+///\param   [in] name:    Name of the series.
+///\param   [in] samples: Latencies in nanoseconds, sorted on return.
+///\param   [in] lost:    Number of samples that timed out.
+////////////////////////////////////////////////////////////////////////////////
+static void report(const char* name, std::vector<unsigned long long>& samples, int lost)
+{
+  if (samples.empty())
+  {
+    printf("%-14s no samples (%d lost)\n", name, lost);
+    return;
+  }
+
+  // Sort and pick the percentiles (nearest rank):
+  std::sort(samples.begin(), samples.end());
+  const double percentiles[3] = { 0.5, 0.99, 0.999 };
+  double us[3];
+  for (int i = 0; i < 3; i++)
+  {
+    size_t rank = (size_t)(percentiles[i] * samples.size() + 0.999999);
+    us[i] = samples[rank > 0 ? rank - 1 : 0] / 1000.0;
+  }
+  printf("%-14s %8lu %10.1f %10.1f %10.1f %10.1f %10.1f %6d\n", name, (unsigned long)samples.size(),
+         samples.front() / 1000.0, us[0], us[1], us[2], samples.back() / 1000.0, lost);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// usage()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Print the command line help.
+////////////////////////////////////////////////////////////////////////////////
+static void usage()
+{
+  printf("Usage: dtlatency [options]\n"
+         "Measures the editor latency from a dial drag to the CC on the wire\n"
+         "(edit-to-wire) and from an incoming CC to the repainted dial\n"
+         "(wire-to-pixel).\n\n"
+         "  --samples <n>   Samples per measurement (default 2000).\n"
+         "  --interval <ms> Pause between samples (default 1).\n");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// main()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Harness entry point.
+///\param   [in] argc: Number of command line arguments passed to this program.
+///\param   [in] argv: Array of command line arguments.
+///\return  Returns zero if successfull or an error code on failure.
+///\remarks Runs without a display, Qt 5 uses the offscreen platform unless
+///         QT_QPA_PLATFORM says otherwise.
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+  #if QT_VERSION >= 0x050000
+  if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  #endif
+
+  // Init the global application object:
+  QApplication a(argc, argv);
+
+  // Use own settings so the configuration of the editor is left alone:
+  a.setApplicationName   (QString("DTLatency"));
+  a.setOrganizationName  (QString("Rolf Meyerhoff"));
+  a.setOrganizationDomain(QString("dtedit.googlecode.com"));
+
+  // Parse the command line:
+  int samples  = 2000;
+  int interval = 1;
+  QStringList args = a.arguments();
+  for (int i = 1; i < args.size(); i++)
+  {
+    bool ok = false;
+    if (args[i] == "--samples" && i + 1 < args.size())
+      samples = args[++i].toInt(&ok);
+    else if (args[i] == "--interval" && i + 1 < args.size())
+      interval = args[++i].toInt(&ok);
+    else
+    {
+      usage();
+      return args[i] == "--help" ? 0 : 1;
+    }
+    if (!ok || samples <= 0 || interval < 0)
+    {
+      fprintf(stderr, "Invalid value for %s\n", args[i - 1].toLocal8Bit().constData());
+      return 1;
+    }
+  }
+
+  // Create the amp side of the connection:
+  LatencyProbe probe(CC_GAIN_A);
+  RtMidiIn  harnessIn(RtMidi::LOOPBACK);
+  RtMidiOut harnessOut(RtMidi::LOOPBACK);
+  harnessIn.setTimedCallback(&LatencyProbe::onMIDIMessageProxy, &probe);
+  harnessIn.openVirtualPort(harnessInName);
+  harnessOut.openVirtualPort(harnessOutName);
+
+  // Create and connect the editor:
+  EditorWindow editor;
+  if (!editor.connectToHarness())
+  {
+    fprintf(stderr, "Could not connect the editor to the harness ports\n");
+    return 1;
+  }
+  editor.show();
+  #if QT_VERSION >= 0x050000
+  QTest::qWaitForWindowExposed(&editor);
+  #else
+  QTest::qWaitForWindowShown(&editor);
+  #endif
+
+  // Find the observed dial:
+  QImageDial* dial = 0;
+  QList<QImageDial*> dials = editor.findChildren<QImageDial*>();
+  for (int i = 0; i < dials.size() && dial == 0; i++)
+    if (dials[i]->tag() == CC_GAIN_A)
+      dial = dials[i];
+  if (dial == 0)
+  {
+    fprintf(stderr, "The gain dial of channel A was not found\n");
+    return 1;
+  }
+  dial->installEventFilter(&probe);
+  QTest::qWait(100);
+
+  // Edit-to-wire: Drag the dial up and down. QTest::mouseMove() can't hold a
+  // button for widgets, so the moves are posted like the window system does
+  // and the press and release come from QTest:
+  std::vector<unsigned long long> editToWire;
+  int editLost = 0;
+  QPoint center(dial->width() / 2, dial->height() / 2);
+  QTest::mousePress(dial, Qt::LeftButton, Qt::NoModifier, center);
+  for (int i = 0; i < samples; i++)
+  {
+    QPoint pos(center.x(), center.y() + (i & 1 ? 8 : -8));
+    probe.reset();
+    unsigned long long start = RtMidi::getMonotonicTime();
+    QCoreApplication::postEvent(dial, new QMouseEvent(QEvent::MouseMove, pos, dial->mapToGlobal(pos), Qt::NoButton, Qt::LeftButton, Qt::NoModifier));
+    unsigned long long wire = waitFor(probe, &LatencyProbe::getWireTime);
+    if (wire != 0)
+      editToWire.push_back(wire - start);
+    else
+      editLost++;
+    QTest::qWait(interval);
+  }
+  QTest::mouseRelease(dial, Qt::LeftButton, Qt::NoModifier, center);
+  QTest::qWait(100);
+
+  // Wire-to-pixel: Send the dial values like the amp does when its knob is
+  // turned:
+  std::vector<unsigned long long> wireToPixel;
+  int paintLost = 0;
+  std::vector<unsigned char> message(3);
+  message[0] = 0xB0 | DT_MIDI_CHANNEL;
+  message[1] = CC_GAIN_A;
+  for (int i = 0; i < samples; i++)
+  {
+    message[2] = i & 1 ? 96 : 32;
+    probe.reset();
+    unsigned long long start = RtMidi::getMonotonicTime();
+    harnessOut.sendMessage(&message);
+    unsigned long long paint = waitFor(probe, &LatencyProbe::getPaintTime);
+    if (paint != 0)
+      wireToPixel.push_back(paint - start);
+    else
+      paintLost++;
+    QTest::qWait(interval);
+  }
+
+  // Print results:
+  printf("%-14s %8s %10s %10s %10s %10s %10s %6s\n", "latency [us]", "samples", "min", "p50", "p99", "p99.9", "max", "lost");
+  report("edit-to-wire",  editToWire,  editLost);
+  report("wire-to-pixel", wireToPixel, paintLost);
+
+  // Return to sender:
+  return editLost + paintLost == 0 ? 0 : 2;
+}
+
+///////////////////////////////// End of File //////////////////////////////////
@@ -32,6 +32,35 @@
 #include "dtedit.h"
 #include "mainmidiwindow.h"
 #include "mainwindow.h"
+#include "traceevents.h"
+#include "startupprofile.h"
+#include "singleinstance.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// presetFiles()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the preset files of the command line.
+///\param   [in] args: The command line arguments.
+///\return  Absolute paths of all arguments that are no options.
+////////////////////////////////////////////////////////////////////////////////
+static QStringList presetFiles(const QStringList& args)
+{
+  // Options that take a value:
+  QStringList valueOptions;
+  valueOptions << "--trace-events" << "--capture" << "--stats" << "--stats-interval";
+
+  QStringList files;
+  for (int i = 1; i < args.size(); i++)
+  {
+    if (valueOptions.contains(args[i]))
+      i++;
+    else if (!args[i].startsWith("-"))
+      files.append(QFileInfo(args[i]).absoluteFilePath());
+  }
+
+  // Return to sender:
+  return files;
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 // main()
@@ -44,6 +73,17 @@
 ////////////////////////////////////////////////////////////////////////////////
 int main(int argc, char** argv)
 {
+  // Time the startup from here:
+  StartupProfile::start();
+
+  // Scale with the screen, fractional factors included:
+  #if QT_VERSION >= 0x050600 && QT_VERSION < 0x060000
+  QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
+  #endif
+  #if QT_VERSION >= 0x050E00
+  QApplication::setHighDpiScaleFactorRoundingPolicy(Qt::HighDpiScaleFactorRoundingPolicy::PassThrough);
+  #endif
+
   // Init the global application object:
   QApplication a(argc, argv);
 
@@ -52,14 +92,91 @@ int main(int argc, char** argv)
   a.setApplicationVersion(QString("1.0"));
   a.setOrganizationName  (QString("Rolf Meyerhoff"));
   a.setOrganizationDomain(QString("dtedit.googlecode.com"));
+  StartupProfile::mark("application created");
 
-  // Create and show the main application window:
-  MainWindow w;
+  // Is the editor running already? Then it gets the preset files and brings
+  // its window to the front, this one quits before it touches any MIDI port
+  // ("--new-instance" starts another editor anyway):
+  QStringList args = a.arguments();
+  QStringList presets = presetFiles(args);
+  SingleInstance instance;
+  if (!args.contains("--new-instance"))
+  {
+    if (instance.forward(presets))
+      return 0;
+    if (!instance.listen())
+    {
+      // Another editor may have won the race to listen:
+      if (instance.forward(presets))
+        return 0;
+      qWarning("Could not listen for other instances of the editor");
+    }
+  }
+
+  // Print the startup phases if asked to ("--startup-profile"):
+  StartupProfile::setPrint(args.contains("--startup-profile"));
+
+  #ifdef __DTEDIT_TRACE_EVENTS__
+  // Record trace spans if asked to ("--trace-events <file>"):
+  int traceIndex = args.indexOf("--trace-events");
+  if (traceIndex > 0 && traceIndex + 1 < args.size())
+  {
+    if (!TraceEvents::start(QFile::encodeName(args[traceIndex + 1]).constData()))
+      qWarning("Could not open the trace file %s", qPrintable(args[traceIndex + 1]));
+  }
+  #endif
+
+  // Create the main application window, optionally with all dials and
+  // switches drawn by a single canvas ("--canvas"):
+  MainWindow w(0, args.contains("--canvas"));
+
+  // Connect before the window appears if asked to ("--no-fast-start"):
+  w.setFastStart(!args.contains("--no-fast-start"));
+
+  // Keep the recent MIDI traffic if the editor crashes:
+  MIDITrace::installCrashHandler(&w.getTrace(), QDir::temp().filePath("dtedit-trace.txt"));
+
+  // Record the MIDI traffic if asked to ("--capture <file>"):
+  int captureIndex = args.indexOf("--capture");
+  if (captureIndex > 0 && captureIndex + 1 < args.size())
+  {
+    if (!w.startCapture(args[captureIndex + 1]))
+      qWarning("Could not open the capture file %s", qPrintable(args[captureIndex + 1]));
+  }
+
+  // Write the engine statistics periodically if asked to
+  // ("--stats <file> [--stats-interval <seconds>]"):
+  int statsIndex = args.indexOf("--stats");
+  if (statsIndex > 0 && statsIndex + 1 < args.size())
+  {
+    int seconds = 5;
+    int intervalIndex = args.indexOf("--stats-interval");
+    if (intervalIndex > 0 && intervalIndex + 1 < args.size())
+      seconds = qMax(1, args[intervalIndex + 1].toInt());
+    w.startStatisticsDump(args[statsIndex + 1], seconds * 1000);
+  }
+
+  // Load the presets of the command line, they are sent to the DT once it
+  // is connected. Later starts hand theirs over to this window:
+  for (int i = 0; i < presets.size(); i++)
+  {
+    if (!w.loadPreset(presets[i]))
+      qWarning("Could not read the preset %s", qPrintable(presets[i]));
+  }
+  QObject::connect(&instance, SIGNAL(activated(const QStringList&)), &w, SLOT(activate(const QStringList&)));
+
+  // Show the window, this opens the MIDI ports (after the first frame with
+  // fast start):
   w.show();
 
   // Run the application:
   int ret = a.exec();
 
+  #ifdef __DTEDIT_TRACE_EVENTS__
+  // Complete the trace file:
+  TraceEvents::stop();
+  #endif
+
   // Return to sender:
   return ret;
 }
@@ -26,6 +26,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include "mainmidiwindow.h"
 #include "setupdialog.h"
+#include "startupprofile.h"
 #include <QThread>
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -39,7 +40,15 @@ MainMIDIWindow::MainMIDIWindow(QWidget *parent) :
   QMainWindow(parent),
   midiInName(""),
   midiOutName(""),
-  midiOK(false)
+  midiOK(false),
+  midiRunningStatus(false),
+  midiApi(RtMidi::UNSPECIFIED),
+  midiScheduling(RtMidi::NORMAL_SCHEDULING),
+  midiPriority(70),
+  midiIn(0),
+  midiOut(0),
+  messageDeferred(false),
+  statisticsTimer(0)
 {
   // Nothing to do here.
 }
@@ -52,7 +61,120 @@ MainMIDIWindow::MainMIDIWindow(QWidget *parent) :
 ////////////////////////////////////////////////////////////////////////////////
 MainMIDIWindow::~MainMIDIWindow()
 {
-  // Nothing to do here.
+  // Free MIDI objects, this closes the ports:
+  delete midiIn;
+  delete midiOut;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainMIDIWindow::startCapture()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Record all MIDI traffic to a log file.
+///\param   [in] fileName: The log file, new messages are appended.
+///\return  Returns true if successfull or false otherwise.
+///\remarks The log can be played back with the dtreplay tool.
+////////////////////////////////////////////////////////////////////////////////
+bool MainMIDIWindow::startCapture(const QString& fileName)
+{
+  return captureLog.open(fileName);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainMIDIWindow::stopCapture()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Stop recording the MIDI traffic and close the log file.
+////////////////////////////////////////////////////////////////////////////////
+void MainMIDIWindow::stopCapture()
+{
+  captureLog.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainMIDIWindow::getTrace()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Access the trace of the recent MIDI traffic.
+///\return  The trace.
+////////////////////////////////////////////////////////////////////////////////
+const MIDITrace& MainMIDIWindow::getTrace() const
+{
+  return trace;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainMIDIWindow::getStatistics()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Report the counters of the MIDI engine.
+///\param   [in] json: Make a JSON report instead of a readable one?
+///\return  The report.
+////////////////////////////////////////////////////////////////////////////////
+QString MainMIDIWindow::getStatistics(bool json)
+{
+  // Collect the driver numbers:
+  DriverStatistics driver;
+  driver.api             = RtMidi::getApiDisplayName(midiOut != 0 ? midiOut->getCurrentApi() : midiApi).c_str();
+  driver.scheduling      = midiIn != 0 ? getSchedulingInfo() : tr("MIDI not active");
+  driver.wireBytesOut    = midiOut != 0 ? midiOut->getWireByteCount() : 0;
+  driver.droppedMessages = midiIn != 0 ? midiIn->getDroppedMessageCount() : 0;
+
+  // Make the report, the readable one shows the startup as well:
+  if (json)
+    return statistics.toJSON(driver);
+  return statistics.toText(driver) + "\n" + StartupProfile::report();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainMIDIWindow::resetStatistics()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Set the counters of the MIDI engine to zero.
+///\remarks The driver counters (wire bytes, dropped messages) keep
+///         counting from the opening of the ports.
+////////////////////////////////////////////////////////////////////////////////
+void MainMIDIWindow::resetStatistics()
+{
+  statistics.reset();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainMIDIWindow::startStatisticsDump()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Write the JSON report to a file periodically.
+///\param   [in] fileName:     The file, it is replaced each time.
+///\param   [in] milliSeconds: Time between two reports.
+////////////////////////////////////////////////////////////////////////////////
+void MainMIDIWindow::startStatisticsDump(const QString& fileName, int milliSeconds)
+{
+  // Create timer on first use:
+  if (statisticsTimer == 0)
+  {
+    statisticsTimer = new QTimer(this);
+    connect(statisticsTimer, SIGNAL(timeout()), this, SLOT(dumpStatistics()));
+  }
+
+  // (Re)start it:
+  statisticsFile = fileName;
+  statisticsTimer->start(milliSeconds);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainMIDIWindow::dumpStatistics()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Write the JSON report to the dump file.
+///\remarks The report is written to a temporary file first and then
+///         renamed, so readers never see half a report.
+////////////////////////////////////////////////////////////////////////////////
+void MainMIDIWindow::dumpStatistics()
+{
+  // Write the report:
+  QString tempName = statisticsFile + ".tmp";
+  QFile file(tempName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return;
+  file.write(getStatistics(true).toUtf8());
+  file.close();
+
+  // Replace the old one:
+  QFile::remove(statisticsFile);
+  QFile::rename(tempName, statisticsFile);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -60,26 +182,45 @@ MainMIDIWindow::~MainMIDIWindow()
 ////////////////////////////////////////////////////////////////////////////////
 ///\brief   Open the MIDI devices for input/output.
 ///\return  Returns true if successfull or false otherwise.
-///\remarks Always closes the port priot trying to open them again.
+///\remarks Always closes the port priot trying to open them again. The
+///         MIDI objects are recreated each time so a changed midiApi takes
+///         effect. The input uses the driver the output resolved, so
+///         "Automatic" never ends up with two different drivers.
 ////////////////////////////////////////////////////////////////////////////////
 bool MainMIDIWindow::openMIDIPorts()
 {
   // flag error:
   midiOK = false;
 
-  // Close ports:
-  midiIn.closePort();
-  midiOut.closePort();
+  // Free old MIDI objects, this closes the ports:
+  delete midiIn;
+  midiIn = 0;
+  delete midiOut;
+  midiOut = 0;
 
   // Check names:
   if (midiInName.isEmpty() || midiOutName.isEmpty())
     return false;
 
+  // Create MIDI objects for the selected API:
+  try
+  {
+    midiOut = new RtMidiOut(midiApi);
+    midiIn  = new RtMidiIn(midiOut->getCurrentApi());
+  }
+  catch (...)
+  {
+    // The driver is not available:
+    delete midiOut;
+    midiOut = 0;
+    return false;
+  }
+
   // Find MIDI in port number:
   int inPortNo = -1;
-  for (int i = 0; i < static_cast<int>(midiIn.getPortCount()); i++)
+  for (int i = 0; i < static_cast<int>(midiIn->getPortCount()); i++)
   {
-    if (midiInName.compare(midiIn.getPortName(i).c_str()) == 0)
+    if (midiInName.compare(midiIn->getPortName(i).c_str()) == 0)
     {
       inPortNo = i;
       break;
@@ -90,9 +231,9 @@ bool MainMIDIWindow::openMIDIPorts()
 
   // Find MIDI out port number:
   int outPortNo = -1;
-  for (int i = 0; i < static_cast<int>(midiOut.getPortCount()); i++)
+  for (int i = 0; i < static_cast<int>(midiOut->getPortCount()); i++)
   {
-    if (midiOutName.compare(midiOut.getPortName(i).c_str()) == 0)
+    if (midiOutName.compare(midiOut->getPortName(i).c_str()) == 0)
     {
       outPortNo = i;
       break;
@@ -104,12 +245,14 @@ bool MainMIDIWindow::openMIDIPorts()
   try
   {
     // Open MIDI in port:
-    midiIn.setCallback(onMIDIMessageProxy, this);
-    midiIn.openPort(inPortNo);
-    midiIn.ignoreTypes(false, true, true);
+    midiIn->setTimedCallback(onMIDIMessageProxy, this);
+    midiIn->setScheduling(midiScheduling, midiPriority);
+    midiIn->openPort(inPortNo);
+    midiIn->ignoreTypes(false, true, true);
 
     // Open MIDI out port:
-    midiOut.openPort(outPortNo);
+    midiOut->setRunningStatus(midiRunningStatus);
+    midiOut->openPort(outPortNo);
 
     // Set status:
     midiOK = true;
@@ -120,8 +263,8 @@ bool MainMIDIWindow::openMIDIPorts()
   catch (...)
   {
     // Close ports:
-    midiIn.closePort();
-    midiOut.closePort();
+    midiIn->closePort();
+    midiOut->closePort();
 
     // Error return:
     return false;
@@ -143,19 +286,59 @@ bool MainMIDIWindow::showSetupWindow()
   // Set properties:
   dlg.setInputName(midiInName);
   dlg.setOutputName(midiOutName);
+  dlg.setApi(midiApi);
+  dlg.setScheduling(midiScheduling, midiPriority);
+  dlg.setSchedulingInfo(getSchedulingInfo());
+  dlg.setRunningStatus(midiRunningStatus);
 
   // Swow the dialog:
   if (dlg.exec() == QDialog::Rejected)
     return false;
 
   // Store properties:
-  midiInName  = dlg.getInputName();
-  midiOutName = dlg.getOutputName();
+  midiInName        = dlg.getInputName();
+  midiOutName       = dlg.getOutputName();
+  midiApi           = dlg.getApi();
+  midiScheduling    = dlg.getScheduling();
+  midiPriority      = dlg.getPriority();
+  midiRunningStatus = dlg.getRunningStatus();
 
   // Return success:
   return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// MainMIDIWindow::getSchedulingInfo()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Describe the scheduling the MIDI input thread actually got.
+///\return  A human readable description like "Real-time (FIFO), priority
+///         70" that can be shown in diagnostics.
+///\remarks The requested class is only granted if the system allows it.
+////////////////////////////////////////////////////////////////////////////////
+QString MainMIDIWindow::getSchedulingInfo()
+{
+  // Anything running?
+  if (!midiOK)
+    return tr("MIDI not active");
+
+  // Ask the input what it got:
+  int priority = 0;
+  switch (midiIn->getScheduling(&priority))
+  {
+  case RtMidi::FIFO_SCHEDULING:
+    return tr("Real-time (FIFO), priority %1").arg(priority);
+  case RtMidi::ROUND_ROBIN_SCHEDULING:
+    return tr("Real-time (round robin), priority %1").arg(priority);
+  default:
+    break;
+  }
+
+  // Tell if real-time was requested but not granted:
+  if (midiScheduling != RtMidi::NORMAL_SCHEDULING)
+    return tr("Normal (real-time not permitted)");
+  return tr("Normal");
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // MainMIDIWindow::noteOnReceived()
 ////////////////////////////////////////////////////////////////////////////////
@@ -166,10 +349,7 @@ bool MainMIDIWindow::showSetupWindow()
 ////////////////////////////////////////////////////////////////////////////////
 void MainMIDIWindow::noteOnReceived(unsigned char /*channel*/, unsigned char /*noteNumber*/, unsigned char /*velocity*/)
 {
-  // Log message:
-  //QString s;
-  //s.sprintf("Note on received (note %d, channel %d, velocity %d)", noteNumber, channel + 1, velocity);
-  //qDebug() << s;
+  // Nothing to do here, onMIDIMessageProxy() traced the message already.
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -182,10 +362,7 @@ void MainMIDIWindow::noteOnReceived(unsigned char /*channel*/, unsigned char /*n
 ////////////////////////////////////////////////////////////////////////////////
 void MainMIDIWindow::noteOffReceived(unsigned char /*channel*/, unsigned char /*noteNumber*/, unsigned char /*velocity*/)
 {
-  // Log message:
-  //QString s;
-  //s.sprintf("Note off received (note %d, channel %d, velocity %d)", noteNumber, channel + 1, velocity);
-  //qDebug() << s;
+  // Nothing to do here, onMIDIMessageProxy() traced the message already.
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -198,10 +375,7 @@ void MainMIDIWindow::noteOffReceived(unsigned char /*channel*/, unsigned char /*
 ////////////////////////////////////////////////////////////////////////////////
 void MainMIDIWindow::controlChangeReceived(unsigned char /*channel*/, unsigned char /*controlNumber*/, unsigned char /*value*/)
 {
-  // Log message:
-  //QString s;
-  //s.sprintf("Control change received (number %d, channel %d, value %d)", controlNumber, channel + 1, value);
-  //qDebug() << s;
+  // Nothing to do here, onMIDIMessageProxy() traced the message already.
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -213,10 +387,7 @@ void MainMIDIWindow::controlChangeReceived(unsigned char /*channel*/, unsigned c
 ////////////////////////////////////////////////////////////////////////////////
 void MainMIDIWindow::programChangeReceived(unsigned char /*channel*/, unsigned char /*value*/)
 {
-  // Log message:
-  //QString s;
-  //s.sprintf("Program change received (channel %d, value %d)", channel + 1, value);
-  //qDebug() << s;
+  // Nothing to do here, onMIDIMessageProxy() traced the message already.
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -228,10 +399,7 @@ void MainMIDIWindow::programChangeReceived(unsigned char /*channel*/, unsigned c
 ////////////////////////////////////////////////////////////////////////////////
 void MainMIDIWindow::channelAftertouchReceived(unsigned char /*channel*/, unsigned char /*value*/)
 {
-  // Log message:
-  //QString s;
-  //s.sprintf("Channel aftertouch received (channel %d, value %d)", channel + 1, value);
-  //qDebug() << s;
+  // Nothing to do here, onMIDIMessageProxy() traced the message already.
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -243,10 +411,7 @@ void MainMIDIWindow::channelAftertouchReceived(unsigned char /*channel*/, unsign
 ////////////////////////////////////////////////////////////////////////////////
 void MainMIDIWindow::pitchBendReceived(unsigned char /*channel*/, unsigned short /*value*/)
 {
-  // Log message:
-  //QString s;
-  //s.sprintf("Pitch bend received (channel %d, value %d)", channel + 1, value);
-  //qDebug() << s;
+  // Nothing to do here, onMIDIMessageProxy() traced the message already.
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -259,10 +424,7 @@ void MainMIDIWindow::pitchBendReceived(unsigned char /*channel*/, unsigned short
 ////////////////////////////////////////////////////////////////////////////////
 void MainMIDIWindow::polyAftertouchReceived(unsigned char /*channel*/, unsigned char /*noteNumber*/, unsigned char /*value*/)
 {
-  // Log message:
-  //QString s;
-  //s.sprintf("Polyphonic aftertouch received (note %d, channel %d, value %d)", noteNumber, channel + 1, value);
-  //qDebug() << s;
+  // Nothing to do here, onMIDIMessageProxy() traced the message already.
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -274,10 +436,46 @@ void MainMIDIWindow::polyAftertouchReceived(unsigned char /*channel*/, unsigned
 ////////////////////////////////////////////////////////////////////////////////
 void MainMIDIWindow::sysExReceived(const std::vector<unsigned char>& /* buff */)
 {
-  // Log message:
-  //QString s;
-  //s.sprintf("SysEx received (size %d bytes)", static_cast<int>(buff.size()));
-  //qDebug() << s;
+  // Nothing to do here, onMIDIMessageProxy() traced the message already.
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainMIDIWindow::sendMessage()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Send a raw MIDI message.
+///\param   [in] message: The complete MIDI message as byte buffer.
+///\remarks All outgoing messages pass this function. It takes the time
+///         stamp right before the message is handed to the driver and
+///         reports both to messageSent().
+////////////////////////////////////////////////////////////////////////////////
+void MainMIDIWindow::sendMessage(std::vector<unsigned char>& message)
+{
+  // Environment check:
+  if (!midiOK)
+    return;
+
+  // Stamp and send the message:
+  unsigned long long timeStamp = RtMidi::getMonotonicTime();
+  midiOut->sendMessage(&message);
+  trace.add(MIDITrace::OUTBOUND, timeStamp, message);
+  captureLog.write(MIDILog::OUTBOUND, timeStamp, message);
+  statistics.messageSent(message);
+
+  // Notify derived classes:
+  messageSent(timeStamp, message);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainMIDIWindow::messageSent()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   This is called after a MIDI message was sent.
+///\param   [in] timeStamp: Absolute send time in nanoseconds.
+///\param   [in] message:   The raw MIDI message as byte buffer.
+///\remarks The default implementation does nothing.
+////////////////////////////////////////////////////////////////////////////////
+void MainMIDIWindow::messageSent(const unsigned long long /* timeStamp */, const std::vector<unsigned char>& /* message */)
+{
+  // Nothing to do here.
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -301,7 +499,7 @@ void MainMIDIWindow::sendNoteOn(unsigned char channel, unsigned char noteNumber,
   buff[2] = velocity & 0x7F;
 
   // Send the message:
-  midiOut.sendMessage(&buff);
+  sendMessage(buff);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -325,7 +523,7 @@ void MainMIDIWindow::sendNoteOff(unsigned char channel, unsigned char noteNumber
   buff[2] = velocity & 0x7F;
 
   // Send the message:
-  midiOut.sendMessage(&buff);
+  sendMessage(buff);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -349,7 +547,7 @@ void MainMIDIWindow::sendControlChange(unsigned char channel, unsigned char cont
   buff[2] = value & 0x7F;
 
   // Send the message:
-  midiOut.sendMessage(&buff);
+  sendMessage(buff);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -371,7 +569,7 @@ void MainMIDIWindow::sendProgramChange(unsigned char channel, unsigned char valu
   buff[1] = value & 0x7F;
 
   // Send the message:
-  midiOut.sendMessage(&buff);
+  sendMessage(buff);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -393,7 +591,7 @@ void MainMIDIWindow::sendChannelAftertouch(unsigned char channel, unsigned char
   buff[1] = value & 0x7F;
 
   // Send the message:
-  midiOut.sendMessage(&buff);
+  sendMessage(buff);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -416,7 +614,7 @@ void MainMIDIWindow::sendPitchBend(unsigned char channel, unsigned short value)
   buff[2] = (value >> 7) & 0x7F;
 
   // Send the message:
-  midiOut.sendMessage(&buff);
+  sendMessage(buff);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -440,18 +638,20 @@ void MainMIDIWindow::sendPolyAftertouch(unsigned char channel, unsigned char not
   buff[2] = value & 0x7F;
 
   // Send the message:
-  midiOut.sendMessage(&buff);
+  sendMessage(buff);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // MainMIDIWindow::onMIDIMessage()
 ////////////////////////////////////////////////////////////////////////////////
 ///\brief   Callback for incoming MIDI messages.
-///\param   [in] timeStamp: Time stamp of the message.
+///\param   [in] timeStamp: Absolute arrival time in nanoseconds.
 ///\param   [in] message:   The raw MIDI message as byte buffer.
-///\remarks Updates the surface depending on the MIDI data.
+///\remarks Updates the surface depending on the MIDI data. This is
+///         called from the MIDI input thread. The time stamp uses the
+///         clock of RtMidi::getMonotonicTime().
 ////////////////////////////////////////////////////////////////////////////////
-void MainMIDIWindow::onMIDIMessage(const double /* timeStamp */, const std::vector<unsigned char>& message)
+void MainMIDIWindow::onMIDIMessage(const unsigned long long /* timeStamp */, const std::vector<unsigned char>& message)
 {
   // Get status:
   unsigned char status  = message.at(0) & 0xF0;
@@ -528,16 +728,29 @@ void MainMIDIWindow::Sleep(int milliSeconds)
 // MainMIDIWindow::onMIDIMessageProxy()
 ////////////////////////////////////////////////////////////////////////////////
 ///\brief   Callback for incoming MIDI messages.
-///\param   [in] timeStamp: Time stamp of the message.
+///\param   [in] timeStamp: Absolute arrival time in nanoseconds.
+///\param   [in] deltaTime: Seconds since the previous message.
 ///\param   [in] message:   The raw MIDI message as byte buffer.
 ///\param   [in] userData:  User data set when the port was created.
 ///\remarks The userData holds a pointer to this class so this function
 ///         delegates the call to the member function of the class.
 ////////////////////////////////////////////////////////////////////////////////
-void MainMIDIWindow::onMIDIMessageProxy(double timeStamp, std::vector<unsigned char>* message, void* userData)
+void MainMIDIWindow::onMIDIMessageProxy(unsigned long long timeStamp, double /* deltaTime */, std::vector<unsigned char>* message, void* userData)
 {
+  // Log and count:
+  MainMIDIWindow* window = static_cast<MainMIDIWindow*>(userData);
+  window->trace.add(MIDITrace::INBOUND, timeStamp, *message);
+  window->captureLog.write(MIDILog::INBOUND, timeStamp, *message);
+  window->statistics.messageReceived(*message);
+
   // Delegate to the class function:
-  static_cast<MainMIDIWindow*>(userData)->onMIDIMessage(timeStamp, *message);
+  window->messageDeferred = false;
+  window->onMIDIMessage(timeStamp, *message);
+
+  // Count the time until the user interface was updated, unless the handler
+  // left the update to a later frame:
+  if (!window->messageDeferred)
+    window->statistics.messageApplied(RtMidi::getMonotonicTime() - timeStamp);
 }
 
 ///////////////////////////////// End of File //////////////////////////////////
@@ -32,6 +32,9 @@
 #include <QtWidgets>
 #endif
 #include "RtMidi/RtMidi.h"
+#include "midilog.h"
+#include "midistatistics.h"
+#include "miditrace.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 ///\class MainMIDIWindow mainmidiwindow.h
@@ -61,13 +64,68 @@ public:
   //////////////////////////////////////////////////////////////////////////////
   ~MainMIDIWindow();
 
+  //////////////////////////////////////////////////////////////////////////////
+  // MainMIDIWindow::startCapture()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Record all MIDI traffic to a log file.
+  ///\param   [in] fileName: The log file, new messages are appended.
+  ///\return  Returns true if successfull or false otherwise.
+  ///\remarks The log can be played back with the dtreplay tool.
+  //////////////////////////////////////////////////////////////////////////////
+  bool startCapture(const QString& fileName);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainMIDIWindow::stopCapture()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Stop recording the MIDI traffic and close the log file.
+  //////////////////////////////////////////////////////////////////////////////
+  void stopCapture();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainMIDIWindow::getTrace()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Access the trace of the recent MIDI traffic.
+  ///\return  The trace.
+  ///\remarks All messages in and out are traced, it is always on.
+  //////////////////////////////////////////////////////////////////////////////
+  const MIDITrace& getTrace() const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainMIDIWindow::getStatistics()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Report the counters of the MIDI engine.
+  ///\param   [in] json: Make a JSON report instead of a readable one?
+  ///\return  The report.
+  //////////////////////////////////////////////////////////////////////////////
+  QString getStatistics(bool json = false);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainMIDIWindow::resetStatistics()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Set the counters of the MIDI engine to zero.
+  ///\remarks The driver counters (wire bytes, dropped messages) keep
+  ///         counting from the opening of the ports.
+  //////////////////////////////////////////////////////////////////////////////
+  void resetStatistics();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainMIDIWindow::startStatisticsDump()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Write the JSON report to a file periodically.
+  ///\param   [in] fileName:     The file, it is replaced each time.
+  ///\param   [in] milliSeconds: Time between two reports.
+  //////////////////////////////////////////////////////////////////////////////
+  void startStatisticsDump(const QString& fileName, int milliSeconds);
+
 protected:
   //////////////////////////////////////////////////////////////////////////////
   // MainMIDIWindow::openMIDIPorts()
   //////////////////////////////////////////////////////////////////////////////
   ///\brief   Open the MIDI devices for input/output.
   ///\return  Returns true if successfull or false otherwise.
-  ///\remarks Always closes the port priot trying to open them again.
+  ///\remarks Always closes the port priot trying to open them again. The
+  ///         MIDI objects are recreated each time so a changed midiApi takes
+  ///         effect.
   //////////////////////////////////////////////////////////////////////////////
   virtual bool openMIDIPorts();
 
@@ -80,6 +138,16 @@ protected:
   //////////////////////////////////////////////////////////////////////////////
   virtual bool showSetupWindow();
 
+  //////////////////////////////////////////////////////////////////////////////
+  // MainMIDIWindow::getSchedulingInfo()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Describe the scheduling the MIDI input thread actually got.
+  ///\return  A human readable description like "Real-time (FIFO), priority
+  ///         70" that can be shown in diagnostics.
+  ///\remarks The requested class is only granted if the system allows it.
+  //////////////////////////////////////////////////////////////////////////////
+  QString getSchedulingInfo();
+
   //////////////////////////////////////////////////////////////////////////////
   // MainMIDIWindow::noteOnReceived()
   //////////////////////////////////////////////////////////////////////////////
@@ -156,6 +224,29 @@ protected:
   //////////////////////////////////////////////////////////////////////////////
   virtual void sysExReceived(const std::vector<unsigned char>& buff);
 
+  //////////////////////////////////////////////////////////////////////////////
+  // MainMIDIWindow::sendMessage()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Send a raw MIDI message.
+  ///\param   [in] message: The complete MIDI message as byte buffer.
+  ///\remarks All outgoing messages pass this function. It takes the time
+  ///         stamp right before the message is handed to the driver and
+  ///         reports both to messageSent().
+  //////////////////////////////////////////////////////////////////////////////
+  virtual void sendMessage(std::vector<unsigned char>& message);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainMIDIWindow::messageSent()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   This is called after a MIDI message was sent.
+  ///\param   [in] timeStamp: Absolute send time in nanoseconds.
+  ///\param   [in] message:   The raw MIDI message as byte buffer.
+  ///\remarks The time stamp uses the same clock as the ones of incoming
+  ///         messages (see RtMidi::getMonotonicTime()), so both can be
+  ///         compared directly. The default implementation does nothing.
+  //////////////////////////////////////////////////////////////////////////////
+  virtual void messageSent(const unsigned long long timeStamp, const std::vector<unsigned char>& message);
+
   //////////////////////////////////////////////////////////////////////////////
   // MainMIDIWindow::sendNoteOn()
   //////////////////////////////////////////////////////////////////////////////
@@ -227,11 +318,13 @@ protected:
   // MainMIDIWindow::onMIDIMessage()
   //////////////////////////////////////////////////////////////////////////////
   ///\brief   Callback for incoming MIDI messages.
-  ///\param   [in] timeStamp: Time stamp of the message.
+  ///\param   [in] timeStamp: Absolute arrival time in nanoseconds.
   ///\param   [in] message:   The raw MIDI message as byte buffer.
-  ///\remarks Updates the surface depending on the MIDI data.
+  ///\remarks Updates the surface depending on the MIDI data. This is
+  ///         called from the MIDI input thread. The time stamp uses the
+  ///         clock of RtMidi::getMonotonicTime().
   //////////////////////////////////////////////////////////////////////////////
-  virtual void onMIDIMessage(const double timeStamp, const std::vector<unsigned char>& message);
+  virtual void onMIDIMessage(const unsigned long long timeStamp, const std::vector<unsigned char>& message);
 
   ////////////////////////////////////////////////////////////////////////////////
   // MainMIDIWindow::Sleep()
@@ -243,11 +336,29 @@ protected:
 
   //////////////////////////////////////////////////////////////////////////////
   // Member:
-  QString   midiInName;  ///> Name of the active MIDI input.
-  QString   midiOutName; ///> Name of the active MIDI output.
-  bool      midiOK;      ///> Is the MIDI system up and running?
-  RtMidiIn  midiIn;      ///> The MIDI input used.
-  RtMidiOut midiOut;     ///> The MIDI output used.
+  QString            midiInName;        ///> Name of the active MIDI input.
+  QString            midiOutName;       ///> Name of the active MIDI output.
+  bool               midiOK;            ///> Is the MIDI system up and running?
+  bool               midiRunningStatus; ///> Use running status on raw byte outputs?
+  RtMidi::Api        midiApi;           ///> The MIDI driver API to use.
+  RtMidi::Scheduling midiScheduling;    ///> Requested scheduling of the MIDI input thread.
+  int                midiPriority;      ///> Requested real-time priority of the MIDI input thread.
+  RtMidiIn*          midiIn;            ///> The MIDI input used (0 until opened).
+  RtMidiOut*         midiOut;           ///> The MIDI output used (0 until opened).
+  MIDILog            captureLog;        ///> Log of the MIDI traffic (if capturing).
+  MIDIStatistics     statistics;        ///> Counters of the MIDI engine.
+  MIDITrace          trace;             ///> Trace of the recent MIDI traffic.
+  bool               messageDeferred;   ///> Set by a handler that counts the apply latency itself.
+
+private slots:
+  //////////////////////////////////////////////////////////////////////////////
+  // MainMIDIWindow::dumpStatistics()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Write the JSON report to the dump file.
+  ///\remarks The report is written to a temporary file first and then
+  ///         renamed, so readers never see half a report.
+  //////////////////////////////////////////////////////////////////////////////
+  void dumpStatistics();
 
 private:
 
@@ -255,13 +366,19 @@ private:
   // MainMIDIWindow::onMIDIMessageProxy()
   //////////////////////////////////////////////////////////////////////////////
   ///\brief   Callback for incoming MIDI messages.
-  ///\param   [in] timeStamp: Time stamp of the message.
+  ///\param   [in] timeStamp: Absolute arrival time in nanoseconds.
+  ///\param   [in] deltaTime: Seconds since the previous message.
   ///\param   [in] message:   The raw MIDI message as byte buffer.
   ///\param   [in] userData:  User data set when the port was created.
   ///\remarks The userData holds a pointer to this class so this function
   ///         delegates the call to the member function of the class.
   //////////////////////////////////////////////////////////////////////////////
-  static void onMIDIMessageProxy(double timeStamp, std::vector<unsigned char>* message, void* userData);
+  static void onMIDIMessageProxy(unsigned long long timeStamp, double deltaTime, std::vector<unsigned char>* message, void* userData);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  QTimer*            statisticsTimer;   ///> Timer of the statistics dump (0 if off).
+  QString            statisticsFile;    ///> File of the statistics dump.
 };
 
 #endif // #ifndef __MAINMIDIWINDOW_H_INCLUDED__
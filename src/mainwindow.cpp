@@ -28,31 +28,193 @@
 #include "mainmidiwindow.h"
 #include "mainwindow.h"
 #include "aboutdialog.h"
+#include "diagnosticsdialog.h"
+#include "midimonitor.h"
+#include "traceevents.h"
+#include "startupprofile.h"
+#include "imageassets.h"
+#include "namelistmodel.h"
+#include "stageview.h"
+
+// Parameter groups read by getValuesFromDT(), one CC 83 query each:
+static const unsigned char resyncQueries[] = { 0, 17, 18, 19, 29, 30, 31, 32, 33, 34, 35 };
+static const int resyncQueryCount = sizeof(resyncQueries) / sizeof(resyncQueries[0]);
+
+// Milliseconds between two queries, the DT needs time to answer:
+static const int resyncInterval = 50;
+
+// The amp selectors and the controllers that select an amp with its
+// defaults. The history keeps both as the amp parameter:
+static int ampDefaultsControl(int controlNumber)
+{
+  return controlNumber == CC_AMP_A ? CC_AMP_DEF_A : controlNumber == CC_AMP_B ? CC_AMP_DEF_B : -1;
+}
+
+static int ampControl(int controlNumber)
+{
+  return controlNumber == CC_AMP_DEF_A ? CC_AMP_A : controlNumber == CC_AMP_DEF_B ? CC_AMP_B : controlNumber;
+}
+
+// Milliseconds the DT gets to load the defaults of a new voicing or amp
+// before the other values of a preset override them:
+static const int presetDefaultsTime = 50;
+
+// Milliseconds without a resize before the sprite atlases of the new size
+// are built:
+static const int resizeSettleTime = 150;
+
+// Milliseconds without a change that end a wheel or key edit of a dial, it
+// is then a single step in the history:
+static const int dialIdleTime = 500;
+
+// Connect anyway if the first frame is not painted within this many
+// milliseconds, a minimized window may never paint:
+static const int firstFrameTimeout = 1000;
+
+// Position of the edit area in the window:
+static const int panelX0 = 0;
+static const int panelY0 = 22;
+
+// Controls of the reverb and power amp sections, which are created after
+// the first frame:
+static const int deferredControls[] =
+{
+  CC_REV_BYPASS_A, CC_REV_DECAY_A, CC_REV_PREDELAY_A, CC_REV_TONE_A, CC_REV_MIX_A,
+  CC_REV_BYPASS_B, CC_REV_DECAY_B, CC_REV_PREDELAY_B, CC_REV_TONE_B, CC_REV_MIX_B,
+  CC_CLASS_A, CC_XTODE_A, CC_BOOST_A, CC_PI_VOLTAGE_A, CC_CAP_TYPE_A,
+  CC_CLASS_B, CC_XTODE_B, CC_BOOST_B, CC_PI_VOLTAGE_B, CC_CAP_TYPE_B
+};
+static const int deferredControlCount = sizeof(deferredControls) / sizeof(deferredControls[0]);
+
+// Images that only these sections use:
+static const char* const deferredImages[] =
+{
+  "led_yellow", "led_yellow_disabled",
+  "class", "class_disabled", "xtode", "xtode_disabled", "boost", "boost_disabled",
+  "piv", "piv_disabled", "cap", "cap_disabled"
+};
+static const int deferredImageCount = sizeof(deferredImages) / sizeof(deferredImages[0]);
+
+////////////////////////////////////////////////////////////////////////////////
+// isDeferredControl()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Is a control created after the first frame?
+///\param   [in] controlNumber: Controller number of the control.
+///\return  Returns true if it belongs to a reverb or power amp section.
+////////////////////////////////////////////////////////////////////////////////
+static bool isDeferredControl(int controlNumber)
+{
+  for (int i = 0; i < deferredControlCount; i++)
+  {
+    if (deferredControls[i] == controlNumber)
+      return true;
+  }
+  return false;
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 // MainWindow::MainWindow()
 ////////////////////////////////////////////////////////////////////////////////
 ///\brief   Initialization constructor of this window.
-///\param   [in] parent: Parent window for this window.
+///\param   [in] parent:    Parent window for this window.
+///\param   [in] useCanvas: Draw the dials, switches and LEDs on a single
+///                         PanelCanvas instead of using a widget for each?
 ///\remarks Basically initializes the entire gui.
 ////////////////////////////////////////////////////////////////////////////////
-MainWindow::MainWindow(QWidget *parent) :
+MainWindow::MainWindow(QWidget *parent, bool useCanvas) :
   MainMIDIWindow(parent),
-  blocked(false)
+  canvas(0),
+  scheduler(0),
+  sectionsCreated(useCanvas),
+  panelScale(0.0),
+  resizeTimer(0),
+  blocked(false),
+  resyncStep(-1),
+  resyncLocked(false),
+  resyncAgain(false),
+  resyncStart(0),
+  presetStep(-1),
+  diagnostics(0),
+  monitor(0),
+  fastStart(true),
+  framePending(true),
+  startupSynced(false),
+  connectStarted(false),
+  dragControl(-1),
+  dialIdleTimer(0),
+  replaying(false)
 {
   // Init title:
-  setWindowTitle("DT Edit");
+  updateTitle();
   setWindowIcon(QIcon(":/images/dtedit.png"));
 
   // Hide status bar and menu:
   statusBar()->setVisible(false);
   menuBar()->setVisible(false);
+  StartupProfile::mark("window created");
+
+  // The reverb and power amp sections are created after the first frame,
+  // decode their images meanwhile:
+  if (!useCanvas)
+  {
+    QStringList names;
+    for (int i = 0; i < deferredImageCount; i++)
+      names.append(deferredImages[i]);
+    ImageAssets::prefetch(names);
+  }
+  for (int i = 0; i < 128; i++)
+    deferredValues[i] = -1;
 
   // Load background:
-  backPic.load(":/images/back.png");
+  backPic = ImageAssets::image("back");
+  StartupProfile::mark("background decoded");
 
   // Create the main edit area:
+  if (useCanvas)
+    canvas = new PanelCanvas(this);
   createEditArea();
+  StartupProfile::mark("edit area created");
+
+  // Dial edits without the mouse end after a pause:
+  dialIdleTimer = new QTimer(this);
+  dialIdleTimer->setSingleShot(true);
+  dialIdleTimer->setInterval(dialIdleTime);
+  connect(dialIdleTimer, SIGNAL(timeout()), this, SLOT(dialIdle()));
+
+  // Atlases are built once a resize settles:
+  resizeTimer = new QTimer(this);
+  resizeTimer->setSingleShot(true);
+  resizeTimer->setInterval(resizeSettleTime);
+  connect(resizeTimer, SIGNAL(timeout()), this, SLOT(resizeSettled()));
+
+  // Received parameters are applied once per frame:
+  scheduler = new UpdateScheduler(this, &statistics);
+  connect(scheduler, SIGNAL(apply(int, int, bool)), this, SLOT(applyControlChange(int, int, bool)));
+
+  // Remember the layout at scale 1, the panel scales with the window:
+  addPanelWidgets();
+
+  // Diagnostics and the MIDI monitor are reached by keyboard only:
+  QShortcut* diagnosticsShortcut = new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_D), this);
+  connect(diagnosticsShortcut, SIGNAL(activated()), this, SLOT(showDiagnostics()));
+  QShortcut* monitorShortcut = new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_M), this);
+  connect(monitorShortcut, SIGNAL(activated()), this, SLOT(showMonitor()));
+
+  // Presets are opened and saved by keyboard as well:
+  QShortcut* openShortcut = new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_O), this);
+  connect(openShortcut, SIGNAL(activated()), this, SLOT(openPreset()));
+  QShortcut* saveShortcut = new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_S), this);
+  connect(saveShortcut, SIGNAL(activated()), this, SLOT(savePresetAs()));
+
+  // Undo and redo of the edits:
+  QShortcut* undoShortcut = new QShortcut(QKeySequence::Undo, this);
+  connect(undoShortcut, SIGNAL(activated()), this, SLOT(undo()));
+  QShortcut* redoShortcut = new QShortcut(QKeySequence::Redo, this);
+  connect(redoShortcut, SIGNAL(activated()), this, SLOT(redo()));
+
+  // Stage views show the main controls in another window:
+  QShortcut* stageShortcut = new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_N), this);
+  connect(stageShortcut, SIGNAL(activated()), this, SLOT(newStageView()));
 
   // Init size and position (screen center):
   int w = backPic.width();
@@ -64,12 +226,20 @@ MainWindow::MainWindow(QWidget *parent) :
   QSettings settings;
   x = settings.value("mainwindow/x", QVariant(x)).toInt();
   y = settings.value("mainwindow/y", QVariant(y)).toInt();
+  w = qMax(settings.value("mainwindow/width",  QVariant(w)).toInt(), backPic.width()  / 2);
+  h = qMax(settings.value("mainwindow/height", QVariant(h)).toInt(), backPic.height() / 2);
   midiInName  = settings.value("MIDI/inputName",  QVariant("")).toString();
   midiOutName = settings.value("MIDI/outputName", QVariant("")).toString();
-
-  // Place window:
-  setFixedSize(w, h);
-  setGeometry(x, y, width(), height());
+  midiRunningStatus = settings.value("MIDI/runningStatus", QVariant(false)).toBool();
+  midiApi = RtMidi::getCompiledApiByName(settings.value("MIDI/api", QVariant("")).toString().toStdString());
+  midiScheduling = static_cast<RtMidi::Scheduling>(qBound(static_cast<int>(RtMidi::NORMAL_SCHEDULING),
+    settings.value("MIDI/scheduling", QVariant(0)).toInt(), static_cast<int>(RtMidi::ROUND_ROBIN_SCHEDULING)));
+  midiPriority = qBound(1, settings.value("MIDI/rtPriority", QVariant(70)).toInt(), 99);
+
+  // Place window, the panel can be scaled down to half its size:
+  setMinimumSize(backPic.width() / 2, backPic.height() / 2);
+  setGeometry(x, y, w, h);
+  StartupProfile::mark("settings loaded");
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -83,6 +253,92 @@ MainWindow::~MainWindow()
   // Nothing to do here.
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::setFastStart()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Paint the first frame before connecting to the DT?
+///\param   [in] enable: Use the fast start (default)?
+///\remarks Without fast start the ports are opened and the sync is started
+///         in the first showEvent(), before the first frame.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::setFastStart(bool enable)
+{
+  fastStart = enable;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::flushUpdates()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Apply the received control changes without waiting for the next
+///         frame.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::flushUpdates()
+{
+  scheduler->flush();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::loadPreset()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Send the settings of a preset file to the DT.
+///\param   [in] fileName: The preset file.
+///\return  Returns true if the file could be read.
+///\remarks Before the DT is connected the preset is kept and sent right
+///         after the state is synced or the ports are opened in the setup.
+////////////////////////////////////////////////////////////////////////////////
+bool MainWindow::loadPreset(const QString& fileName)
+{
+  Preset preset;
+  if (!preset.load(fileName))
+    return false;
+
+  // Send it now or after the sync:
+  if (midiOK && startupSynced)
+    applyPreset(preset);
+  else
+    pendingPreset = preset;
+
+  // Return to sender:
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::savePreset()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Write the current settings of the DT to a preset file.
+///\param   [in] fileName: The preset file.
+///\return  Returns true if successfull or false otherwise.
+////////////////////////////////////////////////////////////////////////////////
+bool MainWindow::savePreset(const QString& fileName)
+{
+  // Include what is not shown yet:
+  scheduler->flush();
+  return state.save(fileName);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::activate()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for another start of the editor.
+///\param   [in] presetFiles: Preset files of its command line.
+///\remarks Brings the window to the front and loads the presets.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::activate(const QStringList& presetFiles)
+{
+  // Bring the window to the front:
+  if (isMinimized())
+    showNormal();
+  raise();
+  activateWindow();
+
+  // Load the presets, the last one wins:
+  for (int i = 0; i < presetFiles.size(); i++)
+  {
+    if (!loadPreset(presetFiles[i]))
+      QMessageBox::warning(this, tr("DT Edit"), tr("Could not read the preset %1.").arg(presetFiles[i]));
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // MainWindow::closeEvent()
 ////////////////////////////////////////////////////////////////////////////////
@@ -97,10 +353,16 @@ void MainWindow::closeEvent(QCloseEvent* e)
   QRect rc = geometry();
   settings.setValue("mainwindow/x", rc.left());
   settings.setValue("mainwindow/y", rc.top());
+  settings.setValue("mainwindow/width",  rc.width());
+  settings.setValue("mainwindow/height", rc.height());
 
   // Save MIDI state:
   settings.setValue("MIDI/inputName",  midiInName);
   settings.setValue("MIDI/outputName", midiOutName);
+  settings.setValue("MIDI/runningStatus", midiRunningStatus);
+  settings.setValue("MIDI/api", QString(RtMidi::getApiName(midiApi).c_str()));
+  settings.setValue("MIDI/scheduling", static_cast<int>(midiScheduling));
+  settings.setValue("MIDI/rtPriority", midiPriority);
 
   // allow closing:
   e->accept();
@@ -114,20 +376,18 @@ void MainWindow::closeEvent(QCloseEvent* e)
 ////////////////////////////////////////////////////////////////////////////////
 void MainWindow::showEvent(QShowEvent* /*e*/)
 {
-  // Open the MIDI ports and if the opening fails, ask user what to do:
-  while (!openMIDIPorts())
-  {
-    // Get user wish:
-    if (QMessageBox::question(this, tr("MIDI error"), tr("There was an error while establishing the MIDI connection to the device.\n\nWould you like to check the configuration?"), QMessageBox::Yes, QMessageBox::No) != QMessageBox::Yes)
-      return;
+  StartupProfile::mark("window shown");
 
-    // Show the setup dialog:
-    if (!showSetupWindow())
-      return;
+  // With fast start the first frame comes first, paintEvent() connects. A
+  // window that is not painted connects after a while:
+  if (fastStart && framePending)
+  {
+    QTimer::singleShot(firstFrameTimeout, this, SLOT(connectToDT()));
+    return;
   }
 
-  // Get current state:
-  getValuesFromDT();
+  // Connect and get current state:
+  connectToDT();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -138,23 +398,198 @@ void MainWindow::showEvent(QShowEvent* /*e*/)
 ////////////////////////////////////////////////////////////////////////////////
 void MainWindow::paintEvent(QPaintEvent* e)
 {
-  // Update title:
-  if (!versionString.isEmpty())
-    setWindowTitle("DT Edit (connected to " + versionString + ")");
-  else
-    setWindowTitle("DT Edit (not connected)");
+  TRACE_SPAN("UI", "MainWindow::paintEvent");
 
   // Do we have a background image?
   if (backPic.isNull())
   {
     // Let the base class do the painting:
     QWidget::paintEvent(e);
+  }
+  else
+  {
+    // Draw the exposed parts of the back pic. Turning a dial only exposes
+    // the dial's rectangle:
+    updateBackCache();
+    #if QT_VERSION >= 0x050000
+    qreal ratio = backCache.devicePixelRatio();
+    #else
+    qreal ratio = 1.0;
+    #endif
+    QPainter qp(this);
+    QVector<QRect> rects = e->region().rects();
+    for (int i = 0; i < rects.size(); i++)
+    {
+      const QRect& r = rects[i];
+      qp.drawPixmap(r, backCache, QRectF(r.x() * ratio, r.y() * ratio, r.width() * ratio, r.height() * ratio).toRect());
+    }
+  }
+
+  // First frame? Then create the remaining sections and connect to the DT
+  // in fast start mode:
+  if (framePending)
+  {
+    framePending = false;
+    if (!sectionsCreated)
+      QTimer::singleShot(0, this, SLOT(createDeferredSections()));
+    if (startupSynced)
+      StartupProfile::finish("first frame");
+    else
+    {
+      StartupProfile::mark("first frame");
+      if (fastStart)
+        QTimer::singleShot(0, this, SLOT(connectToDT()));
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::updateTitle()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Show the connection state in the window title.
+///\remarks Call this whenever versionString changes.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::updateTitle()
+{
+  QString title = versionString.isEmpty() ? QString("DT Edit (not connected)") : "DT Edit (connected to " + versionString + ")";
+  if (title != windowTitle())
+    setWindowTitle(title);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::showVersion()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Show the version of the connected amp.
+///\param   [in] version: Model and firmware version.
+///\remarks sysExReceived() runs in the MIDI thread and hands the version over
+///         with a queued call.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::showVersion(const QString& version)
+{
+  versionString = version;
+  updateTitle();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::updateBackCache()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Render the background image into the pixmap cache.
+///\remarks Does nothing if the cache matches the current window size and
+///         device pixel ratio.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::updateBackCache()
+{
+  qreal ratio = SpriteAtlas::pixelRatio(this);
+  QSize size(qRound(width() * ratio), qRound(height() * ratio));
+
+  // Up to date?
+  #if QT_VERSION >= 0x050000
+  if (!backCache.isNull() && backCache.size() == size && backCache.devicePixelRatio() == ratio)
+    return;
+  #else
+  if (!backCache.isNull() && backCache.size() == size)
+    return;
+  #endif
+
+  // Render the background once at the resolution of the screen, so painting
+  // is a plain blit of the exposed rectangles:
+  QRect target = SpriteAtlas::scaledRect(panelRect, ratio);
+  if (target == QRect(QPoint(0, 0), size) && target.size() == backPic.size())
+    backCache = QPixmap::fromImage(backPic);
+  else
+  {
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(qRgb(0, 0, 0));
+    QPainter qp(&image);
+    qp.drawImage(target.topLeft(), backPic.scaled(target.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+    qp.end();
+    backCache = QPixmap::fromImage(image);
+  }
+  #if QT_VERSION >= 0x050000
+  backCache.setDevicePixelRatio(ratio);
+  #endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::resizeEvent()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Message handler for the resize event.
+///\param   [in] e: Description of the event.
+///\remarks Scales the panel to the new size.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::resizeEvent(QResizeEvent* e)
+{
+  // Base handling:
+  MainMIDIWindow::resizeEvent(e);
+
+  // Don't build the atlases of every size an interactive resize passes,
+  // the first frame builds them right away though:
+  if (!framePending)
+  {
+    SpriteAtlas::setBuildsDeferred(true);
+    resizeTimer->start();
+  }
+
+  // Scale the panel:
+  layoutPanel();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::resizeSettled()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the end of an interactive resize.
+///\remarks Builds the sprite atlases of the final size.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::resizeSettled()
+{
+  // Paint the controls again, now from their atlases:
+  SpriteAtlas::setBuildsDeferred(false);
+  for (int i = 0; i < panelWidgets.size(); i++)
+    panelWidgets[i]->update();
+  if (canvas != 0)
+    canvas->update();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::layoutPanel()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Scale and center the panel in the window.
+///\remarks The panel keeps its aspect ratio, the controls are placed by
+///         their geometry at scale 1.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::layoutPanel()
+{
+  if (backPic.isNull())
+    return;
+
+  // Largest panel that fits:
+  qreal scale = qMin(width() / static_cast<qreal>(backPic.width()), height() / static_cast<qreal>(backPic.height()));
+  QSize size(qRound(backPic.width() * scale), qRound(backPic.height() * scale));
+  QRect rect(QPoint((width() - size.width()) / 2, (height() - size.height()) / 2), size);
+  if (scale == panelScale && rect == panelRect)
     return;
+  panelScale = scale;
+  panelRect  = rect;
+
+  // Place the controls. The combo boxes get a scaled font, the image
+  // controls scale their images themselves:
+  QFont font = QApplication::font();
+  if (font.pointSizeF() > 0)
+    font.setPointSizeF(font.pointSizeF() * scale);
+  else
+    font.setPixelSize(qMax(1, qRound(font.pixelSize() * scale)));
+  for (int i = 0; i < panelWidgets.size(); i++)
+  {
+    panelWidgets[i]->setGeometry(SpriteAtlas::scaledRect(panelRects[i], scale).translated(rect.topLeft()));
+    if (qobject_cast<QComboBox*>(panelWidgets[i]) != 0)
+      panelWidgets[i]->setFont(font);
   }
+  if (canvas != 0)
+    canvas->setLayoutScale(scale);
 
-  // Draw the back pic:
-  QPainter qp(this);
-  qp.drawImage(0, 0, backPic);
+  // Render the background again on the next paint:
+  backCache = QPixmap();
+  update();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -168,6 +603,7 @@ bool MainWindow::openMIDIPorts()
 {
   // Reset version display:
   versionString = "";
+  updateTitle();
 
   // Base class handling:
   if (!MainMIDIWindow::openMIDIPorts())
@@ -182,7 +618,7 @@ bool MainWindow::openMIDIPorts()
   buff.push_back(0x06);
   buff.push_back(0x01);
   buff.push_back(0xF7);
-  midiOut.sendMessage(&buff);
+  sendMessage(buff);
 
   // Return success:
   return true;
@@ -198,6 +634,8 @@ bool MainWindow::openMIDIPorts()
 ////////////////////////////////////////////////////////////////////////////////
 void MainWindow::controlChangeReceived(unsigned char channel, unsigned char controlNumber, unsigned char value)
 {
+  TRACE_SPAN("MIDI", "MainWindow::controlChangeReceived");
+
   // Are we ment?
   if (channel != DT_MIDI_CHANNEL)
     return;
@@ -212,9 +650,53 @@ void MainWindow::controlChangeReceived(unsigned char channel, unsigned char cont
   if (controlNumber == 126)
     receiving = value >= 64;
 
-  // UI locked?
+  // Parameter values answer a pending CC 83 query:
+  if (controlNumber < 126 && controlNumber != 83)
+    statistics.queryAnswered(RtMidi::getMonotonicTime());
+
+  // UI locked? Then this is the echo of our own change:
   if (blocked)
+  {
+    if (controlNumber < 126)
+      statistics.echoSuppressed();
+    return;
+  }
+
+  // Leave the user interface to the next frame, a burst of changes is
+  // applied in one batch:
+  if (controlNumber < 126)
+  {
+    scheduler->post(controlNumber, value, receiving);
+    messageDeferred = true;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::applyControlChange()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Show a received control change in the user interface.
+///\param   [in] controlNumber: Controller number.
+///\param   [in] value:         Control value.
+///\param   [in] receiving:     Did it arrive during a getValuesFromDT()?
+///\remarks Called by the update scheduler once per frame for each changed
+///         controller. A new voicing starts a sync of the other parameters
+///         that runs in the background, the frame does not wait for it.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::applyControlChange(int controlNumber, int value, bool receiving)
+{
+  // Remember the value for presets and the stage views:
+  updateState(controlNumber, value);
+
+  // Dials, switches and LEDs on the canvas:
+  if (canvas != 0 && canvasControlChange(controlNumber, value, receiving))
+    return;
+
+  // Keep the value of a control that is not created yet:
+  if (!sectionsCreated && isDeferredControl(controlNumber))
+  {
+    deferredValues[controlNumber] = value;
     return;
+  }
 
   bool oldState;
   switch (controlNumber)
@@ -471,6 +953,32 @@ void MainWindow::controlChangeReceived(unsigned char channel, unsigned char cont
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::canvasControlChange()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Show a received control change on the panel canvas.
+///\param   [in] controlNumber: Controller number.
+///\param   [in] value:         Control value.
+///\param   [in] receiving:     Is a getValuesFromDT() request running?
+///\return  Returns false if no control on the canvas has this number.
+///\remarks The canvas converts the values like controlChangeReceived() does
+///         for the widgets. The LEDs follow their switches by themselves.
+////////////////////////////////////////////////////////////////////////////////
+bool MainWindow::canvasControlChange(unsigned char controlNumber, unsigned char value, bool receiving)
+{
+  // A new voicing must be read back, the DT loads its defaults:
+  int index = canvas->indexOfTag(controlNumber);
+  if (index < 0)
+    return false;
+  int oldStep = canvas->step(index);
+  canvas->setControllerValue(controlNumber, value);
+  if ((controlNumber == CC_VOICE_A || controlNumber == CC_VOICE_B) && !receiving && canvas->step(index) != oldStep)
+    getValuesFromDT(true);
+
+  // Return to sender:
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // MainWindow::sysExReceived()
 ////////////////////////////////////////////////////////////////////////////////
@@ -494,39 +1002,40 @@ void MainWindow::sysExReceived(const std::vector<unsigned char>& buff)
       return;
 
     // Get model:
+    QString version;
     int model = buff[10];
     switch (model)
     {
     case 0:
-      versionString = "DT50 1x12 Combo";
+      version = "DT50 1x12 Combo";
       break;
     case 1:
-      versionString = "DT50 212 Combo";
+      version = "DT50 212 Combo";
       break;
     case 2:
-      versionString = "DT50 Head";
+      version = "DT50 Head";
       break;
     case 3:
-      versionString = "DT25 1x12 Combo";
+      version = "DT25 1x12 Combo";
       break;
     case 4:
-      versionString = "DT25 Head";
+      version = "DT25 Head";
       break;
     default:
-      versionString = "Unknown DT model";
+      version = "Unknown DT model";
       break;
     }
 
     // Add version:
-    versionString += " v";
-    //versionString += (char)buff[12]; // Leading space. Add again if firmware version reaches 10.00
-    versionString += (char)buff[13];
-    versionString += '.';
-    versionString += (char)buff[14];
-    versionString += (char)buff[15];
-
-    // Force a redraw:
-    update();
+    version += " v";
+    //version += (char)buff[12]; // Leading space. Add again if firmware version reaches 10.00
+    version += (char)buff[13];
+    version += '.';
+    version += (char)buff[14];
+    version += (char)buff[15];
+
+    // Show it, this runs in the MIDI thread:
+    QMetaObject::invokeMethod(this, "showVersion", Qt::QueuedConnection, Q_ARG(QString, version));
   }
 }
 
@@ -537,108 +1046,112 @@ void MainWindow::sysExReceived(const std::vector<unsigned char>& buff)
 ////////////////////////////////////////////////////////////////////////////////
 void MainWindow::createEditArea()
 {
-  int x0 = 0;
-  int y0 = 22;
+  int x0 = panelX0;
+  int y0 = panelY0;
   #ifdef __LINUX_ALSA__
   QString comboStyle("QComboBox { border: 1px solid black; }");
   #else
   QString comboStyle("QComboBox { background: #202020; color: white; border: 1px solid #606060; }");
   #endif
 
-  QPixmap I_II_III_IV(":/images/I_II_III_IV.png");
-  QPixmap I_II_III_IV_disabled(":/images/I_II_III_IV_disabled.png");
-  QPixmap knob_movie(":/images/knob_movie.png");
-  QPixmap knob_disabled(":/images/knob_disabled.png");
-  QPixmap led_yellow(":/images/led_yellow.png");
-  QPixmap led_yellow_disabled(":/images/led_yellow_disabled.png");
-  QPixmap onoff(":/images/onoff.png");
-  QPixmap onoff_disabled(":/images/onoff_disabled.png");
-  QPixmap classAB(":/images/class.png");
-  QPixmap class_disabled(":/images/class_disabled.png");
-  QPixmap xtode(":/images/xtode.png");
-  QPixmap xtode_disabled(":/images/xtode_disabled.png");
-  QPixmap boost(":/images/boost.png");
-  QPixmap boost_disabled(":/images/boost_disabled.png");
-  QPixmap piv(":/images/piv.png");
-  QPixmap piv_disabled(":/images/piv_disabled.png");
-  QPixmap cap(":/images/cap.png");
-  QPixmap cap_disabled(":/images/cap_disabled.png");
-  QPixmap channelImg(":/images/channel.png");
-  QPixmap channel_disabled(":/images/channel_disabled.png");
-  QPixmap led_red(":/images/led_red.png");
-  QPixmap led_red_disabled(":/images/led_red_disabled.png");
-  QPixmap midi(":/images/midi.png");
-  QPixmap midi_disabled(":/images/midi_disabled.png");
-  QPixmap about(":/images/about.png");
-  QPixmap about_disabled(":/images/about_disabled.png");
-
-  voiceA = new QImageToggle4(this);
-  voiceA->setGeometry(x0 + 34, y0 + 30, 48, 48);
-  voiceA->setImage(I_II_III_IV);
-  voiceA->setDisabledImage(I_II_III_IV_disabled);
-  voiceA->setEnabled(true);
-  voiceA->setTag(CC_VOICE_A);
-  connect(voiceA, SIGNAL(valueChanged()), this, SLOT(toggle4Changed()));
+  // Dials, switches and LEDs:
+  if (canvas != 0)
+    createCanvasControls(x0, y0);
+  else
+    createControlWidgets(x0, y0);
 
   ampA = new QComboBox(this);
-  ampA->addItem("None");
-  ampA->addItem("Blackface Double Normal");
-  ampA->addItem("Blackface Double Vib");
-  ampA->addItem("Hiway 100");
-  ampA->addItem("Super O");
-  ampA->addItem("Gibtone 185");
-  ampA->addItem("Tweed B-Man Normal");
-  ampA->addItem("Tweed B-Man Bright");
-  ampA->addItem("Blackface 'Lux Normal");
-  ampA->addItem("Blackface 'Lux Vib");
-  ampA->addItem("Divide 9/15");
-  ampA->addItem("Phd Motorway");
-  ampA->addItem("Class A-15");
-  ampA->addItem("Class A-30");
-  ampA->addItem("Brit J-45 Normal");
-  ampA->addItem("Brit J-45 Bright");
-  ampA->addItem("Brit Plexi 100 Normal");
-  ampA->addItem("Brit Plexi 100 Bright");
-  ampA->addItem("Brit P-75 Normal");
-  ampA->addItem("Brit P-75 Bright");
-  ampA->addItem("Brit J-800");
-  ampA->addItem("Bomber Uber");
-  ampA->addItem("Treadplate");
-  ampA->addItem("Angel F-Ball");
-  ampA->addItem("Line 6 Elektrik");
-  ampA->addItem("Flip Top (Bass)");
-  ampA->addItem("Solo 100 Clean");
-  ampA->addItem("Solo 100 Crunch");
-  ampA->addItem("Solo 100 Overdrive");
-  ampA->addItem("Line 6 Doom");
-  ampA->addItem("Line 6 Epic");
+  ampA->setModel(NameListModel::amps());
   ampA->setGeometry(x0 + 142, y0 + 34, 134, 22);
   ampA->setStyleSheet(comboStyle);
   connect(ampA, SIGNAL(currentIndexChanged(int)), this, SLOT(ampAChanged(int)));
 
   cabA = new QComboBox(this);
-  cabA->addItem("None");
-  cabA->addItem("2x12 Blackface Double");
-  cabA->addItem("4x12 Hiway");
-  cabA->addItem("1x(6x9) Super O");
-  cabA->addItem("1x12 Gibtone F-Coil");
-  cabA->addItem("4x10 Tweed B-Man");
-  cabA->addItem("1x12 Blackface â€˜Lux");
-  cabA->addItem("1x12 Brit 12-H");
-  cabA->addItem("2x12 PhD Ported");
-  cabA->addItem("1x12 Blue Bell");
-  cabA->addItem("2x12 Silver Bell");
-  cabA->addItem("4x12 Greenback 25");
-  cabA->addItem("4x12 Blackback 30");
-  cabA->addItem("4x12 Brit T-75");
-  cabA->addItem("4x12 Uber");
-  cabA->addItem("4x12 Tread V-30");
-  cabA->addItem("4x12 XXL V-30");
-  cabA->addItem("1x15 Flip Top (Bass)");
+  cabA->setModel(NameListModel::cabs());
   cabA->setGeometry(x0 + 142, y0 + 64, 134, 22);
   cabA->setStyleSheet(comboStyle);
   connect(cabA, SIGNAL(currentIndexChanged(int)), this, SLOT(cabAChanged(int)));
 
+  reverbA = new QComboBox(this);
+  reverbA->setModel(NameListModel::reverbs());
+  reverbA->setGeometry(x0 + 280, y0 + 168, 134, 22);
+  reverbA->setStyleSheet(comboStyle);
+  connect(reverbA, SIGNAL(currentIndexChanged(int)), this, SLOT(reverbAChanged(int)));
+
+  ampB = new QComboBox(this);
+  ampB->setModel(NameListModel::amps());
+  ampB->setGeometry(x0 + 143, y0 + 340, 134, 22);
+  ampB->setStyleSheet(comboStyle);
+  connect(ampB, SIGNAL(currentIndexChanged(int)), this, SLOT(ampBChanged(int)));
+
+  cabB = new QComboBox(this);
+  cabB->setModel(NameListModel::cabs());
+  cabB->setGeometry(x0 + 143, y0 + 370, 134, 22);
+  cabB->setStyleSheet(comboStyle);
+  connect(cabB, SIGNAL(currentIndexChanged(int)), this, SLOT(cabBChanged(int)));
+
+  reverbB = new QComboBox(this);
+  reverbB->setModel(NameListModel::reverbs());
+  reverbB->setGeometry(x0 + 280, y0 + 270, 134, 22);
+  reverbB->setStyleSheet(comboStyle);
+  connect(reverbB, SIGNAL(currentIndexChanged(int)), this, SLOT(reverbBChanged(int)));
+
+  mic = new QComboBox(this);
+  mic->setModel(NameListModel::mics());
+  mic->setGeometry(x0 + 62, y0 + 270, 134, 22);
+  mic->setStyleSheet(comboStyle);
+  connect(mic, SIGNAL(currentIndexChanged(int)), this, SLOT(micChanged(int)));
+
+  QPixmap midi(ImageAssets::pixmap("midi"));
+  QPixmap midi_disabled(ImageAssets::pixmap("midi_disabled"));
+  QPixmap about(ImageAssets::pixmap("about"));
+  QPixmap about_disabled(ImageAssets::pixmap("about_disabled"));
+
+  QImageButton* midiButton = new QImageButton(this);
+  midiButton->setGeometry(x0 + 11, y0 - 18, 65, 15);
+  midiButton->setImage(midi);
+  midiButton->setDisabledImage(midi_disabled);
+  midiButton->setEnabled(true);
+  connect(midiButton, SIGNAL(clicked()), this, SLOT(setupMIDI()));
+
+  QImageButton* aboutButton = new QImageButton(this);
+  aboutButton->setGeometry(x0 + 80, y0 - 18, 65, 15);
+  aboutButton->setImage(about);
+  aboutButton->setDisabledImage(about_disabled);
+  aboutButton->setEnabled(true);
+  connect(aboutButton, SIGNAL(clicked()), this, SLOT(about()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::createControlWidgets()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Create the dials, switches and LEDs as widgets.
+///\param   [in] x0: Left edge of the edit area.
+///\param   [in] y0: Top edge of the edit area.
+///\remarks The reverb and power amp sections follow in
+///         createDeferredSections().
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::createControlWidgets(int x0, int y0)
+{
+  QPixmap I_II_III_IV(ImageAssets::pixmap("I_II_III_IV"));
+  QPixmap I_II_III_IV_disabled(ImageAssets::pixmap("I_II_III_IV_disabled"));
+  QPixmap knob_movie(ImageAssets::pixmap("knob_movie"));
+  QPixmap knob_disabled(ImageAssets::pixmap("knob_disabled"));
+  QPixmap onoff(ImageAssets::pixmap("onoff"));
+  QPixmap onoff_disabled(ImageAssets::pixmap("onoff_disabled"));
+  QPixmap channelImg(ImageAssets::pixmap("channel"));
+  QPixmap channel_disabled(ImageAssets::pixmap("channel_disabled"));
+  QPixmap led_red(ImageAssets::pixmap("led_red"));
+  QPixmap led_red_disabled(ImageAssets::pixmap("led_red_disabled"));
+
+  voiceA = new QImageToggle4(this);
+  voiceA->setGeometry(x0 + 34, y0 + 30, 48, 48);
+  voiceA->setImage(I_II_III_IV);
+  voiceA->setDisabledImage(I_II_III_IV_disabled);
+  voiceA->setEnabled(true);
+  voiceA->setTag(CC_VOICE_A);
+  connect(voiceA, SIGNAL(valueChanged()), this, SLOT(toggle4Changed()));
+
   gainA = new QImageDial(this);
   gainA->setImage(knob_movie);
   gainA->setDisabledImage(knob_disabled);
@@ -699,128 +1212,13 @@ void MainWindow::createEditArea()
   connect(volumeA, SIGNAL(valueChanged()), this, SLOT(rotaryChanged()));
   connect(volumeA, SIGNAL(mouseReleased()), this, SLOT(rotaryReleased()));
 
-  reverbA = new QComboBox(this);
-  reverbA->addItem("None");
-  reverbA->addItem("Spring");
-  reverbA->addItem("'63 Spring");
-  reverbA->addItem("Plate");
-  reverbA->addItem("Room");
-  reverbA->addItem("Chamber");
-  reverbA->addItem("Hall");
-  reverbA->addItem("Cave");
-  reverbA->addItem("Ducking");
-  reverbA->addItem("Octo");
-  reverbA->addItem("Tile");
-  reverbA->addItem("Echo");
-  reverbA->addItem("Particle Verb");
-  reverbA->setGeometry(x0 + 280, y0 + 168, 134, 22);
-  reverbA->setStyleSheet(comboStyle);
-  connect(reverbA, SIGNAL(currentIndexChanged(int)), this, SLOT(reverbAChanged(int)));
-
-  reverbLedA = new QImageLED(this);
-  reverbLedA->setImage(led_yellow);
-  reverbLedA->setDisabledImage(led_yellow_disabled);
-  reverbLedA->setGeometry(x0 + 244, y0 + 130, 31, 31);
-  reverbLedA->setEnabled(true);
-  reverbLedA->setValue(true);
-
-  reverbBypassA = new QImageToggle(this);
-  reverbBypassA->setGeometry(x0 + 275, y0 + 130, 44, 31);
-  reverbBypassA->setImage(onoff);
-  reverbBypassA->setDisabledImage(onoff_disabled);
-  reverbBypassA->setEnabled(true);
-  reverbBypassA->setTag(CC_REV_BYPASS_A);
-  reverbBypassA->setLeftRight(true);
-  reverbBypassA->setValue(true);
-  connect(reverbBypassA, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
-
-  reverbDecayA = new QImageDial(this);
-  reverbDecayA->setImage(knob_movie);
-  reverbDecayA->setDisabledImage(knob_disabled);
-  reverbDecayA->setFrameCount(61);
-  reverbDecayA->setEnabled(true);
-  reverbDecayA->setGeometry(x0 + 431, y0 + 133, 48, 48);
-  reverbDecayA->setTag(CC_REV_DECAY_A);
-  connect(reverbDecayA, SIGNAL(valueChanged()), this, SLOT(rotaryChanged()));
-  connect(reverbDecayA, SIGNAL(mouseReleased()), this, SLOT(rotaryReleased()));
-
-  reverbPredelayA = new QImageDial(this);
-  reverbPredelayA->setImage(knob_movie);
-  reverbPredelayA->setDisabledImage(knob_disabled);
-  reverbPredelayA->setFrameCount(61);
-  reverbPredelayA->setEnabled(true);
-  reverbPredelayA->setGeometry(x0 + 495, y0 + 133, 48, 48);
-  reverbPredelayA->setTag(CC_REV_PREDELAY_A);
-  connect(reverbPredelayA, SIGNAL(valueChanged()), this, SLOT(rotaryChanged()));
-  connect(reverbPredelayA, SIGNAL(mouseReleased()), this, SLOT(rotaryReleased()));
-
-  reverbToneA = new QImageDial(this);
-  reverbToneA->setImage(knob_movie);
-  reverbToneA->setDisabledImage(knob_disabled);
-  reverbToneA->setFrameCount(61);
-  reverbToneA->setEnabled(true);
-  reverbToneA->setGeometry(x0 + 559, y0 + 133, 48, 48);
-  reverbToneA->setTag(CC_REV_TONE_A);
-  connect(reverbToneA, SIGNAL(valueChanged()), this, SLOT(rotaryChanged()));
-  connect(reverbToneA, SIGNAL(mouseReleased()), this, SLOT(rotaryReleased()));
-
-  reverbMixA = new QImageDial(this);
-  reverbMixA->setImage(knob_movie);
-  reverbMixA->setDisabledImage(knob_disabled);
-  reverbMixA->setFrameCount(61);
-  reverbMixA->setEnabled(true);
-  reverbMixA->setGeometry(x0 + 623, y0 + 133, 48, 48);
-  reverbMixA->setTag(CC_REV_MIX_A);
-  connect(reverbMixA, SIGNAL(valueChanged()), this, SLOT(rotaryChanged()));
-  connect(reverbMixA, SIGNAL(mouseReleased()), this, SLOT(rotaryReleased()));
-
-  classA = new QImageToggle(this);
-  classA->setGeometry(x0 + 720, y0 + 23, 64, 88);
-  classA->setImage(classAB);
-  classA->setDisabledImage(class_disabled);
-  classA->setEnabled(true);
-  classA->setTag(CC_CLASS_A);
-  connect(classA, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
-
-  topolA = new QImageToggle4(this);
-  topolA->setGeometry(x0 + 804, y0 + 38, 48, 48);
-  topolA->setImage(I_II_III_IV);
-  topolA->setDisabledImage(I_II_III_IV_disabled);
-  topolA->setEnabled(true);
-  topolA->setTag(CC_TOPOL_A);
-  connect(topolA, SIGNAL(valueChanged()), this, SLOT(toggle4Changed()));
-
-  xtodeA = new QImageToggle(this);
-  xtodeA->setGeometry(x0 + 871, y0 + 23, 64, 88);
-  xtodeA->setImage(xtode);
-  xtodeA->setDisabledImage(xtode_disabled);
-  xtodeA->setEnabled(true);
-  xtodeA->setTag(CC_XTODE_A);
-  connect(xtodeA, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
-
-  boostA = new QImageToggle(this);
-  boostA->setGeometry(x0 + 720, y0 + 112, 64, 88);
-  boostA->setImage(boost);
-  boostA->setDisabledImage(boost_disabled);
-  boostA->setEnabled(true);
-  boostA->setTag(CC_BOOST_A);
-  connect(boostA, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
-
-  pivoltA = new QImageToggle(this);
-  pivoltA->setGeometry(x0 + 795, y0 + 112, 64, 88);
-  pivoltA->setImage(piv);
-  pivoltA->setDisabledImage(piv_disabled);
-  pivoltA->setEnabled(true);
-  pivoltA->setTag(CC_PI_VOLTAGE_A);
-  connect(pivoltA, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
-
-  capA = new QImageToggle(this);
-  capA->setGeometry(x0 + 871, y0 + 112, 64, 88);
-  capA->setImage(cap);
-  capA->setDisabledImage(cap_disabled);
-  capA->setEnabled(true);
-  capA->setTag(CC_CAP_TYPE_A);
-  connect(capA, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
+  topolA = new QImageToggle4(this);
+  topolA->setGeometry(x0 + 804, y0 + 38, 48, 48);
+  topolA->setImage(I_II_III_IV);
+  topolA->setDisabledImage(I_II_III_IV_disabled);
+  topolA->setEnabled(true);
+  topolA->setTag(CC_TOPOL_A);
+  connect(topolA, SIGNAL(valueChanged()), this, SLOT(toggle4Changed()));
 
   voiceB = new QImageToggle4(this);
   voiceB->setGeometry(x0 + 34, y0 + 336, 48, 48);
@@ -830,65 +1228,6 @@ void MainWindow::createEditArea()
   voiceB->setTag(CC_VOICE_B);
   connect(voiceB, SIGNAL(valueChanged()), this, SLOT(toggle4Changed()));
 
-  ampB = new QComboBox(this);
-  ampB->addItem("None");
-  ampB->addItem("Blackface Double Normal");
-  ampB->addItem("Blackface Double Vib");
-  ampB->addItem("Hiway 100");
-  ampB->addItem("Super O");
-  ampB->addItem("Gibtone 185");
-  ampB->addItem("Tweed B-Man Normal");
-  ampB->addItem("Tweed B-Man Bright");
-  ampB->addItem("Blackface 'Lux Normal");
-  ampB->addItem("Blackface 'Lux Vib");
-  ampB->addItem("Divide 9/15");
-  ampB->addItem("Phd Motorway");
-  ampB->addItem("Class A-15");
-  ampB->addItem("Class A-30");
-  ampB->addItem("Brit J-45 Normal");
-  ampB->addItem("Brit J-45 Bright");
-  ampB->addItem("Brit Plexi 100 Normal");
-  ampB->addItem("Brit Plexi 100 Bright");
-  ampB->addItem("Brit P-75 Normal");
-  ampB->addItem("Brit P-75 Bright");
-  ampB->addItem("Brit J-800");
-  ampB->addItem("Bomber Uber");
-  ampB->addItem("Treadplate");
-  ampB->addItem("Angel F-Ball");
-  ampB->addItem("Line 6 Elektrik");
-  ampB->addItem("Flip Top (Bass)");
-  ampB->addItem("Solo 100 Clean");
-  ampB->addItem("Solo 100 Crunch");
-  ampB->addItem("Solo 100 Overdrive");
-  ampB->addItem("Line 6 Doom");
-  ampB->addItem("Line 6 Epic");
-  ampB->setGeometry(x0 + 143, y0 + 340, 134, 22);
-  ampB->setStyleSheet(comboStyle);
-  connect(ampB, SIGNAL(currentIndexChanged(int)), this, SLOT(ampBChanged(int)));
-
-  cabB = new QComboBox(this);
-  cabB->addItem("None");
-  cabB->addItem("2x12 Blackface Double");
-  cabB->addItem("4x12 Hiway");
-  cabB->addItem("1x(6x9) Super O");
-  cabB->addItem("1x12 Gibtone F-Coil");
-  cabB->addItem("4x10 Tweed B-Man");
-  cabB->addItem("1x12 Blackface â€˜Lux");
-  cabB->addItem("1x12 Brit 12-H");
-  cabB->addItem("2x12 PhD Ported");
-  cabB->addItem("1x12 Blue Bell");
-  cabB->addItem("2x12 Silver Bell");
-  cabB->addItem("4x12 Greenback 25");
-  cabB->addItem("4x12 Blackback 30");
-  cabB->addItem("4x12 Brit T-75");
-  cabB->addItem("4x12 Uber");
-  cabB->addItem("4x12 Tread V-30");
-  cabB->addItem("4x12 XXL V-30");
-  cabB->addItem("1x15 Flip Top (Bass)");
-  cabB->setGeometry(x0 + 143, y0 + 370, 134, 22);
-  cabB->setStyleSheet(comboStyle);
-  connect(cabB, SIGNAL(currentIndexChanged(int)), this, SLOT(cabBChanged(int)));
-
   gainB = new QImageDial(this);
   gainB->setImage(knob_movie);
   gainB->setDisabledImage(knob_disabled);
@@ -949,23 +1288,177 @@ void MainWindow::createEditArea()
   connect(volumeB, SIGNAL(valueChanged()), this, SLOT(rotaryChanged()));
   connect(volumeB, SIGNAL(mouseReleased()), this, SLOT(rotaryReleased()));
 
-  reverbB = new QComboBox(this);
-  reverbB->addItem("None");
-  reverbB->addItem("Spring");
-  reverbB->addItem("'63 Spring");
-  reverbB->addItem("Plate");
-  reverbB->addItem("Room");
-  reverbB->addItem("Chamber");
-  reverbB->addItem("Hall");
-  reverbB->addItem("Cave");
-  reverbB->addItem("Ducking");
-  reverbB->addItem("Octo");
-  reverbB->addItem("Tile");
-  reverbB->addItem("Echo");
-  reverbB->addItem("Particle Verb");
-  reverbB->setGeometry(x0 + 280, y0 + 270, 134, 22);
-  reverbB->setStyleSheet(comboStyle);
-  connect(reverbB, SIGNAL(currentIndexChanged(int)), this, SLOT(reverbBChanged(int)));
+  topolB = new QImageToggle4(this);
+  topolB->setGeometry(x0 + 804, y0 + 242, 48, 48);
+  topolB->setImage(I_II_III_IV);
+  topolB->setDisabledImage(I_II_III_IV_disabled);
+  topolB->setEnabled(true);
+  topolB->setTag(CC_TOPOL_B);
+  connect(topolB, SIGNAL(valueChanged()), this, SLOT(toggle4Changed()));
+
+  channel = new QImageToggle(this);
+  channel->setGeometry(x0 + 39, y0 + 137, 64, 88);
+  channel->setImage(channelImg);
+  channel->setDisabledImage(channel_disabled);
+  channel->setEnabled(true);
+  channel->setTag(CC_CHANNEL);
+  connect(channel, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
+
+  master = new QImageDial(this);
+  master->setImage(knob_movie);
+  master->setDisabledImage(knob_disabled);
+  master->setFrameCount(61);
+  master->setEnabled(true);
+  master->setGeometry(x0 + 140, y0 + 152, 48, 48);
+  master->setTag(CC_MASTER_VOL);
+  connect(master, SIGNAL(valueChanged()), this, SLOT(rotaryChanged()));
+  connect(master, SIGNAL(mouseReleased()), this, SLOT(rotaryReleased()));
+
+  lowVolLed = new QImageLED(this);
+  lowVolLed->setImage(led_red);
+  lowVolLed->setDisabledImage(led_red_disabled);
+  lowVolLed->setGeometry(x0 + 171, y0 + 232, 31, 31);
+  lowVolLed->setEnabled(true);
+
+  lowVol = new QImageToggle(this);
+  lowVol->setGeometry(x0 + 37, y0 + 232, 44, 31);
+  lowVol->setImage(onoff);
+  lowVol->setDisabledImage(onoff_disabled);
+  lowVol->setEnabled(true);
+  lowVol->setTag(CC_LOWVOLUME);
+  lowVol->setLeftRight(true);
+  lowVol->setValue(true);
+  connect(lowVol, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::createDeferredSections()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Create the reverb and power amp sections.
+///\remarks Called right after the first frame, does nothing if they exist.
+///         Values received before are applied now.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::createDeferredSections()
+{
+  if (sectionsCreated)
+    return;
+  TRACE_SPAN("UI", "MainWindow::createDeferredSections");
+
+  // Create the widgets and place them on the scaled panel:
+  createReverbSections(panelX0, panelY0);
+  createPowerAmpSections(panelX0, panelY0);
+  sectionsCreated = true;
+  addPanelWidgets();
+
+  // Show what was received meanwhile:
+  for (int i = 0; i < 128; i++)
+  {
+    if (deferredValues[i] >= 0)
+      applyControlChange(i, deferredValues[i], true);
+    deferredValues[i] = -1;
+  }
+  StartupProfile::mark("deferred sections created");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::addPanelWidgets()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Add the new controls to the scaled panel.
+///\remarks Remembers the geometry of each control at scale 1 and places it
+///         at the current scale.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::addPanelWidgets()
+{
+  QList<QWidget*> children = findChildren<QWidget*>();
+  for (int i = 0; i < children.size(); i++)
+  {
+    QWidget* child = children[i];
+    if (child->parentWidget() != this || child->isWindow() || child == statusBar() || child == menuBar() || panelWidgets.contains(child))
+      continue;
+    panelWidgets.append(child);
+    panelRects.append(child->geometry());
+
+    // Already laid out? Then place it. Widgets created after the window
+    // was shown must be shown explicitly:
+    if (panelScale > 0.0)
+      child->setGeometry(SpriteAtlas::scaledRect(child->geometry(), panelScale).translated(panelRect.topLeft()));
+    if (isVisible())
+      child->show();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::createReverbSections()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Create the switches, LEDs and dials of both reverbs.
+///\param   [in] x0: Left edge of the edit area.
+///\param   [in] y0: Top edge of the edit area.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::createReverbSections(int x0, int y0)
+{
+  QPixmap knob_movie(ImageAssets::pixmap("knob_movie"));
+  QPixmap knob_disabled(ImageAssets::pixmap("knob_disabled"));
+  QPixmap led_yellow(ImageAssets::pixmap("led_yellow"));
+  QPixmap led_yellow_disabled(ImageAssets::pixmap("led_yellow_disabled"));
+  QPixmap onoff(ImageAssets::pixmap("onoff"));
+  QPixmap onoff_disabled(ImageAssets::pixmap("onoff_disabled"));
+
+  reverbLedA = new QImageLED(this);
+  reverbLedA->setImage(led_yellow);
+  reverbLedA->setDisabledImage(led_yellow_disabled);
+  reverbLedA->setGeometry(x0 + 244, y0 + 130, 31, 31);
+  reverbLedA->setEnabled(true);
+  reverbLedA->setValue(true);
+
+  reverbBypassA = new QImageToggle(this);
+  reverbBypassA->setGeometry(x0 + 275, y0 + 130, 44, 31);
+  reverbBypassA->setImage(onoff);
+  reverbBypassA->setDisabledImage(onoff_disabled);
+  reverbBypassA->setEnabled(true);
+  reverbBypassA->setTag(CC_REV_BYPASS_A);
+  reverbBypassA->setLeftRight(true);
+  reverbBypassA->setValue(true);
+  connect(reverbBypassA, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
+
+  reverbDecayA = new QImageDial(this);
+  reverbDecayA->setImage(knob_movie);
+  reverbDecayA->setDisabledImage(knob_disabled);
+  reverbDecayA->setFrameCount(61);
+  reverbDecayA->setEnabled(true);
+  reverbDecayA->setGeometry(x0 + 431, y0 + 133, 48, 48);
+  reverbDecayA->setTag(CC_REV_DECAY_A);
+  connect(reverbDecayA, SIGNAL(valueChanged()), this, SLOT(rotaryChanged()));
+  connect(reverbDecayA, SIGNAL(mouseReleased()), this, SLOT(rotaryReleased()));
+
+  reverbPredelayA = new QImageDial(this);
+  reverbPredelayA->setImage(knob_movie);
+  reverbPredelayA->setDisabledImage(knob_disabled);
+  reverbPredelayA->setFrameCount(61);
+  reverbPredelayA->setEnabled(true);
+  reverbPredelayA->setGeometry(x0 + 495, y0 + 133, 48, 48);
+  reverbPredelayA->setTag(CC_REV_PREDELAY_A);
+  connect(reverbPredelayA, SIGNAL(valueChanged()), this, SLOT(rotaryChanged()));
+  connect(reverbPredelayA, SIGNAL(mouseReleased()), this, SLOT(rotaryReleased()));
+
+  reverbToneA = new QImageDial(this);
+  reverbToneA->setImage(knob_movie);
+  reverbToneA->setDisabledImage(knob_disabled);
+  reverbToneA->setFrameCount(61);
+  reverbToneA->setEnabled(true);
+  reverbToneA->setGeometry(x0 + 559, y0 + 133, 48, 48);
+  reverbToneA->setTag(CC_REV_TONE_A);
+  connect(reverbToneA, SIGNAL(valueChanged()), this, SLOT(rotaryChanged()));
+  connect(reverbToneA, SIGNAL(mouseReleased()), this, SLOT(rotaryReleased()));
+
+  reverbMixA = new QImageDial(this);
+  reverbMixA->setImage(knob_movie);
+  reverbMixA->setDisabledImage(knob_disabled);
+  reverbMixA->setFrameCount(61);
+  reverbMixA->setEnabled(true);
+  reverbMixA->setGeometry(x0 + 623, y0 + 133, 48, 48);
+  reverbMixA->setTag(CC_REV_MIX_A);
+  connect(reverbMixA, SIGNAL(valueChanged()), this, SLOT(rotaryChanged()));
+  connect(reverbMixA, SIGNAL(mouseReleased()), this, SLOT(rotaryReleased()));
 
   reverbLedB = new QImageLED(this);
   reverbLedB->setImage(led_yellow);
@@ -1023,6 +1516,68 @@ void MainWindow::createEditArea()
   reverbMixB->setTag(CC_REV_MIX_B);
   connect(reverbMixB, SIGNAL(valueChanged()), this, SLOT(rotaryChanged()));
   connect(reverbMixB, SIGNAL(mouseReleased()), this, SLOT(rotaryReleased()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::createPowerAmpSections()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Create the power amp switches of both channels.
+///\param   [in] x0: Left edge of the edit area.
+///\param   [in] y0: Top edge of the edit area.
+///\remarks The topology selectors are created with the other controls.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::createPowerAmpSections(int x0, int y0)
+{
+  QPixmap classAB(ImageAssets::pixmap("class"));
+  QPixmap class_disabled(ImageAssets::pixmap("class_disabled"));
+  QPixmap xtode(ImageAssets::pixmap("xtode"));
+  QPixmap xtode_disabled(ImageAssets::pixmap("xtode_disabled"));
+  QPixmap boost(ImageAssets::pixmap("boost"));
+  QPixmap boost_disabled(ImageAssets::pixmap("boost_disabled"));
+  QPixmap piv(ImageAssets::pixmap("piv"));
+  QPixmap piv_disabled(ImageAssets::pixmap("piv_disabled"));
+  QPixmap cap(ImageAssets::pixmap("cap"));
+  QPixmap cap_disabled(ImageAssets::pixmap("cap_disabled"));
+
+  classA = new QImageToggle(this);
+  classA->setGeometry(x0 + 720, y0 + 23, 64, 88);
+  classA->setImage(classAB);
+  classA->setDisabledImage(class_disabled);
+  classA->setEnabled(true);
+  classA->setTag(CC_CLASS_A);
+  connect(classA, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
+
+  xtodeA = new QImageToggle(this);
+  xtodeA->setGeometry(x0 + 871, y0 + 23, 64, 88);
+  xtodeA->setImage(xtode);
+  xtodeA->setDisabledImage(xtode_disabled);
+  xtodeA->setEnabled(true);
+  xtodeA->setTag(CC_XTODE_A);
+  connect(xtodeA, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
+
+  boostA = new QImageToggle(this);
+  boostA->setGeometry(x0 + 720, y0 + 112, 64, 88);
+  boostA->setImage(boost);
+  boostA->setDisabledImage(boost_disabled);
+  boostA->setEnabled(true);
+  boostA->setTag(CC_BOOST_A);
+  connect(boostA, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
+
+  pivoltA = new QImageToggle(this);
+  pivoltA->setGeometry(x0 + 795, y0 + 112, 64, 88);
+  pivoltA->setImage(piv);
+  pivoltA->setDisabledImage(piv_disabled);
+  pivoltA->setEnabled(true);
+  pivoltA->setTag(CC_PI_VOLTAGE_A);
+  connect(pivoltA, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
+
+  capA = new QImageToggle(this);
+  capA->setGeometry(x0 + 871, y0 + 112, 64, 88);
+  capA->setImage(cap);
+  capA->setDisabledImage(cap_disabled);
+  capA->setEnabled(true);
+  capA->setTag(CC_CAP_TYPE_A);
+  connect(capA, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
 
   classB = new QImageToggle(this);
   classB->setGeometry(x0 + 720, y0 + 227, 64, 88);
@@ -1032,14 +1587,6 @@ void MainWindow::createEditArea()
   classB->setTag(CC_CLASS_B);
   connect(classB, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
 
-  topolB = new QImageToggle4(this);
-  topolB->setGeometry(x0 + 804, y0 + 242, 48, 48);
-  topolB->setImage(I_II_III_IV);
-  topolB->setDisabledImage(I_II_III_IV_disabled);
-  topolB->setEnabled(true);
-  topolB->setTag(CC_TOPOL_B);
-  connect(topolB, SIGNAL(valueChanged()), this, SLOT(toggle4Changed()));
-
   xtodeB = new QImageToggle(this);
   xtodeB->setGeometry(x0 + 871, y0 + 227, 64, 88);
   xtodeB->setImage(xtode);
@@ -1061,78 +1608,82 @@ void MainWindow::createEditArea()
   pivoltB->setImage(piv);
   pivoltB->setDisabledImage(piv_disabled);
   pivoltB->setEnabled(true);
-  pivoltB->setTag(CC_PI_VOLTAGE_B);
-  connect(pivoltB, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
-
-  capB = new QImageToggle(this);
-  capB->setGeometry(x0 + 871, y0 + 316, 64, 88);
-  capB->setImage(cap);
-  capB->setDisabledImage(cap_disabled);
-  capB->setEnabled(true);
-  capB->setTag(CC_CAP_TYPE_B);
-  connect(capB, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
-
-  channel = new QImageToggle(this);
-  channel->setGeometry(x0 + 39, y0 + 137, 64, 88);
-  channel->setImage(channelImg);
-  channel->setDisabledImage(channel_disabled);
-  channel->setEnabled(true);
-  channel->setTag(CC_CHANNEL);
-  connect(channel, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
-
-  master = new QImageDial(this);
-  master->setImage(knob_movie);
-  master->setDisabledImage(knob_disabled);
-  master->setFrameCount(61);
-  master->setEnabled(true);
-  master->setGeometry(x0 + 140, y0 + 152, 48, 48);
-  master->setTag(CC_MASTER_VOL);
-  connect(master, SIGNAL(valueChanged()), this, SLOT(rotaryChanged()));
-  connect(master, SIGNAL(mouseReleased()), this, SLOT(rotaryReleased()));
-
-  lowVolLed = new QImageLED(this);
-  lowVolLed->setImage(led_red);
-  lowVolLed->setDisabledImage(led_red_disabled);
-  lowVolLed->setGeometry(x0 + 171, y0 + 232, 31, 31);
-  lowVolLed->setEnabled(true);
-
-  lowVol = new QImageToggle(this);
-  lowVol->setGeometry(x0 + 37, y0 + 232, 44, 31);
-  lowVol->setImage(onoff);
-  lowVol->setDisabledImage(onoff_disabled);
-  lowVol->setEnabled(true);
-  lowVol->setTag(CC_LOWVOLUME);
-  lowVol->setLeftRight(true);
-  lowVol->setValue(true);
-  connect(lowVol, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
-
-  mic = new QComboBox(this);
-  mic->addItem("None");
-  mic->addItem("57 Dynamic");
-  mic->addItem("57 Dynamic, Off Axis");
-  mic->addItem("409 Dynamic");
-  mic->addItem("421 Dynamic");
-  mic->addItem("4038 Ribbon");
-  mic->addItem("121 Ribbon");
-  mic->addItem("67 Condenser");
-  mic->addItem("87 Condenser");
-  mic->setGeometry(x0 + 62, y0 + 270, 134, 22);
-  mic->setStyleSheet(comboStyle);
-  connect(mic, SIGNAL(currentIndexChanged(int)), this, SLOT(micChanged(int)));
+  pivoltB->setTag(CC_PI_VOLTAGE_B);
+  connect(pivoltB, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
 
-  QImageButton* midiButton = new QImageButton(this);
-  midiButton->setGeometry(x0 + 11, y0 - 18, 65, 15);
-  midiButton->setImage(midi);
-  midiButton->setDisabledImage(midi_disabled);
-  midiButton->setEnabled(true);
-  connect(midiButton, SIGNAL(clicked()), this, SLOT(setupMIDI()));
+  capB = new QImageToggle(this);
+  capB->setGeometry(x0 + 871, y0 + 316, 64, 88);
+  capB->setImage(cap);
+  capB->setDisabledImage(cap_disabled);
+  capB->setEnabled(true);
+  capB->setTag(CC_CAP_TYPE_B);
+  connect(capB, SIGNAL(valueChanged()), this, SLOT(toggleChanged()));
+}
 
-  QImageButton* aboutButton = new QImageButton(this);
-  aboutButton->setGeometry(x0 + 80, y0 - 18, 65, 15);
-  aboutButton->setImage(about);
-  aboutButton->setDisabledImage(about_disabled);
-  aboutButton->setEnabled(true);
-  connect(aboutButton, SIGNAL(clicked()), this, SLOT(about()));
+// The panel with the same layout as the widgets:
+static const PanelItem panelItems[] =
+{
+  { PanelCanvas::TOGGLE4, CC_VOICE_A,         34,  30, 48, 48, "I_II_III_IV", "I_II_III_IV_disabled",  1, 0 },
+  { PanelCanvas::DIAL,    CC_GAIN_A,         303,  30, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::DIAL,    CC_BASS_A,         367,  30, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::DIAL,    CC_MIDDLE_A,       431,  30, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::DIAL,    CC_TREBLE_A,       495,  30, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::DIAL,    CC_PRESENCE_A,     559,  30, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::DIAL,    CC_VOLUME_A,       623,  30, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::LED,     CC_REV_BYPASS_A,   244, 130, 31, 31, "led_yellow",  "led_yellow_disabled",   1, 0 },
+  { PanelCanvas::TOGGLE,  CC_REV_BYPASS_A,   275, 130, 44, 31, "onoff",       "onoff_disabled",        1, ITEM_LEFT_RIGHT | ITEM_ON },
+  { PanelCanvas::DIAL,    CC_REV_DECAY_A,    431, 133, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::DIAL,    CC_REV_PREDELAY_A, 495, 133, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::DIAL,    CC_REV_TONE_A,     559, 133, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::DIAL,    CC_REV_MIX_A,      623, 133, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::TOGGLE,  CC_CLASS_A,        720,  23, 64, 88, "class",       "class_disabled",        1, 0 },
+  { PanelCanvas::TOGGLE4, CC_TOPOL_A,        804,  38, 48, 48, "I_II_III_IV", "I_II_III_IV_disabled",  1, 0 },
+  { PanelCanvas::TOGGLE,  CC_XTODE_A,        871,  23, 64, 88, "xtode",       "xtode_disabled",        1, 0 },
+  { PanelCanvas::TOGGLE,  CC_BOOST_A,        720, 112, 64, 88, "boost",       "boost_disabled",        1, 0 },
+  { PanelCanvas::TOGGLE,  CC_PI_VOLTAGE_A,   795, 112, 64, 88, "piv",         "piv_disabled",          1, 0 },
+  { PanelCanvas::TOGGLE,  CC_CAP_TYPE_A,     871, 112, 64, 88, "cap",         "cap_disabled",          1, 0 },
+  { PanelCanvas::TOGGLE4, CC_VOICE_B,         34, 336, 48, 48, "I_II_III_IV", "I_II_III_IV_disabled",  1, 0 },
+  { PanelCanvas::DIAL,    CC_GAIN_B,         303, 336, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::DIAL,    CC_BASS_B,         367, 336, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::DIAL,    CC_MIDDLE_B,       431, 336, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::DIAL,    CC_TREBLE_B,       495, 336, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::DIAL,    CC_PRESENCE_B,     559, 336, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::DIAL,    CC_VOLUME_B,       623, 336, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::LED,     CC_REV_BYPASS_B,   244, 232, 31, 31, "led_yellow",  "led_yellow_disabled",   1, 0 },
+  { PanelCanvas::TOGGLE,  CC_REV_BYPASS_B,   275, 232, 44, 31, "onoff",       "onoff_disabled",        1, ITEM_LEFT_RIGHT | ITEM_ON },
+  { PanelCanvas::DIAL,    CC_REV_DECAY_B,    431, 235, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::DIAL,    CC_REV_PREDELAY_B, 495, 235, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::DIAL,    CC_REV_TONE_B,     559, 235, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::DIAL,    CC_REV_MIX_B,      623, 235, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::TOGGLE,  CC_CLASS_B,        720, 227, 64, 88, "class",       "class_disabled",        1, 0 },
+  { PanelCanvas::TOGGLE4, CC_TOPOL_B,        804, 242, 48, 48, "I_II_III_IV", "I_II_III_IV_disabled",  1, 0 },
+  { PanelCanvas::TOGGLE,  CC_XTODE_B,        871, 227, 64, 88, "xtode",       "xtode_disabled",        1, 0 },
+  { PanelCanvas::TOGGLE,  CC_BOOST_B,        720, 316, 64, 88, "boost",       "boost_disabled",        1, 0 },
+  { PanelCanvas::TOGGLE,  CC_PI_VOLTAGE_B,   795, 316, 64, 88, "piv",         "piv_disabled",          1, 0 },
+  { PanelCanvas::TOGGLE,  CC_CAP_TYPE_B,     871, 316, 64, 88, "cap",         "cap_disabled",          1, 0 },
+  { PanelCanvas::TOGGLE,  CC_CHANNEL,         39, 137, 64, 88, "channel",     "channel_disabled",      1, ITEM_LOW_ON },
+  { PanelCanvas::DIAL,    CC_MASTER_VOL,     140, 152, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::LED,     CC_LOWVOLUME,      171, 232, 31, 31, "led_red",     "led_red_disabled",      1, ITEM_INVERTED },
+  { PanelCanvas::TOGGLE,  CC_LOWVOLUME,       37, 232, 44, 31, "onoff",       "onoff_disabled",        1, ITEM_LEFT_RIGHT | ITEM_ON | ITEM_LOW_ON }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::createCanvasControls()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Create the dials, switches and LEDs on the panel canvas.
+///\param   [in] x0: Left edge of the edit area.
+///\param   [in] y0: Top edge of the edit area.
+///\remarks The widget members stay 0 in this mode.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::createCanvasControls(int x0, int y0)
+{
+  // The canvas covers the whole window, the combo boxes are placed above it:
+  canvas->setGeometry(0, 0, backPic.width(), backPic.height());
+  connect(canvas, SIGNAL(valueChanged(int)), this, SLOT(canvasValueChanged(int)));
+  connect(canvas, SIGNAL(mouseReleased(int)), this, SLOT(rotaryReleased()));
+
+  // Add the controls:
+  canvas->addItems(panelItems, sizeof(panelItems) / sizeof(panelItems[0]), QPoint(x0, y0));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1145,58 +1696,90 @@ void MainWindow::createEditArea()
 ////////////////////////////////////////////////////////////////////////////////
 void MainWindow::getValuesFromDT(bool async)
 {
-  // Avoid recursion:
-  if (!receiveMutex.tryLock())
+  TRACE_SPAN("MIDI", "MainWindow::getValuesFromDT");
+
+  // Already running? Then read everything once more when it is done, the
+  // values sent so far may be outdated. Before the first query nothing was
+  // read yet, so requests of the same batch, like both voicings of a preset
+  // change, share one sync:
+  if (resyncStep >= 0)
+  {
+    if (resyncStep > 0)
+      resyncAgain = true;
     return;
+  }
 
   // Lock UI:
-  if (!async)
+  resyncLocked = !async;
+  if (resyncLocked)
   {
     this->setEnabled(false);
     this->setCursor(Qt::WaitCursor);
   }
 
+  resyncStart = RtMidi::getMonotonicTime();
   sendControlChange(DT_MIDI_CHANNEL, 126, 127);
 
-  // Send parameter requests:
-  Sleep(50);
-  sendControlChange(DT_MIDI_CHANNEL, 83, 0);
-  Sleep(50);
-  sendControlChange(DT_MIDI_CHANNEL, 83, 17);
-  Sleep(50);
-  sendControlChange(DT_MIDI_CHANNEL, 83, 18);
-  Sleep(50);
-  sendControlChange(DT_MIDI_CHANNEL, 83, 19);
-  Sleep(50);
-  sendControlChange(DT_MIDI_CHANNEL, 83, 29);
-  Sleep(50);
-  sendControlChange(DT_MIDI_CHANNEL, 83, 30);
-  Sleep(50);
-  sendControlChange(DT_MIDI_CHANNEL, 83, 31);
-  Sleep(50);
-  sendControlChange(DT_MIDI_CHANNEL, 83, 32);
-  Sleep(50);
-  sendControlChange(DT_MIDI_CHANNEL, 83, 33);
-  Sleep(50);
-  sendControlChange(DT_MIDI_CHANNEL, 83, 34);
-  Sleep(50);
-  sendControlChange(DT_MIDI_CHANNEL, 83, 35);
-  Sleep(50);
+  // Send parameter requests, the event loop keeps running in between:
+  resyncStep = 0;
+  QTimer::singleShot(resyncInterval, this, SLOT(continueResync()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::continueResync()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Send the next step of a getValuesFromDT() request.
+///\remarks The DT needs a moment between the queries, so each step schedules
+///         the next one with a timer.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::continueResync()
+{
+  // Next parameter request:
+  if (resyncStep < resyncQueryCount)
+  {
+    sendParameterQuery(resyncQueries[resyncStep++]);
+    QTimer::singleShot(resyncInterval, this, SLOT(continueResync()));
+    return;
+  }
 
   // Force user interface release:
   sendBlockMessage(false);
 
   // Release UI:
-  if (!async)
+  if (resyncLocked)
   {
     this->setCursor(Qt::ArrowCursor);
     this->setEnabled(true);
   }
 
   sendControlChange(DT_MIDI_CHANNEL, 126, 0);
+  statistics.resyncDone(RtMidi::getMonotonicTime() - resyncStart);
+  resyncStep = -1;
+
+  // Was something changed during the sync that needs another one?
+  if (resyncAgain)
+  {
+    resyncAgain = false;
+    getValuesFromDT(true);
+    return;
+  }
+
+  // The first sync ends the startup:
+  if (!startupSynced)
+    finishStartup(true);
+}
 
-  // Release mutex:
-  receiveMutex.unlock();
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::sendParameterQuery()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Ask the DT for the values of a parameter group.
+///\param   [in] group: The group to query (value of CC 83).
+///\remarks The response time of the query is counted in the statistics.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::sendParameterQuery(unsigned char group)
+{
+  statistics.queryStarted(group, RtMidi::getMonotonicTime());
+  sendControlChange(DT_MIDI_CHANNEL, 83, group);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1228,6 +1811,131 @@ void MainWindow::about()
   dlg.exec();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::showDiagnostics()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the diagnostics shortcut (Ctrl+D).
+///\remarks Shows the live statistics of the MIDI engine. The panel is not
+///         modal so the editor can be used while watching the numbers.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::showDiagnostics()
+{
+  // Create the panel on first use:
+  if (diagnostics == 0)
+    diagnostics = new DiagnosticsDialog(this, this);
+
+  // Show it:
+  diagnostics->show();
+  diagnostics->raise();
+  diagnostics->activateWindow();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::connectToDT()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Open the MIDI ports and read the state of the DT.
+///\remarks Asks the user what to do if the ports can't be opened.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::connectToDT()
+{
+  // The first frame and the fallback timer may both get here:
+  if (connectStarted)
+    return;
+  connectStarted = true;
+
+  // Open the MIDI ports and if the opening fails, ask user what to do:
+  bool connected = true;
+  while (connected && !openMIDIPorts())
+  {
+    // Get user wish:
+    if (QMessageBox::question(this, tr("MIDI error"), tr("There was an error while establishing the MIDI connection to the device.\n\nWould you like to check the configuration?"), QMessageBox::Yes, QMessageBox::No) != QMessageBox::Yes)
+      connected = false;
+
+    // Show the setup dialog:
+    else if (!showSetupWindow())
+      connected = false;
+  }
+
+  // Get current state, the preset of the command line follows when it is
+  // in:
+  if (connected)
+  {
+    StartupProfile::mark("MIDI ports opened");
+    getValuesFromDT();
+  }
+  else
+    finishStartup(false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::finishStartup()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Send the preset of the command line and end the startup profile.
+///\param   [in] connected: Was the DT connected and synced?
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::finishStartup(bool connected)
+{
+  // Send the preset of the command line:
+  if (connected)
+    sendPendingPreset();
+
+  // The startup ends with the first frame and the sync, whatever is last:
+  startupSynced = true;
+  if (framePending)
+    StartupProfile::mark(connected ? "state synced" : "MIDI setup cancelled");
+  else
+    StartupProfile::finish(connected ? "state synced" : "MIDI setup cancelled");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::showMonitor()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the MIDI monitor shortcut (Ctrl+M).
+///\remarks Shows the trace of the MIDI traffic, including what was traced
+///         before the monitor was opened.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::showMonitor()
+{
+  // Create the window on first use:
+  if (monitor == 0)
+    monitor = new MIDIMonitor(getTrace(), this);
+
+  // Show it:
+  monitor->show();
+  monitor->raise();
+  monitor->activateWindow();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::openPreset()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the open preset shortcut (Ctrl+O).
+///\remarks Asks for a preset file and sends it to the DT.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::openPreset()
+{
+  QString fileName = QFileDialog::getOpenFileName(this, tr("Open preset"), QString(), tr("DT presets (*.dtpreset)"));
+  if (fileName.isEmpty())
+    return;
+  if (!loadPreset(fileName))
+    QMessageBox::warning(this, tr("DT Edit"), tr("Could not read the preset %1.").arg(fileName));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::savePresetAs()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the save preset shortcut (Ctrl+S).
+///\remarks Asks for a file name and saves the current settings.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::savePresetAs()
+{
+  QString fileName = QFileDialog::getSaveFileName(this, tr("Save preset"), QString(), tr("DT presets (*.dtpreset)"));
+  if (fileName.isEmpty())
+    return;
+  if (!savePreset(fileName))
+    QMessageBox::warning(this, tr("DT Edit"), tr("Could not write %1.").arg(fileName));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // MainWindow::setupMIDI()
 ////////////////////////////////////////////////////////////////////////////////
@@ -1242,9 +1950,13 @@ void MainWindow::setupMIDI()
     if (!showSetupWindow())
       break;
 
-    // Reopen ports:
+    // Reopen ports, a preset that came in while they were closed follows:
     if (openMIDIPorts())
+    {
+      if (startupSynced)
+        sendPendingPreset();
       break;
+    }
 
     // There was an error, ask user what to do:
     if (QMessageBox::question(this, tr("MIDI error"), tr("There was an error while establishing the MIDI connection to the device.\n\nWould you like to check the configuration?"), QMessageBox::Yes, QMessageBox::No) != QMessageBox::Yes)
@@ -1271,14 +1983,8 @@ void MainWindow::rotaryChanged()
   if (dial == 0)
     return;
 
-  // Block user interface:
-  sendBlockMessage(true);
-
   // Send the value:
-  sendControlChange(DT_MIDI_CHANNEL, dial->tag(), (int)(dial->value() * 127.0) & 0xFF);
-
-  // Release the user interface:
-  sendBlockMessage(false);
+  sendDialValue(dial->tag(), dial->step());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1288,10 +1994,30 @@ void MainWindow::rotaryChanged()
 ////////////////////////////////////////////////////////////////////////////////
 void MainWindow::rotaryReleased()
 {
+  // The drag is a single step in the history:
+  dialIdleTimer->stop();
+  dragControl = -1;
+  history.close();
+
   // Release the user interface:
   sendBlockMessage(false);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::dialIdle()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the end of a dial edit without the mouse.
+///\remarks Wheel and key edits have no release, a pause ends them. A drag
+///         that holds still goes on until the button is released.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::dialIdle()
+{
+  if (QApplication::mouseButtons() != Qt::NoButton)
+    return;
+  dragControl = -1;
+  history.close();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // MainWindow::toggleChanged()
 ////////////////////////////////////////////////////////////////////////////////
@@ -1308,17 +2034,8 @@ void MainWindow::toggleChanged()
   if (toggle == 0)
     return;
 
-  // Block user interface:
-  sendBlockMessage(true);
-
   // Send the value:
-  if (toggle->tag() == CC_CHANNEL || toggle->tag() == CC_LOWVOLUME)
-    sendControlChange(DT_MIDI_CHANNEL, toggle->tag(), toggle->value() ? : 127);
-  else
-    sendControlChange(DT_MIDI_CHANNEL, toggle->tag(), toggle->value() ? 127 : 0);
-
-  // Release the user interface:
-  sendBlockMessage(false);
+  sendToggleValue(toggle->tag(), toggle->value());
 
   // Update LEDs if needed:
   if (toggle->tag() == CC_REV_BYPASS_A)
@@ -1345,20 +2062,327 @@ void MainWindow::toggle4Changed()
   if (toggle == 0)
     return;
 
+  // Send the value:
+  sendToggle4Value(toggle->tag(), toggle->value());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::canvasValueChanged()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the changed event of the panel canvas.
+///\param   [in] index: Index of the changed control.
+///\remarks Also handles the canvases of the stage views, the main panel then
+///         follows their change.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::canvasValueChanged(int index)
+{
+  // Is the UI locked?
+  if (blocked)
+    return;
+
+  // Get the sending canvas:
+  PanelCanvas* source = qobject_cast<PanelCanvas*>(sender());
+  if (source == 0)
+    source = canvas;
+
+  // Send the value:
+  int tag = source->tag(index);
+  switch (source->type(index))
+  {
+  case PanelCanvas::DIAL:
+    sendDialValue(tag, source->step(index));
+    break;
+  case PanelCanvas::TOGGLE:
+    sendToggleValue(tag, source->step(index) != 0);
+    break;
+  case PanelCanvas::TOGGLE4:
+    sendToggle4Value(tag, source->step(index));
+    break;
+  default:
+    break;
+  }
+
+  // Show a change of a stage view on the main panel:
+  if (source != canvas && state.value(tag) >= 0)
+    applyControlChange(tag, state.value(tag), true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::newStageView()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the stage view shortcut (Ctrl+N).
+///\remarks Opens another view with the channel, voicing and master controls.
+///         It shares the MIDI ports and the state of this window.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::newStageView()
+{
+  StageView* view = new StageView(this);
+  connect(this, SIGNAL(parameterChanged(int, int)), view, SLOT(showValue(int, int)));
+  connect(view->panel(), SIGNAL(valueChanged(int)), this, SLOT(canvasValueChanged(int)));
+  connect(view->panel(), SIGNAL(mouseReleased(int)), this, SLOT(rotaryReleased()));
+
+  // Show the current values:
+  for (int i = 0; i < Preset::controlCount(); i++)
+  {
+    int controlNumber = Preset::controlNumber(i);
+    if (state.value(controlNumber) >= 0)
+      view->showValue(controlNumber, state.value(controlNumber));
+  }
+  view->show();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::sendDialValue()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Send the value of a dial to the DT.
+///\param   [in] tag:   Controller number of the dial.
+///\param   [in] value: CC value of the dial.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::sendDialValue(int tag, int value)
+{
+  // Until the dial is released or rests its changes are one step:
+  dragControl = tag;
+  dialIdleTimer->start();
+
+  // Block user interface:
+  sendBlockMessage(true);
+
+  // Send the value:
+  sendControlChange(DT_MIDI_CHANNEL, tag, value & 0xFF);
+
+  // Release the user interface:
+  sendBlockMessage(false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::sendToggleValue()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Send the state of a switch to the DT.
+///\param   [in] tag:   Controller number of the switch.
+///\param   [in] value: State of the switch.
+///\remarks The channel and low volume switches are inverted.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::sendToggleValue(int tag, bool value)
+{
+  // Block user interface:
+  sendBlockMessage(true);
+
+  // Send the value:
+  if (tag == CC_CHANNEL || tag == CC_LOWVOLUME)
+    sendControlChange(DT_MIDI_CHANNEL, tag, value ? : 127);
+  else
+    sendControlChange(DT_MIDI_CHANNEL, tag, value ? 127 : 0);
+
+  // Release the user interface:
+  sendBlockMessage(false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::sendToggle4Value()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Send the state of a four way switch to the DT.
+///\param   [in] tag:   Controller number of the switch.
+///\param   [in] value: State of the switch (0-3).
+///\remarks A new voicing changes the other parameters, so these are read
+///         back.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::sendToggle4Value(int tag, int value)
+{
   // Block user interface:
   sendBlockMessage(true);
 
   // Send the value:
-  sendControlChange(DT_MIDI_CHANNEL, toggle->tag(), toggle->value());
+  sendControlChange(DT_MIDI_CHANNEL, tag, value);
 
   // Release the user interface:
   sendBlockMessage(false);
 
   // Sync state:
-  if (toggle->tag() == CC_VOICE_A || toggle->tag() == CC_VOICE_B)
+  if (tag == CC_VOICE_A || tag == CC_VOICE_B)
     getValuesFromDT();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::sendControlChange()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Send a control change message.
+///\param   [in] channel:       MIDI channel of this message.
+///\param   [in] controlNumber: Control number.
+///\param   [in] value:         Control value.
+///\remarks Remembers the values of the amp parameters and records the
+///         changes for undo. An amp selected with its defaults counts as
+///         a change of the amp.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::sendControlChange(unsigned char channel, unsigned char controlNumber, unsigned char value)
+{
+  if (channel == DT_MIDI_CHANNEL)
+  {
+    // The changes of a dial drag are merged into one entry:
+    int parameter = ampControl(controlNumber);
+    int oldValue = state.value(parameter);
+    if (!replaying && oldValue >= 0 && oldValue != value)
+      history.record(parameter, oldValue, value, controlNumber == dragControl, parameter != controlNumber);
+    updateState(parameter, value);
+  }
+  MainMIDIWindow::sendControlChange(channel, controlNumber, value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::updateState()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Remember the value of an amp parameter.
+///\param   [in] controlNumber: Controller number.
+///\param   [in] value:         Control value.
+///\remarks Emits parameterChanged() if the value is new, so the stage views
+///         only see real changes.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::updateState(int controlNumber, int value)
+{
+  int oldValue = state.value(controlNumber);
+  state.setValue(controlNumber, value);
+  if (state.value(controlNumber) != oldValue)
+    emit parameterChanged(controlNumber, value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::applyPreset()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Send the values of a preset to the DT and show them.
+///\param   [in] preset: The preset.
+///\param   [in] replay:   Is this an undo or redo step, which is not
+///                        recorded?
+///\param   [in] defaults: Amps of the step that are selected with their
+///                        defaults.
+///\remarks The voicing and amp selectors go first and the DT gets some time
+///         to load their defaults, the other values then override them.
+///         The rest is sent by continuePreset(), so this returns right
+///         away. A preset that comes in meanwhile waits in pendingPreset.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::applyPreset(const Preset& preset, bool replay, const Preset& defaults)
+{
+  TRACE_SPAN("MIDI", "MainWindow::applyPreset");
+
+  // Already sending? Then this one follows, the last one wins:
+  if (presetStep >= 0)
+  {
+    pendingPreset = preset;
+    return;
+  }
+
+  // Show what was received so far, so it doesn't override the preset later:
+  scheduler->flush();
+
+  // Block user interface:
+  sendBlockMessage(true);
+
+  // A loaded preset is undone as a single step:
+  replaying = replay;
+  if (!replaying)
+    history.beginGroup();
+
+  // Send the values:
+  sendingPreset   = preset;
+  sendingDefaults = defaults;
+  presetStep      = 0;
+  continuePreset();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::continuePreset()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Send the next part of an applyPreset() request.
+///\remarks Sends up to the next value that must wait for the defaults of a
+///         selector and schedules the rest with a timer.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::continuePreset()
+{
+  // Send the values and show them right away, the DT only echoes them:
+  bool loadingDefaults = false;
+  for (; presetStep < Preset::controlCount(); presetStep++)
+  {
+    int controlNumber = Preset::controlNumber(presetStep);
+    int value = sendingPreset.value(controlNumber);
+    if (value < 0)
+      continue;
+
+    // Wait for the defaults of a new voicing or amp before overriding them:
+    bool selector = controlNumber == CC_VOICE_A || controlNumber == CC_VOICE_B || controlNumber == CC_AMP_A || controlNumber == CC_AMP_B;
+    if (loadingDefaults && !selector)
+    {
+      QTimer::singleShot(presetDefaultsTime, this, SLOT(continuePreset()));
+      return;
+    }
+    loadingDefaults = loadingDefaults || selector;
+
+    // An amp that was selected with its defaults is selected that way again:
+    if (sendingDefaults.value(controlNumber) >= 0)
+      sendControlChange(DT_MIDI_CHANNEL, ampDefaultsControl(controlNumber), value);
+    else
+      sendControlChange(DT_MIDI_CHANNEL, controlNumber, value);
+    applyControlChange(controlNumber, value, true);
+  }
+  if (!replaying)
+    history.endGroup();
+
+  // Release the user interface:
+  sendBlockMessage(false);
+  presetStep = -1;
+
+  // A new voicing or amp of an undo or redo step loads its defaults, read them
+  // back in the background so undo can be pressed again meanwhile:
+  if (replaying && (sendingPreset.value(CC_VOICE_A) >= 0 || sendingPreset.value(CC_VOICE_B) >= 0 || !sendingDefaults.isEmpty()))
+    getValuesFromDT(true);
+  replaying = false;
+
+  // Send what came in meanwhile:
+  sendPendingPreset();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::sendPendingPreset()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Send the preset that waits in pendingPreset, if any.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::sendPendingPreset()
+{
+  if (pendingPreset.isEmpty())
+    return;
+  Preset preset = pendingPreset;
+  pendingPreset.clear();
+  applyPreset(preset);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MainWindow::undo()
+// MainWindow::redo()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the undo (Ctrl+Z) and redo shortcuts.
+///\remarks A dial drag or a loaded preset is undone as a single step.
+////////////////////////////////////////////////////////////////////////////////
+void MainWindow::undo()
+{
+  // Is the UI locked or the last step still being sent?
+  if (blocked || presetStep >= 0)
+    return;
+
+  Preset values;
+  Preset defaults;
+  if (history.undo(values, defaults))
+    applyPreset(values, true, defaults);
+}
+
+void MainWindow::redo()
+{
+  // Is the UI locked or the last step still being sent?
+  if (blocked || presetStep >= 0)
+    return;
+
+  Preset values;
+  Preset defaults;
+  if (history.redo(values, defaults))
+    applyPreset(values, true, defaults);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // MainWindow::ampAChanged()
 ////////////////////////////////////////////////////////////////////////////////
@@ -33,6 +33,11 @@
 #include "qimagebutton.h"
 #include "qimagetoggle4.h"
 #include "qimageled.h"
+#include "panelcanvas.h"
+#include "spriteatlas.h"
+#include "updatescheduler.h"
+#include "preset.h"
+#include "edithistory.h"
 #include "dtedit.h"
 #include "mainmidiwindow.h"
 
@@ -51,10 +56,12 @@ public:
   // MainWindow::MainWindow()
   //////////////////////////////////////////////////////////////////////////////
   ///\brief   Initialization constructor of this window.
-  ///\param   [in] parent: Parent window for this window.
+  ///\param   [in] parent:    Parent window for this window.
+  ///\param   [in] useCanvas: Draw the dials, switches and LEDs on a single
+  ///                         PanelCanvas instead of using a widget for each?
   ///\remarks Basically initializes the entire gui.
   //////////////////////////////////////////////////////////////////////////////
-  MainWindow(QWidget* parent = 0);
+  MainWindow(QWidget* parent = 0, bool useCanvas = false);
 
   //////////////////////////////////////////////////////////////////////////////
   // MainWindow::~MainWindow()
@@ -64,6 +71,75 @@ public:
   //////////////////////////////////////////////////////////////////////////////
   ~MainWindow();
 
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::setFastStart()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Paint the first frame before connecting to the DT?
+  ///\param   [in] enable: Use the fast start (default)?
+  ///\remarks Without fast start the ports are opened and the sync is started
+  ///         in the first showEvent(), before the first frame.
+  //////////////////////////////////////////////////////////////////////////////
+  void setFastStart(bool enable);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::flushUpdates()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Apply the received control changes without waiting for the next
+  ///         frame.
+  //////////////////////////////////////////////////////////////////////////////
+  void flushUpdates();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::loadPreset()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Send the settings of a preset file to the DT.
+  ///\param   [in] fileName: The preset file.
+  ///\return  Returns true if the file could be read.
+  ///\remarks Before the DT is connected the preset is kept and sent right
+  ///         after the state is synced or the ports are opened in the setup.
+  //////////////////////////////////////////////////////////////////////////////
+  bool loadPreset(const QString& fileName);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::savePreset()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Write the current settings of the DT to a preset file.
+  ///\param   [in] fileName: The preset file.
+  ///\return  Returns true if successfull or false otherwise.
+  //////////////////////////////////////////////////////////////////////////////
+  bool savePreset(const QString& fileName);
+
+public slots:
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::createDeferredSections()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Create the reverb and power amp sections.
+  ///\remarks Called right after the first frame, does nothing if they exist.
+  ///         Values received before are applied now.
+  //////////////////////////////////////////////////////////////////////////////
+  void createDeferredSections();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::activate()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for another start of the editor.
+  ///\param   [in] presetFiles: Preset files of its command line.
+  ///\remarks Brings the window to the front and loads the presets.
+  //////////////////////////////////////////////////////////////////////////////
+  void activate(const QStringList& presetFiles);
+
+signals:
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::parameterChanged()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   An amp parameter got a new value.
+  ///\param   [in] controlNumber: Controller number of the parameter.
+  ///\param   [in] value:         The new value.
+  ///\remarks Received values arrive with the per frame batch of the update
+  ///         scheduler, local edits right away.
+  //////////////////////////////////////////////////////////////////////////////
+  void parameterChanged(int controlNumber, int value);
+
 protected:
   //////////////////////////////////////////////////////////////////////////////
   // MainWindow::closeEvent()
@@ -90,6 +166,15 @@ protected:
   //////////////////////////////////////////////////////////////////////////////
   void paintEvent(QPaintEvent* e);
 
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::resizeEvent()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Message handler for the resize event.
+  ///\param   [in] e: Description of the event.
+  ///\remarks Scales the panel to the new size.
+  //////////////////////////////////////////////////////////////////////////////
+  void resizeEvent(QResizeEvent* e);
+
   //////////////////////////////////////////////////////////////////////////////
   // MainWindow::openMIDIPorts()
   //////////////////////////////////////////////////////////////////////////////
@@ -118,6 +203,17 @@ protected:
   //////////////////////////////////////////////////////////////////////////////
   virtual void sysExReceived(const std::vector<unsigned char>& buff);
 
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::sendControlChange()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Send a control change message.
+  ///\param   [in] channel:       MIDI channel of this message.
+  ///\param   [in] controlNumber: Control number.
+  ///\param   [in] value:         Control value.
+  ///\remarks Remembers the values of the amp parameters.
+  //////////////////////////////////////////////////////////////////////////////
+  virtual void sendControlChange(unsigned char channel, unsigned char controlNumber, unsigned char value);
+
 private:
 
   //////////////////////////////////////////////////////////////////////////////
@@ -127,16 +223,70 @@ private:
   //////////////////////////////////////////////////////////////////////////////
   void createEditArea();
 
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::createControlWidgets()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Create a widget for each dial, switch and LED.
+  ///\param   [in] x0: Left edge of the panel.
+  ///\param   [in] y0: Top edge of the panel.
+  //////////////////////////////////////////////////////////////////////////////
+  void createControlWidgets(int x0, int y0);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::createReverbSections()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Create the switches, LEDs and dials of both reverbs.
+  ///\param   [in] x0: Left edge of the panel.
+  ///\param   [in] y0: Top edge of the panel.
+  //////////////////////////////////////////////////////////////////////////////
+  void createReverbSections(int x0, int y0);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::createPowerAmpSections()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Create the power amp switches of both channels.
+  ///\param   [in] x0: Left edge of the panel.
+  ///\param   [in] y0: Top edge of the panel.
+  //////////////////////////////////////////////////////////////////////////////
+  void createPowerAmpSections(int x0, int y0);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::addPanelWidgets()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Add the new controls to the scaled panel.
+  ///\remarks Remembers the geometry of each control at scale 1 and places it
+  ///         at the current scale.
+  //////////////////////////////////////////////////////////////////////////////
+  void addPanelWidgets();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::createCanvasControls()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Add the dials, switches and LEDs to the panel canvas.
+  ///\param   [in] x0: Left edge of the panel.
+  ///\param   [in] y0: Top edge of the panel.
+  //////////////////////////////////////////////////////////////////////////////
+  void createCanvasControls(int x0, int y0);
+
   //////////////////////////////////////////////////////////////////////////////
   // MainWindow::getValuesFromDT()
   //////////////////////////////////////////////////////////////////////////////
   ///\brief   Sync UI with the values from the actual DT.
-  ///\param   [in] async: Is this called asyncally?
+  ///\param   [in] async: Keep the UI usable during the sync?
   ///\remarks This functions sends value request CCs to the DT. The UI is then
-  ///         updated by the CC receive function.
+  ///         updated by the CC receive function. The requests go out from
+  ///         continueResync(), so this returns right away.
   //////////////////////////////////////////////////////////////////////////////
   void getValuesFromDT(bool async = false);
 
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::finishStartup()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Send the preset of the command line and end the startup profile.
+  ///\param   [in] connected: Was the DT connected and synced?
+  //////////////////////////////////////////////////////////////////////////////
+  void finishStartup(bool connected);
+
   //////////////////////////////////////////////////////////////////////////////
   // MainWindow::sendBlockMessage()
   //////////////////////////////////////////////////////////////////////////////
@@ -149,8 +299,141 @@ private:
   //////////////////////////////////////////////////////////////////////////////
   void sendBlockMessage(bool block);
 
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::sendParameterQuery()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Ask the DT for the values of a parameter group.
+  ///\param   [in] group: The group to query (value of CC 83).
+  ///\remarks The response time of the query is counted in the statistics.
+  //////////////////////////////////////////////////////////////////////////////
+  void sendParameterQuery(unsigned char group);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::updateTitle()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Show the connection state in the window title.
+  ///\remarks Call this whenever versionString changes.
+  //////////////////////////////////////////////////////////////////////////////
+  void updateTitle();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::updateBackCache()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Render the background image into the pixmap cache.
+  ///\remarks Does nothing if the cache matches the current device pixel ratio.
+  //////////////////////////////////////////////////////////////////////////////
+  void updateBackCache();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::layoutPanel()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Scale and center the panel in the window.
+  ///\remarks The panel keeps its aspect ratio, the controls are placed by
+  ///         their geometry at scale 1.
+  //////////////////////////////////////////////////////////////////////////////
+  void layoutPanel();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::canvasControlChange()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Show a received control change on the panel canvas.
+  ///\param   [in] controlNumber: Controller number.
+  ///\param   [in] value:         Control value.
+  ///\param   [in] receiving:     Is a getValuesFromDT() request running?
+  ///\return  Returns false if no control on the canvas has this number.
+  //////////////////////////////////////////////////////////////////////////////
+  bool canvasControlChange(unsigned char controlNumber, unsigned char value, bool receiving);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::updateState()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Remember the value of an amp parameter.
+  ///\param   [in] controlNumber: Controller number.
+  ///\param   [in] value:         Control value.
+  ///\remarks Emits parameterChanged() if the value is new.
+  //////////////////////////////////////////////////////////////////////////////
+  void updateState(int controlNumber, int value);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::sendDialValue()
+  // MainWindow::sendToggleValue()
+  // MainWindow::sendToggle4Value()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Send the value of a control to the DT.
+  ///\param   [in] tag:   Controller number of the control.
+  ///\param   [in] value: The new value.
+  //////////////////////////////////////////////////////////////////////////////
+  void sendDialValue(int tag, int value);
+  void sendToggleValue(int tag, bool value);
+  void sendToggle4Value(int tag, int value);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::applyPreset()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Send the values of a preset to the DT and show them.
+  ///\param   [in] preset: The preset.
+  ///\param   [in] replay:   Is this an undo or redo step, which is not
+  ///                        recorded?
+  ///\param   [in] defaults: Amps of the step that are selected with their
+  ///                        defaults.
+  ///\remarks The voicing and amp selectors go first and the DT gets some time
+  ///         to load their defaults, the other values then override them.
+  ///         The rest is sent by continuePreset(), so this returns right
+  ///         away. A preset that comes in meanwhile waits in pendingPreset.
+  //////////////////////////////////////////////////////////////////////////////
+  void applyPreset(const Preset& preset, bool replay = false, const Preset& defaults = Preset());
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::sendPendingPreset()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Send the preset that waits in pendingPreset, if any.
+  //////////////////////////////////////////////////////////////////////////////
+  void sendPendingPreset();
+
 private slots:
 
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::connectToDT()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Open the MIDI ports and read the state of the DT.
+  ///\remarks Asks the user what to do if the ports can't be opened.
+  //////////////////////////////////////////////////////////////////////////////
+  void connectToDT();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::resizeSettled()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the end of an interactive resize.
+  ///\remarks Builds the sprite atlases of the final size.
+  //////////////////////////////////////////////////////////////////////////////
+  void resizeSettled();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::showVersion()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Show the version of the connected amp.
+  ///\param   [in] version: Model and firmware version.
+  //////////////////////////////////////////////////////////////////////////////
+  void showVersion(const QString& version);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::continueResync()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Send the next step of a getValuesFromDT() request.
+  ///\remarks The DT needs a moment between the queries, so each step
+  ///         schedules the next one with a timer.
+  //////////////////////////////////////////////////////////////////////////////
+  void continueResync();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::continuePreset()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Send the next part of an applyPreset() request.
+  ///\remarks Sends up to the next value that must wait for the defaults of
+  ///         a selector and schedules the rest with a timer.
+  //////////////////////////////////////////////////////////////////////////////
+  void continuePreset();
+
   //////////////////////////////////////////////////////////////////////////////
   // MainWindow::about()
   //////////////////////////////////////////////////////////////////////////////
@@ -167,6 +450,48 @@ private slots:
   //////////////////////////////////////////////////////////////////////////////
   void setupMIDI();
 
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::showDiagnostics()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the diagnostics shortcut (Ctrl+D).
+  ///\remarks Shows the live statistics of the MIDI engine.
+  //////////////////////////////////////////////////////////////////////////////
+  void showDiagnostics();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::showMonitor()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the MIDI monitor shortcut (Ctrl+M).
+  ///\remarks Shows the trace of the MIDI traffic.
+  //////////////////////////////////////////////////////////////////////////////
+  void showMonitor();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::openPreset()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the open preset shortcut (Ctrl+O).
+  ///\remarks Asks for a preset file and sends it to the DT.
+  //////////////////////////////////////////////////////////////////////////////
+  void openPreset();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::savePresetAs()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the save preset shortcut (Ctrl+S).
+  ///\remarks Asks for a file name and saves the current settings.
+  //////////////////////////////////////////////////////////////////////////////
+  void savePresetAs();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::undo()
+  // MainWindow::redo()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the undo (Ctrl+Z) and redo shortcuts.
+  ///\remarks A dial drag or a loaded preset is undone as a single step.
+  //////////////////////////////////////////////////////////////////////////////
+  void undo();
+  void redo();
+
   //////////////////////////////////////////////////////////////////////////////
   // MainWindow::rotaryChanged()
   //////////////////////////////////////////////////////////////////////////////
@@ -181,6 +506,14 @@ private slots:
   //////////////////////////////////////////////////////////////////////////////
   void rotaryReleased();
 
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::dialIdle()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the end of a dial edit without the mouse.
+  ///\remarks Wheel and key edits have no release, a pause ends them.
+  //////////////////////////////////////////////////////////////////////////////
+  void dialIdle();
+
   //////////////////////////////////////////////////////////////////////////////
   // MainWindow::toggleChanged()
   //////////////////////////////////////////////////////////////////////////////
@@ -199,6 +532,35 @@ private slots:
   //////////////////////////////////////////////////////////////////////////////
   void toggle4Changed();
 
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::canvasValueChanged()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the changed event of the panel canvas.
+  ///\param   [in] index: Index of the changed control.
+  ///\remarks Also handles the canvases of the stage views.
+  //////////////////////////////////////////////////////////////////////////////
+  void canvasValueChanged(int index);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::newStageView()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the stage view shortcut (Ctrl+N).
+  ///\remarks Opens another view with the channel, voicing and master controls.
+  //////////////////////////////////////////////////////////////////////////////
+  void newStageView();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MainWindow::applyControlChange()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Show a received control change in the user interface.
+  ///\param   [in] controlNumber: Controller number.
+  ///\param   [in] value:         Control value.
+  ///\param   [in] receiving:     Did it arrive during a getValuesFromDT()?
+  ///\remarks Called by the update scheduler once per frame for each changed
+  ///         controller.
+  //////////////////////////////////////////////////////////////////////////////
+  void applyControlChange(int controlNumber, int value, bool receiving);
+
   //////////////////////////////////////////////////////////////////////////////
   // MainWindow::ampAChanged()
   //////////////////////////////////////////////////////////////////////////////
@@ -308,10 +670,38 @@ private:
   QImageToggle*  lowVol;          ///\> Low volume switch.
   QImageToggle*  channel;         ///\> Channel A/B switch.
   QImageDial*    master;          ///\> Master volume.
+  PanelCanvas*   canvas;          ///\> Panel renderer (0 with widgets).
+  UpdateScheduler* scheduler;     ///\> Applies received changes per frame.
+  bool           sectionsCreated; ///\> Are the reverb and power amp sections there?
+  int            deferredValues[128]; ///\> Values received before (-1 if none).
+  Preset         state;           ///\> Current values of the amp parameters.
+  Preset         pendingPreset;   ///\> Preset to send once connected or after the running one.
+  Preset         sendingPreset;   ///\> Values of the running applyPreset().
+  Preset         sendingDefaults; ///\> Its amps that load their defaults.
+  int            presetStep;      ///\> Next value of sendingPreset (-1 if none).
   QImage         backPic;         ///\> Main background image.
+  QPixmap        backCache;       ///\> Background rendered for the screen.
+  QVector<QWidget*> panelWidgets; ///\> Controls placed on the panel.
+  QVector<QRect> panelRects;      ///\> Their geometry at scale 1.
+  QRect          panelRect;       ///\> Scaled panel within the window.
+  qreal          panelScale;      ///\> Scale of the panel.
+  QTimer*        resizeTimer;     ///\> Ends the atlas deferral after a resize.
   bool           blocked;         ///\> UI udate blocking flag.
-  QMutex         receiveMutex;    ///\> Mutex to avoid endless recursion.
+  int            resyncStep;      ///\> Next query of the running sync (-1 if none).
+  bool           resyncLocked;    ///\> Did the running sync lock the UI?
+  bool           resyncAgain;     ///\> Was another sync asked for meanwhile?
+  unsigned long long resyncStart; ///\> Start time of the running sync.
   QString        versionString;   ///\> Holds the current amp version.
+  QDialog*       diagnostics;     ///\> Diagnostics panel (0 until shown).
+  QDialog*       monitor;         ///\> MIDI monitor window (0 until shown).
+  bool           fastStart;       ///\> Connect after the first frame?
+  bool           framePending;    ///\> Is the first frame still to be painted?
+  bool           startupSynced;   ///\> Did the startup connection finish?
+  bool           connectStarted;  ///\> Was connectToDT() called already?
+  EditHistory    history;         ///\> Undo and redo journal of the edits.
+  int            dragControl;     ///\> Controller of the edited dial (-1 if none).
+  QTimer*        dialIdleTimer;   ///\> Ends a dial edit after a pause.
+  bool           replaying;       ///\> Is sendingPreset an undo or redo step?
 };
 
 #endif // #ifndef __MAINWINDOW_H_INCLUDED__
@@ -0,0 +1,356 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    midilog.cpp
+///\ingroup dtedit
+///\brief   MIDI traffic log implementation.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include <cstring>
+#include "midilog.h"
+
+// Magic string at the start of every log:
+static const char midiLogMagic[8] = { 'D', 'T', 'M', 'I', 'D', 'L', 'O', 'G' };
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDILog::MIDILog()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Default constructor of this class.
+////////////////////////////////////////////////////////////////////////////////
+MIDILog::MIDILog() :
+  head(0),
+  writer(*this)
+{
+  // Slot n is free for record n:
+  for (unsigned int i = 0; i < CAPACITY; i++)
+    ring[i].sequence.fetchAndStoreRelaxed(static_cast<int>(i));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDILog::~MIDILog()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Destructor of this class.
+///\remarks Closes the log.
+////////////////////////////////////////////////////////////////////////////////
+MIDILog::~MIDILog()
+{
+  close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDILog::open()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Open a log file for appending.
+///\param   [in] fileName: The log file. It is created if needed.
+///\return  Returns true if successfull or false otherwise.
+///\remarks Existing files must be logs of the same version.
+////////////////////////////////////////////////////////////////////////////////
+bool MIDILog::open(const QString& fileName)
+{
+  // Close old log:
+  close();
+  QMutexLocker locker(&mutex);
+
+  // Forget records that came in too late for the old one:
+  drain();
+
+  // Open the file:
+  file.setFileName(fileName);
+  if (!file.open(QIODevice::ReadWrite))
+    return false;
+
+  // Write the header to new files:
+  if (file.size() == 0)
+  {
+    uchar header[MIDILOG_HEADER_SIZE];
+    memcpy(header, midiLogMagic, 8);
+    qToLittleEndian<quint32>(MIDILOG_VERSION, header + 8);
+    qToLittleEndian<quint32>(0, header + 12);
+    if (file.write(reinterpret_cast<const char*>(header), MIDILOG_HEADER_SIZE) != MIDILOG_HEADER_SIZE)
+    {
+      file.close();
+      return false;
+    }
+    start();
+    return true;
+  }
+
+  // Check existing files:
+  QByteArray header = file.read(MIDILOG_HEADER_SIZE);
+  if (header.size() != MIDILOG_HEADER_SIZE || memcmp(header.constData(), midiLogMagic, 8) != 0 ||
+      qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(header.constData()) + 8) != MIDILOG_VERSION)
+  {
+    file.close();
+    return false;
+  }
+
+  // Find the end of the last complete record, a crash may have left a
+  // partial one behind:
+  qint64 end = MIDILOG_HEADER_SIZE;
+  while (file.seek(end))
+  {
+    QByteArray recordHeader = file.read(MIDILOG_RECORD_SIZE);
+    if (recordHeader.size() != MIDILOG_RECORD_SIZE)
+      break;
+    unsigned int bytes = qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(recordHeader.constData()) + 10);
+    qint64 recordSize = MIDILOG_RECORD_SIZE + ((bytes + 7) & ~7);
+    if (end + recordSize > file.size())
+      break;
+    end += recordSize;
+  }
+
+  // Append behind it:
+  if (end != file.size())
+    file.resize(end);
+  file.seek(end);
+
+  // Return success:
+  start();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDILog::close()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Flush and close the log file.
+////////////////////////////////////////////////////////////////////////////////
+void MIDILog::close()
+{
+  // Refuse new records and end the writer thread:
+  active.fetchAndStoreRelease(0);
+  writer.stop.fetchAndStoreRelease(1);
+  writer.wait();
+
+  // Write what is left:
+  QMutexLocker locker(&mutex);
+  drain();
+  if (file.isOpen())
+    file.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDILog::isOpen()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Is a log file open?
+///\return  Returns true if messages are written.
+////////////////////////////////////////////////////////////////////////////////
+bool MIDILog::isOpen()
+{
+  return active.fetchAndAddAcquire(0) != 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDILog::write()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Append a message to the log.
+///\param   [in] direction: Direction of the message.
+///\param   [in] timeStamp: Time stamp of the message in nanoseconds.
+///\param   [in] message:   The raw MIDI message.
+///\remarks Does nothing if the log is closed. The record is dropped if the
+///         ring is full.
+////////////////////////////////////////////////////////////////////////////////
+void MIDILog::write(Direction direction, unsigned long long timeStamp, const std::vector<unsigned char>& message)
+{
+  if (active.fetchAndAddAcquire(0) == 0 || message.empty() || message.size() > 0xFFFF)
+    return;
+
+  // Claim a slot. It is free once its sequence equals the record number,
+  // a smaller one means the writer thread is a full ring behind:
+  unsigned int number = static_cast<unsigned int>(tail.fetchAndAddAcquire(0));
+  Slot* slot;
+  for (;;)
+  {
+    slot = &ring[number & (CAPACITY - 1)];
+    int distance = static_cast<int>(static_cast<unsigned int>(slot->sequence.fetchAndAddAcquire(0)) - number);
+    if (distance == 0 && tail.testAndSetOrdered(static_cast<int>(number), static_cast<int>(number + 1)))
+      break;
+    if (distance < 0)
+      return;
+    number = static_cast<unsigned int>(tail.fetchAndAddAcquire(0));
+  }
+
+  // Build the record:
+  QByteArray& record = slot->record;
+  int size = MIDILOG_RECORD_SIZE + ((message.size() + 7) & ~7);
+  record.fill(0, size);
+  uchar* data = reinterpret_cast<uchar*>(record.data());
+  qToLittleEndian<quint64>(timeStamp, data);
+  data[8] = static_cast<uchar>(direction);
+  qToLittleEndian<quint16>(static_cast<quint16>(message.size()), data + 10);
+  memcpy(data + MIDILOG_RECORD_SIZE, &message[0], message.size());
+
+  // Hand it to the writer thread:
+  slot->sequence.fetchAndStoreRelease(static_cast<int>(number + 1));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDILog::start()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Accept records and start the writer thread.
+///\remarks Call with the mutex held once the file is open.
+////////////////////////////////////////////////////////////////////////////////
+void MIDILog::start()
+{
+  writer.stop.fetchAndStoreRelease(0);
+  writer.start();
+  active.fetchAndStoreRelease(1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDILog::drain()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Append the filled records of the ring to the file.
+///\remarks Call with the mutex held. The records are dropped if no file is
+///         open.
+////////////////////////////////////////////////////////////////////////////////
+void MIDILog::drain()
+{
+  // Write the records in order, up to the first one still being filled:
+  bool written = false;
+  for (;;)
+  {
+    Slot& slot = ring[head & (CAPACITY - 1)];
+    if (slot.sequence.fetchAndAddAcquire(0) != static_cast<int>(head + 1))
+      break;
+    if (file.isOpen())
+    {
+      file.write(slot.record);
+      written = true;
+    }
+
+    // Free the slot for the record one ring later:
+    slot.sequence.fetchAndStoreRelease(static_cast<int>(head + CAPACITY));
+    head++;
+  }
+
+  // Flush each batch, which keeps the log complete up to the last interval
+  // if the editor crashes:
+  if (written)
+    file.flush();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDILog::Writer::run()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Writer thread function.
+///\remarks Writes the ring every WRITE_INTERVAL milliseconds until stopped.
+////////////////////////////////////////////////////////////////////////////////
+void MIDILog::Writer::run()
+{
+  while (stop.fetchAndAddAcquire(0) == 0)
+  {
+    msleep(WRITE_INTERVAL);
+    QMutexLocker locker(&log.mutex);
+    log.drain();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDILogReader::MIDILogReader()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Default constructor of this class.
+////////////////////////////////////////////////////////////////////////////////
+MIDILogReader::MIDILogReader() :
+  data(0),
+  size(0),
+  position(0)
+{
+  // Nothing to do here.
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDILogReader::open()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Open a log file and map it.
+///\param   [in] fileName: The log file.
+///\return  Returns true if successfull or false otherwise.
+////////////////////////////////////////////////////////////////////////////////
+bool MIDILogReader::open(const QString& fileName)
+{
+  // Forget the old file:
+  if (file.isOpen())
+    file.close();
+  data     = 0;
+  size     = 0;
+  position = 0;
+
+  // Open and map the new one:
+  file.setFileName(fileName);
+  if (!file.open(QIODevice::ReadOnly) || file.size() < MIDILOG_HEADER_SIZE)
+    return false;
+  const uchar* mapped = file.map(0, file.size());
+  if (mapped == 0)
+    return false;
+
+  // Check the header:
+  if (memcmp(mapped, midiLogMagic, 8) != 0 || qFromLittleEndian<quint32>(mapped + 8) != MIDILOG_VERSION)
+  {
+    file.close();
+    return false;
+  }
+
+  // Ready:
+  data     = mapped;
+  size     = file.size();
+  position = MIDILOG_HEADER_SIZE;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDILogReader::next()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Read the next record.
+///\param   [out] record: Receives the record.
+///\return  Returns false at the end of the log.
+///\remarks The record stays valid as long as this reader exists.
+////////////////////////////////////////////////////////////////////////////////
+bool MIDILogReader::next(Record& record)
+{
+  // Is there a complete record header?
+  if (data == 0 || position + MIDILOG_RECORD_SIZE > size)
+    return false;
+  const uchar* p = data + position;
+  unsigned int bytes = qFromLittleEndian<quint16>(p + 10);
+  qint64 recordSize = MIDILOG_RECORD_SIZE + ((bytes + 7) & ~7);
+  if (position + recordSize > size)
+    return false;
+
+  // Fill the record:
+  record.timeStamp = qFromLittleEndian<quint64>(p);
+  record.direction = p[8] == MIDILog::OUTBOUND ? MIDILog::OUTBOUND : MIDILog::INBOUND;
+  record.bytes     = p + MIDILOG_RECORD_SIZE;
+  record.size      = bytes;
+  position += recordSize;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDILogReader::rewind()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Continue with the first record again.
+////////////////////////////////////////////////////////////////////////////////
+void MIDILogReader::rewind()
+{
+  if (data != 0)
+    position = MIDILOG_HEADER_SIZE;
+}
+
+///////////////////////////////// End of File //////////////////////////////////
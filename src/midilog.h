@@ -0,0 +1,255 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    midilog.h
+///\ingroup dtedit
+///\brief   MIDI traffic log definitions.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef __MIDILOG_H_INCLUDED__
+#define __MIDILOG_H_INCLUDED__
+
+#include <QtCore>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// Log file layout
+////////////////////////////////////////////////////////////////////////////////
+// All numbers are little endian. The file starts with a 16 byte header:
+//
+//   char    magic[8];   "DTMIDLOG"
+//   quint32 version;    MIDILOG_VERSION
+//   quint32 reserved;   0
+//
+// followed by records that are only ever appended:
+//
+//   quint64 timeStamp;  RtMidi::getMonotonicTime() of the message
+//   quint8  direction;  MIDILog::INBOUND or MIDILog::OUTBOUND
+//   quint8  reserved;   0
+//   quint16 size;       Number of message bytes
+//   quint32 reserved;   0
+//   quint8  bytes[];    The message, padded with zeros to a multiple of 8
+//
+// Every record starts on an 8 byte boundary, so a mapped log can be read in
+// place. A record cut off by a crash is ignored by the reader.
+#define MIDILOG_VERSION     1
+#define MIDILOG_HEADER_SIZE 16
+#define MIDILOG_RECORD_SIZE 16
+
+////////////////////////////////////////////////////////////////////////////////
+///\class MIDILog midilog.h
+///\brief Writes the MIDI traffic of the editor to a log file.
+/// Writing is thread safe and lock free, so the MIDI input thread and the GUI
+/// thread can log to the same file without waiting for the disk. The records
+/// go to a ring that a writer thread appends to the file every WRITE_INTERVAL
+/// milliseconds. Closing the log while other threads still write is fine as
+/// well, their messages are dropped.
+////////////////////////////////////////////////////////////////////////////////
+class MIDILog
+{
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  ///\enum  Direction
+  ///\brief Direction of a logged message.
+  //////////////////////////////////////////////////////////////////////////////
+  enum Direction
+  {
+    INBOUND  = 0, ///> Received from the amp.
+    OUTBOUND = 1  ///> Sent to the amp.
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDILog::MIDILog()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Default constructor of this class.
+  //////////////////////////////////////////////////////////////////////////////
+  MIDILog();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDILog::~MIDILog()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Destructor of this class.
+  ///\remarks Closes the log.
+  //////////////////////////////////////////////////////////////////////////////
+  ~MIDILog();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDILog::open()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Open a log file for appending.
+  ///\param   [in] fileName: The log file. It is created if needed.
+  ///\return  Returns true if successfull or false otherwise.
+  ///\remarks Existing files must be logs of the same version.
+  //////////////////////////////////////////////////////////////////////////////
+  bool open(const QString& fileName);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDILog::close()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Flush and close the log file.
+  //////////////////////////////////////////////////////////////////////////////
+  void close();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDILog::isOpen()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Is a log file open?
+  ///\return  Returns true if messages are written.
+  //////////////////////////////////////////////////////////////////////////////
+  bool isOpen();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDILog::write()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Append a message to the log.
+  ///\param   [in] direction: Direction of the message.
+  ///\param   [in] timeStamp: Time stamp of the message in nanoseconds.
+  ///\param   [in] message:   The raw MIDI message.
+  ///\remarks Does nothing if the log is closed. The record is dropped if the
+  ///         ring is full.
+  //////////////////////////////////////////////////////////////////////////////
+  void write(Direction direction, unsigned long long timeStamp, const std::vector<unsigned char>& message);
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  // Ring size, must be a power of two:
+  enum { CAPACITY = 4096 };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Milliseconds between two writes of the writer thread:
+  enum { WRITE_INTERVAL = 50 };
+
+  //////////////////////////////////////////////////////////////////////////////
+  ///\struct Slot
+  ///\brief  A record in the ring.
+  //////////////////////////////////////////////////////////////////////////////
+  struct Slot
+  {
+    QAtomicInt sequence; ///> Number of the record + 1 once it is filled.
+    QByteArray record;   ///> The record as it goes to the file.
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  ///\class Writer
+  ///\brief Appends the ring to the log file.
+  //////////////////////////////////////////////////////////////////////////////
+  class Writer :
+    public QThread
+  {
+  public:
+    Writer(MIDILog& log) : log(log) { }
+    void run();
+    MIDILog&   log;  ///> The log to write.
+    QAtomicInt stop; ///> Non zero to end the thread.
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDILog::start()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Accept records and start the writer thread.
+  ///\remarks Call with the mutex held once the file is open.
+  //////////////////////////////////////////////////////////////////////////////
+  void start();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDILog::drain()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Append the filled records of the ring to the file.
+  ///\remarks Call with the mutex held. The records are dropped if no file
+  ///         is open.
+  //////////////////////////////////////////////////////////////////////////////
+  void drain();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  QMutex       mutex;           ///> Guards the file and the head.
+  QFile        file;            ///> The log file.
+  QAtomicInt   active;          ///> Non zero while a log is open.
+  QAtomicInt   tail;            ///> Number of the next record to fill.
+  unsigned int head;            ///> Number of the next record to write.
+  Slot         ring[CAPACITY];  ///> The records on their way to the file.
+  Writer       writer;          ///> Thread that writes the file.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///\class MIDILogReader midilog.h
+///\brief Reads a MIDI traffic log.
+/// The file is mapped into memory and the records are read in place.
+////////////////////////////////////////////////////////////////////////////////
+class MIDILogReader
+{
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  ///\struct Record
+  ///\brief  A logged message.
+  //////////////////////////////////////////////////////////////////////////////
+  struct Record
+  {
+    unsigned long long   timeStamp; ///> Time stamp in nanoseconds.
+    MIDILog::Direction   direction; ///> Direction of the message.
+    const unsigned char* bytes;     ///> The message, points into the mapped file.
+    unsigned int         size;      ///> Number of message bytes.
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDILogReader::MIDILogReader()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Default constructor of this class.
+  //////////////////////////////////////////////////////////////////////////////
+  MIDILogReader();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDILogReader::open()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Open a log file and map it.
+  ///\param   [in] fileName: The log file.
+  ///\return  Returns true if successfull or false otherwise.
+  //////////////////////////////////////////////////////////////////////////////
+  bool open(const QString& fileName);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDILogReader::next()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Read the next record.
+  ///\param   [out] record: Receives the record.
+  ///\return  Returns false at the end of the log.
+  ///\remarks The record stays valid as long as this reader exists.
+  //////////////////////////////////////////////////////////////////////////////
+  bool next(Record& record);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDILogReader::rewind()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Continue with the first record again.
+  //////////////////////////////////////////////////////////////////////////////
+  void rewind();
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  QFile        file;     ///> The log file.
+  const uchar* data;     ///> The mapped file (0 if not open).
+  qint64       size;     ///> Size of the mapped file.
+  qint64       position; ///> Offset of the next record.
+};
+
+#endif // #ifndef __MIDILOG_H_INCLUDED__
+///////////////////////////////// End of File //////////////////////////////////
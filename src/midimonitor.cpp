@@ -0,0 +1,236 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    midimonitor.cpp
+///\ingroup dtedit
+///\brief   MIDI monitor window class implementation.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include "midimonitor.h"
+#include "mainmidiwindow.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDITraceModel::MIDITraceModel()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Initialization constructor of this model.
+///\param   [in] parent: Parent object of this model.
+////////////////////////////////////////////////////////////////////////////////
+MIDITraceModel::MIDITraceModel(QObject* parent) :
+  QAbstractListModel(parent)
+{
+  // Nothing to do here.
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDITraceModel::append()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Add records at the end.
+///\param   [in] newRecords: The new records.
+///\remarks Drops the oldest rows beyond MAX_ROWS.
+////////////////////////////////////////////////////////////////////////////////
+void MIDITraceModel::append(const std::vector<MIDITrace::Record>& newRecords)
+{
+  // Anything to do?
+  if (newRecords.empty())
+    return;
+
+  // Make room:
+  int excess = static_cast<int>(records.size() + newRecords.size()) - MAX_ROWS;
+  if (excess > 0)
+  {
+    excess = qMin(excess, static_cast<int>(records.size()));
+    beginRemoveRows(QModelIndex(), 0, excess - 1);
+    records.erase(records.begin(), records.begin() + excess);
+    endRemoveRows();
+  }
+
+  // Add the records:
+  int first = static_cast<int>(records.size());
+  beginInsertRows(QModelIndex(), first, first + static_cast<int>(newRecords.size()) - 1);
+  records.insert(records.end(), newRecords.begin(), newRecords.end());
+  endInsertRows();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDITraceModel::clear()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Remove all rows.
+////////////////////////////////////////////////////////////////////////////////
+void MIDITraceModel::clear()
+{
+  beginResetModel();
+  records.clear();
+  endResetModel();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDITraceModel::rowCount()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the number of rows.
+///\param   [in] parent: Parent item, the list has none.
+///\return  The number of rows.
+////////////////////////////////////////////////////////////////////////////////
+int MIDITraceModel::rowCount(const QModelIndex& parent) const
+{
+  return parent.isValid() ? 0 : static_cast<int>(records.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDITraceModel::data()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the text of a row.
+///\param   [in] index: The row.
+///\param   [in] role:  The requested data.
+///\return  The formatted record for the display role.
+////////////////////////////////////////////////////////////////////////////////
+QVariant MIDITraceModel::data(const QModelIndex& index, int role) const
+{
+  if (role != Qt::DisplayRole || !index.isValid() || index.row() >= static_cast<int>(records.size()))
+    return QVariant();
+  return MIDITrace::format(records[index.row()]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIMonitor::MIDIMonitor()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Initialization constructor of this window.
+///\param   [in] trace:  The trace to show.
+///\param   [in] parent: Parent window for this window.
+///\remarks Starts with the records that are in the trace already.
+////////////////////////////////////////////////////////////////////////////////
+MIDIMonitor::MIDIMonitor(const MIDITrace& trace, QWidget *parent) :
+  QDialog(parent),
+  trace(trace),
+  next(0)
+{
+  setWindowTitle(tr("MIDI Monitor"));
+
+  // List of the records. All rows have the same height, so the view does
+  // not need to format rows to lay them out:
+  model = new MIDITraceModel(this);
+  view  = new QListView(this);
+  view->setModel(model);
+  view->setUniformItemSizes(true);
+  view->setSelectionMode(QAbstractItemView::ExtendedSelection);
+  QFont font("Monospace");
+  font.setStyleHint(QFont::TypeWriter);
+  view->setFont(font);
+
+  // Buttons:
+  pause = new QCheckBox(tr("Pause"), this);
+  QPushButton* clearButton = new QPushButton(tr("Clear"), this);
+  QPushButton* saveButton  = new QPushButton(tr("Save..."), this);
+  QPushButton* closeButton = new QPushButton(tr("Close"), this);
+  connect(clearButton, SIGNAL(clicked()), this, SLOT(clear()));
+  connect(saveButton,  SIGNAL(clicked()), this, SLOT(save()));
+  connect(closeButton, SIGNAL(clicked()), this, SLOT(close()));
+
+  // Layout:
+  QHBoxLayout* buttons = new QHBoxLayout();
+  buttons->addWidget(pause);
+  buttons->addWidget(clearButton);
+  buttons->addWidget(saveButton);
+  buttons->addStretch();
+  buttons->addWidget(closeButton);
+  QVBoxLayout* layout = new QVBoxLayout(this);
+  layout->addWidget(view);
+  layout->addLayout(buttons);
+  resize(560, 480);
+
+  // Poll timer:
+  connect(&timer, SIGNAL(timeout()), this, SLOT(poll()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIMonitor::showEvent()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Start polling when the window is shown.
+///\param   [in] e: Description of the event.
+////////////////////////////////////////////////////////////////////////////////
+void MIDIMonitor::showEvent(QShowEvent* e)
+{
+  poll();
+  timer.start(250);
+  QDialog::showEvent(e);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIMonitor::hideEvent()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Stop polling when the window is hidden.
+///\param   [in] e: Description of the event.
+////////////////////////////////////////////////////////////////////////////////
+void MIDIMonitor::hideEvent(QHideEvent* e)
+{
+  timer.stop();
+  QDialog::hideEvent(e);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIMonitor::poll()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Add the records traced since the last poll.
+///\remarks While paused the trace keeps running, the records are picked up
+///         when the pause ends as long as they are still in the ring.
+////////////////////////////////////////////////////////////////////////////////
+void MIDIMonitor::poll()
+{
+  if (pause->isChecked())
+    return;
+
+  // Fetch new records:
+  fresh.clear();
+  next = trace.read(next, fresh);
+  if (fresh.empty())
+    return;
+
+  // Show them, following the end of the list unless the user scrolled away:
+  bool atEnd = view->verticalScrollBar()->value() == view->verticalScrollBar()->maximum();
+  model->append(fresh);
+  if (atEnd)
+    view->scrollToBottom();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIMonitor::clear()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the clear button.
+////////////////////////////////////////////////////////////////////////////////
+void MIDIMonitor::clear()
+{
+  model->clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIMonitor::save()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the save button, dumps the trace to a file.
+////////////////////////////////////////////////////////////////////////////////
+void MIDIMonitor::save()
+{
+  QString fileName = QFileDialog::getSaveFileName(this, tr("Save MIDI trace"), QString(), tr("Text files (*.txt)"));
+  if (fileName.isEmpty())
+    return;
+  if (!trace.dump(fileName))
+    QMessageBox::warning(this, tr("MIDI Monitor"), tr("Could not write %1.").arg(fileName));
+}
+
+///////////////////////////////// End of File //////////////////////////////////
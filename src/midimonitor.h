@@ -0,0 +1,158 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    midimonitor.h
+///\ingroup dtedit
+///\brief   MIDI monitor window class definition.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef __MIDIMONITOR_H_INCLUDED__
+#define __MIDIMONITOR_H_INCLUDED__
+
+#include <QDialog>
+#include <QTimer>
+#include <QAbstractListModel>
+#include "miditrace.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Forwards:
+class QListView;
+class QCheckBox;
+
+////////////////////////////////////////////////////////////////////////////////
+///\class MIDITraceModel midimonitor.h
+///\brief List model over records copied from a MIDI trace.
+/// Only the binary records are kept, the text of a row is made when the view
+/// asks for it, so only the visible rows are ever formatted.
+////////////////////////////////////////////////////////////////////////////////
+class MIDITraceModel :
+  public QAbstractListModel
+{
+public:
+  enum { MAX_ROWS = 50000 };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDITraceModel::MIDITraceModel()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Initialization constructor of this model.
+  ///\param   [in] parent: Parent object of this model.
+  //////////////////////////////////////////////////////////////////////////////
+  MIDITraceModel(QObject* parent = 0);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDITraceModel::append()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Add records at the end.
+  ///\param   [in] newRecords: The new records.
+  ///\remarks Drops the oldest rows beyond MAX_ROWS.
+  //////////////////////////////////////////////////////////////////////////////
+  void append(const std::vector<MIDITrace::Record>& newRecords);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDITraceModel::clear()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Remove all rows.
+  //////////////////////////////////////////////////////////////////////////////
+  void clear();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDITraceModel::rowCount()
+  // MIDITraceModel::data()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Model interface, see QAbstractListModel.
+  //////////////////////////////////////////////////////////////////////////////
+  int rowCount(const QModelIndex& parent = QModelIndex()) const;
+  QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  std::vector<MIDITrace::Record> records; ///> The rows.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///\class MIDIMonitor midimonitor.h
+///\brief MIDI monitor window.
+/// Shows the MIDI trace of the editor while it grows. New records are picked
+/// up four times a second while the window is visible.
+////////////////////////////////////////////////////////////////////////////////
+class MIDIMonitor : public QDialog
+{
+  Q_OBJECT // Qt magic...
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDIMonitor::MIDIMonitor()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Initialization constructor of this window.
+  ///\param   [in] trace:  The trace to show.
+  ///\param   [in] parent: Parent window for this window.
+  ///\remarks Starts with the records that are in the trace already.
+  //////////////////////////////////////////////////////////////////////////////
+  MIDIMonitor(const MIDITrace& trace, QWidget *parent = 0);
+
+protected:
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDIMonitor::showEvent()
+  // MIDIMonitor::hideEvent()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Start and stop the polling with the visibility.
+  ///\param   [in] e: Description of the event.
+  //////////////////////////////////////////////////////////////////////////////
+  void showEvent(QShowEvent* e);
+  void hideEvent(QHideEvent* e);
+
+private slots:
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDIMonitor::poll()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Add the records traced since the last poll.
+  //////////////////////////////////////////////////////////////////////////////
+  void poll();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDIMonitor::clear()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the clear button.
+  //////////////////////////////////////////////////////////////////////////////
+  void clear();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDIMonitor::save()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the save button, dumps the trace to a file.
+  //////////////////////////////////////////////////////////////////////////////
+  void save();
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  const MIDITrace&               trace;   ///> The trace shown.
+  unsigned int                   next;    ///> Position of the next read.
+  std::vector<MIDITrace::Record> fresh;   ///> Buffer of the polled records.
+  MIDITraceModel*                model;   ///> The rows shown.
+  QListView*                     view;    ///> The list.
+  QCheckBox*                     pause;   ///> Pause the updates?
+  QTimer                         timer;   ///> Poll timer.
+};
+
+#endif // __MIDIMONITOR_H_INCLUDED__
+///////////////////////////////// End of File //////////////////////////////////
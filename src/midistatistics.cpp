@@ -0,0 +1,461 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    midistatistics.cpp
+///\ingroup dtedit
+///\brief   MIDI engine statistics implementation.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include "midistatistics.h"
+#include "RtMidi/RtMidi.h"
+
+// Names of the message types in reports, in the order of the counters:
+static const char* typeNames[MIDIStatistics::TYPE_COUNT] =
+{
+  "noteOff", "noteOn", "polyAftertouch", "controlChange",
+  "programChange", "channelAftertouch", "pitchBend", "system"
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// atomicLoad()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Read an atomic counter with Qt 4 and Qt 5.
+///\param   [in] value: The counter.
+///\return  The current value.
+////////////////////////////////////////////////////////////////////////////////
+static int atomicLoad(const QAtomicInt& value)
+{
+  #if QT_VERSION >= 0x050000
+  return value.load();
+  #else
+  return value;
+  #endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// jsonString()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Quote a string for JSON.
+///\param   [in] text: The string.
+///\return  The quoted string.
+////////////////////////////////////////////////////////////////////////////////
+static QString jsonString(const QString& text)
+{
+  QString quoted = text;
+  quoted.replace('\\', "\\\\");
+  quoted.replace('"', "\\\"");
+  return "\"" + quoted + "\"";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// LatencyHistogram::add()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Count a duration.
+///\param   [in] nanoSeconds: The duration.
+////////////////////////////////////////////////////////////////////////////////
+void LatencyHistogram::add(unsigned long long nanoSeconds)
+{
+  // Convert to microseconds:
+  unsigned long long us = nanoSeconds / 1000;
+  int microSeconds = us > 0x7FFFFFFF ? 0x7FFFFFFF : static_cast<int>(us);
+
+  // Find bucket:
+  int bucket = 0;
+  for (unsigned long long v = us >> 1; v != 0 && bucket < BUCKET_COUNT - 1; v >>= 1)
+    bucket++;
+
+  // Count:
+  buckets[bucket].fetchAndAddRelaxed(1);
+  total.fetchAndAddRelaxed(1);
+  lastMicroSeconds.fetchAndStoreRelaxed(microSeconds);
+  for (;;)
+  {
+    int old = atomicLoad(maxMicroSeconds);
+    if (microSeconds <= old || maxMicroSeconds.testAndSetRelaxed(old, microSeconds))
+      break;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// LatencyHistogram::reset()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Forget all counted durations.
+////////////////////////////////////////////////////////////////////////////////
+void LatencyHistogram::reset()
+{
+  for (int i = 0; i < BUCKET_COUNT; i++)
+    buckets[i].fetchAndStoreRelaxed(0);
+  total.fetchAndStoreRelaxed(0);
+  maxMicroSeconds.fetchAndStoreRelaxed(0);
+  lastMicroSeconds.fetchAndStoreRelaxed(0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// LatencyHistogram::count()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the number of counted durations.
+///\return  The count.
+////////////////////////////////////////////////////////////////////////////////
+int LatencyHistogram::count() const
+{
+  return atomicLoad(total);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// LatencyHistogram::maximum()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the longest counted duration.
+///\return  The duration in microseconds.
+////////////////////////////////////////////////////////////////////////////////
+int LatencyHistogram::maximum() const
+{
+  return atomicLoad(maxMicroSeconds);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// LatencyHistogram::last()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the most recent duration.
+///\return  The duration in microseconds.
+////////////////////////////////////////////////////////////////////////////////
+int LatencyHistogram::last() const
+{
+  return atomicLoad(lastMicroSeconds);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// LatencyHistogram::percentile()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Estimate a percentile.
+///\param   [in] fraction: The percentile, 0.5 for the median.
+///\return  Upper bound of the bucket holding the percentile in
+///         microseconds, or 0 if nothing was counted.
+////////////////////////////////////////////////////////////////////////////////
+int LatencyHistogram::percentile(double fraction) const
+{
+  // Take a copy, the buckets may change meanwhile:
+  int counts[BUCKET_COUNT];
+  int sum = 0;
+  for (int i = 0; i < BUCKET_COUNT; i++)
+  {
+    counts[i] = atomicLoad(buckets[i]);
+    sum += counts[i];
+  }
+  if (sum == 0)
+    return 0;
+
+  // Find the bucket, the last one is only limited by the maximum:
+  int rank = static_cast<int>(fraction * sum + 0.5);
+  if (rank < 1)
+    rank = 1;
+  for (int i = 0; i < BUCKET_COUNT - 1; i++)
+  {
+    rank -= counts[i];
+    if (rank <= 0)
+      return qMin(2 << i, maximum());
+  }
+  return maximum();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// LatencyHistogram::toJSON()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Describe this histogram as JSON object.
+///\return  The JSON text.
+////////////////////////////////////////////////////////////////////////////////
+QString LatencyHistogram::toJSON() const
+{
+  QString json = QString("{ \"count\": %1, \"lastUs\": %2, \"p50Us\": %3, \"p99Us\": %4, \"maxUs\": %5, \"buckets\": [")
+    .arg(count()).arg(last()).arg(percentile(0.5)).arg(percentile(0.99)).arg(maximum());
+  for (int i = 0; i < BUCKET_COUNT; i++)
+    json += QString(i ? ", %1" : "%1").arg(atomicLoad(buckets[i]));
+  return json + "] }";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIStatistics::MIDIStatistics()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Default constructor of this class.
+////////////////////////////////////////////////////////////////////////////////
+MIDIStatistics::MIDIStatistics() :
+  pendingQuery(-1),
+  querySendTime(0)
+{
+  // Nothing to do here.
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIStatistics::reset()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Set all counters to zero.
+////////////////////////////////////////////////////////////////////////////////
+void MIDIStatistics::reset()
+{
+  for (int i = 0; i < TYPE_COUNT; i++)
+  {
+    messagesIn[i].fetchAndStoreRelaxed(0);
+    messagesOut[i].fetchAndStoreRelaxed(0);
+  }
+  bytesIn.fetchAndStoreRelaxed(0);
+  bytesOut.fetchAndStoreRelaxed(0);
+  echoes.fetchAndStoreRelaxed(0);
+  unansweredQueries.fetchAndStoreRelaxed(0);
+  batches.fetchAndStoreRelaxed(0);
+  batchedChanges.fetchAndStoreRelaxed(0);
+  overBudgetBatches.fetchAndStoreRelaxed(0);
+  applyLatency.reset();
+  resyncDuration.reset();
+  batchDuration.reset();
+  for (int i = 0; i < QUERY_COUNT; i++)
+    queryResponse[i].reset();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIStatistics::messageReceived()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Count a received message by type and size.
+///\param   [in] message: The raw MIDI message.
+////////////////////////////////////////////////////////////////////////////////
+void MIDIStatistics::messageReceived(const std::vector<unsigned char>& message)
+{
+  if (message.empty())
+    return;
+  messagesIn[typeIndex(message[0])].fetchAndAddRelaxed(1);
+  bytesIn.fetchAndAddRelaxed(static_cast<int>(message.size()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIStatistics::messageSent()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Count a sent message by type and size.
+///\param   [in] message: The raw MIDI message.
+////////////////////////////////////////////////////////////////////////////////
+void MIDIStatistics::messageSent(const std::vector<unsigned char>& message)
+{
+  if (message.empty())
+    return;
+  messagesOut[typeIndex(message[0])].fetchAndAddRelaxed(1);
+  bytesOut.fetchAndAddRelaxed(static_cast<int>(message.size()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIStatistics::messageApplied()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Count the time from the arrival of a message until the user
+///         interface was updated.
+///\param   [in] nanoSeconds: The duration.
+////////////////////////////////////////////////////////////////////////////////
+void MIDIStatistics::messageApplied(unsigned long long nanoSeconds)
+{
+  applyLatency.add(nanoSeconds);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIStatistics::batchApplied()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Count a batch of control changes applied in one frame.
+///\param   [in] changes:     Number of changes in the batch.
+///\param   [in] nanoSeconds: Time it took to apply them.
+///\param   [in] overBudget:  Did it take longer than the frame budget?
+////////////////////////////////////////////////////////////////////////////////
+void MIDIStatistics::batchApplied(int changes, unsigned long long nanoSeconds, bool overBudget)
+{
+  batches.fetchAndAddRelaxed(1);
+  batchedChanges.fetchAndAddRelaxed(changes);
+  if (overBudget)
+    overBudgetBatches.fetchAndAddRelaxed(1);
+  batchDuration.add(nanoSeconds);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIStatistics::echoSuppressed()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Count a control change ignored while the UI was blocked.
+////////////////////////////////////////////////////////////////////////////////
+void MIDIStatistics::echoSuppressed()
+{
+  echoes.fetchAndAddRelaxed(1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIStatistics::resyncDone()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Count a complete read of the amp state.
+///\param   [in] nanoSeconds: Duration of the resync.
+////////////////////////////////////////////////////////////////////////////////
+void MIDIStatistics::resyncDone(unsigned long long nanoSeconds)
+{
+  resyncDuration.add(nanoSeconds);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIStatistics::queryStarted()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Note that a CC 83 parameter query was sent.
+///\param   [in] query:    The queried parameter group (the CC value).
+///\param   [in] sendTime: Monotonic send time in nanoseconds.
+///\remarks A query still waiting for its answer counts as unanswered. The
+///         64 bit send time can't be stored atomically everywhere, so it is
+///         written together with the query under the query mutex.
+////////////////////////////////////////////////////////////////////////////////
+void MIDIStatistics::queryStarted(int query, unsigned long long sendTime)
+{
+  if (query < 0 || query >= QUERY_COUNT)
+    return;
+  QMutexLocker locker(&queryMutex);
+  querySendTime = sendTime;
+  if (pendingQuery.fetchAndStoreOrdered(query) >= 0)
+    unansweredQueries.fetchAndAddRelaxed(1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIStatistics::queryAnswered()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Note the arrival of a parameter value.
+///\param   [in] arrivalTime: Monotonic arrival time in nanoseconds.
+///\remarks The first value after a query is taken as its answer, later
+///         ones are ignored. Only values that answer a query take the query
+///         mutex.
+////////////////////////////////////////////////////////////////////////////////
+void MIDIStatistics::queryAnswered(unsigned long long arrivalTime)
+{
+  if (atomicLoad(pendingQuery) < 0)
+    return;
+  int query;
+  unsigned long long sendTime;
+  {
+    QMutexLocker locker(&queryMutex);
+    query    = pendingQuery.fetchAndStoreOrdered(-1);
+    sendTime = querySendTime;
+  }
+  if (query < 0)
+    return;
+  queryResponse[query].add(arrivalTime > sendTime ? arrivalTime - sendTime : 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIStatistics::toJSON()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Make a report in JSON format.
+///\param   [in] driver: Numbers of the MIDI driver to include.
+///\return  The JSON text.
+////////////////////////////////////////////////////////////////////////////////
+QString MIDIStatistics::toJSON(const DriverStatistics& driver) const
+{
+  QString json = "{\n";
+  json += QString("  \"time\": %1,\n").arg(RtMidi::getMonotonicTime());
+  json += QString("  \"api\": %1,\n").arg(jsonString(driver.api));
+  json += QString("  \"scheduling\": %1,\n").arg(jsonString(driver.scheduling));
+
+  // Message counters:
+  json += "  \"messagesIn\": {";
+  for (int i = 0; i < TYPE_COUNT; i++)
+    json += QString(i ? ", \"%1\": %2" : " \"%1\": %2").arg(typeNames[i]).arg(atomicLoad(messagesIn[i]));
+  json += " },\n  \"messagesOut\": {";
+  for (int i = 0; i < TYPE_COUNT; i++)
+    json += QString(i ? ", \"%1\": %2" : " \"%1\": %2").arg(typeNames[i]).arg(atomicLoad(messagesOut[i]));
+  json += " },\n";
+
+  // Other counters:
+  json += QString("  \"bytesIn\": %1,\n").arg(atomicLoad(bytesIn));
+  json += QString("  \"bytesOut\": %1,\n").arg(atomicLoad(bytesOut));
+  json += QString("  \"wireBytesOut\": %1,\n").arg(driver.wireBytesOut);
+  json += QString("  \"droppedMessages\": %1,\n").arg(driver.droppedMessages);
+  json += QString("  \"echoesSuppressed\": %1,\n").arg(atomicLoad(echoes));
+  json += QString("  \"unansweredQueries\": %1,\n").arg(atomicLoad(unansweredQueries));
+  json += QString("  \"batches\": %1,\n").arg(atomicLoad(batches));
+  json += QString("  \"batchedChanges\": %1,\n").arg(atomicLoad(batchedChanges));
+  json += QString("  \"batchesOverBudget\": %1,\n").arg(atomicLoad(overBudgetBatches));
+
+  // Histograms:
+  json += "  \"applyLatency\": " + applyLatency.toJSON() + ",\n";
+  json += "  \"resyncDuration\": " + resyncDuration.toJSON() + ",\n";
+  json += "  \"batchDuration\": " + batchDuration.toJSON() + ",\n";
+  json += "  \"queryResponse\": {";
+  bool first = true;
+  for (int i = 0; i < QUERY_COUNT; i++)
+  {
+    if (queryResponse[i].count() == 0)
+      continue;
+    json += QString(first ? "\n    \"%1\": " : ",\n    \"%1\": ").arg(i) + queryResponse[i].toJSON();
+    first = false;
+  }
+  json += first ? "}\n}\n" : "\n  }\n}\n";
+  return json;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIStatistics::toText()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Make a human readable report.
+///\param   [in] driver: Numbers of the MIDI driver to include.
+///\return  The report, one value per line.
+////////////////////////////////////////////////////////////////////////////////
+QString MIDIStatistics::toText(const DriverStatistics& driver) const
+{
+  QString text;
+  text += QString("MIDI API:             %1\n").arg(driver.api);
+  text += QString("Input thread:         %1\n\n").arg(driver.scheduling);
+
+  // Messages:
+  text += QString("%1 %2 %3\n").arg("Messages", -21).arg("in", 10).arg("out", 10);
+  for (int i = 0; i < TYPE_COUNT; i++)
+    text += QString("  %1 %2 %3\n").arg(typeNames[i], -19).arg(atomicLoad(messagesIn[i]), 10).arg(atomicLoad(messagesOut[i]), 10);
+  text += QString("  %1 %2 %3\n").arg("bytes", -19).arg(atomicLoad(bytesIn), 10).arg(atomicLoad(bytesOut), 10);
+  text += QString("  %1 %2 %3\n\n").arg("bytes on the wire", -19).arg("", 10).arg(driver.wireBytesOut, 10);
+
+  // Counters:
+  text += QString("Dropped at queue limit: %1\n").arg(driver.droppedMessages);
+  text += QString("Echoes suppressed:      %1\n").arg(atomicLoad(echoes));
+  text += QString("Unanswered queries:     %1\n").arg(atomicLoad(unansweredQueries));
+  text += QString("GUI batches:            %1 (%2 changes, %3 over budget)\n\n").arg(atomicLoad(batches)).arg(atomicLoad(batchedChanges)).arg(atomicLoad(overBudgetBatches));
+
+  // Durations:
+  text += QString("%1 %2 %3 %4 %5 %6\n").arg("Durations [us]", -21).arg("count", 8).arg("last", 9).arg("p50", 9).arg("p99", 9).arg("max", 9);
+  QList<QPair<QString, const LatencyHistogram*> > histograms;
+  histograms.append(qMakePair(QString("GUI apply"), &applyLatency));
+  histograms.append(qMakePair(QString("resync"), &resyncDuration));
+  histograms.append(qMakePair(QString("GUI batch"), &batchDuration));
+  for (int i = 0; i < QUERY_COUNT; i++)
+    if (queryResponse[i].count() > 0)
+      histograms.append(qMakePair(QString("query 83/%1").arg(i), &queryResponse[i]));
+  for (int i = 0; i < histograms.size(); i++)
+  {
+    const LatencyHistogram* h = histograms[i].second;
+    text += QString("  %1 %2 %3 %4 %5 %6\n").arg(histograms[i].first, -19).arg(h->count(), 8)
+      .arg(h->last(), 9).arg(h->percentile(0.5), 9).arg(h->percentile(0.99), 9).arg(h->maximum(), 9);
+  }
+  return text;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDIStatistics::typeIndex()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the counter index for a status byte.
+///\param   [in] status: The status byte.
+///\return  0-6 for the channel messages, 7 for system messages.
+////////////////////////////////////////////////////////////////////////////////
+int MIDIStatistics::typeIndex(unsigned char status)
+{
+  return status >= 0xF0 ? 7 : (status >> 4) & 0x07;
+}
+
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,261 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    midistatistics.h
+///\ingroup dtedit
+///\brief   MIDI engine statistics definitions.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef __MIDISTATISTICS_H_INCLUDED__
+#define __MIDISTATISTICS_H_INCLUDED__
+
+#include <QtCore>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+///\class LatencyHistogram midistatistics.h
+///\brief Lock-free histogram of durations.
+/// The buckets are powers of two in microseconds: Bucket 0 counts everything
+/// below 2 us, bucket n the range [2^n, 2^(n+1)) us and the last bucket all
+/// longer durations. Any thread can add values at any time.
+////////////////////////////////////////////////////////////////////////////////
+class LatencyHistogram
+{
+public:
+  enum { BUCKET_COUNT = 24 };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // LatencyHistogram::add()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Count a duration.
+  ///\param   [in] nanoSeconds: The duration.
+  //////////////////////////////////////////////////////////////////////////////
+  void add(unsigned long long nanoSeconds);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // LatencyHistogram::reset()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Forget all counted durations.
+  //////////////////////////////////////////////////////////////////////////////
+  void reset();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // LatencyHistogram::count()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get the number of counted durations.
+  ///\return  The count.
+  //////////////////////////////////////////////////////////////////////////////
+  int count() const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // LatencyHistogram::maximum()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get the longest counted duration.
+  ///\return  The duration in microseconds.
+  //////////////////////////////////////////////////////////////////////////////
+  int maximum() const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // LatencyHistogram::last()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get the most recent duration.
+  ///\return  The duration in microseconds.
+  //////////////////////////////////////////////////////////////////////////////
+  int last() const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // LatencyHistogram::percentile()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Estimate a percentile.
+  ///\param   [in] fraction: The percentile, 0.5 for the median.
+  ///\return  Upper bound of the bucket holding the percentile in
+  ///         microseconds, or 0 if nothing was counted.
+  //////////////////////////////////////////////////////////////////////////////
+  int percentile(double fraction) const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // LatencyHistogram::toJSON()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Describe this histogram as JSON object.
+  ///\return  The JSON text.
+  //////////////////////////////////////////////////////////////////////////////
+  QString toJSON() const;
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  QAtomicInt buckets[BUCKET_COUNT]; ///> Number of durations per bucket.
+  QAtomicInt total;                 ///> Number of all durations.
+  QAtomicInt maxMicroSeconds;       ///> Longest duration.
+  QAtomicInt lastMicroSeconds;      ///> Most recent duration.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///\struct DriverStatistics
+///\brief  Numbers kept by the MIDI driver, collected for a report.
+////////////////////////////////////////////////////////////////////////////////
+struct DriverStatistics
+{
+  QString       api;             ///> Name of the MIDI API in use.
+  QString       scheduling;      ///> Scheduling of the MIDI input thread.
+  unsigned long wireBytesOut;    ///> Bytes written to the wire by RtMidiOut.
+  unsigned long droppedMessages; ///> Messages dropped at the RtMidiIn queue limit.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///\class MIDIStatistics midistatistics.h
+///\brief Counters of the MIDI engine of the editor.
+/// All counters are atomic so the MIDI input thread and the GUI thread can
+/// update them without locks while a report is made.
+////////////////////////////////////////////////////////////////////////////////
+class MIDIStatistics
+{
+public:
+  enum { TYPE_COUNT = 8, QUERY_COUNT = 128 };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDIStatistics::MIDIStatistics()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Default constructor of this class.
+  //////////////////////////////////////////////////////////////////////////////
+  MIDIStatistics();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDIStatistics::reset()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Set all counters to zero.
+  //////////////////////////////////////////////////////////////////////////////
+  void reset();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDIStatistics::messageReceived()
+  // MIDIStatistics::messageSent()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Count a message by type and size.
+  ///\param   [in] message: The raw MIDI message.
+  //////////////////////////////////////////////////////////////////////////////
+  void messageReceived(const std::vector<unsigned char>& message);
+  void messageSent(const std::vector<unsigned char>& message);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDIStatistics::messageApplied()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Count the time from the arrival of a message until the user
+  ///         interface was updated.
+  ///\param   [in] nanoSeconds: The duration.
+  //////////////////////////////////////////////////////////////////////////////
+  void messageApplied(unsigned long long nanoSeconds);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDIStatistics::batchApplied()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Count a batch of control changes applied in one frame.
+  ///\param   [in] changes:     Number of changes in the batch.
+  ///\param   [in] nanoSeconds: Time it took to apply them.
+  ///\param   [in] overBudget:  Did it take longer than the frame budget?
+  //////////////////////////////////////////////////////////////////////////////
+  void batchApplied(int changes, unsigned long long nanoSeconds, bool overBudget);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDIStatistics::echoSuppressed()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Count a control change ignored while the UI was blocked.
+  //////////////////////////////////////////////////////////////////////////////
+  void echoSuppressed();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDIStatistics::resyncDone()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Count a complete read of the amp state.
+  ///\param   [in] nanoSeconds: Duration of the resync.
+  //////////////////////////////////////////////////////////////////////////////
+  void resyncDone(unsigned long long nanoSeconds);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDIStatistics::queryStarted()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Note that a CC 83 parameter query was sent.
+  ///\param   [in] query:    The queried parameter group (the CC value).
+  ///\param   [in] sendTime: Monotonic send time in nanoseconds.
+  ///\remarks A query still waiting for its answer counts as unanswered.
+  //////////////////////////////////////////////////////////////////////////////
+  void queryStarted(int query, unsigned long long sendTime);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDIStatistics::queryAnswered()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Note the arrival of a parameter value.
+  ///\param   [in] arrivalTime: Monotonic arrival time in nanoseconds.
+  ///\remarks The first value after a query is taken as its answer, later
+  ///         ones are ignored.
+  //////////////////////////////////////////////////////////////////////////////
+  void queryAnswered(unsigned long long arrivalTime);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDIStatistics::toJSON()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Make a report in JSON format.
+  ///\param   [in] driver: Numbers of the MIDI driver to include.
+  ///\return  The JSON text.
+  //////////////////////////////////////////////////////////////////////////////
+  QString toJSON(const DriverStatistics& driver) const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDIStatistics::toText()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Make a human readable report.
+  ///\param   [in] driver: Numbers of the MIDI driver to include.
+  ///\return  The report, one value per line.
+  //////////////////////////////////////////////////////////////////////////////
+  QString toText(const DriverStatistics& driver) const;
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDIStatistics::typeIndex()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get the counter index for a status byte.
+  ///\param   [in] status: The status byte.
+  ///\return  0-6 for the channel messages, 7 for system messages.
+  //////////////////////////////////////////////////////////////////////////////
+  static int typeIndex(unsigned char status);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  QAtomicInt         messagesIn[TYPE_COUNT];     ///> Received messages by type.
+  QAtomicInt         messagesOut[TYPE_COUNT];    ///> Sent messages by type.
+  QAtomicInt         bytesIn;                    ///> Received bytes.
+  QAtomicInt         bytesOut;                   ///> Sent bytes before any compression.
+  QAtomicInt         echoes;                     ///> Suppressed echoes.
+  QAtomicInt         unansweredQueries;          ///> Queries without an answer.
+  QAtomicInt         batches;                    ///> Batches applied by the GUI.
+  QAtomicInt         batchedChanges;             ///> Changes in all batches.
+  QAtomicInt         overBudgetBatches;          ///> Batches over the frame budget.
+  QMutex             queryMutex;                 ///> Pairs the pending query with its send time.
+  QAtomicInt         pendingQuery;               ///> Query waiting for its answer (-1 if none).
+  unsigned long long querySendTime;              ///> Send time of the pending query.
+  LatencyHistogram   applyLatency;               ///> Arrival to UI update.
+  LatencyHistogram   resyncDuration;             ///> Duration of complete resyncs.
+  LatencyHistogram   batchDuration;              ///> Time to apply a batch.
+  LatencyHistogram   queryResponse[QUERY_COUNT]; ///> Response time per query.
+};
+
+#endif // #ifndef __MIDISTATISTICS_H_INCLUDED__
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,411 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    miditrace.cpp
+///\ingroup dtedit
+///\brief   MIDI trace implementation.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include <cstring>
+#include <csignal>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include "miditrace.h"
+
+// The trace dumped by the crash handler and its file:
+static const MIDITrace* crashTrace = 0;
+static char             crashFileName[1024];
+
+////////////////////////////////////////////////////////////////////////////////
+// appendText()
+// appendNumber()
+// appendHex()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Helpers of formatLine(), they do not allocate and can be used in a
+///         signal handler.
+///\param   [in] p:     Where to write.
+///\param   [in] text:  Text to copy.
+///\param   [in] value: Number to write.
+///\param   [in] width: Minimum number of digits.
+///\param   [in] fill:  Character used to reach the width.
+///\return  Position after the written characters.
+////////////////////////////////////////////////////////////////////////////////
+static char* appendText(char* p, const char* text)
+{
+  while (*text != 0)
+    *p++ = *text++;
+  return p;
+}
+
+static char* appendNumber(char* p, unsigned long long value, int width = 1, char fill = ' ')
+{
+  // Collect digits backwards:
+  char digits[20];
+  int count = 0;
+  do
+  {
+    digits[count++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+
+  // Pad and copy:
+  for (int i = count; i < width; i++)
+    *p++ = fill;
+  while (count > 0)
+    *p++ = digits[--count];
+  return p;
+}
+
+static char* appendHex(char* p, unsigned char value)
+{
+  static const char hexDigits[] = "0123456789ABCDEF";
+  *p++ = hexDigits[value >> 4];
+  *p++ = hexDigits[value & 0x0F];
+  return p;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDITrace::MIDITrace()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Default constructor of this class.
+////////////////////////////////////////////////////////////////////////////////
+MIDITrace::MIDITrace() :
+  head(0)
+{
+  // Mark all slots as empty:
+  for (int i = 0; i < CAPACITY; i++)
+    ring[i].sequence.fetchAndStoreRelaxed(0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDITrace::~MIDITrace()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Destructor of this class.
+///\remarks Removes the crash handler if it dumps this trace.
+////////////////////////////////////////////////////////////////////////////////
+MIDITrace::~MIDITrace()
+{
+  if (crashTrace == this)
+    crashTrace = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDITrace::add()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Trace a message.
+///\param   [in] direction: Direction of the message.
+///\param   [in] timeStamp: Time of the message in nanoseconds.
+///\param   [in] message:   The raw MIDI message.
+///\remarks Overwrites the oldest record once the ring is full.
+////////////////////////////////////////////////////////////////////////////////
+void MIDITrace::add(Direction direction, unsigned long long timeStamp, const std::vector<unsigned char>& message)
+{
+  // Claim a slot:
+  unsigned int number = static_cast<unsigned int>(head.fetchAndAddOrdered(1));
+  Slot& slot = ring[number & (CAPACITY - 1)];
+
+  // Fill it, readers skip it meanwhile. The ordered store keeps the record
+  // stores below from moving ahead of it:
+  slot.sequence.fetchAndStoreOrdered(0);
+  size_t size = message.size();
+  slot.record.timeStamp = timeStamp;
+  slot.record.size      = static_cast<quint16>(size > 0xFFFF ? 0xFFFF : size);
+  slot.record.direction = static_cast<quint8>(direction);
+  slot.record.reserved  = 0;
+  for (size_t i = 0; i < 4; i++)
+    slot.record.bytes[i] = i < size ? message[i] : 0;
+
+  // Publish it:
+  slot.sequence.fetchAndStoreRelease(static_cast<int>(number + 1));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDITrace::read()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Copy the records traced since a previous read.
+///\param   [in]  from:    Value returned by the previous read, 0 for the
+///                        first one.
+///\param   [out] records: Receives the records, oldest first.
+///\return  The value to pass to the next read.
+///\remarks Only the last CAPACITY records can be read, older ones are lost.
+////////////////////////////////////////////////////////////////////////////////
+unsigned int MIDITrace::read(unsigned int from, std::vector<Record>& records) const
+{
+  // Skip what was overwritten already:
+  unsigned int end = static_cast<unsigned int>(const_cast<QAtomicInt&>(head).fetchAndAddAcquire(0));
+  if (end - from > CAPACITY)
+    from = end - CAPACITY;
+
+  // Copy the records:
+  for (unsigned int number = from; number != end; number++)
+  {
+    QAtomicInt& sequence = const_cast<QAtomicInt&>(ring[number & (CAPACITY - 1)].sequence);
+    int expected = static_cast<int>(number + 1);
+    int before   = sequence.fetchAndAddAcquire(0);
+
+    // Still being written? Then continue here next time:
+    if (before == 0 || static_cast<int>(static_cast<unsigned int>(before) - (number + 1)) < 0)
+      return number;
+
+    // Copy it unless it was overwritten meanwhile:
+    if (before != expected)
+      continue;
+    // The ordered read keeps the copy from moving behind it:
+    Record record = ring[number & (CAPACITY - 1)].record;
+    if (sequence.fetchAndAddOrdered(0) != expected)
+      continue;
+    records.push_back(record);
+  }
+
+  // Return to sender:
+  return end;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDITrace::dump()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Write all records in the ring to a text file.
+///\param   [in] fileName: The file, it is replaced.
+///\return  Returns true if successfull or false otherwise.
+////////////////////////////////////////////////////////////////////////////////
+bool MIDITrace::dump(const QString& fileName) const
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered))
+    return false;
+  writeTo(file.handle());
+  file.close();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDITrace::format()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Describe a record as one line of text.
+///\param   [in] record: The record.
+///\return  The text, like "12.345678 OUT B0 07 64     CC ch 1 #7 = 100".
+////////////////////////////////////////////////////////////////////////////////
+QString MIDITrace::format(const Record& record)
+{
+  // Format without the line feed:
+  char line[LINE_SIZE];
+  int length = formatLine(record, line);
+  return QString::fromLatin1(line, length - 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDITrace::installCrashHandler()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Dump a trace to a file when the program crashes.
+///\param   [in] trace:    The trace to dump.
+///\param   [in] fileName: The dump file.
+///\remarks Handles SIGSEGV, SIGBUS, SIGILL, SIGFPE and SIGABRT. On systems
+///         with SIGUSR1 the dump can also be requested from outside with
+///         "kill -USR1 <pid>" while the program keeps running.
+////////////////////////////////////////////////////////////////////////////////
+void MIDITrace::installCrashHandler(const MIDITrace* trace, const QString& fileName)
+{
+  // The handler must not allocate, so keep the encoded name:
+  QByteArray name = QFile::encodeName(fileName);
+  strncpy(crashFileName, name.constData(), sizeof(crashFileName) - 1);
+  crashFileName[sizeof(crashFileName) - 1] = 0;
+  crashTrace = trace;
+
+  // Install the handler:
+  signal(SIGSEGV, onSignal);
+  signal(SIGILL,  onSignal);
+  signal(SIGFPE,  onSignal);
+  signal(SIGABRT, onSignal);
+  #ifdef SIGBUS
+  signal(SIGBUS,  onSignal);
+  #endif
+  #ifdef SIGUSR1
+  signal(SIGUSR1, onSignal);
+  #endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDITrace::formatLine()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Describe a record as one line of text without allocations.
+///\param   [in]  record: The record.
+///\param   [out] line:   Receives the text and a line feed, must hold
+///                       LINE_SIZE characters.
+///\return  Number of characters written (without a terminating zero).
+///\remarks Safe to call from a signal handler.
+////////////////////////////////////////////////////////////////////////////////
+int MIDITrace::formatLine(const Record& record, char* line)
+{
+  // Time and direction:
+  char* p = line;
+  p = appendNumber(p, record.timeStamp / 1000000000ULL, 6);
+  *p++ = '.';
+  p = appendNumber(p, (record.timeStamp % 1000000000ULL) / 1000, 6, '0');
+  p = appendText(p, record.direction == INBOUND ? " IN  " : " OUT ");
+
+  // Raw bytes, longer messages end with "..":
+  int shown = record.size > 4 ? 3 : record.size;
+  for (int i = 0; i < 4; i++)
+  {
+    if (i < shown)
+      p = appendHex(p, record.bytes[i]);
+    else
+      p = appendText(p, i == 3 && record.size > 4 ? ".." : "  ");
+    *p++ = ' ';
+  }
+  *p++ = ' ';
+
+  // Decoded message:
+  unsigned char status  = record.bytes[0];
+  unsigned char data1   = record.bytes[1];
+  unsigned char data2   = record.bytes[2];
+  unsigned int  channel = (status & 0x0F) + 1;
+  switch (record.size > 0 ? status & 0xF0 : 0)
+  {
+  case 0x80:
+    p = appendText(p, "Note off ch ");
+    p = appendNumber(p, channel);
+    p = appendText(p, " note ");
+    p = appendNumber(p, data1);
+    p = appendText(p, " vel ");
+    p = appendNumber(p, data2);
+    break;
+  case 0x90:
+    p = appendText(p, "Note on ch ");
+    p = appendNumber(p, channel);
+    p = appendText(p, " note ");
+    p = appendNumber(p, data1);
+    p = appendText(p, " vel ");
+    p = appendNumber(p, data2);
+    break;
+  case 0xA0:
+    p = appendText(p, "Poly AT ch ");
+    p = appendNumber(p, channel);
+    p = appendText(p, " note ");
+    p = appendNumber(p, data1);
+    p = appendText(p, " = ");
+    p = appendNumber(p, data2);
+    break;
+  case 0xB0:
+    p = appendText(p, "CC ch ");
+    p = appendNumber(p, channel);
+    p = appendText(p, " #");
+    p = appendNumber(p, data1);
+    p = appendText(p, " = ");
+    p = appendNumber(p, data2);
+    break;
+  case 0xC0:
+    p = appendText(p, "Program ch ");
+    p = appendNumber(p, channel);
+    p = appendText(p, " = ");
+    p = appendNumber(p, data1);
+    break;
+  case 0xD0:
+    p = appendText(p, "Channel AT ch ");
+    p = appendNumber(p, channel);
+    p = appendText(p, " = ");
+    p = appendNumber(p, data1);
+    break;
+  case 0xE0:
+    p = appendText(p, "Pitch bend ch ");
+    p = appendNumber(p, channel);
+    p = appendText(p, " = ");
+    p = appendNumber(p, data1 | (data2 << 7));
+    break;
+  case 0xF0:
+    p = appendText(p, status == 0xF0 ? "SysEx " : "System ");
+    p = appendNumber(p, record.size);
+    p = appendText(p, " bytes");
+    break;
+  default:
+    p = appendText(p, "Invalid");
+    break;
+  }
+
+  // Terminate the line:
+  *p++ = '\n';
+
+  // Return to sender:
+  return static_cast<int>(p - line);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDITrace::writeTo()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Write all records in the ring to an open file.
+///\param   [in] fd: Descriptor of the file.
+///\remarks Safe to call from a signal handler.
+////////////////////////////////////////////////////////////////////////////////
+void MIDITrace::writeTo(int fd) const
+{
+  // Walk the ring from the oldest record, skipping incomplete ones:
+  char line[LINE_SIZE];
+  unsigned int end   = static_cast<unsigned int>(const_cast<QAtomicInt&>(head).fetchAndAddAcquire(0));
+  unsigned int begin = end > CAPACITY ? end - CAPACITY : 0;
+  for (unsigned int number = begin; number != end; number++)
+  {
+    const Slot& slot = ring[number & (CAPACITY - 1)];
+    if (const_cast<QAtomicInt&>(slot.sequence).fetchAndAddAcquire(0) != static_cast<int>(number + 1))
+      continue;
+    int length = formatLine(slot.record, line);
+    if (write(fd, line, length) != length)
+      return;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MIDITrace::onSignal()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Signal handler of the crash dump.
+///\param   [in] signalNumber: The raised signal.
+////////////////////////////////////////////////////////////////////////////////
+void MIDITrace::onSignal(int signalNumber)
+{
+  // Dump the trace:
+  if (crashTrace != 0)
+  {
+    int fd = open(crashFileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0)
+    {
+      crashTrace->writeTo(fd);
+      close(fd);
+    }
+  }
+
+  // A requested dump keeps the program running:
+  #ifdef SIGUSR1
+  if (signalNumber == SIGUSR1)
+  {
+    signal(SIGUSR1, onSignal);
+    return;
+  }
+  #endif
+
+  // Crash for real:
+  signal(signalNumber, SIG_DFL);
+  raise(signalNumber);
+}
+
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,192 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    miditrace.h
+///\ingroup dtedit
+///\brief   MIDI trace definitions.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef __MIDITRACE_H_INCLUDED__
+#define __MIDITRACE_H_INCLUDED__
+
+#include <QtCore>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+///\class MIDITrace miditrace.h
+///\brief Always-on trace of the recent MIDI traffic.
+/// The trace is a fixed ring of small binary records: The time stamp, the
+/// direction and the first four bytes of each message. Adding a record costs
+/// one atomic increment and a few stores, nothing is allocated or formatted,
+/// so it can stay enabled on the MIDI input thread. The records are turned
+/// into text only when they are looked at (monitor window, dump file).
+///\remarks Any number of threads can add records while others read them. A
+///         reader never blocks a writer, records overwritten while they are
+///         read are skipped.
+////////////////////////////////////////////////////////////////////////////////
+class MIDITrace
+{
+public:
+  enum
+  {
+    CAPACITY  = 4096, ///> Number of records kept, must be a power of two.
+    LINE_SIZE = 96    ///> Buffer size needed by formatLine().
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  ///\enum  Direction
+  ///\brief Direction of a traced message.
+  //////////////////////////////////////////////////////////////////////////////
+  enum Direction
+  {
+    INBOUND  = 0, ///> Received from the amp.
+    OUTBOUND = 1  ///> Sent to the amp.
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  ///\struct Record
+  ///\brief  A traced message.
+  //////////////////////////////////////////////////////////////////////////////
+  struct Record
+  {
+    quint64 timeStamp; ///> RtMidi::getMonotonicTime() of the message.
+    quint16 size;      ///> Size of the complete message in bytes.
+    quint8  direction; ///> INBOUND or OUTBOUND.
+    quint8  reserved;  ///> Padding.
+    quint8  bytes[4];  ///> The first bytes of the message.
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDITrace::MIDITrace()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Default constructor of this class.
+  //////////////////////////////////////////////////////////////////////////////
+  MIDITrace();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDITrace::~MIDITrace()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Destructor of this class.
+  ///\remarks Removes the crash handler if it dumps this trace.
+  //////////////////////////////////////////////////////////////////////////////
+  ~MIDITrace();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDITrace::add()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Trace a message.
+  ///\param   [in] direction: Direction of the message.
+  ///\param   [in] timeStamp: Time of the message in nanoseconds.
+  ///\param   [in] message:   The raw MIDI message.
+  ///\remarks Overwrites the oldest record once the ring is full.
+  //////////////////////////////////////////////////////////////////////////////
+  void add(Direction direction, unsigned long long timeStamp, const std::vector<unsigned char>& message);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDITrace::read()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Copy the records traced since a previous read.
+  ///\param   [in]  from:    Value returned by the previous read, 0 for the
+  ///                        first one.
+  ///\param   [out] records: Receives the records, oldest first.
+  ///\return  The value to pass to the next read.
+  ///\remarks Only the last CAPACITY records can be read, older ones are lost.
+  //////////////////////////////////////////////////////////////////////////////
+  unsigned int read(unsigned int from, std::vector<Record>& records) const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDITrace::dump()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Write all records in the ring to a text file.
+  ///\param   [in] fileName: The file, it is replaced.
+  ///\return  Returns true if successfull or false otherwise.
+  //////////////////////////////////////////////////////////////////////////////
+  bool dump(const QString& fileName) const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDITrace::format()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Describe a record as one line of text.
+  ///\param   [in] record: The record.
+  ///\return  The text, like "12.345678 OUT B0 07 64     CC ch 1 #7 = 100".
+  //////////////////////////////////////////////////////////////////////////////
+  static QString format(const Record& record);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDITrace::installCrashHandler()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Dump a trace to a file when the program crashes.
+  ///\param   [in] trace:    The trace to dump.
+  ///\param   [in] fileName: The dump file.
+  ///\remarks Handles SIGSEGV, SIGBUS, SIGILL, SIGFPE and SIGABRT. On systems
+  ///         with SIGUSR1 the dump can also be requested from outside with
+  ///         "kill -USR1 <pid>" while the program keeps running.
+  //////////////////////////////////////////////////////////////////////////////
+  static void installCrashHandler(const MIDITrace* trace, const QString& fileName);
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDITrace::formatLine()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Describe a record as one line of text without allocations.
+  ///\param   [in]  record: The record.
+  ///\param   [out] line:   Receives the text and a line feed, must hold
+  ///                       LINE_SIZE characters.
+  ///\return  Number of characters written (without a terminating zero).
+  ///\remarks Safe to call from a signal handler.
+  //////////////////////////////////////////////////////////////////////////////
+  static int formatLine(const Record& record, char* line);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDITrace::writeTo()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Write all records in the ring to an open file.
+  ///\param   [in] fd: Descriptor of the file.
+  ///\remarks Safe to call from a signal handler.
+  //////////////////////////////////////////////////////////////////////////////
+  void writeTo(int fd) const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // MIDITrace::onSignal()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Signal handler of the crash dump.
+  ///\param   [in] signalNumber: The raised signal.
+  //////////////////////////////////////////////////////////////////////////////
+  static void onSignal(int signalNumber);
+
+  //////////////////////////////////////////////////////////////////////////////
+  ///\struct Slot
+  ///\brief  A record in the ring.
+  //////////////////////////////////////////////////////////////////////////////
+  struct Slot
+  {
+    QAtomicInt sequence; ///> Number of the record + 1, 0 while it is written.
+    Record     record;   ///> The record.
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  QAtomicInt head;           ///> Number of the next record.
+  Slot       ring[CAPACITY]; ///> The records.
+};
+
+#endif // #ifndef __MIDITRACE_H_INCLUDED__
+///////////////////////////////// End of File //////////////////////////////////
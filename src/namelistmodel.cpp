@@ -0,0 +1,141 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    namelistmodel.cpp
+///\ingroup dtedit
+///\brief   Name list model implementation.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include <QApplication>
+#include "namelistmodel.h"
+#include "dtedit.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// NameListModel::NameListModel()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Initialization constructor of this model.
+///\param   [in] nameTable: The name table.
+///\param   [in] nameCount: Number of entries in the table.
+///\param   [in] parent:    Parent object of this model.
+////////////////////////////////////////////////////////////////////////////////
+NameListModel::NameListModel(const char* const* nameTable, int nameCount, QObject* parent) :
+  QAbstractListModel(parent),
+  names(nameTable),
+  count(nameCount)
+{
+  // Nothing to do here.
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// NameListModel::amps()
+// NameListModel::cabs()
+// NameListModel::mics()
+// NameListModel::reverbs()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the shared model of a name table.
+///\return  The model, owned by the application object.
+///\remarks The models are created on first use.
+////////////////////////////////////////////////////////////////////////////////
+NameListModel* NameListModel::amps()
+{
+  static NameListModel* model = 0;
+  return shared(model, ampNames, AMP_COUNT);
+}
+
+NameListModel* NameListModel::cabs()
+{
+  static NameListModel* model = 0;
+  return shared(model, cabNames, CAB_COUNT);
+}
+
+NameListModel* NameListModel::mics()
+{
+  static NameListModel* model = 0;
+  return shared(model, micNames, MIC_COUNT);
+}
+
+NameListModel* NameListModel::reverbs()
+{
+  static NameListModel* model = 0;
+  return shared(model, reverbNames, REV_COUNT);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// NameListModel::rowCount()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the number of names.
+///\param   [in] parent: Parent item, the list has no children.
+///\return  The number of names.
+////////////////////////////////////////////////////////////////////////////////
+int NameListModel::rowCount(const QModelIndex& parent) const
+{
+  return parent.isValid() ? 0 : count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// NameListModel::data()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the name of a row.
+///\param   [in] index: The row.
+///\param   [in] role:  Display and edit role give the name.
+///\return  The name or an invalid variant.
+////////////////////////////////////////////////////////////////////////////////
+QVariant NameListModel::data(const QModelIndex& index, int role) const
+{
+  if (!index.isValid() || index.row() < 0 || index.row() >= count)
+    return QVariant();
+  if (role != Qt::DisplayRole && role != Qt::EditRole)
+    return QVariant();
+  return QString::fromLatin1(names[index.row()]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// NameListModel::flags()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the flags of a row.
+///\param   [in] index: The row.
+///\return  Names can be selected, but not edited.
+////////////////////////////////////////////////////////////////////////////////
+Qt::ItemFlags NameListModel::flags(const QModelIndex& index) const
+{
+  if (!index.isValid())
+    return Qt::NoItemFlags;
+  return Qt::ItemIsSelectable | Qt::ItemIsEnabled;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// NameListModel::shared()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Create a shared model on first use.
+///\param   [in,out] model:     The shared model.
+///\param   [in]     nameTable: The name table.
+///\param   [in]     nameCount: Number of entries in the table.
+///\return  The shared model.
+////////////////////////////////////////////////////////////////////////////////
+NameListModel* NameListModel::shared(NameListModel*& model, const char* const* nameTable, int nameCount)
+{
+  // The application object deletes the model on exit:
+  if (model == 0)
+    model = new NameListModel(nameTable, nameCount, QCoreApplication::instance());
+  return model;
+}
+
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,99 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    namelistmodel.h
+///\ingroup dtedit
+///\brief   Shared read-only models of the DT name tables.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef __NAMELISTMODEL_H_INCLUDED__
+#define __NAMELISTMODEL_H_INCLUDED__
+
+#include <QAbstractListModel>
+
+////////////////////////////////////////////////////////////////////////////////
+///\class NameListModel namelistmodel.h
+///\brief Read-only list model on top of a static name table.
+/// The rows are the entries of one of the name tables in dtedit.h, so the
+/// strings are never copied into the model. There is one shared model per
+/// table, all combo boxes that show the same list use the same model.
+////////////////////////////////////////////////////////////////////////////////
+class NameListModel : public QAbstractListModel
+{
+  Q_OBJECT // Qt magic...
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  // NameListModel::NameListModel()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Initialization constructor of this model.
+  ///\param   [in] nameTable: The name table.
+  ///\param   [in] nameCount: Number of entries in the table.
+  ///\param   [in] parent:    Parent object of this model.
+  //////////////////////////////////////////////////////////////////////////////
+  NameListModel(const char* const* nameTable, int nameCount, QObject* parent = 0);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // NameListModel::amps()
+  // NameListModel::cabs()
+  // NameListModel::mics()
+  // NameListModel::reverbs()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get the shared model of a name table.
+  ///\return  The model, owned by the application object.
+  ///\remarks The models are created on first use.
+  //////////////////////////////////////////////////////////////////////////////
+  static NameListModel* amps();
+  static NameListModel* cabs();
+  static NameListModel* mics();
+  static NameListModel* reverbs();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // NameListModel::rowCount()
+  // NameListModel::data()
+  // NameListModel::flags()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   QAbstractListModel implementation.
+  //////////////////////////////////////////////////////////////////////////////
+  int rowCount(const QModelIndex& parent = QModelIndex()) const;
+  QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+  Qt::ItemFlags flags(const QModelIndex& index) const;
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  // NameListModel::shared()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Create a shared model on first use.
+  ///\param   [in,out] model:     The shared model.
+  ///\param   [in]     nameTable: The name table.
+  ///\param   [in]     nameCount: Number of entries in the table.
+  ///\return  The shared model.
+  //////////////////////////////////////////////////////////////////////////////
+  static NameListModel* shared(NameListModel*& model, const char* const* nameTable, int nameCount);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  const char* const* names; ///> The name table.
+  int                count; ///> Number of entries in the table.
+};
+
+#endif // #ifndef __NAMELISTMODEL_H_INCLUDED__
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,633 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    panelcanvas.cpp
+///\ingroup dtedit
+///\brief   Single widget renderer for the amp panel controls.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include <QPainter>
+#include <QPaintEvent>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QTimer>
+#include <QMap>
+#include "panelcanvas.h"
+#include "spriteatlas.h"
+#include "imageassets.h"
+#include "traceevents.h"
+
+// Dial behaviour, the same as the QImageDial defaults:
+static const double dialDefaultValue = 0.5;
+static const double dialLinearSize   = 128.0;
+static const double dialWheelScale   = 0.00025;
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::PanelCanvas()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Initialization constructor of this widget.
+///\param   [in] parent: Parent window for this widget.
+////////////////////////////////////////////////////////////////////////////////
+PanelCanvas::PanelCanvas(QWidget* parent) :
+  QWidget(parent),
+  scale(1.0),
+  pressed(-1),
+  pressValue(0.0)
+{
+  for (int i = 0; i < 128; i++)
+    tagIndex[i] = -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::addImage()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Add an image strip that controls can use.
+///\param   [in] image: The image strip.
+///\return  Index of the image.
+///\remarks Add each image once and use the index for all controls that look
+///         the same.
+////////////////////////////////////////////////////////////////////////////////
+int PanelCanvas::addImage(const QPixmap& image)
+{
+  images.append(image);
+  return images.size() - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::addControl()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Add a control.
+///\param   [in] type:          Kind of control.
+///\param   [in] tag:           Controller number or -1 for none.
+///\param   [in] rect:          Position and size at scale 1.
+///\param   [in] image:         Index of the image strip.
+///\param   [in] disabledImage: Index of the disabled image or -1.
+///\param   [in] frameCount:    Number of frames of a dial's knob movie.
+///\return  Index of the control.
+////////////////////////////////////////////////////////////////////////////////
+int PanelCanvas::addControl(ControlType type, int tag, const QRect& rect, int image, int disabledImage, int frameCount)
+{
+  Control control;
+  control.rect          = SpriteAtlas::scaledRect(rect, scale);
+  control.type          = static_cast<quint8>(type);
+  control.flags         = 0;
+  control.tag           = static_cast<qint8>(tag >= 0 && tag < 128 ? tag : -1);
+  control.image         = static_cast<quint8>(image);
+  control.disabledImage = static_cast<qint8>(disabledImage);
+  control.link          = -1;
+
+  // Frames of the image strip:
+  switch (type)
+  {
+  case DIAL:
+    control.frameCount = static_cast<quint8>(qBound(1, frameCount, 255));
+    break;
+  case TOGGLE4:
+    control.frameCount = 4;
+    break;
+  default:
+    control.frameCount = 2;
+    break;
+  }
+
+  // Start value, a dial starts centered:
+  if (type == DIAL)
+  {
+    control.value = static_cast<float>(dialDefaultValue);
+    control.frame = static_cast<qint16>(dialDefaultValue * (control.frameCount - 1));
+    control.step  = static_cast<qint16>(dialDefaultValue * 127);
+  }
+  else
+  {
+    control.value = 0.0f;
+    control.frame = 0;
+    control.step  = 0;
+  }
+
+  // Add it:
+  controls.append(control);
+  layoutRects.append(rect);
+  int index = controls.size() - 1;
+  if (control.tag >= 0 && type != LED)
+    tagIndex[control.tag] = static_cast<qint16>(index);
+  update(control.rect);
+
+  // Return to sender:
+  return index;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::setLeftRight()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Let a toggle work left to right instead of top to bottom.
+///\param   [in] index:     Index of the toggle.
+///\param   [in] leftRight: Work left to right?
+////////////////////////////////////////////////////////////////////////////////
+void PanelCanvas::setLeftRight(int index, bool leftRight)
+{
+  if (leftRight)
+    controls[index].flags |= LEFT_RIGHT;
+  else
+    controls[index].flags &= ~LEFT_RIGHT;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::linkLED()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Let an LED show the state of a toggle.
+///\param   [in] led:      Index of the LED.
+///\param   [in] toggle:   Index of the toggle.
+///\param   [in] inverted: Light the LED when the toggle is off?
+////////////////////////////////////////////////////////////////////////////////
+void PanelCanvas::linkLED(int led, int toggle, bool inverted)
+{
+  Control& control = controls[toggle];
+  control.link = static_cast<qint16>(led);
+  if (inverted)
+    control.flags |= LINK_INVERTED;
+  else
+    control.flags &= ~LINK_INVERTED;
+
+  // Show the current state:
+  setValue(led, inverted ? !control.step : control.step);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::setInverted()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Let a toggle be on for controller values below 64.
+///\param   [in] index:    Index of the toggle.
+///\param   [in] inverted: Is it on below 64?
+///\remarks Only used by setControllerValue().
+////////////////////////////////////////////////////////////////////////////////
+void PanelCanvas::setInverted(int index, bool inverted)
+{
+  if (inverted)
+    controls[index].flags |= INVERTED;
+  else
+    controls[index].flags &= ~INVERTED;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::addItems()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Add the controls of a layout table.
+///\param   [in] items:  The layout table.
+///\param   [in] count:  Number of items in the table.
+///\param   [in] origin: Offset of the item positions at scale 1.
+///\remarks Loads each image of the table once and links the LEDs to their
+///         switches.
+////////////////////////////////////////////////////////////////////////////////
+void PanelCanvas::addItems(const PanelItem* items, int count, const QPoint& origin)
+{
+  // Add the controls, each image only once:
+  QMap<QString, int> imageIndices;
+  QVector<int> indices(count);
+  for (int i = 0; i < count; i++)
+  {
+    const PanelItem& item = items[i];
+    int imageIndex[2];
+    const char* names[2] = { item.image, item.disabledImage };
+    for (int j = 0; j < 2; j++)
+    {
+      QMap<QString, int>::const_iterator it = imageIndices.constFind(names[j]);
+      if (it == imageIndices.constEnd())
+        it = imageIndices.insert(names[j], addImage(ImageAssets::pixmap(names[j])));
+      imageIndex[j] = it.value();
+    }
+    QRect rect(origin.x() + item.x, origin.y() + item.y, item.width, item.height);
+    indices[i] = addControl(item.type, item.type == LED ? -1 : item.tag, rect, imageIndex[0], imageIndex[1], item.frameCount);
+    setLeftRight(indices[i], (item.flags & ITEM_LEFT_RIGHT) != 0);
+    setInverted(indices[i], (item.flags & ITEM_LOW_ON) != 0);
+    if (item.flags & ITEM_ON)
+      setValue(indices[i], 1);
+  }
+
+  // Let the LEDs follow their switches:
+  for (int i = 0; i < count; i++)
+  {
+    if (items[i].type == LED)
+      linkLED(indices[i], indexOfTag(items[i].tag), (items[i].flags & ITEM_INVERTED) != 0);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::layoutScale()
+// PanelCanvas::setLayoutScale()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Access the scale of the control rectangles.
+///\remarks The images are scaled along through sprite atlases.
+////////////////////////////////////////////////////////////////////////////////
+qreal PanelCanvas::layoutScale() const
+{
+  return scale;
+}
+
+void PanelCanvas::setLayoutScale(qreal newScale)
+{
+  if (newScale <= 0.0 || newScale == scale)
+    return;
+  scale = newScale;
+
+  // Move the controls and repaint everything:
+  for (int i = 0; i < controls.size(); i++)
+    controls[i].rect = SpriteAtlas::scaledRect(layoutRects[i], scale);
+  update();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas accessors
+////////////////////////////////////////////////////////////////////////////////
+int PanelCanvas::controlCount() const
+{
+  return controls.size();
+}
+
+int PanelCanvas::indexOfTag(int tag) const
+{
+  if (tag < 0 || tag >= 128)
+    return -1;
+  return tagIndex[tag];
+}
+
+PanelCanvas::ControlType PanelCanvas::type(int index) const
+{
+  return static_cast<ControlType>(controls[index].type);
+}
+
+int PanelCanvas::tag(int index) const
+{
+  return controls[index].tag;
+}
+
+QRect PanelCanvas::controlRect(int index) const
+{
+  return controls[index].rect;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::value()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the value of a control.
+///\param   [in] index: Index of the control.
+///\return  The value, see the class description for the ranges.
+////////////////////////////////////////////////////////////////////////////////
+double PanelCanvas::value(int index) const
+{
+  return controls[index].value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::step()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the output value of a control.
+///\param   [in] index: Index of the control.
+///\return  The CC value of a dial (0-127) or the state of anything else.
+////////////////////////////////////////////////////////////////////////////////
+int PanelCanvas::step(int index) const
+{
+  return controls[index].step;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::setValue()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Set the value of a control.
+///\param   [in] index:  Index of the control.
+///\param   [in] value:  The new value, clipped to the range of the control.
+///\param   [in] notify: Emit valueChanged() if the output value changes?
+///\remarks The control is only repainted if it looks different afterwards.
+///         Values set from outside usually come from the amp, so nothing
+///         is emitted by default, just like a widget with blocked signals.
+////////////////////////////////////////////////////////////////////////////////
+void PanelCanvas::setValue(int index, double value, bool notify)
+{
+  if (index < 0 || index >= controls.size())
+    return;
+  Control& control = controls[index];
+
+  // Calc frame and output value:
+  int frame;
+  int step;
+  if (control.type == DIAL)
+  {
+    value = qBound(0.0, value, 1.0);
+    control.value = static_cast<float>(value);
+    frame = qBound(0, (int)(value * (control.frameCount - 1)), control.frameCount - 1);
+    step  = qBound(0, (int)(value * 127.0), 127);
+  }
+  else
+  {
+    step  = qBound(0, (int)(value + 0.5), control.frameCount - 1);
+    frame = step;
+    control.value = static_cast<float>(step);
+  }
+
+  // Repaint if it looks different:
+  if (frame != control.frame)
+  {
+    control.frame = static_cast<qint16>(frame);
+    markDirty(index);
+  }
+
+  // Anything else to do?
+  if (step == control.step)
+    return;
+  control.step = static_cast<qint16>(step);
+
+  // Update the linked LED:
+  if (control.link >= 0)
+    setValue(control.link, (control.flags & LINK_INVERTED) ? !step : step);
+
+  // Notify listeners:
+  if (notify && !signalsBlocked())
+    emit valueChanged(index);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::setControllerValue()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Show a controller value on the control with its tag.
+///\param   [in] tag:   Controller number.
+///\param   [in] value: Controller value (0-127).
+///\return  Index of the control or -1 if no control has the tag.
+///\remarks Dials map the value to [0,1], toggles are on from 64 (inverted
+///         ones below 64) and four way toggles take it as state. Nothing
+///         is emitted.
+////////////////////////////////////////////////////////////////////////////////
+int PanelCanvas::setControllerValue(int tag, int value)
+{
+  int index = indexOfTag(tag);
+  if (index < 0)
+    return -1;
+
+  const Control& control = controls[index];
+  switch (control.type)
+  {
+  case DIAL:
+    setValue(index, value / 127.0);
+    break;
+  case TOGGLE:
+    if (control.flags & INVERTED)
+      setValue(index, value < 64 ? 1 : 0);
+    else
+      setValue(index, value >= 64 ? 1 : 0);
+    break;
+  case TOGGLE4:
+    setValue(index, value);
+    break;
+  default:
+    break;
+  }
+
+  // Return to sender:
+  return index;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::hitTest()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Find the control at a position.
+///\param   [in] pos: Position in the canvas.
+///\return  Index of the control or -1 if there is none that takes input.
+////////////////////////////////////////////////////////////////////////////////
+int PanelCanvas::hitTest(const QPoint& pos) const
+{
+  // Topmost first:
+  for (int i = controls.size() - 1; i >= 0; i--)
+  {
+    if (controls[i].type != LED && controls[i].rect.contains(pos))
+      return i;
+  }
+  return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::paintEvent()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Paint the controls within the exposed region.
+///\param   [in] e: Description of the event.
+////////////////////////////////////////////////////////////////////////////////
+void PanelCanvas::paintEvent(QPaintEvent* e)
+{
+  TRACE_SPAN("UI", "PanelCanvas::paintEvent");
+
+  QPainter qp(this);
+  const QRegion& region = e->region();
+  bool enabled = isEnabled();
+  for (int i = 0; i < controls.size(); i++)
+  {
+    const Control& control = controls[i];
+    if (!region.intersects(control.rect))
+      continue;
+
+    // Disabled look:
+    if (!enabled && control.disabledImage >= 0)
+    {
+      SpriteAtlas::drawFrame(qp, this, control.rect, images[control.disabledImage], 1, 0);
+      continue;
+    }
+
+    // Blit the current frame, scaled to the control:
+    SpriteAtlas::drawFrame(qp, this, control.rect, images[control.image], control.frameCount, control.frame);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::mousePressEvent()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Start a drag or a click.
+///\param   [in] e: Description of the event.
+////////////////////////////////////////////////////////////////////////////////
+void PanelCanvas::mousePressEvent(QMouseEvent* e)
+{
+  pressed = -1;
+  if (e->buttons() != Qt::LeftButton)
+    return;
+
+  // Remember the control and where it was hit:
+  pressed    = hitTest(e->pos());
+  pressPos   = e->pos();
+  pressValue = pressed >= 0 ? controls[pressed].value : 0.0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::mouseMoveEvent()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Turn a dragged dial, like a fader.
+///\param   [in] e: Description of the event.
+////////////////////////////////////////////////////////////////////////////////
+void PanelCanvas::mouseMoveEvent(QMouseEvent* e)
+{
+  if (pressed < 0 || controls[pressed].type != DIAL || e->buttons() != Qt::LeftButton)
+    return;
+  setValue(pressed, pressValue + (pressPos.y() - e->y()) / dialLinearSize, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::mouseReleaseEvent()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   End a drag or switch a clicked toggle.
+///\param   [in] e: Description of the event.
+////////////////////////////////////////////////////////////////////////////////
+void PanelCanvas::mouseReleaseEvent(QMouseEvent* e)
+{
+  int index = pressed;
+  pressed = -1;
+  if (index < 0 || (e->buttons() & Qt::LeftButton))
+    return;
+
+  // Dial drag done:
+  const Control& control = controls[index];
+  if (control.type == DIAL)
+  {
+    if (!signalsBlocked())
+      emit mouseReleased(index);
+    return;
+  }
+
+  // A toggle switches if the button goes up over the half or quadrant where
+  // it went down:
+  if (!control.rect.contains(e->pos()))
+    return;
+  int state = stateFromPos(control, e->pos());
+  if (state == stateFromPos(control, pressPos))
+    setValue(index, state, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::mouseDoubleClickEvent()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Reset a double clicked dial.
+///\param   [in] e: Description of the event.
+////////////////////////////////////////////////////////////////////////////////
+void PanelCanvas::mouseDoubleClickEvent(QMouseEvent* e)
+{
+  if (e->buttons() != Qt::LeftButton)
+    return;
+  int index = hitTest(e->pos());
+  if (index >= 0 && controls[index].type == DIAL)
+    setValue(index, dialDefaultValue, true);
+
+  // Treat it as new press, so the release ends it:
+  pressed    = index;
+  pressPos   = e->pos();
+  pressValue = index >= 0 ? controls[index].value : 0.0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::wheelEvent()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Turn the dial under the mouse.
+///\param   [in] e: Description of the event.
+////////////////////////////////////////////////////////////////////////////////
+void PanelCanvas::wheelEvent(QWheelEvent* e)
+{
+  int index = hitTest(e->pos());
+  if (index < 0 || controls[index].type != DIAL)
+  {
+    e->ignore();
+    return;
+  }
+  setValue(index, controls[index].value + e->delta() * dialWheelScale, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::changeEvent()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Switch to the disabled images and back.
+///\param   [in] e: Description of the event.
+////////////////////////////////////////////////////////////////////////////////
+void PanelCanvas::changeEvent(QEvent* e)
+{
+  // Base handling:
+  QWidget::changeEvent(e);
+
+  // Redraw all controls if the enabled state changed:
+  if (e->type() == QEvent::EnabledChange)
+  {
+    for (int i = 0; i < controls.size(); i++)
+      markDirty(i);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::flushDirty()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Schedule one repaint for all controls changed since the last
+///         call.
+////////////////////////////////////////////////////////////////////////////////
+void PanelCanvas::flushDirty()
+{
+  QRegion region;
+  for (int i = 0; i < dirty.size(); i++)
+  {
+    Control& control = controls[dirty[i]];
+    control.flags &= ~DIRTY;
+    region += control.rect;
+  }
+  dirty.clear();
+  update(region);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::markDirty()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Add a control to the list of controls to repaint.
+///\param   [in] index: Index of the control.
+////////////////////////////////////////////////////////////////////////////////
+void PanelCanvas::markDirty(int index)
+{
+  Control& control = controls[index];
+  if (control.flags & DIRTY)
+    return;
+  control.flags |= DIRTY;
+
+  // The first change of this round schedules the flush:
+  if (dirty.isEmpty())
+    QTimer::singleShot(0, this, SLOT(flushDirty()));
+  dirty.append(index);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PanelCanvas::stateFromPos()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the state that a click selects on a toggle.
+///\param   [in] control: The toggle.
+///\param   [in] pos:     Position in the canvas.
+///\return  The state for the clicked half or quadrant.
+////////////////////////////////////////////////////////////////////////////////
+int PanelCanvas::stateFromPos(const Control& control, const QPoint& pos)
+{
+  bool left = pos.x() < control.rect.x() + control.rect.width()  / 2;
+  bool top  = pos.y() < control.rect.y() + control.rect.height() / 2;
+
+  // Four way toggles use the quadrant:
+  if (control.type == TOGGLE4)
+    return (top ? 0 : 2) + (left ? 0 : 1);
+
+  // The upper (or left) half switches it on:
+  if (control.flags & LEFT_RIGHT)
+    return left ? 1 : 0;
+  return top ? 1 : 0;
+}
+
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,348 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    panelcanvas.h
+///\ingroup dtedit
+///\brief   Single widget renderer for the amp panel controls.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef __PANELCANVAS_H_INCLUDED__
+#define __PANELCANVAS_H_INCLUDED__
+
+#include <QWidget>
+#include <QPixmap>
+#include <QVector>
+
+////////////////////////////////////////////////////////////////////////////////
+// Forwards:
+struct PanelItem;
+
+////////////////////////////////////////////////////////////////////////////////
+///\class PanelCanvas panelcanvas.h
+///\brief Draws all image controls of the panel from one widget.
+/// The dials, toggles and LEDs are small structs instead of child widgets.
+/// The canvas does the hit-testing and the mouse handling of the QImage*
+/// widgets and collects the rectangles of changed controls, so any number of
+/// value changes within one event loop round ends in a single paint. The
+/// canvas is transparent, the parent paints the background.
+///
+/// Values follow the widgets: dials use [0,1], toggles and LEDs 0 or 1 and
+/// four way toggles 0 to 3. step() gives the output value, that is the 7 bit
+/// CC value for dials and the state for everything else.
+////////////////////////////////////////////////////////////////////////////////
+class PanelCanvas : public QWidget
+{
+  Q_OBJECT // Qt magic...
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  ///\enum  ControlType
+  ///\brief The kinds of controls, like QImageDial, QImageToggle etc.
+  //////////////////////////////////////////////////////////////////////////////
+  enum ControlType
+  {
+    DIAL,    ///> Knob movie, dragged up and down.
+    TOGGLE,  ///> Two state switch, the clicked half selects the state.
+    TOGGLE4, ///> Four state switch, the clicked quadrant selects the state.
+    LED      ///> Two state display, follows a linked toggle.
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::PanelCanvas()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Initialization constructor of this widget.
+  ///\param   [in] parent: Parent window for this widget.
+  //////////////////////////////////////////////////////////////////////////////
+  PanelCanvas(QWidget* parent = 0);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::addImage()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Add an image strip that controls can use.
+  ///\param   [in] image: The image strip.
+  ///\return  Index of the image.
+  ///\remarks Add each image once and use the index for all controls that look
+  ///         the same.
+  //////////////////////////////////////////////////////////////////////////////
+  int addImage(const QPixmap& image);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::addControl()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Add a control.
+  ///\param   [in] type:          Kind of control.
+  ///\param   [in] tag:           Controller number or -1 for none.
+  ///\param   [in] rect:          Position and size at scale 1.
+  ///\param   [in] image:         Index of the image strip.
+  ///\param   [in] disabledImage: Index of the disabled image or -1.
+  ///\param   [in] frameCount:    Number of frames of a dial's knob movie.
+  ///\return  Index of the control.
+  //////////////////////////////////////////////////////////////////////////////
+  int addControl(ControlType type, int tag, const QRect& rect, int image, int disabledImage, int frameCount = 1);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::setLeftRight()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Let a toggle work left to right instead of top to bottom.
+  ///\param   [in] index:     Index of the toggle.
+  ///\param   [in] leftRight: Work left to right?
+  //////////////////////////////////////////////////////////////////////////////
+  void setLeftRight(int index, bool leftRight);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::linkLED()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Let an LED show the state of a toggle.
+  ///\param   [in] led:      Index of the LED.
+  ///\param   [in] toggle:   Index of the toggle.
+  ///\param   [in] inverted: Light the LED when the toggle is off?
+  //////////////////////////////////////////////////////////////////////////////
+  void linkLED(int led, int toggle, bool inverted);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::setInverted()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Let a toggle be on for controller values below 64.
+  ///\param   [in] index:    Index of the toggle.
+  ///\param   [in] inverted: Is it on below 64?
+  ///\remarks Only used by setControllerValue().
+  //////////////////////////////////////////////////////////////////////////////
+  void setInverted(int index, bool inverted);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::addItems()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Add the controls of a layout table.
+  ///\param   [in] items:  The layout table.
+  ///\param   [in] count:  Number of items in the table.
+  ///\param   [in] origin: Offset of the item positions at scale 1.
+  ///\remarks Loads each image of the table once and links the LEDs to their
+  ///         switches.
+  //////////////////////////////////////////////////////////////////////////////
+  void addItems(const PanelItem* items, int count, const QPoint& origin);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::layoutScale()
+  // PanelCanvas::setLayoutScale()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Access the scale of the control rectangles.
+  ///\remarks The images are scaled along through sprite atlases.
+  //////////////////////////////////////////////////////////////////////////////
+  qreal layoutScale() const;
+  void  setLayoutScale(qreal scale);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::controlCount()
+  // PanelCanvas::indexOfTag()
+  // PanelCanvas::type()
+  // PanelCanvas::tag()
+  // PanelCanvas::controlRect()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Access the controls.
+  ///\remarks indexOfTag() returns -1 if no control has the tag, controlRect()
+  ///         gives the scaled rectangle.
+  //////////////////////////////////////////////////////////////////////////////
+  int         controlCount() const;
+  int         indexOfTag(int tag) const;
+  ControlType type(int index) const;
+  int         tag(int index) const;
+  QRect       controlRect(int index) const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::value()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get the value of a control.
+  ///\param   [in] index: Index of the control.
+  ///\return  The value, see the class description for the ranges.
+  //////////////////////////////////////////////////////////////////////////////
+  double value(int index) const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::step()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get the output value of a control.
+  ///\param   [in] index: Index of the control.
+  ///\return  The CC value of a dial (0-127) or the state of anything else.
+  //////////////////////////////////////////////////////////////////////////////
+  int step(int index) const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::setValue()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Set the value of a control.
+  ///\param   [in] index:  Index of the control.
+  ///\param   [in] value:  The new value, clipped to the range of the control.
+  ///\param   [in] notify: Emit valueChanged() if the output value changes?
+  ///\remarks The control is only repainted if it looks different afterwards.
+  ///         Values set from outside usually come from the amp, so nothing
+  ///         is emitted by default, just like a widget with blocked signals.
+  //////////////////////////////////////////////////////////////////////////////
+  void setValue(int index, double value, bool notify = false);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::setControllerValue()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Show a controller value on the control with its tag.
+  ///\param   [in] tag:   Controller number.
+  ///\param   [in] value: Controller value (0-127).
+  ///\return  Index of the control or -1 if no control has the tag.
+  ///\remarks Dials map the value to [0,1], toggles are on from 64 (inverted
+  ///         ones below 64) and four way toggles take it as state. Nothing
+  ///         is emitted.
+  //////////////////////////////////////////////////////////////////////////////
+  int setControllerValue(int tag, int value);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::hitTest()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Find the control at a position.
+  ///\param   [in] pos: Position in the canvas.
+  ///\return  Index of the control or -1 if there is none that takes input.
+  //////////////////////////////////////////////////////////////////////////////
+  int hitTest(const QPoint& pos) const;
+
+signals:
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::valueChanged()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   The user changed the output value of a control.
+  ///\param   [in] index: Index of the control.
+  //////////////////////////////////////////////////////////////////////////////
+  void valueChanged(int index);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::mouseReleased()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   The user released the mouse after dragging a dial.
+  ///\param   [in] index: Index of the dial.
+  //////////////////////////////////////////////////////////////////////////////
+  void mouseReleased(int index);
+
+protected:
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas event handlers
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Paint the exposed controls and handle the user input like the
+  ///         QImage* widgets do.
+  ///\param   [in] e: Description of the event.
+  //////////////////////////////////////////////////////////////////////////////
+  void paintEvent(QPaintEvent* e);
+  void mousePressEvent(QMouseEvent* e);
+  void mouseMoveEvent(QMouseEvent* e);
+  void mouseReleaseEvent(QMouseEvent* e);
+  void mouseDoubleClickEvent(QMouseEvent* e);
+  void wheelEvent(QWheelEvent* e);
+  void changeEvent(QEvent* e);
+
+private slots:
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::flushDirty()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Schedule one repaint for all controls changed since the last
+  ///         call.
+  //////////////////////////////////////////////////////////////////////////////
+  void flushDirty();
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  ///\struct Control
+  ///\brief  State of a single control, 32 bytes instead of a widget.
+  //////////////////////////////////////////////////////////////////////////////
+  struct Control
+  {
+    QRect  rect;          ///> Position and size in the canvas.
+    float  value;         ///> Dial value in [0,1] or the state.
+    qint16 frame;         ///> Shown frame of the image strip.
+    qint16 step;          ///> Output value.
+    qint16 link;          ///> Index of the linked LED or -1.
+    quint8 type;          ///> ControlType.
+    quint8 flags;         ///> Combination of the flags below.
+    quint8 frameCount;    ///> Number of frames in the image strip.
+    quint8 image;         ///> Index of the image strip.
+    qint8  disabledImage; ///> Index of the disabled image or -1.
+    qint8  tag;           ///> Controller number or -1.
+  };
+
+  enum
+  {
+    LEFT_RIGHT    = 0x01, ///> Toggle works left to right.
+    LINK_INVERTED = 0x02, ///> Linked LED shows the inverted state.
+    DIRTY         = 0x04, ///> Control waits for a repaint.
+    INVERTED      = 0x08  ///> Toggle is on for controller values below 64.
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::markDirty()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Add a control to the list of controls to repaint.
+  ///\param   [in] index: Index of the control.
+  //////////////////////////////////////////////////////////////////////////////
+  void markDirty(int index);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // PanelCanvas::stateFromPos()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get the state that a click selects on a toggle.
+  ///\param   [in] control: The toggle.
+  ///\param   [in] pos:     Position in the canvas.
+  ///\return  The state for the clicked half or quadrant.
+  //////////////////////////////////////////////////////////////////////////////
+  static int stateFromPos(const Control& control, const QPoint& pos);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  QVector<Control> controls;      ///> All controls in drawing order.
+  QVector<QPixmap> images;        ///> The image strips.
+  QVector<QRect>   layoutRects;   ///> Control rectangles at scale 1.
+  qreal            scale;         ///> Scale of the control rectangles.
+  QVector<int>     dirty;         ///> Controls that wait for a repaint.
+  qint16           tagIndex[128]; ///> Control of each controller number.
+  int              pressed;       ///> Control under the mouse button or -1.
+  QPoint           pressPos;      ///> Mouse down position.
+  double           pressValue;    ///> Dial value at the mouse down.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///\struct PanelItem
+///\brief  Layout of a dial, switch or LED on a panel canvas.
+////////////////////////////////////////////////////////////////////////////////
+struct PanelItem
+{
+  PanelCanvas::ControlType type;          ///> Kind of control.
+  int                      tag;           ///> Controller number. LEDs use the one of the switch they show.
+  int                      x;             ///> Position relative to the panel origin.
+  int                      y;             ///> Position relative to the panel origin.
+  int                      width;         ///> Size in pixels.
+  int                      height;        ///> Size in pixels.
+  const char*              image;         ///> Name of the image strip.
+  const char*              disabledImage; ///> Name of the disabled image.
+  int                      frameCount;    ///> Frames of a knob movie.
+  int                      flags;         ///> Combination of the ITEM_* flags.
+};
+
+// Panel item flags:
+#define ITEM_LEFT_RIGHT 0x01 // Switch works left to right.
+#define ITEM_ON         0x02 // Switch starts switched on.
+#define ITEM_INVERTED   0x04 // LED is lit while its switch is off.
+#define ITEM_LOW_ON     0x08 // Switch is on for controller values below 64.
+
+#endif // #ifndef __PANELCANVAS_H_INCLUDED__
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,230 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    preset.cpp
+///\ingroup dtedit
+///\brief   Preset file implementation.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include <QtXml>
+#include "preset.h"
+#include "dtedit.h"
+
+// The controllers of the amp parameters, in the order they are sent:
+static const int presetControls[] =
+{
+  CC_VOICE_A,        CC_VOICE_B,        CC_AMP_A,          CC_AMP_B,
+  CC_CAB_A,          CC_CAB_B,          CC_TOPOL_A,        CC_TOPOL_B,
+  CC_GAIN_A,         CC_BASS_A,         CC_MIDDLE_A,       CC_TREBLE_A,
+  CC_PRESENCE_A,     CC_VOLUME_A,       CC_REV_BYPASS_A,   CC_REV_TYPE_A,
+  CC_REV_DECAY_A,    CC_REV_PREDELAY_A, CC_REV_TONE_A,     CC_REV_MIX_A,
+  CC_CLASS_A,        CC_XTODE_A,        CC_BOOST_A,        CC_PI_VOLTAGE_A,
+  CC_CAP_TYPE_A,     CC_GAIN_B,         CC_BASS_B,         CC_MIDDLE_B,
+  CC_TREBLE_B,       CC_PRESENCE_B,     CC_VOLUME_B,       CC_REV_BYPASS_B,
+  CC_REV_TYPE_B,     CC_REV_DECAY_B,    CC_REV_PREDELAY_B, CC_REV_TONE_B,
+  CC_REV_MIX_B,      CC_CLASS_B,        CC_XTODE_B,        CC_BOOST_B,
+  CC_PI_VOLTAGE_B,   CC_CAP_TYPE_B,     CC_XLR_MIC,        CC_LOWVOLUME,
+  CC_CHANNEL,        CC_MASTER_VOL
+};
+static const int presetControlCount = sizeof(presetControls) / sizeof(presetControls[0]);
+
+////////////////////////////////////////////////////////////////////////////////
+// isParameter()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Is a controller an amp parameter?
+///\param   [in] controlNumber: The controller number.
+///\return  Returns true if it is kept in presets.
+////////////////////////////////////////////////////////////////////////////////
+static bool isParameter(int controlNumber)
+{
+  for (int i = 0; i < presetControlCount; i++)
+  {
+    if (presetControls[i] == controlNumber)
+      return true;
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Preset::Preset()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Default constructor of this class.
+///\remarks The preset starts empty.
+////////////////////////////////////////////////////////////////////////////////
+Preset::Preset()
+{
+  clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Preset::clear()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Remove all values.
+////////////////////////////////////////////////////////////////////////////////
+void Preset::clear()
+{
+  for (int i = 0; i < 128; i++)
+    values[i] = -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Preset::isEmpty()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Does this preset hold no value at all?
+///\return  Returns true if no parameter is set.
+////////////////////////////////////////////////////////////////////////////////
+bool Preset::isEmpty() const
+{
+  for (int i = 0; i < 128; i++)
+  {
+    if (values[i] >= 0)
+      return false;
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Preset::value()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the value of a parameter.
+///\param   [in] controlNumber: Controller number of the parameter.
+///\return  The value (0-127) or -1 if it is not set.
+////////////////////////////////////////////////////////////////////////////////
+int Preset::value(int controlNumber) const
+{
+  if (controlNumber < 0 || controlNumber > 127)
+    return -1;
+  return values[controlNumber];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Preset::setValue()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Set the value of a parameter.
+///\param   [in] controlNumber: Controller number of the parameter.
+///\param   [in] value:         The value (0-127).
+///\remarks Controllers that are no amp parameters are ignored.
+////////////////////////////////////////////////////////////////////////////////
+void Preset::setValue(int controlNumber, int value)
+{
+  if (value < 0 || value > 127 || !isParameter(controlNumber))
+    return;
+  values[controlNumber] = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Preset::load()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Read a preset file.
+///\param   [in] fileName: The preset file.
+///\return  Returns true if successfull or false otherwise.
+///\remarks Replaces all values of this preset.
+////////////////////////////////////////////////////////////////////////////////
+bool Preset::load(const QString& fileName)
+{
+  // Parse the file:
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+  QDomDocument doc;
+  if (!doc.setContent(&file))
+    return false;
+  QDomElement root = doc.documentElement();
+  if (root.tagName() != "dtpreset" || root.attribute("version").toInt() > PRESET_VERSION)
+    return false;
+
+  // Read the values, unknown elements are skipped:
+  clear();
+  for (QDomElement e = root.firstChildElement("control"); !e.isNull(); e = e.nextSiblingElement("control"))
+  {
+    bool numberOK = false;
+    bool valueOK  = false;
+    int  number   = e.attribute("number").toInt(&numberOK);
+    int  value    = e.attribute("value").toInt(&valueOK);
+    if (numberOK && valueOK)
+      setValue(number, value);
+  }
+
+  // Return to sender:
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Preset::save()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Write a preset file.
+///\param   [in] fileName: The preset file.
+///\return  Returns true if successfull or false otherwise.
+////////////////////////////////////////////////////////////////////////////////
+bool Preset::save(const QString& fileName) const
+{
+  // Build the document:
+  QDomDocument doc("dtpreset");
+  QDomElement root = doc.createElement("dtpreset");
+  root.setAttribute("version", PRESET_VERSION);
+  doc.appendChild(root);
+  for (int i = 0; i < presetControlCount; i++)
+  {
+    int number = presetControls[i];
+    if (values[number] < 0)
+      continue;
+    QDomElement e = doc.createElement("control");
+    e.setAttribute("number", number);
+    e.setAttribute("value", values[number]);
+    root.appendChild(e);
+  }
+
+  // Write it:
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+  QByteArray data = doc.toByteArray(2);
+
+  // Return to sender:
+  return file.write(data) == data.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Preset::controlCount()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the number of amp parameters.
+///\return  The number of parameters.
+////////////////////////////////////////////////////////////////////////////////
+int Preset::controlCount()
+{
+  return presetControlCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Preset::controlNumber()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the controller of an amp parameter.
+///\param   [in] index: Index of the parameter.
+///\return  The controller number.
+///\remarks The voicing and amp selectors come first. The amp sets the other
+///         parameters when they change, so they must be sent before them.
+////////////////////////////////////////////////////////////////////////////////
+int Preset::controlNumber(int index)
+{
+  return presetControls[index];
+}
+
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    preset.h
+///\ingroup dtedit
+///\brief   Amp settings stored in a preset file.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef __PRESET_H_INCLUDED__
+#define __PRESET_H_INCLUDED__
+
+#include <QtCore>
+
+////////////////////////////////////////////////////////////////////////////////
+// Preset file layout
+////////////////////////////////////////////////////////////////////////////////
+// A preset is an XML file with the value of each amp parameter under its
+// controller number. Parameters that are left out keep their current value:
+//
+//   <!DOCTYPE dtpreset>
+//   <dtpreset version="1">
+//     <control number="120" value="2"/>
+//     <control number="13" value="64"/>
+//     ...
+//   </dtpreset>
+#define PRESET_VERSION 1
+
+////////////////////////////////////////////////////////////////////////////////
+///\class Preset preset.h
+///\brief The settings of the amp as controller values.
+/// Only the controllers of amp parameters are kept, the block, query and
+/// amp default controllers are ignored.
+////////////////////////////////////////////////////////////////////////////////
+class Preset
+{
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  // Preset::Preset()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Default constructor of this class.
+  ///\remarks The preset starts empty.
+  //////////////////////////////////////////////////////////////////////////////
+  Preset();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Preset::clear()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Remove all values.
+  //////////////////////////////////////////////////////////////////////////////
+  void clear();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Preset::isEmpty()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Does this preset hold no value at all?
+  ///\return  Returns true if no parameter is set.
+  //////////////////////////////////////////////////////////////////////////////
+  bool isEmpty() const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Preset::value()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get the value of a parameter.
+  ///\param   [in] controlNumber: Controller number of the parameter.
+  ///\return  The value (0-127) or -1 if it is not set.
+  //////////////////////////////////////////////////////////////////////////////
+  int value(int controlNumber) const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Preset::setValue()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Set the value of a parameter.
+  ///\param   [in] controlNumber: Controller number of the parameter.
+  ///\param   [in] value:         The value (0-127).
+  ///\remarks Controllers that are no amp parameters are ignored.
+  //////////////////////////////////////////////////////////////////////////////
+  void setValue(int controlNumber, int value);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Preset::load()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Read a preset file.
+  ///\param   [in] fileName: The preset file.
+  ///\return  Returns true if successfull or false otherwise.
+  ///\remarks Replaces all values of this preset.
+  //////////////////////////////////////////////////////////////////////////////
+  bool load(const QString& fileName);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Preset::save()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Write a preset file.
+  ///\param   [in] fileName: The preset file.
+  ///\return  Returns true if successfull or false otherwise.
+  //////////////////////////////////////////////////////////////////////////////
+  bool save(const QString& fileName) const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Preset::controlCount()
+  // Preset::controlNumber()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   The controllers of the amp parameters.
+  ///\param   [in] index: Index of the parameter.
+  ///\return  The number of parameters or the controller number.
+  ///\remarks The voicing and amp selectors come first. The amp sets the other
+  ///         parameters when they change, so they must be sent before them.
+  //////////////////////////////////////////////////////////////////////////////
+  static int controlCount();
+  static int controlNumber(int index);
+
+private:
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  int values[128]; ///> Value of each controller, -1 if not set.
+};
+
+#endif // #ifndef __PRESET_H_INCLUDED__
+///////////////////////////////// End of File //////////////////////////////////
@@ -65,13 +65,18 @@ public:
     m_value(0.5),
     m_defaultValue(0.5),
     m_frameCount(0),
+    m_stepCount(128),
+    m_frame(0),
+    m_step(0),
     m_absoluteMode(false),
     m_circularMode(false),
     m_startY(0),
     m_startVal(0.5),
     m_linearSize(128)
   {
-    // Nothing to do here.
+    // Init frame and output step of the start value:
+    m_frame = frameFromValue(m_value);
+    m_step  = stepFromValue(m_value);
   }
 
   //////////////////////////////////////////////////////////////////////////////
@@ -103,9 +108,11 @@ public:
   //////////////////////////////////////////////////////////////////////////////
   ///\brief   Set accessor for the Value property.
   ///\param   [in] newVal: The new value of this dial.
-  ///\remarks The value is clipped to the range [0,1]. If this value is set then
-  ///         the widget will be repainted and a valueChanged event will be
-  ///         emitted.
+  ///\remarks The value is clipped to the range [0,1]. The widget is only
+  ///         repainted if the value shows another frame of the knob movie and
+  ///         the valueChanged event is only emitted if the value falls on
+  ///         another output step. Mouse and wheel events arrive much faster
+  ///         than either changes.
   //////////////////////////////////////////////////////////////////////////////
   void setValue(const double newVal)
   {
@@ -118,12 +125,67 @@ public:
     else if (m_value > 1.0)
       m_value = 1.0;
 
-    // Schedule redraw:
-    update();
+    // Schedule redraw if another frame is shown:
+    int newFrame = frameFromValue(m_value);
+    if (newFrame != m_frame)
+    {
+      m_frame = newFrame;
+      update();
+    }
 
-    // Notify listeners:
-    if (!signalsBlocked())
-      emit valueChanged();
+    // Notify listeners if the output changed:
+    int newStep = stepFromValue(m_value);
+    if (newStep != m_step)
+    {
+      m_step = newStep;
+      if (!signalsBlocked())
+        emit valueChanged();
+    }
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // QImageDial::step()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get the current value as output step.
+  ///\return  The step of the current value in the range [0,StepCount - 1].
+  //////////////////////////////////////////////////////////////////////////////
+  int step() const
+  {
+    // Return current step:
+    return m_step;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // QImageDial::stepCount()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get accessor for the StepCount property.
+  ///\return  The number of distinct output values of this dial.
+  ///\remarks The default of 128 matches a 7 bit MIDI controller.
+  //////////////////////////////////////////////////////////////////////////////
+  int stepCount() const
+  {
+    // Return current count:
+    return m_stepCount;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // QImageDial::setStepCount()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Set accessor for the StepCount property.
+  ///\param   [in] newCount: The new number of distinct output values.
+  ///\remarks The default of 128 matches a 7 bit MIDI controller.
+  //////////////////////////////////////////////////////////////////////////////
+  void setStepCount(const int newCount)
+  {
+    // Set new value:
+    m_stepCount = newCount;
+
+    // Clip value:
+    if (m_stepCount <= 0)
+      m_stepCount = 1;
+
+    // Update step:
+    m_step = stepFromValue(m_value);
   }
 
   //////////////////////////////////////////////////////////////////////////////
@@ -190,6 +252,10 @@ public:
     // Clip value:
     if (m_frameCount <= 0)
       m_frameCount = 1;
+
+    // Update frame:
+    m_frame = frameFromValue(m_value);
+    update();
   }
 
   //////////////////////////////////////////////////////////////////////////////
@@ -453,34 +519,59 @@ protected:
   {
     if (isEnabled() || disabledImage().isNull())
     {
-      // Get size of a single sub image:
-      int w = image().width() / m_frameCount;
-      int h = image().height();
-
-      // Calc active frame:
-      int l = (int)(m_value * (m_frameCount - 1));
-      if (l < 0)
-        l = 0;
-      if (l > (m_frameCount - 1))
-        l = m_frameCount - 1;
-
-      // Calc source position:
-      int x = w * l;
-      int y = 0;
-
-      // Finally blit the image:
-      qp.drawPixmap(0, 0, image(), x, y, w, h);
+      // Blit the active frame, scaled to the widget:
+      SpriteAtlas::drawFrame(qp, this, rect(), image(), m_frameCount, m_frame);
     }
 
     else
     {
       // Just show the disabled image:
-      qp.drawPixmap(0, 0, disabledImage());
+      SpriteAtlas::drawFrame(qp, this, rect(), disabledImage(), 1, 0);
     }
   }
 
 private:
 
+  //////////////////////////////////////////////////////////////////////////////
+  // QImageDial::frameFromValue()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief  Internal helper to calc the knob movie frame for a value.
+  ///\param  [in] val: The value in the range [0,1].
+  ///\return The frame in the range [0,FrameCount - 1].
+  //////////////////////////////////////////////////////////////////////////////
+  int frameFromValue(const double val) const
+  {
+    // Calc frame:
+    int frame = (int)(val * (m_frameCount - 1));
+
+    // Clip frame:
+    if (frame < 0)
+      frame = 0;
+    else if (frame > m_frameCount - 1)
+      frame = m_frameCount > 0 ? m_frameCount - 1 : 0;
+    return frame;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // QImageDial::stepFromValue()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief  Internal helper to calc the output step for a value.
+  ///\param  [in] val: The value in the range [0,1].
+  ///\return The step in the range [0,StepCount - 1].
+  //////////////////////////////////////////////////////////////////////////////
+  int stepFromValue(const double val) const
+  {
+    // Same rounding as the value to CC conversion used by the editor:
+    int step = (int)(val * (m_stepCount - 1));
+
+    // Clip step:
+    if (step < 0)
+      step = 0;
+    else if (step > m_stepCount - 1)
+      step = m_stepCount - 1;
+    return step;
+  }
+
   //////////////////////////////////////////////////////////////////////////////
   // QImageDial::valueFromMousePos()
   //////////////////////////////////////////////////////////////////////////////
@@ -522,6 +613,9 @@ private:
   double m_value;        ///\> The current value of this dial.
   double m_defaultValue; ///\> The default value of this value.
   int    m_frameCount;   ///\> The number of frames in the knob movie image.
+  int    m_stepCount;    ///\> The number of distinct output values.
+  int    m_frame;        ///\> Knob movie frame of the current value.
+  int    m_step;         ///\> Output step of the current value.
   bool   m_absoluteMode; ///\> Use absolute or relative movement?
   bool   m_circularMode; ///\> Use linear or circular movement?
   int    m_startY;       ///\> Mouse down position for linear movement.
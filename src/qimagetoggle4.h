@@ -176,20 +176,13 @@ protected:
   {
     if (isEnabled() || disabledImage().isNull())
     {
-      // Get size of a single sub image:
-      int w = image().width() / 4;
-      int h = image().height();
-
-      // Calc source position:
-      int x = m_value * w;
-
-      // Finally blit the image:
-      qp.drawPixmap(0, 0, image(), x, 0, w, h);
+      // Blit the active frame, scaled to the widget:
+      SpriteAtlas::drawFrame(qp, this, rect(), image(), 4, m_value);
     }
     else
     {
       // Just show the disabled image:
-      qp.drawPixmap(0, 0, disabledImage());
+      SpriteAtlas::drawFrame(qp, this, rect(), disabledImage(), 1, 0);
     }
   }
 
@@ -29,6 +29,8 @@
 #if QT_VERSION >= 0x050000
 #include <QtWidgets>
 #endif
+#include "traceevents.h"
+#include "spriteatlas.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 ///\class QImageWidget qimagewidget.h
@@ -163,6 +165,8 @@ protected:
   //////////////////////////////////////////////////////////////////////////////
   void paintEvent(QPaintEvent* event)
   {
+    TRACE_SPAN("UI", "QImageWidget::paintEvent");
+
     // Do we have a movie?
     if (image().isNull())
     {
@@ -0,0 +1,18 @@
+#-------------------------------------------------
+#
+# Replays captured MIDI traffic into the editor.
+#
+#-------------------------------------------------
+
+QT += core gui xml
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = dtreplay
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+SOURCES += main.cpp
+
+include(../dtedit.pri)
@@ -0,0 +1,235 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    main.cpp
+///\ingroup dtedit
+///\brief   Replay of captured MIDI traffic.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include <cstdio>
+#include <QApplication>
+#include "dtedit.h"
+#include "mainmidiwindow.h"
+#include "mainwindow.h"
+#include "midilog.h"
+
+////////////////////////////////////////////////////////////////////////////////
+///\struct ReplayStatistics
+///\brief  Outcome of a replay.
+////////////////////////////////////////////////////////////////////////////////
+struct ReplayStatistics
+{
+  unsigned long      replayed; ///> Number of messages fed to the editor.
+  unsigned long      skipped;  ///> Number of outbound messages in the log.
+  unsigned long long elapsed;  ///> Duration of the replay in nanoseconds.
+  unsigned long long maxLag;   ///> Worst delay behind the schedule in nanoseconds.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///\class ReplayWindow
+///\brief The editor window fed from a traffic log instead of a device.
+////////////////////////////////////////////////////////////////////////////////
+class ReplayWindow :
+  public MainWindow
+{
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  // ReplayWindow::replay()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Feed the inbound messages of a log to the editor.
+  ///\param   [in]  reader: The log, read from its current position.
+  ///\param   [in]  speed:  Speed factor, 1 is real time and 0 replays as fast
+  ///                       as possible.
+  ///\param   [out] stats:  Receives the numbers of this run.
+  ///\remarks The messages are passed to onMIDIMessage() on the GUI thread in
+  ///         log order, so two runs of the same log see the same sequence.
+  ///         Outbound messages are skipped, the editor sends its own.
+  //////////////////////////////////////////////////////////////////////////////
+  void replay(MIDILogReader& reader, double speed, ReplayStatistics& stats)
+  {
+    stats.replayed = 0;
+    stats.skipped  = 0;
+    stats.maxLag   = 0;
+
+    MIDILogReader::Record      record;
+    std::vector<unsigned char> message;
+    unsigned long long         start    = RtMidi::getMonotonicTime();
+    unsigned long long         logTime  = 0;
+    unsigned long long         previous = 0;
+    while (reader.next(record))
+    {
+      if (record.direction != MIDILog::INBOUND)
+      {
+        stats.skipped++;
+        continue;
+      }
+
+      // Advance the log clock. Appended sessions may start with a smaller
+      // time stamp, these continue without a gap:
+      if (previous != 0 && record.timeStamp > previous)
+        logTime += record.timeStamp - previous;
+      previous = record.timeStamp;
+
+      // Wait for the message, keeping the UI alive:
+      unsigned long long now = RtMidi::getMonotonicTime();
+      unsigned long long due = now;
+      if (speed > 0.0)
+      {
+        due = start + (unsigned long long)(logTime / speed);
+        while (now < due)
+        {
+          QCoreApplication::processEvents();
+          now = RtMidi::getMonotonicTime();
+          if (due > now + 2000000)
+            Sleep(1);
+        }
+        if (now - due > stats.maxLag)
+          stats.maxLag = now - due;
+      }
+      else
+        QCoreApplication::processEvents();
+
+      // Deliver it like the MIDI input does:
+      message.assign(record.bytes, record.bytes + record.size);
+      onMIDIMessage(due, message);
+      stats.replayed++;
+    }
+
+    // Let the last updates through:
+    QCoreApplication::processEvents();
+    stats.elapsed = RtMidi::getMonotonicTime() - start;
+  }
+
+protected:
+  //////////////////////////////////////////////////////////////////////////////
+  // ReplayWindow::openMIDIPorts()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   No ports are used for a replay.
+  ///\return  Always true so the window does not ask for a setup.
+  //////////////////////////////////////////////////////////////////////////////
+  bool openMIDIPorts()
+  {
+    return true;
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// usage()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Print the command line help.
+////////////////////////////////////////////////////////////////////////////////
+static void usage()
+{
+  printf("Usage: dtreplay [options] <log file>\n"
+         "Feeds a MIDI log written by \"dtedit --capture <log file>\" to the\n"
+         "editor.\n\n"
+         "  --speed <x>  Speed factor, 1 = real time (default), 0 = as fast as\n"
+         "               possible.\n"
+         "  --loops <n>  Replay the log n times (default 1).\n"
+         "  --exit       Quit after the replay instead of keeping the window\n"
+         "               open.\n\n"
+         "Set QT_QPA_PLATFORM=offscreen to run without a display.\n");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// main()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Replay entry point.
+///\param   [in] argc: Number of command line arguments passed to this program.
+///\param   [in] argv: Array of command line arguments.
+///\return  Returns zero if successfull or an error code on failure.
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+  // Init the global application object:
+  QApplication a(argc, argv);
+
+  // Use own settings so the configuration of the editor is left alone:
+  a.setApplicationName   (QString("DTReplay"));
+  a.setOrganizationName  (QString("Rolf Meyerhoff"));
+  a.setOrganizationDomain(QString("dtedit.googlecode.com"));
+
+  // Parse the command line:
+  double  speed = 1.0;
+  int     loops = 1;
+  bool    quit  = false;
+  QString fileName;
+  QStringList args = a.arguments();
+  for (int i = 1; i < args.size(); i++)
+  {
+    bool ok = true;
+    if (args[i] == "--speed" && i + 1 < args.size())
+      speed = args[++i].toDouble(&ok);
+    else if (args[i] == "--loops" && i + 1 < args.size())
+      loops = args[++i].toInt(&ok);
+    else if (args[i] == "--exit")
+      quit = true;
+    else if (!args[i].startsWith("-") && fileName.isEmpty())
+      fileName = args[i];
+    else
+    {
+      usage();
+      return args[i] == "--help" ? 0 : 1;
+    }
+    if (!ok || speed < 0.0 || loops < 1)
+    {
+      fprintf(stderr, "Invalid value for %s\n", args[i - 1].toLocal8Bit().constData());
+      return 1;
+    }
+  }
+  if (fileName.isEmpty())
+  {
+    usage();
+    return 1;
+  }
+
+  // Open the log:
+  MIDILogReader reader;
+  if (!reader.open(fileName))
+  {
+    fprintf(stderr, "%s is not a MIDI log\n", fileName.toLocal8Bit().constData());
+    return 1;
+  }
+
+  // Create and show the editor:
+  ReplayWindow w;
+  w.show();
+  QCoreApplication::processEvents();
+
+  // Replay:
+  for (int i = 0; i < loops; i++)
+  {
+    ReplayStatistics stats;
+    reader.rewind();
+    w.replay(reader, speed, stats);
+    printf("Replayed %lu messages (%lu outbound skipped) in %.1f ms, %.0f messages/s, max lag %.3f ms\n",
+           stats.replayed, stats.skipped, stats.elapsed / 1e6,
+           stats.elapsed > 0 ? stats.replayed * 1e9 / stats.elapsed : 0.0, stats.maxLag / 1e6);
+    fflush(stdout);
+  }
+
+  // Keep the window open for inspection unless asked to quit:
+  if (quit)
+    return 0;
+  return a.exec();
+}
+
+///////////////////////////////// End of File //////////////////////////////////
@@ -40,6 +40,11 @@ SetupDialog::SetupDialog(QWidget* parent) :
   ui(new Ui::SetupDialog),
   inputName(""),
   outputName(""),
+  api(RtMidi::UNSPECIFIED),
+  resolvedApi(RtMidi::UNSPECIFIED),
+  scheduling(RtMidi::NORMAL_SCHEDULING),
+  priority(70),
+  runningStatus(false),
   blocked(false)
 {
   // Init user interface:
@@ -106,6 +111,104 @@ const QString& SetupDialog::getOutputName() const
   return outputName;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// SetupDialog::setApi()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Set accessor for the Api property.
+///\param   [in] api: The MIDI driver API to use.
+////////////////////////////////////////////////////////////////////////////////
+void SetupDialog::setApi(RtMidi::Api api)
+{
+  // Store API:
+  this->api = api;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SetupDialog::getApi()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get accessor for the Api property.
+///\return  The currently selected MIDI driver API.
+////////////////////////////////////////////////////////////////////////////////
+RtMidi::Api SetupDialog::getApi() const
+{
+  // Return the API:
+  return api;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SetupDialog::setScheduling()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Set accessor for the Scheduling property.
+///\param   [in] scheduling: Scheduling class of the MIDI input thread.
+///\param   [in] priority:   Real-time priority of the MIDI input thread.
+////////////////////////////////////////////////////////////////////////////////
+void SetupDialog::setScheduling(RtMidi::Scheduling scheduling, int priority)
+{
+  // Store values:
+  this->scheduling = scheduling;
+  this->priority   = priority;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SetupDialog::getScheduling()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get accessor for the Scheduling property.
+///\return  The selected scheduling class of the MIDI input thread.
+////////////////////////////////////////////////////////////////////////////////
+RtMidi::Scheduling SetupDialog::getScheduling() const
+{
+  // Return the scheduling class:
+  return scheduling;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SetupDialog::getPriority()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get accessor for the Priority property.
+///\return  The selected real-time priority of the MIDI input thread.
+////////////////////////////////////////////////////////////////////////////////
+int SetupDialog::getPriority() const
+{
+  // Return the priority:
+  return priority;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SetupDialog::setSchedulingInfo()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Set the text that reports the currently achieved scheduling.
+///\param   [in] info: Description of the current input thread scheduling.
+////////////////////////////////////////////////////////////////////////////////
+void SetupDialog::setSchedulingInfo(const QString& info)
+{
+  // Store text:
+  schedulingInfo = info;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SetupDialog::setRunningStatus()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Set accessor for the RunningStatus property.
+///\param   [in] enable: Leave out repeated status bytes on raw outputs?
+////////////////////////////////////////////////////////////////////////////////
+void SetupDialog::setRunningStatus(bool enable)
+{
+  // Store flag:
+  runningStatus = enable;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SetupDialog::getRunningStatus()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get accessor for the RunningStatus property.
+///\return  Returns true if running status is used on raw outputs.
+////////////////////////////////////////////////////////////////////////////////
+bool SetupDialog::getRunningStatus() const
+{
+  // Return the flag:
+  return runningStatus;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // SetupDialog::showEvent()
 ////////////////////////////////////////////////////////////////////////////////
@@ -117,57 +220,137 @@ void SetupDialog::showEvent(QShowEvent* /*e*/)
   // Lock UI:
   blocked = true;
 
-  // Get MIDI in properties:
-  RtMidiIn midiIn;
-  unsigned int portCnt = midiIn.getPortCount();
-  if (portCnt > 0)
+  // The first entry lets RtMidi choose the first driver that has ports:
+  ui->apiComboBox->clear();
+  ui->apiComboBox->addItem(RtMidi::getApiDisplayName(RtMidi::UNSPECIFIED).c_str(), QVariant(static_cast<int>(RtMidi::UNSPECIFIED)));
+
+  // Add all drivers compiled into this build:
+  std::vector<RtMidi::Api> apis;
+  RtMidi::getCompiledApi(apis);
+  int selItem = 0;
+  for (unsigned int i = 0; i < apis.size(); i++)
   {
-    int selItem = -1;
+    // Does this match the currently selected option?
+    if (apis[i] == api)
+      selItem = i + 1;
 
-    // Loop through MIDI ports:
-    for (unsigned int i = 0; i < portCnt; i++)
-    {
-      // Get name of the port:
-      QString name(midiIn.getPortName(i).c_str());
+    // Add item to the combo box:
+    ui->apiComboBox->addItem(RtMidi::getApiDisplayName(apis[i]).c_str(), QVariant(static_cast<int>(apis[i])));
+  }
+  ui->apiComboBox->setCurrentIndex(selItem);
 
-      // Does this match the currently selected option?
-      if (name == inputName)
-        selItem = i;
+  // Get the ports of the selected driver:
+  fillPortLists();
 
-      // Add item to the combo box:
-      ui->inputComboBox->addItem(name);
-    }
+  // Only the raw driver writes bytes that running status can leave out:
+  ui->runningStatusCheckBox->setChecked(runningStatus);
+  ui->runningStatusCheckBox->setEnabled(resolvedApi == RtMidi::LINUX_ALSA_RAW);
 
-    // Select current item, if any:
-    ui->inputComboBox->setCurrentIndex(selItem);
-  }
+  // Set input thread properties:
+  ui->schedulingComboBox->setCurrentIndex(static_cast<int>(scheduling));
+  ui->prioritySpinBox->setValue(priority);
+  ui->prioritySpinBox->setEnabled(scheduling != RtMidi::NORMAL_SCHEDULING);
+  ui->schedulingInfoLabel->setText(tr("Current: ") + schedulingInfo);
+
+  // Unlock UI:
+  blocked = false;
+}
 
-  // Get MIDI out properties:
-  RtMidiOut midiOut;
-  portCnt = midiOut.getPortCount();
-  if (portCnt > 0)
+////////////////////////////////////////////////////////////////////////////////
+// SetupDialog::fillPortLists()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Fill the input and output combo boxes with the ports of the
+///         currently selected API.
+///\remarks Also sets resolvedApi to the driver the output picked, the input
+///         is opened with the same one like in MainMIDIWindow::openMIDIPorts().
+////////////////////////////////////////////////////////////////////////////////
+void SetupDialog::fillPortLists()
+{
+  // Clear old lists:
+  ui->inputComboBox->clear();
+  ui->outputComboBox->clear();
+  resolvedApi = RtMidi::UNSPECIFIED;
+
+  try
   {
-    int selItem = -1;
+    // Let the output resolve "Automatic" so both lists come from one driver:
+    RtMidiOut midiOut(api);
+    resolvedApi = midiOut.getCurrentApi();
 
-    // Loop through MIDI ports:
-    for (unsigned int i = 0; i < portCnt; i++)
+    // Get MIDI in properties:
+    RtMidiIn midiIn(resolvedApi);
+    unsigned int portCnt = midiIn.getPortCount();
+    if (portCnt > 0)
     {
-      // Get name of the port:
-      QString name(midiOut.getPortName(i).c_str());
+      int selItem = -1;
+
+      // Loop through MIDI ports:
+      for (unsigned int i = 0; i < portCnt; i++)
+      {
+        // Get name of the port:
+        QString name(midiIn.getPortName(i).c_str());
 
-      // Does this match the currently selected option?
-      if (name == outputName)
-        selItem = i;
+        // Does this match the currently selected option?
+        if (name == inputName)
+          selItem = i;
 
-      // Add item to the combo box:
-      ui->outputComboBox->addItem(name);
+        // Add item to the combo box:
+        ui->inputComboBox->addItem(name);
+      }
+
+      // Select current item, if any:
+      ui->inputComboBox->setCurrentIndex(selItem);
     }
 
-    // Select current item, if any:
-    ui->outputComboBox->setCurrentIndex(selItem);
+    // Get MIDI out properties:
+    portCnt = midiOut.getPortCount();
+    if (portCnt > 0)
+    {
+      int selItem = -1;
+
+      // Loop through MIDI ports:
+      for (unsigned int i = 0; i < portCnt; i++)
+      {
+        // Get name of the port:
+        QString name(midiOut.getPortName(i).c_str());
+
+        // Does this match the currently selected option?
+        if (name == outputName)
+          selItem = i;
+
+        // Add item to the combo box:
+        ui->outputComboBox->addItem(name);
+      }
+
+      // Select current item, if any:
+      ui->outputComboBox->setCurrentIndex(selItem);
+    }
   }
+  catch (RtError& /*err*/)
+  {
+    // The driver is not available on this system, leave the lists empty.
+  }
+}
 
-  // Unlock UI:
+////////////////////////////////////////////////////////////////////////////////
+// SetupDialog::on_apiComboBox_currentIndexChanged()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the driver combo box selection changed signal.
+///\remarks Updates the api member and reloads the port lists.
+////////////////////////////////////////////////////////////////////////////////
+void SetupDialog::on_apiComboBox_currentIndexChanged(int index)
+{
+  // Update allowed?
+  if (blocked || index < 0)
+    return;
+
+  // Save API:
+  api = static_cast<RtMidi::Api>(ui->apiComboBox->itemData(index).toInt());
+
+  // The port names differ between the drivers, so get the new ones:
+  blocked = true;
+  fillPortLists();
+  ui->runningStatusCheckBox->setEnabled(resolvedApi == RtMidi::LINUX_ALSA_RAW);
   blocked = false;
 }
 
@@ -203,4 +386,54 @@ void SetupDialog::on_outputComboBox_currentIndexChanged(const QString& arg1)
   outputName = arg1;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// SetupDialog::on_schedulingComboBox_currentIndexChanged()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the scheduling combo box selection changed signal.
+///\remarks Updates the scheduling member.
+////////////////////////////////////////////////////////////////////////////////
+void SetupDialog::on_schedulingComboBox_currentIndexChanged(int index)
+{
+  // Update allowed?
+  if (blocked || index < 0)
+    return;
+
+  // Save scheduling class, the priority is used for real-time only:
+  scheduling = static_cast<RtMidi::Scheduling>(index);
+  ui->prioritySpinBox->setEnabled(scheduling != RtMidi::NORMAL_SCHEDULING);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SetupDialog::on_prioritySpinBox_valueChanged()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the priority spin box value changed signal.
+///\remarks Updates the priority member.
+////////////////////////////////////////////////////////////////////////////////
+void SetupDialog::on_prioritySpinBox_valueChanged(int value)
+{
+  // Update allowed?
+  if (blocked)
+    return;
+
+  // Save priority:
+  priority = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SetupDialog::on_runningStatusCheckBox_toggled()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the running status check box toggled signal.
+///\param   [in] checked: New state of the check box.
+///\remarks Updates the runningStatus member.
+////////////////////////////////////////////////////////////////////////////////
+void SetupDialog::on_runningStatusCheckBox_toggled(bool checked)
+{
+  // Update allowed?
+  if (blocked)
+    return;
+
+  // Save flag:
+  runningStatus = checked;
+}
+
 ///////////////////////////////// End of File //////////////////////////////////
@@ -28,6 +28,7 @@
 #define __SETUPDIALOG_H_INCLUDED__
 
 #include <QDialog>
+#include "RtMidi/RtMidi.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 // Forwards:
@@ -92,6 +93,71 @@ public:
   //////////////////////////////////////////////////////////////////////////////
   const QString& getOutputName() const;
 
+  //////////////////////////////////////////////////////////////////////////////
+  // SetupDialog::setApi()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Set accessor for the Api property.
+  ///\param   [in] api: The MIDI driver API to use.
+  //////////////////////////////////////////////////////////////////////////////
+  void setApi(RtMidi::Api api);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SetupDialog::getApi()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get accessor for the Api property.
+  ///\return  The currently selected MIDI driver API.
+  //////////////////////////////////////////////////////////////////////////////
+  RtMidi::Api getApi() const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SetupDialog::setScheduling()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Set accessor for the Scheduling property.
+  ///\param   [in] scheduling: Scheduling class of the MIDI input thread.
+  ///\param   [in] priority:   Real-time priority of the MIDI input thread.
+  //////////////////////////////////////////////////////////////////////////////
+  void setScheduling(RtMidi::Scheduling scheduling, int priority);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SetupDialog::getScheduling()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get accessor for the Scheduling property.
+  ///\return  The selected scheduling class of the MIDI input thread.
+  //////////////////////////////////////////////////////////////////////////////
+  RtMidi::Scheduling getScheduling() const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SetupDialog::getPriority()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get accessor for the Priority property.
+  ///\return  The selected real-time priority of the MIDI input thread.
+  //////////////////////////////////////////////////////////////////////////////
+  int getPriority() const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SetupDialog::setSchedulingInfo()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Set the text that reports the currently achieved scheduling.
+  ///\param   [in] info: Description of the current input thread scheduling.
+  //////////////////////////////////////////////////////////////////////////////
+  void setSchedulingInfo(const QString& info);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SetupDialog::setRunningStatus()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Set accessor for the RunningStatus property.
+  ///\param   [in] enable: Leave out repeated status bytes on raw outputs?
+  //////////////////////////////////////////////////////////////////////////////
+  void setRunningStatus(bool enable);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SetupDialog::getRunningStatus()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get accessor for the RunningStatus property.
+  ///\return  Returns true if running status is used on raw outputs.
+  //////////////////////////////////////////////////////////////////////////////
+  bool getRunningStatus() const;
+
 protected:
   //////////////////////////////////////////////////////////////////////////////
   // SetupDialog::showEvent()
@@ -102,6 +168,14 @@ protected:
   void showEvent(QShowEvent* e);
 
 private slots:
+  //////////////////////////////////////////////////////////////////////////////
+  // SetupDialog::on_apiComboBox_currentIndexChanged()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the driver combo box selection changed signal.
+  ///\remarks Updates the api member and reloads the port lists.
+  //////////////////////////////////////////////////////////////////////////////
+  void on_apiComboBox_currentIndexChanged(int index);
+
   //////////////////////////////////////////////////////////////////////////////
   // SetupDialog::on_inputComboBox_currentIndexChanged()
   //////////////////////////////////////////////////////////////////////////////
@@ -118,13 +192,52 @@ private slots:
   //////////////////////////////////////////////////////////////////////////////
   void on_outputComboBox_currentIndexChanged(const QString& arg1);
 
+  //////////////////////////////////////////////////////////////////////////////
+  // SetupDialog::on_schedulingComboBox_currentIndexChanged()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the scheduling combo box selection changed signal.
+  ///\remarks Updates the scheduling member.
+  //////////////////////////////////////////////////////////////////////////////
+  void on_schedulingComboBox_currentIndexChanged(int index);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SetupDialog::on_prioritySpinBox_valueChanged()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the priority spin box value changed signal.
+  ///\remarks Updates the priority member.
+  //////////////////////////////////////////////////////////////////////////////
+  void on_prioritySpinBox_valueChanged(int value);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SetupDialog::on_runningStatusCheckBox_toggled()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the running status check box toggled signal.
+  ///\param   [in] checked: New state of the check box.
+  ///\remarks Updates the runningStatus member.
+  //////////////////////////////////////////////////////////////////////////////
+  void on_runningStatusCheckBox_toggled(bool checked);
+
 private:
+  //////////////////////////////////////////////////////////////////////////////
+  // SetupDialog::fillPortLists()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Fill the input and output combo boxes with the ports of the
+  ///         currently selected API.
+  //////////////////////////////////////////////////////////////////////////////
+  void fillPortLists();
+
   //////////////////////////////////////////////////////////////////////////////
   // Member:
-  Ui::SetupDialog* ui;         ///> Design class.
-  QString          inputName;  ///> Name of the currently selected input.
-  QString          outputName; ///> Name of the currently selected output.
-  bool             blocked;    ///> UI udate blocking flag.
+  Ui::SetupDialog*   ui;             ///> Design class.
+  QString            inputName;      ///> Name of the currently selected input.
+  QString            outputName;     ///> Name of the currently selected output.
+  RtMidi::Api        api;            ///> The currently selected MIDI API.
+  RtMidi::Api        resolvedApi;    ///> The driver "Automatic" resolves to.
+  RtMidi::Scheduling scheduling;     ///> Scheduling class of the input thread.
+  int                priority;       ///> Real-time priority of the input thread.
+  QString            schedulingInfo; ///> Achieved scheduling of the input thread.
+  bool               runningStatus;  ///> Use running status on raw outputs?
+  bool               blocked;        ///> UI udate blocking flag.
 };
 
 #endif // #ifndef __SETUPDIALOG_H_INCLUDED__
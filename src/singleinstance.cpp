@@ -0,0 +1,175 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    singleinstance.cpp
+///\ingroup dtedit
+///\brief   Single instance implementation.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include "singleinstance.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// SingleInstance::SingleInstance()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Initialization constructor of this class.
+///\param   [in] parent: Parent object.
+////////////////////////////////////////////////////////////////////////////////
+SingleInstance::SingleInstance(QObject* parent) :
+  QObject(parent),
+  server(0)
+{
+  // Nothing to do here.
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SingleInstance::forward()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Hand files over to the running instance.
+///\param   [in] files:   Absolute paths of the preset files (may be empty).
+///\param   [in] timeout: Time to wait for the connection in milliseconds.
+///\return  Returns true if an instance is running and got the files.
+////////////////////////////////////////////////////////////////////////////////
+bool SingleInstance::forward(const QStringList& files, int timeout)
+{
+  // Anybody there? Without a running instance this fails right away:
+  QLocalSocket socket;
+  socket.connectToServer(serverName());
+  if (!socket.waitForConnected(timeout))
+    return false;
+
+  // Send the file names:
+  QByteArray message;
+  for (int i = 0; i < files.size(); i++)
+    message += files[i].toUtf8() + '\n';
+  message += '\n';
+  socket.write(message);
+  bool ok = socket.waitForBytesWritten(timeout);
+  socket.disconnectFromServer();
+
+  // Return to sender:
+  return ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SingleInstance::listen()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Become the running instance.
+///\return  Returns true if successfull or false otherwise.
+///\remarks Call this after forward() failed. A socket left behind by a
+///         crashed instance is removed. Fails if another instance started
+///         listening since, forward() to it then.
+////////////////////////////////////////////////////////////////////////////////
+bool SingleInstance::listen()
+{
+  #if QT_VERSION >= 0x050100
+  // Editors that start at the same time take turns here, so none of them
+  // removes the socket that another one just created:
+  QLockFile lock(QDir(QDir::tempPath()).absoluteFilePath(serverName() + ".lock"));
+  lock.tryLock(2000);
+  #endif
+
+  if (server == 0)
+  {
+    server = new QLocalServer(this);
+    #if QT_VERSION >= 0x050000
+    server->setSocketOptions(QLocalServer::UserAccessOption);
+    #endif
+    connect(server, SIGNAL(newConnection()), this, SLOT(newConnection()));
+  }
+
+  // Nobody answered in forward(), but another editor may have started to
+  // listen since. Only a socket that still doesn't answer is stale:
+  if (server->listen(serverName()))
+    return true;
+  QLocalSocket socket;
+  socket.connectToServer(serverName());
+  if (socket.waitForConnected(500))
+  {
+    socket.disconnectFromServer();
+    return false;
+  }
+  QLocalServer::removeServer(serverName());
+
+  // Return to sender:
+  return server->listen(serverName());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SingleInstance::newConnection()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the new connection signal of the server.
+////////////////////////////////////////////////////////////////////////////////
+void SingleInstance::newConnection()
+{
+  QLocalSocket* socket = server->nextPendingConnection();
+  while (socket != 0)
+  {
+    connect(socket, SIGNAL(readyRead()), this, SLOT(readMessage()));
+    connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+    socket = server->nextPendingConnection();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SingleInstance::readMessage()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Handler for the ready read signal of a connection.
+////////////////////////////////////////////////////////////////////////////////
+void SingleInstance::readMessage()
+{
+  QLocalSocket* socket = qobject_cast<QLocalSocket*>(sender());
+  if (socket == 0)
+    return;
+
+  // Collect the lines up to the empty one, a message may come in pieces:
+  QStringList files = socket->property("files").toStringList();
+  while (socket->canReadLine())
+  {
+    QByteArray line = socket->readLine();
+    line.chop(1);
+    if (line.isEmpty())
+    {
+      socket->disconnect(this);
+      socket->setProperty("files", QVariant());
+      emit activated(files);
+      return;
+    }
+    files.append(QString::fromUtf8(line.constData(), line.size()));
+  }
+  socket->setProperty("files", files);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SingleInstance::serverName()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the name of the local socket.
+///\return  The name, it includes the user name.
+////////////////////////////////////////////////////////////////////////////////
+QString SingleInstance::serverName()
+{
+  // One editor per user:
+  QString user = QString::fromLocal8Bit(qgetenv("USER"));
+  if (user.isEmpty())
+    user = QString::fromLocal8Bit(qgetenv("USERNAME"));
+  return QCoreApplication::applicationName() + "-" + user;
+}
+
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    singleinstance.h
+///\ingroup dtedit
+///\brief   Hand over to an already running editor.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef __SINGLEINSTANCE_H_INCLUDED__
+#define __SINGLEINSTANCE_H_INCLUDED__
+
+#include <QtCore>
+#include <QtNetwork>
+
+////////////////////////////////////////////////////////////////////////////////
+///\class SingleInstance singleinstance.h
+///\brief Keeps the editor to one instance per user.
+/// The first instance listens on a local socket. Later ones connect to it,
+/// hand over the preset files of their command line and quit before they
+/// create a window or open any MIDI port.
+///
+/// A message is one line per file name in UTF-8, ended by an empty line.
+////////////////////////////////////////////////////////////////////////////////
+class SingleInstance : public QObject
+{
+  Q_OBJECT // Qt magic...
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  // SingleInstance::SingleInstance()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Initialization constructor of this class.
+  ///\param   [in] parent: Parent object.
+  //////////////////////////////////////////////////////////////////////////////
+  SingleInstance(QObject* parent = 0);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SingleInstance::forward()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Hand files over to the running instance.
+  ///\param   [in] files:   Absolute paths of the preset files (may be empty).
+  ///\param   [in] timeout: Time to wait for the connection in milliseconds.
+  ///\return  Returns true if an instance is running and got the files.
+  //////////////////////////////////////////////////////////////////////////////
+  bool forward(const QStringList& files, int timeout = 500);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SingleInstance::listen()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Become the running instance.
+  ///\return  Returns true if successfull or false otherwise.
+  ///\remarks Call this after forward() failed. A socket left behind by a
+  ///         crashed instance is removed. Fails if another instance started
+  ///         listening since, forward() to it then.
+  //////////////////////////////////////////////////////////////////////////////
+  bool listen();
+
+signals:
+  //////////////////////////////////////////////////////////////////////////////
+  // SingleInstance::activated()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Another instance was started.
+  ///\param   [in] files: The preset files it handed over.
+  //////////////////////////////////////////////////////////////////////////////
+  void activated(const QStringList& files);
+
+private slots:
+  //////////////////////////////////////////////////////////////////////////////
+  // SingleInstance::newConnection()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the new connection signal of the server.
+  //////////////////////////////////////////////////////////////////////////////
+  void newConnection();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SingleInstance::readMessage()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Handler for the ready read signal of a connection.
+  //////////////////////////////////////////////////////////////////////////////
+  void readMessage();
+
+private:
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SingleInstance::serverName()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get the name of the local socket.
+  ///\return  The name, it includes the user name.
+  //////////////////////////////////////////////////////////////////////////////
+  static QString serverName();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  QLocalServer* server; ///> Server of the running instance (0 until listen()).
+};
+
+#endif // #ifndef __SINGLEINSTANCE_H_INCLUDED__
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,241 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    spriteatlas.cpp
+///\ingroup dtedit
+///\brief   Sprite atlas implementation.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include <cmath>
+#include "spriteatlas.h"
+
+// Cache size in KB. The QPixmapCache default of 10 MB is too small: the
+// atlas of the 61 knob frames alone takes about 9 MB on a 2x screen with the
+// window at twice its size, and the images of ImageAssets live there too:
+static const int atlasCacheLimit = 64 * 1024;
+
+// Are the builds of new atlases deferred?
+static bool buildsDeferred = false;
+
+////////////////////////////////////////////////////////////////////////////////
+// SpriteAtlas::SpriteAtlas()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Default constructor, creates a null atlas.
+////////////////////////////////////////////////////////////////////////////////
+SpriteAtlas::SpriteAtlas() :
+  columns(1)
+{
+  // Nothing to do here.
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SpriteAtlas::find()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the atlas of an image strip.
+///\param   [in] strip:      Horizontal image strip.
+///\param   [in] frameCount: Number of frames in the strip.
+///\param   [in] frameSize:  Size of a frame on the screen in device pixels.
+///\return  The atlas, built if it is not in the cache.
+////////////////////////////////////////////////////////////////////////////////
+SpriteAtlas SpriteAtlas::find(const QPixmap& strip, int frameCount, const QSize& frameSize)
+{
+  SpriteAtlas result;
+  if (strip.isNull() || frameCount <= 0 || frameSize.isEmpty())
+    return result;
+  result.frameSize = frameSize;
+  result.columns   = static_cast<int>(ceil(sqrt(static_cast<double>(frameCount))));
+
+  // Already built?
+  QString key = cacheKey(strip, frameCount, frameSize);
+  if (QPixmapCache::find(key, &result.atlas))
+    return result;
+
+  // Scale each frame on its own, so the filter does not mix in the pixels
+  // of the neighbour frames:
+  int    rows        = (frameCount + result.columns - 1) / result.columns;
+  QImage source      = strip.toImage();
+  int    sourceWidth = source.width() / frameCount;
+  QImage grid(result.columns * frameSize.width(), rows * frameSize.height(), QImage::Format_ARGB32_Premultiplied);
+  grid.fill(0);
+  QPainter qp(&grid);
+  qp.setCompositionMode(QPainter::CompositionMode_Source);
+  for (int i = 0; i < frameCount; i++)
+  {
+    QImage frame = source.copy(i * sourceWidth, 0, sourceWidth, source.height());
+    frame = frame.scaled(frameSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    qp.drawImage((i % result.columns) * frameSize.width(), (i / result.columns) * frameSize.height(), frame);
+  }
+  qp.end();
+
+  // Keep it for the other controls and the next paint. An atlas larger than
+  // the cache would be built again on every paint:
+  result.atlas = QPixmap::fromImage(grid);
+  if (QPixmapCache::cacheLimit() < atlasCacheLimit)
+    QPixmapCache::setCacheLimit(atlasCacheLimit);
+  QPixmapCache::insert(key, result.atlas);
+
+  // Return to sender:
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SpriteAtlas::isNull()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Is this atlas empty?
+////////////////////////////////////////////////////////////////////////////////
+bool SpriteAtlas::isNull() const
+{
+  return atlas.isNull();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SpriteAtlas::draw()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Draw a frame.
+///\param   [in] qp:     Painter to use.
+///\param   [in] target: Target rectangle in logical pixels.
+///\param   [in] frame:  Index of the frame.
+///\remarks The target must cover frameSize device pixels for a 1:1 blit.
+////////////////////////////////////////////////////////////////////////////////
+void SpriteAtlas::draw(QPainter& qp, const QRect& target, int frame) const
+{
+  if (atlas.isNull() || frame < 0)
+    return;
+  int x = (frame % columns) * frameSize.width();
+  int y = (frame / columns) * frameSize.height();
+  qp.drawPixmap(target, atlas, QRect(x, y, frameSize.width(), frameSize.height()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SpriteAtlas::drawFrame()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Draw a frame of an image strip into a rectangle of a widget.
+///\param   [in] qp:         Painter to use.
+///\param   [in] widget:     The painted widget.
+///\param   [in] target:     Target rectangle in logical pixels.
+///\param   [in] strip:      Horizontal image strip.
+///\param   [in] frameCount: Number of frames in the strip.
+///\param   [in] frame:      Index of the frame.
+///\remarks Blits right from the strip if the frame is shown at its own
+///         size and uses an atlas otherwise.
+////////////////////////////////////////////////////////////////////////////////
+void SpriteAtlas::drawFrame(QPainter& qp, const QWidget* widget, const QRect& target, const QPixmap& strip, int frameCount, int frame)
+{
+  if (strip.isNull() || frameCount <= 0)
+    return;
+
+  // Size of the frame on the screen:
+  qreal ratio = pixelRatio(widget);
+  QSize frameSize(qRound(target.width() * ratio), qRound(target.height() * ratio));
+
+  // Shown at its own size? Then there is nothing to scale:
+  int w = strip.width() / frameCount;
+  if (frameSize.width() == w && frameSize.height() == strip.height())
+  {
+    qp.drawPixmap(target, strip, QRect(w * frame, 0, w, strip.height()));
+    return;
+  }
+
+  // Scale on the fly while the builds are deferred, instead of building an
+  // atlas for each size that a resize passes:
+  if (buildsDeferred)
+  {
+    QPixmap atlas;
+    if (!QPixmapCache::find(cacheKey(strip, frameCount, frameSize), &atlas))
+    {
+      bool smooth = qp.testRenderHint(QPainter::SmoothPixmapTransform);
+      qp.setRenderHint(QPainter::SmoothPixmapTransform);
+      qp.drawPixmap(target, strip, QRect(w * frame, 0, w, strip.height()));
+      qp.setRenderHint(QPainter::SmoothPixmapTransform, smooth);
+      return;
+    }
+  }
+
+  // Blit from the scaled frames:
+  find(strip, frameCount, frameSize).draw(qp, target, frame);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SpriteAtlas::setBuildsDeferred()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Defer the builds of new atlases, for example during a resize.
+///\param   [in] defer: Scale the frames on the fly instead of building?
+///\remarks Repaint the controls after ending the deferral, so they get their
+///         atlases.
+////////////////////////////////////////////////////////////////////////////////
+void SpriteAtlas::setBuildsDeferred(bool defer)
+{
+  buildsDeferred = defer;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SpriteAtlas::cacheKey()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the key of an atlas in the QPixmapCache.
+///\param   [in] strip:      Horizontal image strip.
+///\param   [in] frameCount: Number of frames in the strip.
+///\param   [in] frameSize:  Size of a frame on the screen in device pixels.
+///\return  The key.
+////////////////////////////////////////////////////////////////////////////////
+QString SpriteAtlas::cacheKey(const QPixmap& strip, int frameCount, const QSize& frameSize)
+{
+  return QString("atlas:%1:%2:%3x%4").arg(strip.cacheKey()).arg(frameCount).arg(frameSize.width()).arg(frameSize.height());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SpriteAtlas::pixelRatio()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the device pixel ratio of a widget.
+///\param   [in] widget: The widget.
+///\return  The ratio, fractional where Qt supports it, 1 with Qt 4.
+////////////////////////////////////////////////////////////////////////////////
+qreal SpriteAtlas::pixelRatio(const QWidget* widget)
+{
+  #if QT_VERSION >= 0x050600
+  return widget->devicePixelRatioF();
+  #elif QT_VERSION >= 0x050000
+  return widget->devicePixelRatio();
+  #else
+  Q_UNUSED(widget);
+  return 1.0;
+  #endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SpriteAtlas::scaledRect()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Scale a rectangle of the panel layout.
+///\param   [in] rect:  The rectangle at scale 1.
+///\param   [in] scale: The scale.
+///\return  The scaled rectangle.
+///\remarks The edges are rounded, not the size, so rectangles that touch
+///         at scale 1 still touch at any scale.
+////////////////////////////////////////////////////////////////////////////////
+QRect SpriteAtlas::scaledRect(const QRect& rect, qreal scale)
+{
+  int left   = qRound(rect.x() * scale);
+  int top    = qRound(rect.y() * scale);
+  int right  = qRound((rect.x() + rect.width())  * scale);
+  int bottom = qRound((rect.y() + rect.height()) * scale);
+  return QRect(left, top, right - left, bottom - top);
+}
+
+///////////////////////////////// End of File //////////////////////////////////
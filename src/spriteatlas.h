@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    spriteatlas.h
+///\ingroup dtedit
+///\brief   Pre-scaled frame atlas for image strips.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef __SPRITEATLAS_H_INCLUDED__
+#define __SPRITEATLAS_H_INCLUDED__
+
+#include <QtGui>
+
+////////////////////////////////////////////////////////////////////////////////
+///\class SpriteAtlas spriteatlas.h
+///\brief The frames of an image strip, scaled for the screen.
+/// The image widgets use horizontal strips with one frame per state, like the
+/// 61 frames of the knob movie. An atlas holds all frames already scaled to
+/// the size that a control covers on the screen in device pixels, so painting
+/// a frame is always a 1:1 blit, whatever the device pixel ratio and the
+/// scale of the window are. The frames are arranged in a grid that is about
+/// square instead of a long strip, so the rows of one frame lie close to each
+/// other in memory.
+///
+/// Atlases are built with smooth filtering on first use and kept in the
+/// QPixmapCache, so all dials with the same strip and size share one atlas.
+/// While the window is resized the builds can be deferred, the frames are
+/// then scaled on the fly until the size settles.
+////////////////////////////////////////////////////////////////////////////////
+class SpriteAtlas
+{
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  // SpriteAtlas::SpriteAtlas()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Default constructor, creates a null atlas.
+  //////////////////////////////////////////////////////////////////////////////
+  SpriteAtlas();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SpriteAtlas::find()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get the atlas of an image strip.
+  ///\param   [in] strip:      Horizontal image strip.
+  ///\param   [in] frameCount: Number of frames in the strip.
+  ///\param   [in] frameSize:  Size of a frame on the screen in device pixels.
+  ///\return  The atlas, built if it is not in the cache.
+  //////////////////////////////////////////////////////////////////////////////
+  static SpriteAtlas find(const QPixmap& strip, int frameCount, const QSize& frameSize);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SpriteAtlas::isNull()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Is this atlas empty?
+  //////////////////////////////////////////////////////////////////////////////
+  bool isNull() const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SpriteAtlas::draw()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Draw a frame.
+  ///\param   [in] qp:     Painter to use.
+  ///\param   [in] target: Target rectangle in logical pixels.
+  ///\param   [in] frame:  Index of the frame.
+  ///\remarks The target must cover frameSize device pixels for a 1:1 blit.
+  //////////////////////////////////////////////////////////////////////////////
+  void draw(QPainter& qp, const QRect& target, int frame) const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SpriteAtlas::drawFrame()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Draw a frame of an image strip into a rectangle of a widget.
+  ///\param   [in] qp:         Painter to use.
+  ///\param   [in] widget:     The painted widget.
+  ///\param   [in] target:     Target rectangle in logical pixels.
+  ///\param   [in] strip:      Horizontal image strip.
+  ///\param   [in] frameCount: Number of frames in the strip.
+  ///\param   [in] frame:      Index of the frame.
+  ///\remarks Blits right from the strip if the frame is shown at its own
+  ///         size and uses an atlas otherwise.
+  //////////////////////////////////////////////////////////////////////////////
+  static void drawFrame(QPainter& qp, const QWidget* widget, const QRect& target, const QPixmap& strip, int frameCount, int frame);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SpriteAtlas::setBuildsDeferred()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Defer the builds of new atlases, for example during a resize.
+  ///\param   [in] defer: Scale the frames on the fly instead of building?
+  ///\remarks Repaint the controls after ending the deferral, so they get
+  ///         their atlases.
+  //////////////////////////////////////////////////////////////////////////////
+  static void setBuildsDeferred(bool defer);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SpriteAtlas::pixelRatio()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get the device pixel ratio of a widget.
+  ///\param   [in] widget: The widget.
+  ///\return  The ratio, fractional where Qt supports it, 1 with Qt 4.
+  //////////////////////////////////////////////////////////////////////////////
+  static qreal pixelRatio(const QWidget* widget);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // SpriteAtlas::scaledRect()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Scale a rectangle of the panel layout.
+  ///\param   [in] rect:  The rectangle at scale 1.
+  ///\param   [in] scale: The scale.
+  ///\return  The scaled rectangle.
+  ///\remarks The edges are rounded, not the size, so rectangles that touch
+  ///         at scale 1 still touch at any scale.
+  //////////////////////////////////////////////////////////////////////////////
+  static QRect scaledRect(const QRect& rect, qreal scale);
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  // SpriteAtlas::cacheKey()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get the key of an atlas in the QPixmapCache.
+  ///\param   [in] strip:      Horizontal image strip.
+  ///\param   [in] frameCount: Number of frames in the strip.
+  ///\param   [in] frameSize:  Size of a frame on the screen in device pixels.
+  ///\return  The key.
+  //////////////////////////////////////////////////////////////////////////////
+  static QString cacheKey(const QPixmap& strip, int frameCount, const QSize& frameSize);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  QPixmap atlas;     ///> All frames in a grid, or null.
+  QSize   frameSize; ///> Size of a frame in device pixels.
+  int     columns;   ///> Number of frames per row.
+};
+
+#endif // #ifndef __SPRITEATLAS_H_INCLUDED__
+///////////////////////////////// End of File //////////////////////////////////
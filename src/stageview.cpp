@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    stageview.cpp
+///\ingroup dtedit
+///\brief   Stage view class implementation.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include <QtGui>
+#include "stageview.h"
+#include "panelcanvas.h"
+#include "dtedit.h"
+
+// Size of the panel at scale 1:
+#define STAGE_WIDTH  314
+#define STAGE_HEIGHT 124
+
+// The controls of the stage panel:
+static const PanelItem stageItems[] =
+{
+  { PanelCanvas::TOGGLE4, CC_VOICE_A,     20, 30, 48, 48, "I_II_III_IV", "I_II_III_IV_disabled",  1, 0 },
+  { PanelCanvas::TOGGLE,  CC_CHANNEL,     90, 10, 64, 88, "channel",     "channel_disabled",      1, ITEM_LOW_ON },
+  { PanelCanvas::DIAL,    CC_MASTER_VOL, 176, 30, 48, 48, "knob_movie",  "knob_disabled",        61, 0 },
+  { PanelCanvas::TOGGLE4, CC_VOICE_B,    246, 30, 48, 48, "I_II_III_IV", "I_II_III_IV_disabled",  1, 0 }
+};
+
+// Labels below the controls, centered on x:
+static const struct
+{
+  int         x;
+  const char* text;
+} stageLabels[] =
+{
+  {  44, QT_TRANSLATE_NOOP("StageView", "VOICE A") },
+  { 122, QT_TRANSLATE_NOOP("StageView", "CHANNEL") },
+  { 200, QT_TRANSLATE_NOOP("StageView", "MASTER") },
+  { 270, QT_TRANSLATE_NOOP("StageView", "VOICE B") }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// StageView::StageView()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Initialization constructor of this window.
+///\param   [in] parent: Parent window for this window.
+///\remarks The view is a top level window that deletes itself when closed.
+////////////////////////////////////////////////////////////////////////////////
+StageView::StageView(QWidget* parent) :
+  QWidget(parent, Qt::Window),
+  scale(1.0)
+{
+  setWindowTitle(tr("DT Edit Stage"));
+  setAttribute(Qt::WA_DeleteOnClose);
+  setAttribute(Qt::WA_QuitOnClose, false);
+
+  // The images come from the pixmap cache, the main window loaded them:
+  canvas = new PanelCanvas(this);
+  canvas->addItems(stageItems, sizeof(stageItems) / sizeof(stageItems[0]), QPoint(0, 0));
+
+  // Twice the size is readable from a distance:
+  setMinimumSize(STAGE_WIDTH, STAGE_HEIGHT);
+  resize(STAGE_WIDTH * 2, STAGE_HEIGHT * 2);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// StageView::panel()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Access the canvas with the controls.
+///\return  The canvas, its controls are tagged with the controller numbers.
+////////////////////////////////////////////////////////////////////////////////
+PanelCanvas* StageView::panel() const
+{
+  return canvas;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// StageView::showValue()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Show the value of an amp parameter.
+///\param   [in] controlNumber: Controller number of the parameter.
+///\param   [in] value:         The value (0-127).
+///\remarks Parameters without a control in this view are ignored.
+////////////////////////////////////////////////////////////////////////////////
+void StageView::showValue(int controlNumber, int value)
+{
+  canvas->setControllerValue(controlNumber, value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// StageView::paintEvent()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Paint the background and the labels.
+///\param   [in] e: Description of the event.
+////////////////////////////////////////////////////////////////////////////////
+void StageView::paintEvent(QPaintEvent* e)
+{
+  QPainter qp(this);
+  qp.fillRect(e->rect(), Qt::black);
+
+  // Labels, scaled with the panel:
+  QFont font = qp.font();
+  font.setPixelSize(qMax(6, qRound(10 * scale)));
+  font.setBold(true);
+  qp.setFont(font);
+  qp.setPen(Qt::lightGray);
+  int labelHeight = qRound(20 * scale);
+  int labelWidth  = qRound(80 * scale);
+  for (unsigned int i = 0; i < sizeof(stageLabels) / sizeof(stageLabels[0]); i++)
+  {
+    QRect rect(panelRect.left() + qRound(stageLabels[i].x * scale) - labelWidth / 2,
+               panelRect.bottom() - labelHeight, labelWidth, labelHeight);
+    qp.drawText(rect, Qt::AlignCenter, tr(stageLabels[i].text));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// StageView::resizeEvent()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Scale the panel with the window.
+///\param   [in] e: Description of the event.
+////////////////////////////////////////////////////////////////////////////////
+void StageView::resizeEvent(QResizeEvent* e)
+{
+  // Fit the panel into the window and center it:
+  scale = qMin(static_cast<qreal>(e->size().width()) / STAGE_WIDTH, static_cast<qreal>(e->size().height()) / STAGE_HEIGHT);
+  int w = qRound(STAGE_WIDTH * scale);
+  int h = qRound(STAGE_HEIGHT * scale);
+  panelRect = QRect((e->size().width() - w) / 2, (e->size().height() - h) / 2, w, h);
+
+  // The canvas covers the panel and scales its controls:
+  canvas->setGeometry(panelRect);
+  canvas->setLayoutScale(scale);
+  update();
+}
+
+///////////////////////////////// End of File //////////////////////////////////
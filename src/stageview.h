@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    stageview.h
+///\ingroup dtedit
+///\brief   Stage view class definition.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef __STAGEVIEW_H_INCLUDED__
+#define __STAGEVIEW_H_INCLUDED__
+
+#include <QWidget>
+
+////////////////////////////////////////////////////////////////////////////////
+// Forwards:
+class PanelCanvas;
+
+////////////////////////////////////////////////////////////////////////////////
+///\class StageView stageview.h
+///\brief Compact window with the channel, voicing and master controls.
+/// The view has no MIDI ports and no state of its own. The main window
+/// passes the changed parameters in and sends the edits made on its canvas,
+/// so any number of views stay in sync with the editor and the DT.
+////////////////////////////////////////////////////////////////////////////////
+class StageView : public QWidget
+{
+  Q_OBJECT // Qt magic...
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  // StageView::StageView()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Initialization constructor of this window.
+  ///\param   [in] parent: Parent window for this window.
+  ///\remarks The view is a top level window that deletes itself when closed.
+  //////////////////////////////////////////////////////////////////////////////
+  StageView(QWidget* parent = 0);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // StageView::panel()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Access the canvas with the controls.
+  ///\return  The canvas, its controls are tagged with the controller numbers.
+  //////////////////////////////////////////////////////////////////////////////
+  PanelCanvas* panel() const;
+
+public slots:
+  //////////////////////////////////////////////////////////////////////////////
+  // StageView::showValue()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Show the value of an amp parameter.
+  ///\param   [in] controlNumber: Controller number of the parameter.
+  ///\param   [in] value:         The value (0-127).
+  ///\remarks Parameters without a control in this view are ignored.
+  //////////////////////////////////////////////////////////////////////////////
+  void showValue(int controlNumber, int value);
+
+protected:
+  //////////////////////////////////////////////////////////////////////////////
+  // StageView::paintEvent()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Paint the background and the labels.
+  ///\param   [in] e: Description of the event.
+  //////////////////////////////////////////////////////////////////////////////
+  void paintEvent(QPaintEvent* e);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // StageView::resizeEvent()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Scale the panel with the window.
+  ///\param   [in] e: Description of the event.
+  //////////////////////////////////////////////////////////////////////////////
+  void resizeEvent(QResizeEvent* e);
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  PanelCanvas* canvas;    ///> The controls.
+  QRect        panelRect; ///> Scaled panel within the window.
+  qreal        scale;     ///> Scale of the panel.
+};
+
+#endif // __STAGEVIEW_H_INCLUDED__
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,144 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    startupprofile.cpp
+///\ingroup dtedit
+///\brief   Startup time profile implementation.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include <cstdio>
+#include "startupprofile.h"
+#include "traceevents.h"
+#include "RtMidi/RtMidi.h"
+
+// The time line:
+static unsigned long long startTime  = 0;
+static const char*        phaseNames[StartupProfile::MAX_PHASES];
+static unsigned long long phaseEnds[StartupProfile::MAX_PHASES];
+static int                phaseCount = 0;
+static bool               finished   = false;
+static bool               printIt    = false;
+
+////////////////////////////////////////////////////////////////////////////////
+// StartupProfile::start()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Start the time line, call this first thing in main().
+////////////////////////////////////////////////////////////////////////////////
+void StartupProfile::start()
+{
+  startTime  = RtMidi::getMonotonicTime();
+  phaseCount = 0;
+  finished   = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// StartupProfile::mark()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Mark the end of a phase.
+///\param   [in] phase: Name of the phase (string literal).
+////////////////////////////////////////////////////////////////////////////////
+void StartupProfile::mark(const char* phase)
+{
+  // Still starting?
+  if (finished || startTime == 0 || phaseCount >= MAX_PHASES)
+    return;
+
+  // Note the end:
+  unsigned long long now = RtMidi::getMonotonicTime();
+  phaseNames[phaseCount] = phase;
+  phaseEnds[phaseCount]  = now;
+
+  #ifdef __DTEDIT_TRACE_EVENTS__
+  // Show the phase in the trace:
+  TraceEvents::addSpan("Startup", phase, phaseCount > 0 ? phaseEnds[phaseCount - 1] : startTime, now);
+  #endif
+
+  phaseCount++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// StartupProfile::finish()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Mark the last phase and end the time line.
+///\param   [in] phase: Name of the phase (string literal).
+///\remarks Prints the report to stdout if enabled by setPrint().
+////////////////////////////////////////////////////////////////////////////////
+void StartupProfile::finish(const char* phase)
+{
+  if (finished)
+    return;
+  mark(phase);
+  finished = true;
+
+  // Print the report:
+  if (printIt)
+  {
+    printf("%s", report().toLocal8Bit().constData());
+    fflush(stdout);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// StartupProfile::setPrint()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Print the report when the startup is finished?
+///\param   [in] enable: Print it?
+////////////////////////////////////////////////////////////////////////////////
+void StartupProfile::setPrint(bool enable)
+{
+  printIt = enable;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// StartupProfile::isFinished()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Check if the startup is complete.
+///\return  Returns true after finish().
+////////////////////////////////////////////////////////////////////////////////
+bool StartupProfile::isFinished()
+{
+  return finished;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// StartupProfile::report()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Describe the time line.
+///\return  One line per phase with its duration and the time since start.
+////////////////////////////////////////////////////////////////////////////////
+QString StartupProfile::report()
+{
+  QString text = "Startup phase                  took ms    at ms\n";
+  unsigned long long previous = startTime;
+  for (int i = 0; i < phaseCount; i++)
+  {
+    text += QString("%1 %2 %3\n")
+      .arg(QString(phaseNames[i]), -30)
+      .arg((phaseEnds[i] - previous) / 1e6, 7, 'f', 1)
+      .arg((phaseEnds[i] - startTime) / 1e6, 8, 'f', 1);
+    previous = phaseEnds[i];
+  }
+  if (!finished)
+    text += "(still starting)\n";
+  return text;
+}
+
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    startupprofile.h
+///\ingroup dtedit
+///\brief   Startup time profile definitions.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef __STARTUPPROFILE_H_INCLUDED__
+#define __STARTUPPROFILE_H_INCLUDED__
+
+#include <QtCore>
+
+////////////////////////////////////////////////////////////////////////////////
+///\class StartupProfile startupprofile.h
+///\brief Time line of the editor startup.
+/// The startup code marks the end of each phase, from the entry of main()
+/// to the completed state sync with the amp. Marks after finish() are
+/// ignored, so code that also runs later can mark unconditionally. With
+/// trace events compiled in, each phase is recorded as span as well.
+///\remarks Only to be used from the GUI thread.
+////////////////////////////////////////////////////////////////////////////////
+class StartupProfile
+{
+public:
+  enum { MAX_PHASES = 16 };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // StartupProfile::start()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Start the time line, call this first thing in main().
+  //////////////////////////////////////////////////////////////////////////////
+  static void start();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // StartupProfile::mark()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Mark the end of a phase.
+  ///\param   [in] phase: Name of the phase (string literal).
+  //////////////////////////////////////////////////////////////////////////////
+  static void mark(const char* phase);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // StartupProfile::finish()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Mark the last phase and end the time line.
+  ///\param   [in] phase: Name of the phase (string literal).
+  ///\remarks Prints the report to stdout if enabled by setPrint().
+  //////////////////////////////////////////////////////////////////////////////
+  static void finish(const char* phase);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // StartupProfile::setPrint()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Print the report when the startup is finished?
+  ///\param   [in] enable: Print it?
+  //////////////////////////////////////////////////////////////////////////////
+  static void setPrint(bool enable);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // StartupProfile::isFinished()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Check if the startup is complete.
+  ///\return  Returns true after finish().
+  //////////////////////////////////////////////////////////////////////////////
+  static bool isFinished();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // StartupProfile::report()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Describe the time line.
+  ///\return  One line per phase with its duration and the time since start.
+  //////////////////////////////////////////////////////////////////////////////
+  static QString report();
+};
+
+#endif // #ifndef __STARTUPPROFILE_H_INCLUDED__
+///////////////////////////////// End of File //////////////////////////////////
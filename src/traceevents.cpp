@@ -0,0 +1,206 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    traceevents.cpp
+///\ingroup dtedit
+///\brief   Trace event recording implementation.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include <cstdio>
+#include <vector>
+#include <QtCore>
+#include "traceevents.h"
+#include "RtMidi/RtMidi.h"
+
+////////////////////////////////////////////////////////////////////////////////
+///\struct TraceEvent
+///\brief  A buffered span.
+////////////////////////////////////////////////////////////////////////////////
+struct TraceEvent
+{
+  const char*        category; ///> Category of the span.
+  const char*        name;     ///> Name of the span.
+  unsigned long long begin;    ///> Start time in nanoseconds.
+  unsigned long long end;      ///> End time in nanoseconds.
+  int                thread;   ///> Number of the recording thread.
+};
+
+// Spans are written in blocks of this size:
+static const size_t traceBlockSize = 1024;
+
+// Recording state, guarded by traceMutex:
+static QMutex                  traceMutex;
+static QAtomicInt              traceActive(0);
+static FILE*                   traceFile  = 0;
+static unsigned long long      traceStart = 0;
+static bool                    traceFirst = true;
+static std::vector<TraceEvent> traceEvents;
+static QList<Qt::HANDLE>       traceThreads;
+
+////////////////////////////////////////////////////////////////////////////////
+// writeEvents()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Write the buffered spans to the trace file.
+///\remarks The caller must hold traceMutex.
+////////////////////////////////////////////////////////////////////////////////
+static void writeEvents()
+{
+  // Chrome wants microseconds relative to any origin:
+  long long pid = QCoreApplication::applicationPid();
+  for (size_t i = 0; i < traceEvents.size(); i++)
+  {
+    const TraceEvent& event = traceEvents[i];
+    fprintf(traceFile, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%lld,\"tid\":%d}",
+            traceFirst ? "\n" : ",\n", event.name, event.category,
+            (event.begin - traceStart) / 1000.0, (event.end - event.begin) / 1000.0, pid, event.thread);
+    traceFirst = false;
+  }
+  traceEvents.clear();
+  fflush(traceFile);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// threadNumber()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get a small number for the calling thread.
+///\return  The number, the first thread seen gets 1.
+///\remarks The caller must hold traceMutex. A thread seen for the first
+///         time is named in the trace.
+////////////////////////////////////////////////////////////////////////////////
+static int threadNumber()
+{
+  // Known thread?
+  Qt::HANDLE id = QThread::currentThreadId();
+  int index = traceThreads.indexOf(id);
+  if (index >= 0)
+    return index + 1;
+
+  // Name it:
+  traceThreads.append(id);
+  int number = traceThreads.size();
+  bool gui = QCoreApplication::instance() != 0 && QThread::currentThread() == QCoreApplication::instance()->thread();
+  fprintf(traceFile, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%lld,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+          traceFirst ? "\n" : ",\n", static_cast<long long>(QCoreApplication::applicationPid()), number,
+          gui ? "GUI" : "MIDI/worker");
+  traceFirst = false;
+  return number;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// TraceEvents::start()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Start recording spans.
+///\param   [in] fileName: The trace file, it is replaced.
+///\return  Returns true if successfull or false otherwise.
+////////////////////////////////////////////////////////////////////////////////
+bool TraceEvents::start(const char* fileName)
+{
+  // Close a running trace:
+  stop();
+
+  // Open the file:
+  QMutexLocker lock(&traceMutex);
+  traceFile = fopen(fileName, "w");
+  if (traceFile == 0)
+    return false;
+  fputs("[", traceFile);
+
+  // Reset state:
+  traceStart = now();
+  traceFirst = true;
+  traceThreads.clear();
+  traceEvents.reserve(traceBlockSize);
+  traceActive.fetchAndStoreRelease(1);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// TraceEvents::stop()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Write the buffered spans and close the trace file.
+///\remarks An unclosed file (after a crash) can still be opened, the JSON
+///         array format does not need the closing bracket.
+////////////////////////////////////////////////////////////////////////////////
+void TraceEvents::stop()
+{
+  QMutexLocker lock(&traceMutex);
+  traceActive.fetchAndStoreRelease(0);
+  if (traceFile == 0)
+    return;
+  writeEvents();
+  fputs("\n]\n", traceFile);
+  fclose(traceFile);
+  traceFile = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// TraceEvents::isActive()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Check if spans are recorded.
+///\return  Returns true between start() and stop().
+////////////////////////////////////////////////////////////////////////////////
+bool TraceEvents::isActive()
+{
+  return traceActive.fetchAndAddAcquire(0) != 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// TraceEvents::now()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the clock of the spans.
+///\return  RtMidi::getMonotonicTime(), in nanoseconds.
+////////////////////////////////////////////////////////////////////////////////
+unsigned long long TraceEvents::now()
+{
+  return RtMidi::getMonotonicTime();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// TraceEvents::addSpan()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Record a span of the calling thread.
+///\param   [in] category: Category of the span (string literal).
+///\param   [in] name:     Name of the span (string literal).
+///\param   [in] begin:    Start time from now().
+///\param   [in] end:      End time from now().
+////////////////////////////////////////////////////////////////////////////////
+void TraceEvents::addSpan(const char* category, const char* name, unsigned long long begin, unsigned long long end)
+{
+  // Still recording? Spans that began before the start are dropped:
+  QMutexLocker lock(&traceMutex);
+  if (traceFile == 0 || begin < traceStart)
+    return;
+
+  // Buffer the span:
+  TraceEvent event;
+  event.category = category;
+  event.name     = name;
+  event.begin    = begin;
+  event.end      = end;
+  event.thread   = threadNumber();
+  traceEvents.push_back(event);
+
+  // Write full blocks:
+  if (traceEvents.size() >= traceBlockSize)
+    writeEvents();
+}
+
+///////////////////////////////// End of File //////////////////////////////////
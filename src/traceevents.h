@@ -0,0 +1,133 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    traceevents.h
+///\ingroup dtedit
+///\brief   Trace event recording definitions.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef __TRACEEVENTS_H_INCLUDED__
+#define __TRACEEVENTS_H_INCLUDED__
+
+////////////////////////////////////////////////////////////////////////////////
+// Usage
+////////////////////////////////////////////////////////////////////////////////
+// Put TRACE_SPAN("category", "name") at the start of a scope to record the
+// time spent in it. Both arguments must be string literals. The spans are
+// only compiled in with "qmake CONFIG+=trace_events" (which defines
+// __DTEDIT_TRACE_EVENTS__), otherwise TRACE_SPAN expands to nothing. This
+// header does not use Qt so RtMidi can include it as well.
+
+#ifdef __DTEDIT_TRACE_EVENTS__
+
+////////////////////////////////////////////////////////////////////////////////
+///\class TraceEvents traceevents.h
+///\brief Writes spans to a file in the Chrome trace-event JSON format.
+/// The file can be opened in Perfetto (ui.perfetto.dev) or chrome://tracing.
+/// Spans are buffered and written in blocks, recording is thread safe.
+////////////////////////////////////////////////////////////////////////////////
+class TraceEvents
+{
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  // TraceEvents::start()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Start recording spans.
+  ///\param   [in] fileName: The trace file, it is replaced.
+  ///\return  Returns true if successfull or false otherwise.
+  //////////////////////////////////////////////////////////////////////////////
+  static bool start(const char* fileName);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // TraceEvents::stop()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Write the buffered spans and close the trace file.
+  ///\remarks An unclosed file (after a crash) can still be opened, the JSON
+  ///         array format does not need the closing bracket.
+  //////////////////////////////////////////////////////////////////////////////
+  static void stop();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // TraceEvents::isActive()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Check if spans are recorded.
+  ///\return  Returns true between start() and stop().
+  //////////////////////////////////////////////////////////////////////////////
+  static bool isActive();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // TraceEvents::now()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get the clock of the spans.
+  ///\return  RtMidi::getMonotonicTime(), in nanoseconds.
+  //////////////////////////////////////////////////////////////////////////////
+  static unsigned long long now();
+
+  //////////////////////////////////////////////////////////////////////////////
+  // TraceEvents::addSpan()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Record a span of the calling thread.
+  ///\param   [in] category: Category of the span (string literal).
+  ///\param   [in] name:     Name of the span (string literal).
+  ///\param   [in] begin:    Start time from now().
+  ///\param   [in] end:      End time from now().
+  //////////////////////////////////////////////////////////////////////////////
+  static void addSpan(const char* category, const char* name, unsigned long long begin, unsigned long long end);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///\class TraceSpan traceevents.h
+///\brief Records the lifetime of a scope as span, see TRACE_SPAN.
+////////////////////////////////////////////////////////////////////////////////
+class TraceSpan
+{
+public:
+  TraceSpan(const char* category, const char* name) :
+    category(category),
+    name(name),
+    begin(TraceEvents::isActive() ? TraceEvents::now() : 0)
+  {
+  }
+
+  ~TraceSpan()
+  {
+    if (begin != 0)
+      TraceEvents::addSpan(category, name, begin, TraceEvents::now());
+  }
+
+private:
+  const char*        category; ///> Category of the span.
+  const char*        name;     ///> Name of the span.
+  unsigned long long begin;    ///> Start time, 0 if not recording.
+};
+
+#define TRACE_SPAN_JOIN2(a, b) a##b
+#define TRACE_SPAN_JOIN(a, b)  TRACE_SPAN_JOIN2(a, b)
+#define TRACE_SPAN(category, name) TraceSpan TRACE_SPAN_JOIN(traceSpan, __LINE__)(category, name)
+
+#else // #ifdef __DTEDIT_TRACE_EVENTS__
+
+#define TRACE_SPAN(category, name)
+
+#endif // #ifdef __DTEDIT_TRACE_EVENTS__
+
+#endif // #ifndef __TRACEEVENTS_H_INCLUDED__
+///////////////////////////////// End of File //////////////////////////////////
@@ -13,12 +13,14 @@
 #include <QtWidgets/QAction>
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QButtonGroup>
+#include <QtWidgets/QCheckBox>
 #include <QtWidgets/QComboBox>
 #include <QtWidgets/QDialog>
 #include <QtWidgets/QDialogButtonBox>
 #include <QtWidgets/QGroupBox>
 #include <QtWidgets/QHeaderView>
 #include <QtWidgets/QLabel>
+#include <QtWidgets/QSpinBox>
 
 QT_BEGIN_NAMESPACE
 
@@ -31,34 +33,69 @@ public:
     QComboBox *outputComboBox;
     QLabel *inputLabel;
     QLabel *outputLabel;
+    QComboBox *apiComboBox;
+    QLabel *apiLabel;
+    QCheckBox *runningStatusCheckBox;
+    QGroupBox *threadGroupBox;
+    QComboBox *schedulingComboBox;
+    QSpinBox *prioritySpinBox;
+    QLabel *schedulingLabel;
+    QLabel *schedulingInfoLabel;
 
     void setupUi(QDialog *SetupDialog)
     {
         if (SetupDialog->objectName().isEmpty())
             SetupDialog->setObjectName(QStringLiteral("SetupDialog"));
-        SetupDialog->resize(360, 154);
+        SetupDialog->resize(360, 314);
         SetupDialog->setModal(true);
         buttonBox = new QDialogButtonBox(SetupDialog);
         buttonBox->setObjectName(QStringLiteral("buttonBox"));
-        buttonBox->setGeometry(QRect(80, 110, 201, 41));
+        buttonBox->setGeometry(QRect(80, 269, 201, 41));
         buttonBox->setOrientation(Qt::Horizontal);
         buttonBox->setStandardButtons(QDialogButtonBox::Cancel|QDialogButtonBox::Ok);
         buttonBox->setCenterButtons(true);
         groupBox = new QGroupBox(SetupDialog);
         groupBox->setObjectName(QStringLiteral("groupBox"));
-        groupBox->setGeometry(QRect(10, 10, 341, 101));
+        groupBox->setGeometry(QRect(10, 10, 341, 155));
         inputComboBox = new QComboBox(groupBox);
         inputComboBox->setObjectName(QStringLiteral("inputComboBox"));
-        inputComboBox->setGeometry(QRect(90, 30, 241, 24));
+        inputComboBox->setGeometry(QRect(90, 60, 241, 24));
         outputComboBox = new QComboBox(groupBox);
         outputComboBox->setObjectName(QStringLiteral("outputComboBox"));
-        outputComboBox->setGeometry(QRect(90, 60, 241, 24));
+        outputComboBox->setGeometry(QRect(90, 90, 241, 24));
         inputLabel = new QLabel(groupBox);
         inputLabel->setObjectName(QStringLiteral("inputLabel"));
-        inputLabel->setGeometry(QRect(20, 34, 54, 20));
+        inputLabel->setGeometry(QRect(20, 64, 54, 20));
         outputLabel = new QLabel(groupBox);
         outputLabel->setObjectName(QStringLiteral("outputLabel"));
-        outputLabel->setGeometry(QRect(20, 64, 54, 20));
+        outputLabel->setGeometry(QRect(20, 94, 54, 20));
+        apiComboBox = new QComboBox(groupBox);
+        apiComboBox->setObjectName(QStringLiteral("apiComboBox"));
+        apiComboBox->setGeometry(QRect(90, 30, 241, 24));
+        apiLabel = new QLabel(groupBox);
+        apiLabel->setObjectName(QStringLiteral("apiLabel"));
+        apiLabel->setGeometry(QRect(20, 34, 54, 20));
+        runningStatusCheckBox = new QCheckBox(groupBox);
+        runningStatusCheckBox->setObjectName(QStringLiteral("runningStatusCheckBox"));
+        runningStatusCheckBox->setGeometry(QRect(90, 124, 241, 20));
+        threadGroupBox = new QGroupBox(SetupDialog);
+        threadGroupBox->setObjectName(QStringLiteral("threadGroupBox"));
+        threadGroupBox->setGeometry(QRect(10, 174, 341, 91));
+        schedulingComboBox = new QComboBox(threadGroupBox);
+        schedulingComboBox->setObjectName(QStringLiteral("schedulingComboBox"));
+        schedulingComboBox->setGeometry(QRect(90, 30, 171, 24));
+        prioritySpinBox = new QSpinBox(threadGroupBox);
+        prioritySpinBox->setObjectName(QStringLiteral("prioritySpinBox"));
+        prioritySpinBox->setGeometry(QRect(271, 30, 60, 24));
+        prioritySpinBox->setMinimum(1);
+        prioritySpinBox->setMaximum(99);
+        prioritySpinBox->setValue(70);
+        schedulingLabel = new QLabel(threadGroupBox);
+        schedulingLabel->setObjectName(QStringLiteral("schedulingLabel"));
+        schedulingLabel->setGeometry(QRect(20, 34, 64, 20));
+        schedulingInfoLabel = new QLabel(threadGroupBox);
+        schedulingInfoLabel->setObjectName(QStringLiteral("schedulingInfoLabel"));
+        schedulingInfoLabel->setGeometry(QRect(20, 64, 311, 20));
 
         retranslateUi(SetupDialog);
         QObject::connect(buttonBox, SIGNAL(accepted()), SetupDialog, SLOT(accept()));
@@ -73,6 +110,23 @@ public:
         groupBox->setTitle(QApplication::translate("SetupDialog", "MIDI Ports", 0));
         inputLabel->setText(QApplication::translate("SetupDialog", "Input:", 0));
         outputLabel->setText(QApplication::translate("SetupDialog", "Output", 0));
+        apiLabel->setText(QApplication::translate("SetupDialog", "Driver:", 0));
+#ifndef QT_NO_TOOLTIP
+        runningStatusCheckBox->setToolTip(QApplication::translate("SetupDialog", "Leave out repeated status bytes, raw MIDI drivers only", 0));
+#endif // QT_NO_TOOLTIP
+        runningStatusCheckBox->setText(QApplication::translate("SetupDialog", "Use running status", 0));
+        threadGroupBox->setTitle(QApplication::translate("SetupDialog", "MIDI Input Thread", 0));
+        schedulingComboBox->clear();
+        schedulingComboBox->insertItems(0, QStringList()
+         << QApplication::translate("SetupDialog", "Normal", 0)
+         << QApplication::translate("SetupDialog", "Real-time (FIFO)", 0)
+         << QApplication::translate("SetupDialog", "Real-time (round robin)", 0)
+        );
+#ifndef QT_NO_TOOLTIP
+        prioritySpinBox->setToolTip(QApplication::translate("SetupDialog", "Real-time priority", 0));
+#endif // QT_NO_TOOLTIP
+        schedulingLabel->setText(QApplication::translate("SetupDialog", "Scheduling:", 0));
+        schedulingInfoLabel->setText(QString());
     } // retranslateUi
 
 };
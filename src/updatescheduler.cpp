@@ -0,0 +1,199 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    updatescheduler.cpp
+///\ingroup dtedit
+///\brief   Update scheduler implementation.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#include "updatescheduler.h"
+#include "traceevents.h"
+#include "RtMidi/RtMidi.h"
+
+// Batches of at least this many changes are applied with the updates of the
+// target widget disabled. Smaller ones only repaint the changed controls:
+static const int holdUpdatesThreshold = 8;
+
+////////////////////////////////////////////////////////////////////////////////
+// UpdateScheduler::UpdateScheduler()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Initialization constructor of this scheduler.
+///\param   [in] target:     Widget whose updates are held during a batch.
+///\param   [in] statistics: Counters for the batch durations.
+////////////////////////////////////////////////////////////////////////////////
+UpdateScheduler::UpdateScheduler(QWidget* target, MIDIStatistics* statistics) :
+  QObject(target),
+  target(target),
+  statistics(statistics),
+  budget(0)
+{
+  for (int i = 0; i < 128; i++)
+  {
+    changes[i].arrival   = 0;
+    changes[i].value     = 0;
+    changes[i].receiving = false;
+    changes[i].queued    = false;
+  }
+
+  // One shot per frame, restarted by the first change of the next batch:
+  timer.setSingleShot(true);
+  #if QT_VERSION >= 0x050000
+  timer.setTimerType(Qt::PreciseTimer);
+  #endif
+  connect(&timer, SIGNAL(timeout()), this, SLOT(flush()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// UpdateScheduler::post()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Queue a control change for the next frame.
+///\param   [in] controlNumber: Controller number (0-127).
+///\param   [in] value:         Control value.
+///\param   [in] receiving:     Did it arrive during a getValuesFromDT()?
+///\remarks Can be called from any thread.
+////////////////////////////////////////////////////////////////////////////////
+void UpdateScheduler::post(int controlNumber, int value, bool receiving)
+{
+  if (controlNumber < 0 || controlNumber >= 128)
+    return;
+
+  // Queue the value, a newer one replaces the older:
+  bool first;
+  {
+    QMutexLocker lock(&mutex);
+    Change& change = changes[controlNumber];
+    if (!change.queued)
+    {
+      change.queued  = true;
+      change.arrival = RtMidi::getMonotonicTime();
+      order.append(controlNumber);
+    }
+    change.value     = value;
+    change.receiving = receiving;
+    first = order.size() == 1;
+  }
+
+  // The first change of a batch starts the frame timer. Timers belong to
+  // the GUI thread, so this goes through its event loop:
+  if (first)
+    QMetaObject::invokeMethod(this, "schedule", Qt::QueuedConnection);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// UpdateScheduler::frameBudget()
+// UpdateScheduler::setFrameBudget()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Access the time a batch may take, in microseconds.
+///\remarks The default is half the refresh interval, which leaves the
+///         other half for painting.
+////////////////////////////////////////////////////////////////////////////////
+int UpdateScheduler::frameBudget() const
+{
+  return static_cast<int>((budget != 0 ? budget : refreshInterval() / 2) / 1000);
+}
+
+void UpdateScheduler::setFrameBudget(int microSeconds)
+{
+  budget = microSeconds > 0 ? microSeconds * 1000ULL : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// UpdateScheduler::flush()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Apply all queued changes now.
+///\remarks GUI thread only. This is the frame tick.
+////////////////////////////////////////////////////////////////////////////////
+void UpdateScheduler::flush()
+{
+  TRACE_SPAN("UI", "UpdateScheduler::flush");
+  timer.stop();
+
+  // Take the batch, the MIDI thread starts the next one meanwhile:
+  QVector<int>    batch;
+  QVector<Change> values;
+  {
+    QMutexLocker lock(&mutex);
+    batch = order;
+    order.clear();
+    values.resize(batch.size());
+    for (int i = 0; i < batch.size(); i++)
+    {
+      values[i] = changes[batch[i]];
+      changes[batch[i]].queued = false;
+    }
+  }
+  if (batch.isEmpty())
+    return;
+
+  // Apply it, large batches with a single repaint at the end:
+  unsigned long long start = RtMidi::getMonotonicTime();
+  bool hold = batch.size() >= holdUpdatesThreshold && target->updatesEnabled();
+  if (hold)
+    target->setUpdatesEnabled(false);
+  for (int i = 0; i < batch.size(); i++)
+    emit apply(batch[i], values[i].value, values[i].receiving);
+  if (hold)
+    target->setUpdatesEnabled(true);
+  unsigned long long end = RtMidi::getMonotonicTime();
+
+  // Count latency and duration, and whether the frame budget was kept:
+  for (int i = 0; i < values.size(); i++)
+    statistics->messageApplied(end - values[i].arrival);
+  unsigned long long limit = budget != 0 ? budget : refreshInterval() / 2;
+  statistics->batchApplied(batch.size(), end - start, end - start > limit);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// UpdateScheduler::schedule()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Start the timer for the next frame tick.
+////////////////////////////////////////////////////////////////////////////////
+void UpdateScheduler::schedule()
+{
+  if (timer.isActive())
+    return;
+
+  // Wait for the next multiple of the refresh interval, rounded up to the
+  // timer resolution:
+  unsigned long long interval = refreshInterval();
+  unsigned long long wait     = interval - RtMidi::getMonotonicTime() % interval;
+  timer.start(static_cast<int>((wait + 999999) / 1000000));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// UpdateScheduler::refreshInterval()
+////////////////////////////////////////////////////////////////////////////////
+///\brief   Get the refresh interval of the target's screen.
+///\return  The interval in nanoseconds, 60 Hz if unknown.
+////////////////////////////////////////////////////////////////////////////////
+unsigned long long UpdateScheduler::refreshInterval() const
+{
+  qreal rate = 60.0;
+  #if QT_VERSION >= 0x050000
+  QWindow* window = target->window()->windowHandle();
+  QScreen* screen = window != 0 ? window->screen() : QGuiApplication::primaryScreen();
+  if (screen != 0 && screen->refreshRate() >= 1.0)
+    rate = screen->refreshRate();
+  #endif
+  return static_cast<unsigned long long>(1000000000.0 / rate);
+}
+
+///////////////////////////////// End of File //////////////////////////////////
@@ -0,0 +1,147 @@
+////////////////////////////////////////////////////////////////////////////////
+// (c) 2012 Rolf Meyerhoff. All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+///\file    updatescheduler.h
+///\ingroup dtedit
+///\brief   Frame paced application of received parameter changes.
+///\author  Rolf Meyerhoff (badlantic@gmail.com)
+///\version 1.0
+/// This file is part of the DT editor.
+////////////////////////////////////////////////////////////////////////////////
+///\par License:
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 2 of the License, or (at your option)
+/// any later version.
+///\par
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even  the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+/// more details.
+///\par
+/// You should have received a copy of the GNU General Public License along with
+/// this program; see the file COPYING. If not, see http://www.gnu.org/licenses/
+/// or write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+/// Floor, Boston, MA 02110-1301, USA.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef __UPDATESCHEDULER_H_INCLUDED__
+#define __UPDATESCHEDULER_H_INCLUDED__
+
+#include <QtGui>
+#if QT_VERSION >= 0x050000
+#include <QtWidgets>
+#endif
+#include "midistatistics.h"
+
+////////////////////////////////////////////////////////////////////////////////
+///\class UpdateScheduler updatescheduler.h
+///\brief Collects received control changes and applies them once per frame.
+/// A resync makes the DT send dozens of control changes back to back. Instead
+/// of updating a widget for each of them, the MIDI input thread posts them
+/// here and the GUI thread applies everything that arrived at the next frame
+/// tick in one batch. Each controller keeps only its latest value, in the
+/// order of its first arrival. Large batches are applied with the updates of
+/// the target widget disabled, so the whole batch ends in one repaint.
+///
+/// The ticks are placed on multiples of the refresh interval of the screen.
+/// The time spent applying each batch is counted in the MIDI statistics,
+/// together with the batches that took longer than the frame budget.
+////////////////////////////////////////////////////////////////////////////////
+class UpdateScheduler : public QObject
+{
+  Q_OBJECT // Qt magic...
+
+public:
+  //////////////////////////////////////////////////////////////////////////////
+  // UpdateScheduler::UpdateScheduler()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Initialization constructor of this scheduler.
+  ///\param   [in] target:     Widget whose updates are held during a batch.
+  ///\param   [in] statistics: Counters for the batch durations.
+  //////////////////////////////////////////////////////////////////////////////
+  UpdateScheduler(QWidget* target, MIDIStatistics* statistics);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // UpdateScheduler::post()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Queue a control change for the next frame.
+  ///\param   [in] controlNumber: Controller number (0-127).
+  ///\param   [in] value:         Control value.
+  ///\param   [in] receiving:     Did it arrive during a getValuesFromDT()?
+  ///\remarks Can be called from any thread.
+  //////////////////////////////////////////////////////////////////////////////
+  void post(int controlNumber, int value, bool receiving);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // UpdateScheduler::frameBudget()
+  // UpdateScheduler::setFrameBudget()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Access the time a batch may take, in microseconds.
+  ///\remarks The default is half the refresh interval, which leaves the
+  ///         other half for painting.
+  //////////////////////////////////////////////////////////////////////////////
+  int  frameBudget() const;
+  void setFrameBudget(int microSeconds);
+
+public slots:
+  //////////////////////////////////////////////////////////////////////////////
+  // UpdateScheduler::flush()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Apply all queued changes now.
+  ///\remarks GUI thread only. This is the frame tick.
+  //////////////////////////////////////////////////////////////////////////////
+  void flush();
+
+signals:
+  //////////////////////////////////////////////////////////////////////////////
+  // UpdateScheduler::apply()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Apply a control change to the user interface.
+  ///\param   [in] controlNumber: Controller number.
+  ///\param   [in] value:         Control value.
+  ///\param   [in] receiving:     Did it arrive during a getValuesFromDT()?
+  //////////////////////////////////////////////////////////////////////////////
+  void apply(int controlNumber, int value, bool receiving);
+
+private slots:
+  //////////////////////////////////////////////////////////////////////////////
+  // UpdateScheduler::schedule()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Start the timer for the next frame tick.
+  //////////////////////////////////////////////////////////////////////////////
+  void schedule();
+
+private:
+  //////////////////////////////////////////////////////////////////////////////
+  ///\struct Change
+  ///\brief  Latest queued value of a controller.
+  //////////////////////////////////////////////////////////////////////////////
+  struct Change
+  {
+    unsigned long long arrival;   ///> Arrival of the oldest unapplied value.
+    int                value;     ///> Latest value.
+    bool               receiving; ///> Latest receiving state.
+    bool               queued;    ///> Is the controller in the batch?
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // UpdateScheduler::refreshInterval()
+  //////////////////////////////////////////////////////////////////////////////
+  ///\brief   Get the refresh interval of the target's screen.
+  ///\return  The interval in nanoseconds, 60 Hz if unknown.
+  //////////////////////////////////////////////////////////////////////////////
+  unsigned long long refreshInterval() const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Member:
+  QWidget*           target;        ///> Widget held during a batch.
+  MIDIStatistics*    statistics;    ///> Counters for the batch durations.
+  QTimer             timer;         ///> Frame tick.
+  QMutex             mutex;         ///> Guards changes and order.
+  Change             changes[128];  ///> Latest value of each controller.
+  QVector<int>       order;         ///> Queued controllers by first arrival.
+  unsigned long long budget;        ///> Frame budget in nanoseconds (0 = auto).
+};
+
+#endif // #ifndef __UPDATESCHEDULER_H_INCLUDED__
+///////////////////////////////// End of File //////////////////////////////////